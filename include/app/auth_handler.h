@@ -3,13 +3,29 @@
 
 typedef struct ClientContext ClientContext;
 
+/**
+ * @brief 비밀번호 해시 전용 스레드 풀을 시작합니다.
+ * * scrypt 1회가 수십 ms CPU를 쓰므로, 요청 워커에서 돌리면 로그인이 몰릴 때 스트리밍 응답이 밀립니다.
+ * * 로그인/회원가입은 파싱만 요청 워커에서 하고 해시와 응답은 이 풀에서 처리합니다.
+ * * 큐가 가득 차면 기다리지 않고 503 + Retry-After로 바로 거절합니다.
+ * @param num_threads 0 이하이면 풀 없이 요청 워커에서 해시
+ * @param queue_capacity 대기 가능한 인증 요청 수
+ * @return 성공 0, 풀 없이 동작 -1
+ */
+int auth_pool_init(int num_threads, int queue_capacity);
+
+/**
+ * @brief 대기 중인 인증 요청까지 처리한 뒤 풀을 종료합니다. (요청 워커 풀 종료 후 호출)
+ */
+void auth_pool_shutdown(void);
+
 /**
  * @brief 로그인 요청(POST /login)을 처리합니다.
- * * 1. HTTP Body에서 username과 password를 파싱합니다.
- * 2. db_verify_user()를 호출하여 자격 증명을 확인합니다.
+ * * 1. HTTP Body에서 username과 password를 파싱해 인증 풀로 넘깁니다.
+ * 2. 저장된 scrypt 해시와 비교합니다. (평문/이전 비용 해시면 맞았을 때 새 해시로 교체)
  * 3. 성공 시 session_create()로 세션을 생성합니다.
  * 4. 성공 응답과 함께 Set-Cookie 헤더를 클라이언트에 전송합니다.
- * * @param ctx 클라이언트 컨텍스트
+ * * @param ctx 클라이언트 컨텍스트 (인증 풀로 넘어가면 그 스레드가 응답 후 재등록)
  */
 void handle_login(ClientContext *ctx);
 
@@ -22,6 +38,10 @@ void handle_login(ClientContext *ctx);
  */
 void handle_logout(ClientContext *ctx);
 
-
+/**
+ * @brief 회원가입 요청(POST /register)을 처리합니다.
+ * * 비밀번호는 인증 풀에서 salt를 붙여 scrypt로 해시한 값만 저장합니다.
+ * * @param ctx 클라이언트 컨텍스트
+ */
 void handle_register(ClientContext *ctx);
 #endif
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+typedef struct ClientContext ClientContext;
+typedef struct JsonWriter JsonWriter;
+
+/**
+ * @brief 목록 한 페이지의 최대 항목 수를 정합니다. (catalog_refresh 전에 호출)
+ * @param page_max 0 이하이면 기본값 200
+ */
+void catalog_init(int page_max);
+
+/**
+ * @brief DB의 비디오 목록으로 카탈로그 스냅샷을 새로 만들어 교체합니다.
+ * * 1. 비디오마다 사용자와 무관한 JSON 조각(제목, 썸네일, 길이 등)을 미리 직렬화해 둡니다.
+ * 2. 새 스냅샷을 만든 뒤 포인터만 바꾸므로, 응답을 만드는 중인 요청은 이전 스냅샷을 끝까지 씁니다. (참조 카운트)
+ * 3. 스냅샷 버전은 내용 해시이므로 재시작하거나 프로세스가 달라도 같은 카탈로그면 같은 ETag가 나옵니다.
+ * 4. 버전이 달라졌을 때만 제목 검색 색인을 새로 만들어 스냅샷과 함께 교체합니다. (같으면 새 스냅샷을 버림)
+ * * 기동 시(db_init 이후)와 라이브러리 변경을 DB에 반영한 뒤 호출합니다.
+ * @return 성공 0, 실패 -1 (실패 시 이전 스냅샷 유지)
+ */
+int catalog_refresh(void);
+
+/**
+ * @brief 동영상 목록 API 요청을 처리합니다. (GET /api/videos)
+ * * 1. ?limit=&cursor= 키셋 페이지: cursor(이전 페이지 마지막 id) 다음부터 최대 limit개.
+ *    더 남아 있으면 X-Next-Cursor 헤더로 다음 커서를 알려 줍니다.
+ * 2. 페이지 항목의 이어보기 위치를 (user_id) 인덱스로 조회합니다. (쓰기 지연 버퍼에 있는 최신 위치가 우선)
+ * 3. ETag = 카탈로그 버전 + 페이지 범위 + 사용자 위치 해시 + 서명 만료 구간. If-None-Match가 같으면 본문 없이 304.
+ * 4. 아니면 미리 이스케이프한 조각 사이에 서명 URL과 last_pos만 끼워 넣어 chunked 인코딩으로 흘려보냅니다.
+ * * @param ctx 클라이언트 컨텍스트
+ */
+void handle_api_video_list(ClientContext *ctx);
+
+/**
+ * @brief 제목 검색 API 요청을 처리합니다. (GET /api/search?q=&limit=N)
+ * * 1. 스냅샷과 함께 만든 제목 역색인으로 찾습니다. (검색어 단어마다 접두어 일치, 한글 초성 검색 지원)
+ * 2. 점수 순으로 최대 N개(기본 20, 상한 50). 항목 모양은 /api/videos와 같습니다.
+ * 3. 검색어가 비어 있거나 구분자뿐이면 빈 배열입니다.
+ * * 색인은 catalog_refresh에서 내용이 바뀐 경우에만 다시 만들고, 요청 경로에서는 읽기만 합니다.
+ * @param ctx 클라이언트 컨텍스트
+ */
+void handle_api_search(ClientContext *ctx);
+
+/**
+ * @brief 주어진 비디오들을 /api/videos와 같은 모양의 JSON 배열로 씁니다. (이어보기 목록용)
+ * * 순서는 입력 순서를 따르고, 카탈로그에 없는 비디오와 거의 끝까지 본 비디오(남은 길이 5% 미만)는 건너뜁니다.
+ * @param video_ids / positions 비디오 ID와 이어보기 위치 (count개)
+ * @param max_items 최대 항목 수
+ * @return 쓴 항목 수
+ */
+int catalog_write_in_progress(JsonWriter *w, int user_id, const int *video_ids, const int *positions,
+                              int count, int max_items);
+
+/**
+ * @brief 현재 스냅샷을 놓습니다. (응답 중인 요청이 끝나면 해제)
+ */
+void catalog_cleanup(void);
+
+#endif
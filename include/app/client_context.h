@@ -23,7 +23,7 @@ typedef struct ClientContext{
     int epoll_fd;
     int client_fd;                      // 클라이언트 소켓
     char client_ip[INET_ADDRSTRLEN];    // 클라이언트 ip
-    char session_id[33];                // 세션 ID 저장용 (NULL 포함 33바이트)
+    char session_id[64];                // 세션 ID 또는 서명 토큰 저장용 (NULL 포함)
     time_t last_active;                 // Resource Leak 방지
 
     char buffer[4096];  // 송수신 버퍼 (재사용)
@@ -36,13 +36,34 @@ typedef struct ClientContext{
 
     Method method;
     char request_path[512];
+    char query[256];        // '?' 뒤 쿼리 문자열 (request_path에서 분리)
+    int url_max_age;        // 서명 URL로 인증된 경우 만료까지 남은 초 (0: 세션으로 인증)
+    char if_none_match[64]; // If-None-Match 헤더 값 (조건부 요청, 없으면 빈 문자열)
+    long long req_start_ns; // 라우팅을 시작한 시각 (경로별 지연 측정, 비동기로 끝나는 경로가 사용)
 
     int file_fd;            
+    dev_t file_dev;     // 세그먼트 캐시 키 (dev, ino, mtime)
+    ino_t file_ino;
+    time_t file_mtime;
+    off_t file_size;    // 파일 전체 크기
     off_t file_offset;  // 현재 파일 위치
     off_t range_start;  // range 시작점
     off_t range_end;    // range 끝점 (-1이면 끝까지)
 
     size_t bytes_remaining; // 남은 파일 크기 (Chunk)
+
+    // direct 읽기 엔진 (STREAM_READ_ENGINE = direct)
+    int direct_fd;          // O_DIRECT로 연 파일 (-1이면 sendfile)
+    int io_buf;             // 읽기가 끝나 전송 대기 중인 버퍼 (-1: 없음)
+    int io_result;          // 읽기 결과 (바이트 수 또는 -errno)
+    off_t io_skip;          // 정렬 오프셋 -> 실제 요청 오프셋까지의 거리
+    const char *io_data;    // 아직 보내지 않은 데이터 시작
+    size_t io_len;          // 아직 보내지 않은 데이터 길이
+
+    // 장치별 I/O 큐 (device_io)
+    int io_dev;             // 응답을 서비스 중인 장치 (-1: 범용 워커에서 처리)
+    void (*io_handler)(struct ClientContext *ctx); // EPOLLOUT 재개 시 호출할 핸들러
+    long long io_enqueued_ns; // 장치 큐에 넣은 시각 (대기 시간 측정)
 } ClientContext;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef CONTINUE_WATCHING_H
+#define CONTINUE_WATCHING_H
+
+typedef struct ClientContext ClientContext;
+
+#define CONTINUE_MAX_ITEMS 20   // limit 상한 (기본 10)
+
+// 통계 스냅샷
+typedef struct {
+    unsigned long long cached_users;    // 캐시에 있는 사용자 수
+    unsigned long long capacity;
+    unsigned long long hits;
+    unsigned long long misses;          // DB(커버링 인덱스) 조회 수
+    unsigned long long updates;         // 하트비트로 캐시 목록을 갱신한 수
+    unsigned long long evictions;
+} ContinueStats;
+
+/**
+ * @brief 사용자별 "이어보기" 목록 LRU 캐시를 준비합니다. (db_init 이후)
+ * @param cache_users 캐시할 최대 사용자 수 (0 이하이면 캐시 없이 매번 DB 조회)
+ * @return 성공 0, 캐시 비활성 -1
+ */
+int continue_watching_init(int cache_users);
+
+/**
+ * @brief 시청 위치 기록을 캐시에 반영합니다. (history_buffer_put 성공 후 호출)
+ * * 캐시에 있는 사용자면 해당 비디오를 목록 맨 앞으로 옮기고 위치를 바꿉니다. 없으면 아무 일도 하지 않습니다.
+ * * 위치가 0 이하(처음부터 다시)이면 그 사용자의 캐시를 버리고 다음 조회 때 DB에서 다시 읽습니다.
+ */
+void continue_watching_on_write(int user_id, int video_id, int last_pos);
+
+/**
+ * @brief 이어보기 API 요청을 처리합니다. (GET /api/continue?limit=N)
+ * * 1. 최근에 본 순서로 시청 중인 비디오를 최대 N개(기본 10, 상한 CONTINUE_MAX_ITEMS) 돌려줍니다.
+ * 2. 캐시에 없으면 (user_id, updated_at DESC) 커버링 인덱스로 상위 몇 행만 읽고,
+ *    쓰기 지연 버퍼에 더 최신 위치가 있으면 덮어씁니다.
+ * 3. 항목 모양은 /api/videos와 같습니다. (카탈로그 스냅샷의 조각 + 서명 URL)
+ * * 로그인하지 않았으면 401을 반환합니다.
+ * @param ctx 클라이언트 컨텍스트
+ */
+void handle_api_continue(ClientContext *ctx);
+
+/**
+ * @brief 캐시 통계를 채웁니다.
+ */
+void continue_watching_get_stats(ContinueStats *out);
+
+/**
+ * @brief 캐시를 해제합니다.
+ */
+void continue_watching_cleanup(void);
+
+#endif
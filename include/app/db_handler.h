@@ -1,34 +1,55 @@
 #ifndef DB_HANDLER_H
 #define DB_HANDLER_H
 
+#include <stddef.h>
+
 typedef struct ClientContext ClientContext;
 
+// 라이브러리 스캐너가 DB에 반영할 비디오 1건
+typedef struct {
+    const char *filepath;   // URL 경로 (예: "/videos/movie.mp4"), UNIQUE 키
+    const char *title;
+    const char *thumbnail;  // 썸네일 URL 경로
+    int duration;           // 초 단위
+    long long file_size;    // 변경 감지용
+    long long file_mtime;   // 변경 감지용
+} VideoRecord;
+
+// 시청 이력 쓰기 지연 버퍼가 DB에 반영할 위치 1건
+typedef struct {
+    int user_id;
+    int video_id;
+    int last_pos;
+    long long updated_at;   // unix time (마지막 하트비트 시각)
+} HistoryRecord;
+
 /**
  * @brief 데이터베이스 시스템을 초기화.
  * * 1. SQLite DB 파일을 엽니다 (없으면 생성).
  * 2. 'videos' 테이블이 존재하는지 확인하고 없으면 생성(CREATE TABLE)합니다.
- * 3. 테이블이 비어있다면 테스트용 초기 데이터(Seed Data)를 삽입합니다.
+ * 3. 비디오 목록은 채우지 않습니다. (library_scanner가 미디어 폴더를 스캔하여 반영)
+ * 4. 조회용 읽기 전용 연결 read_pool_size개를 엽니다. 조회 함수는 연결을 빌려 쓰므로
+ *    워커 수만큼 병렬로 실행되고, 쓰기는 기존 연결에서 직렬화됩니다. (WAL)
  * * @param db_path 데이터베이스 파일 경로 (예: "./ott.db")
+ * @param read_pool_size 읽기 연결 수 (0이면 풀 없이 단일 연결 사용)
  * @return 성공 시 0, 실패 시 -1
  */
-int db_init(const char *db_path);
+int db_init(const char *db_path, int read_pool_size);
 
 /**
- * @brief 동영상 목록 API 요청을 처리합니다. (GET /api/videos)
- * * 1. DB에서 id, title, filepath, thumbnail 등을 조회합니다.
- * 2. 조회된 데이터를 JSON 포맷의 문자열로 직렬화(Serialization)합니다.
- * 3. ClientContext 버퍼에 기록하고 응답(200 OK, Application/json)을 전송합니다.
- * * @param ctx 클라이언트 컨텍스트
+ * @brief 아이디로 사용자와 저장된 비밀번호 해시를 조회합니다. (검증은 password_verify)
+ * @param username 클라이언트가 입력한 아이디
+ * @param out_user_id 사용자 ID
+ * @param out_hash 저장된 값 (PASSWORD_HASH_LEN 이상)
+ * @return 찾으면 0, 없는 아이디 -1, DB 오류 -2
  */
-void handle_api_video_list(ClientContext *ctx);
+int db_get_user_password(const char *username, int *out_user_id, char *out_hash, size_t out_len);
 
 /**
- * @brief 사용자 아이디와 비밀번호를 검증합니다.
- * @param username 클라이언트가 입력한 아이디
- * @param password 클라이언트가 입력한 비밀번호
- * @return 검증 성공 시 user_id (양수), 일치하는 유저 없음 -1, DB 오류 -2
+ * @brief 저장된 비밀번호 해시를 교체합니다. (평문/이전 비용 해시를 로그인 시 업그레이드)
+ * @return 성공 0, 실패 -1
  */
-int db_verify_user(const char *username, const char *password);
+int db_update_password(int user_id, const char *password_hash);
 
 /**
  * @brief 데이터베이스 연결을 닫고 자원을 해제합니다.
@@ -45,13 +66,84 @@ void db_cleanup();
 int db_update_history(int user_id, int video_id, int timestamp);
 
 /**
- * @brief 로그인한 유저의 시청 기록이 포함된 비디오 목록 JSON을 반환합니다.
- * @param user_id 로그인한 사용자 ID
- * @return JSON 문자열 (반드시 free 해야 함)
+ * @brief 사용자의 이어보기 위치(last_pos > 0)를 video_id 오름차순으로 순회합니다.
+ * @param callback (video_id, last_pos, arg)를 받는 함수
+ * @return 성공 0, 실패 -1
+ */
+int db_for_each_user_position(int user_id, void (*callback)(int video_id, int last_pos, void *arg),
+                              void *arg);
+
+/**
+ * @brief 사용자의 시청 중인 비디오(last_pos > 0)를 최근 시청 순으로 최대 limit개 순회합니다.
+ * * (user_id, updated_at DESC, video_id, last_pos) 커버링 인덱스 범위 조회라 이력 전체를 정렬하지 않습니다.
+ * @param callback (video_id, last_pos, updated_at(unix 초), arg)를 받는 함수
+ * @return 성공 0, 실패 -1
+ */
+int db_for_each_recent_history(int user_id, int limit,
+                               void (*callback)(int video_id, int last_pos, long long updated_at, void *arg),
+                               void *arg);
+
+// 회원가입 (password_hash로 만든 해시 문자열 저장): 성공 시 0, 중복 아이디면 -1, DB 에러 -2
+int db_create_user(const char *username, const char *password_hash);
+
+/**
+ * @brief 등록된 모든 비디오를 id 순으로 순회하며 callback을 호출합니다.
+ * callback 안에서 전달받은 문자열은 호출이 끝나면 무효가 되므로 필요하면 복사해야 합니다.
+ * @param callback (id, filepath, thumbnail, arg)를 받는 함수
+ * @param arg callback에 그대로 전달할 사용자 데이터
+ * @return 성공 0, 실패 -1
+ */
+int db_for_each_video(void (*callback)(int id, const char *filepath, const char *thumbnail, void *arg),
+                      void *arg);
+
+/**
+ * @brief 카탈로그 스냅샷용으로 모든 비디오의 표시 정보를 id 순으로 순회합니다.
+ * @param callback (id, title, filepath, thumbnail, duration, arg)를 받는 함수
+ * @return 성공 0, 실패 -1
  */
-char* db_get_video_list_json(int user_id);
+int db_for_each_catalog_item(void (*callback)(int id, const char *title, const char *filepath,
+                                               const char *thumbnail, int duration, void *arg),
+                             void *arg);
 
-// 회원가입: 성공 시 0, 중복 아이디면 -1, DB 에러 -2
-int db_create_user(const char *username, const char *password);
+/**
+ * @brief 라이브러리 변경 감지용으로 모든 비디오의 (filepath, size, mtime)을 순회합니다.
+ * @param callback (id, filepath, file_size, file_mtime, arg)를 받는 함수
+ * @param arg callback에 그대로 전달할 사용자 데이터
+ * @return 성공 0, 실패 -1
+ */
+int db_for_each_library_entry(void (*callback)(int id, const char *filepath,
+                                                long long file_size, long long file_mtime, void *arg),
+                              void *arg);
+
+/**
+ * @brief 최근 시청 활동이 많은 비디오와 각 시청자의 이어보기 위치를 순회합니다. (프리웜용)
+ * * 1. 최근 window_days 일 동안 갱신된 watch_history를 비디오별로 집계해 시청자 수 순으로 top_n개를 고릅니다.
+ * 2. 고른 비디오마다 이어보기 위치(last_pos > 0)별로 callback을 호출합니다. 위치가 없으면 last_pos = 0으로 한 번 호출합니다.
+ * 3. 같은 비디오의 행은 연속해서 전달되며, 비디오 순서는 순위 순입니다.
+ * @param callback (video_id, filepath, duration, last_pos, arg)를 받는 함수
+ * @return 성공 0, 실패 -1
+ */
+int db_for_each_prewarm_target(int window_days, int top_n,
+                               void (*callback)(int video_id, const char *filepath, int duration,
+                                                int last_pos, void *arg),
+                               void *arg);
+
+/**
+ * @brief 시청 위치 여러 건을 단일 트랜잭션으로 upsert합니다. (history_buffer 플러시용)
+ * 라이브러리 배치와 같은 전용 쓰기 연결을 사용하므로 요청 처리 워커의 쿼리와 섞이지 않습니다.
+ * @return 성공 0, 실패 -1 (실패 시 전체 롤백)
+ */
+int db_apply_history_batch(const HistoryRecord *records, int count);
+
+/**
+ * @brief 라이브러리 변경분을 단일 트랜잭션으로 반영합니다.
+ * * 1. upserts: filepath 기준 INSERT 또는 UPDATE (기존 id 유지)
+ * 2. removed: filepath 삭제. '/'로 끝나는 항목은 해당 경로 하위 전체 삭제
+ * 3. 요청 처리 워커와 섞이지 않도록 전용 쓰기 연결을 사용합니다.
+ * * @param out_ids upsert된 각 행의 id를 받을 배열 (n_upserts 크기, NULL 가능)
+ * @return 성공 0, 실패 -1 (실패 시 전체 롤백)
+ */
+int db_apply_library_batch(const VideoRecord *upserts, int n_upserts,
+                           const char *const *removed, int n_removed, int *out_ids);
 
 #endif
\ No newline at end of file
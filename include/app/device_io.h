@@ -0,0 +1,67 @@
+#ifndef DEVICE_IO_H
+#define DEVICE_IO_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "app/client_context.h"
+
+// 구분할 수 있는 최대 장치(st_dev) 수
+#define DEVICE_IO_MAX_DEVICES 16
+// 이 크기 이하의 Range 요청은 작은 요청으로 보고 503을 보내지 않음 (탐색용 probe 등)
+#define DEVICE_IO_SMALL_BYTES (1024 * 1024)
+
+typedef void (*DeviceIoHandler)(ClientContext *ctx);
+
+/**
+ * @brief 장치별 I/O 큐 시스템을 초기화합니다. (장치 등록은 device_io_register_path로)
+ * @param threads_per_device 장치 하나에 할당할 I/O 스레드 수
+ * @param max_active_per_device 장치 하나에 대기 중이거나 실행 중인 디스크 작업 수 상한 (넘으면 새 대용량 요청은 503)
+ * @return 성공 0, 실패 -1
+ */
+int device_io_init(int threads_per_device, int max_active_per_device);
+
+/**
+ * @brief 디렉토리를 해당 장치(st_dev)의 큐에 매핑합니다.
+ * * 처음 보는 장치면 전용 스레드 풀을 만들고, 이미 있는 장치면 경로 접두사만 추가합니다.
+ * @param path 미디어 루트, 정적 파일 디렉토리 등
+ * @return 장치 인덱스 (0 이상), 실패 -1
+ */
+int device_io_register_path(const char *path);
+
+/**
+ * @brief 파일 응답을 요청 경로가 속한 장치의 큐로 넘깁니다.
+ * * 1. ctx->request_path(물리 경로)의 접두사로 장치를 찾습니다. 없으면 현재 스레드에서 바로 처리합니다.
+ * 2. 대용량 요청은 장치에 대기/실행 중인 작업이 이미 max_active 이상이면 503을 보냅니다.
+ *    소켓이 쓰기 가능해지길 기다리는(EPOLLOUT) 응답은 작업으로 세지 않습니다.
+ * 3. 작은 요청(정적 파일, DEVICE_IO_SMALL_BYTES 이하 Range)은 같은 큐를 쓰되 거절하지 않습니다.
+ * 4. 이후 EAGAIN으로 재개되는 전송(device_io_resume)도 응답이 끝날 때까지 같은 장치 큐에서 실행됩니다.
+ * @param ctx 클라이언트 컨텍스트 (request_path가 물리 경로로 변환된 상태)
+ * @param handler 실제 처리 함수 (handle_streaming_request, handle_static_request)
+ * @param bulk 동영상 본문처럼 오래 디스크를 읽는 응답이면 true (상한 적용 대상)
+ */
+void device_io_dispatch(ClientContext *ctx, DeviceIoHandler handler, bool bulk);
+
+/**
+ * @brief 전송 중(EPOLLOUT) 재개 이벤트를 원래 장치 큐로 보냅니다.
+ * * 이미 시작한 응답이므로 상한과 관계없이 넣습니다. 큐가 가득 차면 연결을 닫습니다. (장치 밖으로 새지 않음)
+ * 장치 큐를 쓰지 않는 응답이면 현재 스레드에서 바로 처리합니다.
+ */
+void device_io_resume(ClientContext *ctx);
+
+/**
+ * @brief 응답이 끝났거나 연결을 닫을 때 장치 큐와의 연결을 끊습니다. (중복 호출 안전)
+ */
+void device_io_release(ClientContext *ctx);
+
+/**
+ * @brief 장치별 큐 깊이, 대기 시간, 서비스 지연 통계를 JSON 배열로 씁니다.
+ * @return 쓴 바이트 수 (snprintf 규칙)
+ */
+int device_io_stats_json(char *buf, size_t cap);
+
+/**
+ * @brief 모든 장치 풀을 정리합니다.
+ */
+void device_io_shutdown(void);
+
+#endif
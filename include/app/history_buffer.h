@@ -0,0 +1,63 @@
+#ifndef HISTORY_BUFFER_H
+#define HISTORY_BUFFER_H
+
+// 통계 스냅샷
+typedef struct {
+    unsigned long long buffered;    // 메모리에 있는 (user, video) 항목 수
+    unsigned long long dirty;       // 아직 DB에 쓰지 않은 항목 수
+    unsigned long long puts;        // 받은 하트비트 수
+    unsigned long long coalesced;   // 같은 항목의 이전 값을 덮어쓴 수 (DB 쓰기 절약)
+    unsigned long long flushes;     // 커밋한 배치 수
+    unsigned long long rows_flushed;
+    unsigned long long write_through; // 버퍼가 가득 차 바로 DB에 쓴 수
+    double last_flush_ms;
+} HistoryBufferStats;
+
+/**
+ * @brief 시청 이력 쓰기 지연 버퍼를 시작합니다.
+ * * 1. /api/history 하트비트는 (user_id, video_id)별 최신 위치만 메모리에 남깁니다.
+ * 2. 백그라운드 스레드가 flush_interval_sec마다 변경된 항목 전체를 한 트랜잭션으로 씁니다.
+ * 3. 종료 시(history_buffer_shutdown) 남은 항목을 모두 씁니다.
+ * * db_init 이후에 호출해야 합니다.
+ * @param flush_interval_sec 배치 주기 (초, 0이면 비활성 -> 요청마다 바로 DB에 씀)
+ * @param max_entries 버퍼 항목 상한 (넘으면 해당 요청은 바로 DB에 씀)
+ * @return 성공 0, 비활성/실패 -1
+ */
+int history_buffer_init(int flush_interval_sec, int max_entries);
+
+/**
+ * @brief 시청 위치를 기록합니다. (버퍼가 비활성이면 db_update_history로 바로 씀)
+ * @return 성공 0, 실패 -1
+ */
+int history_buffer_put(int user_id, int video_id, int last_pos);
+
+/**
+ * @brief 아직 DB에 반영되지 않았을 수 있는 최신 위치를 조회합니다.
+ * @param out_pos 찾으면 위치 (초)
+ * @return 버퍼에 있으면 1, 없으면 0 (DB 값이 최신)
+ */
+int history_buffer_get(int user_id, int video_id, int *out_pos);
+
+/**
+ * @brief 한 사용자에 대해 버퍼에 있는 위치를 모두 순회합니다. (아직 DB에 없을 수 있는 최근 시청 포함)
+ * * 항목이 (user, video) 해시로 흩어져 있어 전체 스트라이프를 훑으므로, 캐시 미스처럼 드문 경로에서만 사용합니다.
+ * * callback은 스트라이프 락을 잡은 채 호출되므로 짧게 끝내야 하고 버퍼 함수를 다시 부르면 안 됩니다.
+ * @param callback (video_id, last_pos, updated_at(unix 초), arg)를 받는 함수
+ * @return 순회한 항목 수 (버퍼가 비활성이면 0)
+ */
+int history_buffer_for_each_user(int user_id,
+                                 void (*callback)(int video_id, int last_pos, long long updated_at, void *arg),
+                                 void *arg);
+
+/**
+ * @brief 통계 스냅샷을 복사합니다.
+ */
+void history_buffer_get_stats(HistoryBufferStats *out);
+
+/**
+ * @brief 플러시 스레드를 멈추고 남은 항목을 모두 DB에 씁니다.
+ * 워커 스레드가 모두 멈춘 뒤, db_cleanup 이전에 호출해야 합니다.
+ */
+void history_buffer_shutdown(void);
+
+#endif
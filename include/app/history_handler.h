@@ -8,7 +8,8 @@
  * 요청 바디: video_id=1&timestamp=120
  * * 1. 세션을 통해 user_id를 식별합니다 (보안 필수).
  * 2. 바디에서 video_id와 timestamp를 파싱합니다.
- * 3. db_update_history()를 호출하여 저장합니다.
+ * 3. history_buffer_put()으로 쓰기 지연 버퍼에 기록합니다. (비활성이면 바로 DB에 저장)
+ * 4. 캐시된 이어보기 목록에 반영합니다. (continue_watching_on_write)
  */
 void handle_api_history(ClientContext *ctx);
 
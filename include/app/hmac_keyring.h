@@ -0,0 +1,53 @@
+#ifndef HMAC_KEYRING_H
+#define HMAC_KEYRING_H
+#include <stddef.h>
+#include <stdint.h>
+
+// 서명 길이 (HMAC-SHA256 앞 128비트)
+#define HMAC_KEYRING_MAC_LEN 16
+
+/**
+ * @brief 서명 키를 읽습니다. (세션 토큰, 서명 URL 공용)
+ * * 키 파일 형식: 한 줄에 "<kid> <hex 키>" (kid 0~255, 키 16~64바이트, '#' 주석)
+ * * 첫 번째 키로 새 서명을 만들고, 나머지 키는 검증에만 사용합니다. (키 교체 기간)
+ * * key_file이 비어 있으면 기동 시 무작위 키를 만듭니다. (재시작하면 기존 서명 무효)
+ * * 초기화 이후 키는 읽기 전용이므로 서명/검증에 락이 없습니다.
+ * @param key_file 키 파일 경로 (NULL 또는 빈 문자열 허용)
+ * @return 성공 0, 실패 -1
+ */
+int hmac_keyring_init(const char *key_file);
+
+/**
+ * @brief 새 서명에 쓰는 키 id를 반환합니다. (초기화 전이면 -1)
+ */
+int hmac_keyring_active_kid(void);
+
+/**
+ * @brief kid 키로 data의 HMAC-SHA256을 계산해 앞 HMAC_KEYRING_MAC_LEN 바이트를 mac에 씁니다.
+ * @return 성공 0, 해당 키가 없으면 -1
+ */
+int hmac_keyring_sign(int kid, const void *data, size_t len, uint8_t *mac);
+
+/**
+ * @brief 서명을 다시 계산해 상수 시간으로 비교합니다.
+ * @return 일치하면 0, 아니면 -1
+ */
+int hmac_keyring_verify(int kid, const void *data, size_t len, const uint8_t *mac);
+
+/**
+ * @brief 패딩 없는 base64url 인코딩 (out은 (len * 4 + 2) / 3 + 1 바이트 이상)
+ */
+void b64url_encode(const uint8_t *in, size_t len, char *out);
+
+/**
+ * @brief 패딩 없는 base64url 디코딩. 정확히 out_len 바이트가 나와야 성공
+ * @return 성공 0, 실패 -1
+ */
+int b64url_decode(const char *in, size_t in_len, uint8_t *out, size_t out_len);
+
+/**
+ * @brief 키를 메모리에서 지웁니다.
+ */
+void hmac_keyring_cleanup(void);
+
+#endif
@@ -30,6 +30,13 @@ typedef enum {
  */
 void send_error_response(ClientContext *ctx, int status_code);
 
+/**
+ * @brief 클라이언트 소켓을 닫고 컨텍스트를 해제합니다. (닫힌 연결 수를 셈)
+ * * 연결을 끝내는 곳은 모두 이 함수를 거치므로 (수락 수 - 닫힌 수)가 열린 연결 수가 됩니다.
+ * * 파일/direct 버퍼 등 다른 자원은 호출 전에 정리해야 합니다. 호출 뒤에는 ctx에 접근하지 마세요.
+ */
+void http_close_client(ClientContext *ctx);
+
 /**
  * @brief key=value&key2=value2 형태의 문자열을 파싱하여 특정 키의 값을 찾습니다.
  * @param body 원본 데이터 포인터
@@ -39,6 +46,27 @@ void send_error_response(ClientContext *ctx, int status_code);
  */
 int http_get_form_param(const char *body, const char *key, char *out_buf, size_t out_len);
 
+/**
+ * @brief 폼/쿼리 값의 퍼센트 인코딩을 그 자리에서 풉니다. ('+'는 공백, 잘못된 %XX는 그대로)
+ * @param s NULL 종료 문자열 (결과는 항상 원래보다 짧거나 같음)
+ */
+void http_url_decode(char *s);
+
+/**
+ * @brief URL 경로를 퍼센트 인코딩합니다. (영숫자와 "-._~/"만 그대로, 공백/한글/?#& 등은 %XX)
+ * @param in 원래 경로 (예: "/videos/한글 제목.mp4")
+ * @param out 인코딩 결과 버퍼 (최악의 경우 입력의 3배 + 1)
+ * @return 성공 시 결과 길이, 버퍼 부족 -1
+ */
+int http_url_encode_path(const char *in, char *out, size_t out_len);
+
+/**
+ * @brief URL 경로의 퍼센트 인코딩을 풉니다. (경로이므로 '+'는 그대로, %00/잘못된 %XX도 그대로)
+ * * 서명 URL 검증과 라이브러리 경로 매핑이 같은 규칙으로 푼 경로를 사용합니다.
+ * @return 성공 시 결과 길이, 버퍼 부족 -1
+ */
+int http_url_decode_path(const char *in, char *out, size_t out_len);
+
 /**
  * @brief 소켓 버퍼 상태와 관계없이 모든 데이터를 보낼 때까지 반복합니다 (Blocking).
  * @param fd 대상 소켓 파일 디스크립터
@@ -48,4 +76,12 @@ int http_get_form_param(const char *body, const char *key, char *out_buf, size_t
  */
 int send_all_blocking(int fd, const char *data, size_t len);
 
+/**
+ * @brief send_all_blocking과 같지만, 소켓 버퍼가 가득 차면(EAGAIN) 쓸 수 있을 때까지 poll로 기다립니다.
+ * * 한 응답을 여러 번 나눠 보내는 경우(chunked 목록 등)에 사용합니다. 워커 스레드가 기다리는 동안 묶이므로 상한을 둡니다.
+ * @param timeout_ms 한 번 기다릴 때의 상한 (밀리초, 넘으면 느린 클라이언트로 보고 실패)
+ * @return 성공 0, 실패/시간 초과 -1
+ */
+int send_all_wait(int fd, const char *data, size_t len, int timeout_ms);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef LIBRARY_SCANNER_H
+#define LIBRARY_SCANNER_H
+
+#include <stddef.h>
+
+// 설정 가능한 미디어 루트 최대 개수
+#define LIBRARY_MAX_ROOTS 16
+
+/**
+ * @brief 미디어 라이브러리 설정을 초기화합니다. (스캔은 하지 않음)
+ * * 루트별 URL 접두사: 첫 번째 루트는 "/videos/", 이후 루트는 "/videos1/", "/videos2/" ...
+ * * @param roots_csv 쉼표로 구분된 미디어 루트 목록 (예: "./videos,/mnt/hdd/movies")
+ * @param scan_threads 초기 스캔(stat walk, probe)에 사용할 스레드 수
+ * @param thumb_format 새로 발견된 비디오의 썸네일 포맷 ("jpg" 또는 "webp")
+ * @return 성공 0, 실패 -1
+ */
+int library_init(const char *roots_csv, int scan_threads, const char *thumb_format);
+
+/**
+ * @brief 백그라운드 인덱서 스레드를 시작합니다. (Non-blocking)
+ * * 1. 초기 스캔: 병렬 stat walk 후 DB의 (size, mtime)과 비교하여 변경된 파일만 재probe
+ * 2. 이후 inotify로 루트를 감시하며 추가/변경/삭제된 파일만 반영
+ * 3. 모든 DB 쓰기는 배치 단위로 단일 트랜잭션에 묶습니다.
+ * @return 성공 0, 실패 -1
+ */
+int library_start(void);
+
+/**
+ * @brief URL 경로를 미디어 파일의 물리 경로로 변환합니다.
+ * 퍼센트 인코딩(%20 등)을 디코딩하고, 어느 루트에도 속하지 않으면 실패합니다.
+ * @param url 요청 경로 (예: "/videos/movie.mp4")
+ * @param out_path 물리 경로를 받을 버퍼
+ * @param out_len 버퍼 크기
+ * @return 성공 시 루트 인덱스(0 이상), 실패 -1
+ */
+int library_resolve_url(const char *url, char *out_path, size_t out_len);
+
+/**
+ * @brief 설정된 미디어 루트 개수를 반환합니다.
+ */
+int library_root_count(void);
+
+/**
+ * @brief idx번째 미디어 루트의 경로를 반환합니다. 범위를 벗어나면 NULL
+ */
+const char* library_root_path(int idx);
+
+/**
+ * @brief 인덱서 스레드를 멈추고 inotify 자원을 정리합니다.
+ */
+void library_shutdown(void);
+
+#endif
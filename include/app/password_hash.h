@@ -0,0 +1,38 @@
+#ifndef PASSWORD_HASH_H
+#define PASSWORD_HASH_H
+
+#include <stddef.h>
+
+// 저장 문자열 버퍼 크기: "$scrypt$ln$r$p$<salt 22자>$<hash 43자>" + 여유
+#define PASSWORD_HASH_LEN 128
+
+/**
+ * @brief scrypt 비용 파라미터를 정합니다. (서버 시작 시 1회)
+ * * 메모리 사용량은 약 128 * r * 2^log2_n 바이트 (기본 ln=14, r=8 -> 16MB), 해시 1회에 수십 ms.
+ * * 파라미터를 올리면 기존 해시는 다음 로그인 때 새 비용으로 다시 저장됩니다.
+ * @param log2_n N = 2^log2_n (10 ~ 22)
+ * @param r 블록 크기 (1 ~ 32)
+ * @param p 병렬도 (1 ~ 16)
+ * @return 성공 0, 범위를 벗어나면 -1 (기본값 사용)
+ */
+int password_hash_init(int log2_n, int r, int p);
+
+/**
+ * @brief 랜덤 salt로 비밀번호를 해시해 저장용 문자열을 만듭니다.
+ * * 형식: $scrypt$<log2_n>$<r>$<p>$<salt base64url>$<hash base64url>
+ * @param out PASSWORD_HASH_LEN 이상
+ * @return 성공 0, 실패 -1
+ */
+int password_hash(const char *password, char *out, size_t out_len);
+
+/**
+ * @brief 저장된 값과 비밀번호를 상수 시간으로 비교합니다.
+ * * 해시 형식이 아닌 값은 이전 버전이 저장한 평문으로 보고 비교합니다. (needs_rehash = 1)
+ * * stored가 NULL이면 (없는 사용자) 같은 비용의 해시를 한 번 계산한 뒤 실패를 반환해,
+ *   응답 시간으로 아이디 존재 여부가 드러나지 않게 합니다.
+ * @param needs_rehash 평문이거나 비용 파라미터가 현재 설정과 다르면 1 (NULL 가능)
+ * @return 일치 0, 불일치 또는 오류 -1
+ */
+int password_verify(const char *password, const char *stored, int *needs_rehash);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef PREWARM_H
+#define PREWARM_H
+
+/**
+ * @brief 페이지 캐시 프리웜 스레드를 시작합니다. (Non-blocking)
+ * * 1. 시작 직후 한 번, 이후 interval_sec 마다 watch_history의 최근 활동으로 비디오 순위를 매깁니다.
+ * 2. 상위 top_n개에 대해 파일 앞/뒤(ftyp/moov가 있는 구간)와 각 시청자의 이어보기 위치 주변을
+ * readahead로 페이지 캐시에 올립니다.
+ * 3. 한 번의 프리웜에서 읽는 양은 budget_mb를 넘지 않습니다.
+ * * @param top_n 프리웜할 비디오 수 (0이면 비활성)
+ * @param budget_mb 1회 프리웜의 I/O 예산 (MB)
+ * @param interval_sec 반복 주기 (초, 0이면 시작 시 한 번만)
+ * @return 성공 0, 실패(또는 비활성) -1
+ */
+int prewarm_start(int top_n, int budget_mb, int interval_sec);
+
+/**
+ * @brief 프리웜 스레드를 멈춥니다. (진행 중인 readahead 한 건은 끝까지 수행)
+ */
+void prewarm_shutdown(void);
+
+#endif
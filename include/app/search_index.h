@@ -0,0 +1,38 @@
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include <stddef.h>
+
+// 카탈로그 제목 역색인 (만든 뒤에는 읽기 전용이라 락 없이 여러 스레드가 조회)
+typedef struct SearchIndex SearchIndex;
+
+/**
+ * @brief 제목 목록으로 역색인을 만듭니다.
+ * * 토큰: UTF-8 코드포인트 단위로 글자/숫자(ASCII 영숫자, 한글 등 비 ASCII 문자)를 이어 붙인 단어.
+ *   ASCII는 소문자로 바꾸고, 구두점/공백/전각 기호는 구분자로 봅니다.
+ * * 한글 단어는 초성 문자열("아이언맨" -> "ㅇㅇㅇㅁ")도 함께 색인해 초성 검색을 지원합니다.
+ * * 용어는 바이트 순으로 정렬해 두므로 접두어는 이진 탐색 두 번으로 범위가 정해집니다.
+ * @param titles 문서 번호 순 제목 (NULL은 빈 제목)
+ * @param count 문서 수
+ * @return 색인 (search_index_free로 해제), 실패 시 NULL
+ */
+SearchIndex* search_index_build(const char *const *titles, int count);
+
+/**
+ * @brief 검색어의 모든 단어가 제목 단어의 접두어로 나오는 문서를 점수 순으로 찾습니다.
+ * * 점수: 단어 전체 일치 > 접두어 일치 > 초성 일치, 제목 앞쪽 단어일수록, 짧은 제목일수록 높음.
+ * * 후보는 가장 희귀한 검색 단어의 게시 목록에서만 뽑고 나머지 단어는 문서별 토큰으로 확인합니다.
+ * @param out_docs 문서 번호 (build에 넘긴 순서)
+ * @param max_results out_docs 크기
+ * @return 찾은 문서 수
+ */
+int search_index_query(const SearchIndex *idx, const char *query, int *out_docs, int max_results);
+
+/**
+ * @brief 색인 메모리 크기 (바이트)
+ */
+size_t search_index_memory(const SearchIndex *idx);
+
+void search_index_free(SearchIndex *idx);
+
+#endif
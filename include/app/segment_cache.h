@@ -0,0 +1,74 @@
+#ifndef SEGMENT_CACHE_H
+#define SEGMENT_CACHE_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+// 캐시 단위 (파일 오프셋 기준으로 정렬된 청크)
+#define SEGMENT_CHUNK_SIZE (1024 * 1024)
+
+// 캐시 히트 시 돌려받는 참조 (release 전까지 슬롯이 교체되지 않음)
+typedef struct {
+    int slot;
+    const char *data;   // 요청 오프셋 위치의 데이터
+    size_t len;         // data부터 청크 끝(또는 파일 끝)까지 바이트 수
+} SegmentRef;
+
+// 통계 스냅샷
+typedef struct {
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long bytes_from_ram;
+    unsigned long long admissions;
+    unsigned long long rejections;  // TinyLFU가 입장을 거절한 횟수
+    unsigned long long evictions;
+    int slots_total;
+    int slots_used;
+    int hugepages;                  // MAP_HUGETLB로 할당되었는지
+} SegmentCacheStats;
+
+/**
+ * @brief 고정 예산의 세그먼트 캐시를 할당합니다.
+ * * 1. budget_mb 만큼의 메모리를 한 번에 할당합니다. (MAP_HUGETLB 우선, 실패 시 일반 mmap + THP 힌트)
+ * 2. 입장은 TinyLFU(Count-Min Sketch) 빈도 비교로 결정하여, 한 번 보고 마는 콜드 트래픽이
+ * 인기 청크를 밀어내지 못하게 합니다.
+ * * @param budget_mb 캐시 크기 (MB), 0이면 비활성
+ * @return 성공 0, 실패(또는 비활성) -1
+ */
+int segment_cache_init(size_t budget_mb);
+
+/**
+ * @brief 파일의 offset 위치가 포함된 청크를 찾습니다.
+ * * 미스인 경우 빈도를 기록하고, 입장이 허용되면 fd에서 청크를 읽어 채운 뒤 히트로 처리합니다.
+ * * @param dev, ino, mtime 파일 식별자 (mtime이 바뀌면 다른 파일로 취급)
+ * @param file_size 파일 전체 크기
+ * @param fd 미스 시 청크를 읽어올 파일
+ * @param offset 요청 오프셋
+ * @param ref 히트 시 채워지는 참조
+ * @return 히트 0 (ref 사용 후 segment_cache_release 필수), 미스 -1 (sendfile로 처리)
+ */
+int segment_cache_get(dev_t dev, ino_t ino, time_t mtime, off_t file_size,
+                      int fd, off_t offset, SegmentRef *ref);
+
+/**
+ * @brief segment_cache_get으로 얻은 참조를 반납합니다.
+ * @param bytes_sent 참조에서 실제로 전송한 바이트 수 (통계용)
+ */
+void segment_cache_release(SegmentRef *ref, size_t bytes_sent);
+
+/**
+ * @brief 캐시가 활성화되어 있는지 반환합니다.
+ */
+int segment_cache_enabled(void);
+
+/**
+ * @brief 통계 스냅샷을 복사합니다.
+ */
+void segment_cache_get_stats(SegmentCacheStats *out);
+
+/**
+ * @brief 캐시 메모리를 해제합니다. (모든 참조가 반납된 뒤 호출)
+ */
+void segment_cache_cleanup(void);
+
+#endif
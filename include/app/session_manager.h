@@ -4,26 +4,51 @@
 #include <stdbool.h>
 
 // [상수 정의]
-// 세션 ID의 길이 (32바이트 + NULL)
-#define SESSION_ID_LENGTH 33
+// 세션 ID 버퍼 길이 (테이블 모드 32자리 hex, 토큰 모드 40자 base64url + NULL, 여유 포함)
+#define SESSION_ID_LENGTH 64
 
 // 세션 만료 시간 (30분 = 1800초)
 #define SESSION_TTL_SEC 1800
 
+// 통계 스냅샷
+typedef struct {
+    unsigned long long live;        // 테이블에 있는 세션 수
+    unsigned long long created;
+    unsigned long long expired;     // TTL 초과로 회수된 수 (청소 스레드 + 조회 시)
+    unsigned long long evicted;     // 상한 초과로 퇴출된 수
+    unsigned long long max_sessions; // 0이면 상한 없음
+    unsigned long long table_bytes; // 슬롯 배열 전체 크기 (세션당 별도 할당 없음)
+    unsigned long long revoked;     // 토큰 모드: 폐기 목록에 있는 토큰 수
+    unsigned long long restored;    // 기동 시 스냅샷에서 복원한 세션 수
+    int token_mode;
+    int shm_mode;
+} SessionStats;
+
 /**
- * @brief 세션 시스템(해시 테이블 및 Mutex)을 초기화합니다.
+ * @brief 세션 시스템(샤드별 해시 테이블 및 RW 락)을 초기화합니다.
  * 서버 시작 시 한 번 호출해야 합니다.
+ * 각 샤드는 독립된 락을 가지며, 노드 수가 늘면 샤드별로 버킷을 자동 확장합니다.
+ * 청소 스레드가 주기마다 샤드별로 버킷 몇 개씩 검사해 만료된 세션을 회수합니다.
+ * SESSION_MODE가 "token"이면 테이블 대신 HMAC 서명 토큰을 발급/검증합니다. (session_token.h)
+ * 토큰 모드는 hmac_keyring_init 이후에 호출해야 합니다.
+ * SESSION_MODE가 "shm"이면 같은 테이블을 이름 있는 공유 메모리에 두어, 같은 호스트의
+ * 여러 서버 프로세스(SO_REUSEPORT)가 세션을 공유합니다. 샤드 락은 프로세스 공유 robust 뮤텍스이며
+ * 락을 잡은 프로세스가 죽으면 다음 프로세스가 샤드를 재구성합니다. 슬롯 배열은 max_sessions로 크기가 고정됩니다.
+ * @param mode "table", "token" 또는 "shm"
+ * @param max_sessions 최대 세션 수 (초과 시 가장 오래 쓰이지 않은 세션부터 퇴출, 0이면 무제한, shm 모드는 필수)
+ * @param revoke_capacity 로그아웃된 토큰을 기억할 슬롯 수 (토큰 모드 전용)
+ * @param shm_name 공유 메모리 이름 ('/'로 시작, shm 모드 전용)
  * @return 성공 0, 실패 -1
  */
-int session_system_init(void);
+int session_system_init(const char *mode, int max_sessions, int revoke_capacity, const char *shm_name);
 
 /**
  * @brief 새로운 세션을 생성하고 메모리에 저장합니다.
- * * 1. 난수 기반의 유니크한 세션 ID를 생성합니다.
- * 2. 해시 테이블에 {session_id : user_id} 매핑을 저장합니다.
+ * * 1. getrandom으로 16바이트 세션 키를 만들고 32자리 hex로 인코딩합니다.
+ * 2. 샤드의 열린 주소법 테이블에 {키 : user_id} 슬롯을 저장합니다. (세션당 malloc 없음)
  * 3. 생성된 세션 ID를 out_buf에 복사하여 반환합니다.
  * * @param user_id 로그인에 성공한 사용자 식별자 (DB PK)
- * @param out_buf 생성된 세션 ID가 저장될 버퍼 (최소 33바이트 이상)
+ * @param out_buf 생성된 세션 ID가 저장될 버퍼 (SESSION_ID_LENGTH 이상)
  * @param buf_len 버퍼의 크기
  * @return 성공 0, 실패 -1
  */
@@ -34,6 +59,7 @@ int session_create(int user_id, char *out_buf, size_t buf_len);
  * * 1. 해시 테이블에서 세션 ID를 검색합니다 (O(1)).
  * 2. 세션이 존재하고, 만료되지 않았는지 확인합니다.
  * 3. 유효하다면 user_id를 반환하고, '마지막 접근 시간'을 갱신합니다.
+ * (읽기 락만 사용, 접근 시간은 relaxed atomic으로 기록)
  * * @param session_id 클라이언트 쿠키에서 파싱한 세션 문자열
  * @return 유효한 경우 user_id (양수), 유효하지 않거나 만료된 경우 -1
  */
@@ -45,9 +71,26 @@ int session_get_user(const char *session_id);
  */
 void session_remove(const char *session_id);
 
+/**
+ * @brief 세션 스냅샷 파일을 지정하고, 있으면 만료되지 않은 세션을 복원합니다. (테이블 모드 전용)
+ * * 청소 스레드가 interval_sec마다, 그리고 session_system_cleanup이 종료 직전에
+ * 테이블을 파일로 저장합니다. (임시 파일에 쓴 뒤 rename, 권한 0600)
+ * * 재시작해도 로그인이 유지되어 배포 직후 /login 폭주를 막습니다.
+ * @param path 스냅샷 파일 경로 (비어 있으면 비활성)
+ * @param interval_sec 주기 저장 간격 (초, 0이면 종료 시에만)
+ * @return 성공(복원할 파일이 없어도) 0, 비활성/실패 -1
+ */
+int session_persist_init(const char *path, int interval_sec);
+
+/**
+ * @brief 세션 통계 스냅샷을 복사합니다.
+ */
+void session_get_stats(SessionStats *out);
+
 /**
  * @brief 시스템 종료 시 자원을 해제합니다.
- * 할당된 모든 노드 메모리와 Mutex를 정리합니다.
+ * 할당된 모든 노드 메모리와 락을 정리합니다.
+ * shm 모드에서는 매핑만 해제하고 세그먼트는 남겨 둡니다. (다른 프로세스/재시작한 프로세스가 계속 사용)
  */
 void session_system_cleanup(void);
 
@@ -0,0 +1,43 @@
+#ifndef SESSION_TOKEN_H
+#define SESSION_TOKEN_H
+#include <stddef.h>
+
+// 토큰 문자열 길이 (30바이트 base64url = 40자)
+#define SESSION_TOKEN_LENGTH 40
+
+/**
+ * @brief 토큰 세션 모드를 준비합니다. (서명 키는 hmac_keyring_init으로 먼저 읽어야 함)
+ * @param revoke_capacity 로그아웃된 토큰을 기억할 슬롯 수
+ * @return 성공 0, 실패 -1
+ */
+int session_token_init(int revoke_capacity);
+
+/**
+ * @brief {user_id, 만료 시각, kid, nonce}에 HMAC-SHA256(앞 16바이트)을 붙인 토큰을 발급합니다.
+ * @param out 토큰이 저장될 버퍼 (SESSION_TOKEN_LENGTH + 1 이상)
+ * @return 성공 0, 실패 -1
+ */
+int session_token_issue(int user_id, int ttl_sec, char *out, size_t out_len);
+
+/**
+ * @brief 토큰을 검증합니다. 락과 테이블 조회 없이 HMAC을 다시 계산해 상수 시간으로 비교합니다.
+ * @return 유효하면 user_id, 아니면 -1
+ */
+int session_token_verify(const char *token);
+
+/**
+ * @brief 토큰을 만료 시각까지 폐기 목록에 올립니다. (로그아웃)
+ */
+void session_token_revoke(const char *token);
+
+/**
+ * @brief 폐기 목록에 있는 (아직 만료되지 않은) 토큰 수를 반환합니다.
+ */
+unsigned long long session_token_revoked_count(void);
+
+/**
+ * @brief 폐기 목록을 해제합니다.
+ */
+void session_token_cleanup(void);
+
+#endif
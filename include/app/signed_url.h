@@ -0,0 +1,45 @@
+#ifndef SIGNED_URL_H
+#define SIGNED_URL_H
+#include <stddef.h>
+
+/**
+ * @brief 서명 URL을 활성화합니다. (서명 키는 hmac_keyring_init으로 먼저 읽어야 함)
+ * * /api/videos가 돌려주는 비디오 URL에 {user_id, 만료 시각, kid, HMAC}을 붙여,
+ * 스트리밍 Range 요청이 세션 조회 없이 서명 검증만으로 통과하게 합니다.
+ * * 만료 시각은 구간 단위로 올림하므로 같은 구간 안에서는 URL이 바뀌지 않습니다. (프록시 캐시 적중)
+ * @param ttl_sec 서명 유효 시간 (초, 0이면 비활성)
+ * @return 활성 0, 비활성 -1
+ */
+int signed_url_init(int ttl_sec);
+
+/**
+ * @brief 서명 URL이 활성화되어 있는지 반환합니다.
+ */
+int signed_url_enabled(void);
+
+/**
+ * @brief 지금 발급할 서명의 만료 시각을 반환합니다. (구간 단위로 올림, 비활성이면 0)
+ * 한 응답의 모든 URL에 같은 값을 쓰고, 응답 ETag에도 포함합니다.
+ */
+long long signed_url_expiry(void);
+
+/**
+ * @brief url 뒤에 "?u=&e=&k=&s=" 서명 쿼리를 붙여 out에 씁니다.
+ * * 서명은 퍼센트 인코딩을 푼 경로로 계산하므로, 브라우저가 경로를 어떻게 다시 인코딩해도 검증됩니다.
+ * @param url 퍼센트 인코딩된 비디오 URL 경로 (예: "/videos/%ED%95%9C%EA%B8%80%20a.mp4", http_url_encode_path)
+ * @param user_id URL을 받을 사용자
+ * @param expiry signed_url_expiry()가 돌려준 만료 시각
+ * @return 성공 0, 실패(버퍼 부족/비활성) -1
+ */
+int signed_url_make(const char *url, int user_id, long long expiry, char *out, size_t out_len);
+
+/**
+ * @brief 요청 경로와 쿼리의 서명을 검증합니다. (락/세션 조회 없음)
+ * @param path 쿼리를 뗀 요청 경로 (인코딩된 그대로, 디코딩한 경로로 검증)
+ * @param query '?' 뒤 쿼리 문자열
+ * @param out_max_age 유효하면 만료까지 남은 초 (Cache-Control max-age)
+ * @return 유효하면 user_id, 아니면 -1
+ */
+int signed_url_verify(const char *path, const char *query, int *out_max_age);
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef STATS_HANDLER_H
+#define STATS_HANDLER_H
+
+#include "app/client_context.h"
+
+/**
+ * @brief 서버 내부 통계 API (GET /api/stats)
+ * * 세그먼트 캐시(히트율, RAM에서 보낸 바이트, 입장/교체)와 direct 읽기 엔진(버퍼 사용량,
+ * 읽기 수), 장치별 I/O 큐(큐 깊이, 대기 시간, 서비스 지연), 계층화(승격/강등, 계층별 히트)
+ * 통계와 로거(기록/버린 레코드 수)를 JSON으로 응답합니다.
+ * 세션 검증은 라우터(http_handler)에서 끝난 상태로 호출됩니다.
+ */
+void handle_api_stats(ClientContext *ctx);
+
+#endif
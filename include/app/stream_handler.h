@@ -13,4 +13,10 @@ typedef struct ClientContext ClientContext;
  */
 void handle_streaming_request(ClientContext* ctx);
 
+/**
+ * @brief 응답이 잡고 있는 I/O 자원(O_DIRECT fd, io 버퍼)을 반납하고 장치 큐와의 연결을 끊습니다.
+ * 응답이 끝나거나 연결을 닫는 모든 경로에서 file_fd를 닫기 전에 호출합니다. (중복 호출 안전)
+ */
+void stream_release_io(ClientContext *ctx);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef THUMBNAIL_WORKER_H
+#define THUMBNAIL_WORKER_H
+
+/**
+ * @brief 썸네일 생성 전용 백그라운드 풀을 시작합니다.
+ * * 1. 요청 처리용 ThreadPool과 분리된 별도의 풀을 생성합니다.
+ * 2. 리스너가 열린 뒤(reactor_init 이후)에 호출해야 서버 기동이 지연되지 않습니다.
+ * * @param num_threads 썸네일 워커 스레드 수
+ * @param queue_capacity 작업 큐 크기
+ * @param trickplay_interval_sec 탐색 미리보기 타일 간격 (초), 0이면 trickplay 생성 안 함
+ * @return 성공 0, 실패 -1
+ */
+int thumbnail_worker_init(int num_threads, int queue_capacity, int trickplay_interval_sec);
+
+/**
+ * @brief 단일 썸네일 생성 작업을 큐에 넣습니다. (큐가 꽉 차면 대기)
+ * * 썸네일이 이미 있고 mtime이 원본 비디오보다 같거나 최신이면 작업은 건너뜁니다.
+ * 출력 포맷은 썸네일 경로의 확장자로 결정합니다 (.jpg / .webp).
+ * * @param video_path 원본 비디오의 물리 경로 (예: "./videos/test.mp4")
+ * @param thumb_path 썸네일 물리 경로 (예: "./static/thumb1.jpg")
+ * @return 성공 0, 실패 -1
+ */
+int thumbnail_worker_submit(const char *video_path, const char *thumb_path);
+
+/**
+ * @brief 탐색 미리보기(trickplay) 생성 작업을 큐에 넣습니다. (큐가 꽉 차면 대기)
+ * * 일정 간격의 프레임을 10x10 스프라이트 시트 JPEG로 묶고, 각 타일 위치를 담은
+ * WebVTT 인덱스를 ./static/trickplay/<video_id>/index.vtt 로 저장합니다.
+ * index.vtt가 원본보다 최신이면 건너뜁니다.
+ * * @param video_id 비디오 ID (출력 디렉토리 이름)
+ * @param video_path 원본 비디오의 물리 경로
+ * @return 성공 0, 실패 -1
+ */
+int thumbnail_worker_submit_trickplay(int video_id, const char *video_path);
+
+/**
+ * @brief DB에 등록된 전체 카탈로그의 썸네일/trickplay 생성을 예약합니다. (Non-blocking)
+ * 카탈로그 조회와 큐 투입은 별도 스레드에서 수행하므로 호출 즉시 반환합니다.
+ * @return 성공 0, 실패 -1
+ */
+int thumbnail_worker_schedule_catalog(void);
+
+/**
+ * @brief 진행 중인 작업을 중단시키고 풀을 정리합니다.
+ * 대기 중이던 작업은 실행되지 않고 버려집니다.
+ */
+void thumbnail_worker_shutdown(void);
+
+#endif
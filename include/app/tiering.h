@@ -0,0 +1,70 @@
+#ifndef TIERING_H
+#define TIERING_H
+
+#include <stddef.h>
+
+// 통계 스냅샷
+typedef struct {
+    unsigned long long promotions;
+    unsigned long long demotions;
+    unsigned long long bytes_copied;
+    unsigned long long fast_hits;   // 빠른 계층 사본으로 응답한 요청 수
+    unsigned long long slow_hits;   // 원본(느린 계층)으로 응답한 요청 수
+    unsigned long long used_bytes;
+    unsigned long long max_bytes;
+    int tracked;                    // 인기도를 추적 중인 비디오 수
+    int fast_copies;                // 빠른 계층에 있는 사본 수
+} TieringStats;
+
+/**
+ * @brief 계층화 시스템을 초기화하고 백그라운드 복사 스레드를 시작합니다.
+ * * 1. 요청마다 비디오별 인기도를 기록합니다. (1시간 반감기로 감쇠)
+ * 2. 인기도가 임계값을 넘은 비디오는 복사 스레드가 빠른 계층 디렉토리로 복사합니다. (속도 제한)
+ * 3. 빠른 계층이 가득 차면 인기도가 가장 낮은 사본부터 강등(삭제)합니다.
+ * 4. 재시작 시 빠른 계층에 남아 있던 사본은 원본과 크기/mtime을 비교한 뒤 재사용합니다.
+ * * @param fast_dir 빠른 계층 디렉토리 (NULL 또는 빈 문자열이면 비활성)
+ * @param max_mb 빠른 계층 사용량 상한 (MB)
+ * @param promote_threshold 승격에 필요한 (감쇠된) 요청 수
+ * @param copy_rate_mbps 복사 속도 상한 (MB/s, 0이면 제한 없음)
+ * @return 성공 0, 실패(또는 비활성) -1
+ */
+int tiering_init(const char *fast_dir, size_t max_mb, int promote_threshold, int copy_rate_mbps);
+
+/**
+ * @brief 추적 중인 비디오의 요청을 기록하고, 빠른 계층 사본이 있으면 그 경로로 바꿉니다.
+ * * 인증을 통과한 요청에서만 호출합니다. 처음 보는 경로는 항목을 만들지 않습니다.
+ * * 디스크 I/O 없이 메모리 조회만 합니다. (검증/복사는 복사 스레드 담당)
+ * @param path 원본 물리 경로 (library_resolve_url 결과). 사본이 있으면 사본 경로로 덮어씀
+ * @param path_len 버퍼 크기
+ */
+void tiering_resolve(char *path, size_t path_len);
+
+/**
+ * @brief 원본 파일을 실제로 연 뒤 호출하여, 처음 보는 비디오를 추적 대상에 넣습니다.
+ * * 없는 경로로 추적 테이블이 커지지 않도록 열기에 성공한 일반 파일만 넘깁니다.
+ * * 추적 항목 수에는 상한이 있고, 사본 없이 식은 항목은 복사 스레드가 주기적으로 해제합니다.
+ * @param path 연 파일 경로 (빠른 계층 사본 경로면 무시)
+ */
+void tiering_record_open(const char *path);
+
+/**
+ * @brief 계층화가 활성화되어 있는지 반환합니다.
+ */
+int tiering_enabled(void);
+
+/**
+ * @brief 빠른 계층 디렉토리 경로를 반환합니다. (비활성이면 NULL)
+ */
+const char* tiering_fast_dir(void);
+
+/**
+ * @brief 통계 스냅샷을 복사합니다.
+ */
+void tiering_get_stats(TieringStats *out);
+
+/**
+ * @brief 복사 스레드를 멈추고 추적 정보를 해제합니다. (빠른 계층 사본은 남겨둠)
+ */
+void tiering_shutdown(void);
+
+#endif
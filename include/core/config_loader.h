@@ -2,15 +2,57 @@
 #define CONFIG_LOADER_H
 
 #define MAX_HOST_LEN 128
+#define MAX_PATH_LIST_LEN 1024
 
 // 설정값들을 저장할 구조체
 typedef struct ServerConfig{
     int port;
     int max_clients;
     int timeout_sec;
-    int log_level;
+    int log_level;          // 0=ERROR 1=WARN 2=INFO 3=DEBUG
+    char log_file[MAX_PATH_LIST_LEN]; // 로그 파일 (비우면 표준 출력)
+    int log_ring_slots;     // 스레드당 로그 링 슬롯 수 (가득 차면 버림)
+    int metrics_port;       // /metrics 수집 포트 (0이면 비활성)
+    char metrics_bind[MAX_HOST_LEN]; // 수집 리스너 바인딩 주소
     int queue_capacity;
     int thread_num;
+    int db_read_pool_size;  // 읽기 전용 DB 연결 수 (0이면 워커 수)
+    int history_flush_interval_sec; // 시청 이력 일괄 쓰기 주기 (초, 0이면 요청마다 바로 씀)
+    int history_buffer_max; // 시청 이력 버퍼 항목 상한
+    int auth_thread_num;    // 비밀번호 해시 전용 스레드 수 (0이면 요청 워커에서 해시)
+    int auth_queue_capacity; // 인증 요청 대기열 크기 (가득 차면 503)
+    int scrypt_log2_n;      // scrypt 비용 N = 2^값
+    int scrypt_r;           // scrypt 블록 크기
+    int scrypt_p;           // scrypt 병렬도
+    int continue_cache_users; // 이어보기 목록을 캐시할 사용자 수 (0이면 매번 인덱스 조회)
+    int video_list_page_max; // /api/videos 한 페이지 최대 항목 수 (limit 기본값이자 상한)
+    int thumb_thread_num;   // 썸네일 생성 전용 스레드 수
+    int trickplay_interval; // 탐색 미리보기 타일 간격 (초, 0이면 비활성)
+    int scan_thread_num;    // 라이브러리 초기 스캔 스레드 수
+    char thumb_format[8];   // 새 썸네일 포맷 ("jpg" / "webp")
+    char media_roots[MAX_PATH_LIST_LEN]; // 쉼표로 구분된 미디어 루트 목록
+    int segment_cache_mb;   // 인기 구간 RAM 캐시 크기 (MB, 0이면 비활성)
+    char read_engine[16];   // 스트리밍 읽기 방식 ("sendfile" / "direct")
+    int direct_io_buffers;  // direct 엔진 버퍼 개수 (동시 디스크 읽기 수)
+    int direct_io_buffer_kb; // direct 엔진 버퍼 하나의 크기 (KB)
+    int device_io_threads;  // 장치(디스크)별 I/O 스레드 수
+    int device_io_max_active; // 장치별 대기+실행 중인 디스크 작업 수 상한 (넘으면 새 동영상 요청 503)
+    char fast_tier_dir[MAX_PATH_LIST_LEN]; // 인기 영상 사본을 둘 빠른 계층 (비어 있으면 비활성)
+    int fast_tier_max_mb;   // 빠른 계층 사용량 상한 (MB)
+    int tier_promote_threshold; // 승격에 필요한 요청 수 (1시간 반감기로 감쇠)
+    int tier_copy_rate_mbps; // 승격 복사 속도 상한 (MB/s)
+    int prewarm_top_n;      // 기동/주기 프리웜 대상 비디오 수 (0이면 비활성)
+    int prewarm_budget_mb;  // 1회 프리웜 I/O 예산 (MB)
+    int prewarm_interval_sec; // 프리웜 반복 주기 (초, 0이면 기동 시 한 번)
+    int session_max_count;  // 최대 세션 수 (초과 시 오래된 세션부터 퇴출, 0이면 무제한)
+    char session_mode[16];  // 세션 방식 ("table" / "token" / "shm")
+    char session_shm_name[64]; // shm 모드 공유 메모리 이름 ('/'로 시작)
+    int reuse_port;         // 1이면 SO_REUSEPORT로 같은 포트에 여러 프로세스 바인딩
+    char session_key_file[MAX_PATH_LIST_LEN]; // 토큰/서명 URL 키 파일 (비어 있으면 기동 시 임시 키)
+    int session_revoke_capacity; // 토큰 모드 로그아웃 폐기 목록 크기
+    int signed_url_ttl_sec; // 비디오 서명 URL 유효 시간 (초, 0이면 비활성)
+    char session_snapshot_file[MAX_PATH_LIST_LEN]; // 세션 스냅샷 파일 (비어 있으면 비활성)
+    int session_snapshot_interval; // 세션 스냅샷 주기 (초, 0이면 종료 시에만)
     char server_host[MAX_HOST_LEN]; // 문자열 설정 예시 추가
 } ServerConfig;
 
@@ -0,0 +1,82 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stddef.h>
+
+// 청크 하나의 크기 (스트리밍 시 HTTP chunk 하나)
+#define JSON_CHUNK_SIZE 16384
+
+typedef struct JsonChunk {
+    struct JsonChunk *next;
+    size_t len;
+    char data[JSON_CHUNK_SIZE];
+} JsonChunk;
+
+/**
+ * @brief 가득 찬 청크를 내보내는 함수 (스트리밍 모드)
+ * @return 성공 0, 실패 -1 (이후 쓰기는 모두 무시되고 json_writer_error가 1)
+ */
+typedef int (*JsonSink)(void *arg, const char *data, size_t len);
+
+typedef struct JsonWriter {
+    JsonChunk *head;
+    JsonChunk *tail;
+    size_t total;           // 지금까지 쓴 바이트 수 (내보낸 것 포함)
+    JsonSink sink;          // NULL이면 청크를 이어 붙여 메모리에 보관
+    void *sink_arg;
+    int error;
+} JsonWriter;
+
+/**
+ * @brief 쓰기를 시작합니다. 청크는 프로세스 공용 풀에서 빌립니다.
+ * * sink가 있으면 청크가 찰 때마다 내보내고 같은 청크를 재사용하므로 메모리가 청크 하나로 고정됩니다.
+ * * sink가 없으면 청크를 사슬로 이어 두고 json_writer_dup으로 한 덩어리를 얻습니다.
+ */
+void json_writer_init(JsonWriter *w, JsonSink sink, void *sink_arg);
+
+/**
+ * @brief 이스케이프 없이 그대로 씁니다. (구조 문자, 미리 직렬화된 조각)
+ */
+void json_write_raw(JsonWriter *w, const char *data, size_t len);
+
+/**
+ * @brief 문자열을 따옴표로 감싸고 JSON 규칙에 맞게 이스케이프해 씁니다.
+ * * 16바이트씩 SSE2로 '"', '\\', 제어 문자(< 0x20)를 찾아 그 사이 구간은 통째로 복사합니다.
+ * * NULL은 빈 문자열로 씁니다. UTF-8 멀티바이트는 그대로 통과합니다.
+ */
+void json_write_string(JsonWriter *w, const char *s);
+
+/**
+ * @brief 따옴표 없이 이스케이프만 적용해 씁니다. (문자열 값을 여러 조각으로 나눠 쓸 때)
+ */
+void json_write_escaped(JsonWriter *w, const char *s, size_t len);
+
+/**
+ * @brief 정수를 씁니다.
+ */
+void json_write_int(JsonWriter *w, long long v);
+
+/**
+ * @brief 남은 데이터를 sink로 내보냅니다. (sink가 없으면 아무 일도 하지 않음)
+ * @return 성공 0, 실패 -1
+ */
+int json_writer_flush(JsonWriter *w);
+
+/**
+ * @brief 지금까지 쓴 내용을 NULL 종료된 한 덩어리로 복사합니다. (sink 없는 모드 전용)
+ * @param out_len 길이 (NULL 가능)
+ * @return malloc된 문자열 (free 필요), 실패 시 NULL
+ */
+char* json_writer_dup(const JsonWriter *w, size_t *out_len);
+
+/**
+ * @brief 오류가 있었는지 반환합니다. (할당 실패 또는 sink 실패)
+ */
+int json_writer_error(const JsonWriter *w);
+
+/**
+ * @brief 청크를 풀에 돌려줍니다. (flush하지 않은 데이터는 버려짐)
+ */
+void json_writer_release(JsonWriter *w);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+// 로그 레벨 (server.conf의 LOG_LEVEL 값과 같음)
+#define LOG_LEVEL_ERROR 0
+#define LOG_LEVEL_WARN  1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_DEBUG 3
+
+// 컴파일 시 상한 (Makefile의 LOG_COMPILE_LEVEL). 이보다 상세한 로그 호출은 코드에서 사라짐
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_MSG_MAX 224     // 메시지 최대 길이 (넘으면 잘림)
+
+// 실행 시 레벨 (logger_init에서 설정). 호출부에서 인자 평가 전에 거르기 위해 노출
+extern int g_log_level;
+
+// 통계 스냅샷
+typedef struct {
+    unsigned long long written;     // 파일에 쓴 레코드 수
+    unsigned long long dropped;     // 링이 가득 차 버린 레코드 수
+    unsigned long long rings;       // 로그를 남긴 스레드 수 (링 수)
+} LoggerStats;
+
+#define LOG_AT(level, tag, ...)                                                 \
+    do {                                                                        \
+        if ((level) <= LOG_COMPILE_LEVEL && (level) <= g_log_level)             \
+            logger_write((level), (tag), __VA_ARGS__);                          \
+    } while (0)
+
+#define LOG_ERROR(tag, ...) LOG_AT(LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define LOG_WARN(tag, ...)  LOG_AT(LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define LOG_INFO(tag, ...)  LOG_AT(LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define LOG_DEBUG(tag, ...) LOG_AT(LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+
+/**
+ * @brief 비동기 로거를 시작합니다. (다른 스레드를 만들기 전에 호출)
+ * * 1. 스레드마다 처음 로그를 남길 때 전용 링 버퍼(단일 생산자/단일 소비자)를 하나 받습니다.
+ *    기록은 그 링 슬롯에 바로 포맷하고 인덱스만 올리므로 락이나 시스템 콜이 없습니다.
+ * 2. 백그라운드 스레드가 모든 링을 비우며 JSON 한 줄씩({"ts","level","tag","msg"}) 모아 파일에 씁니다.
+ * 3. 링이 가득 차면 기다리지 않고 그 레코드를 버린 뒤 개수만 셉니다. (버린 수는 주기적으로 로그에 남김)
+ * * 시작 전이나 시작에 실패하면 stderr에 바로 씁니다.
+ * @param level 실행 시 레벨 (LOG_LEVEL_ERROR ~ LOG_LEVEL_DEBUG)
+ * @param path 로그 파일 경로 (빈 문자열이면 표준 출력)
+ * @param ring_slots 스레드당 링 슬롯 수 (2의 거듭제곱으로 올림)
+ * @return 성공 0, 실패 -1
+ */
+int logger_init(int level, const char *path, int ring_slots);
+
+/**
+ * @brief 레코드 하나를 남깁니다. (LOG_* 매크로를 통해 호출)
+ */
+void logger_write(int level, const char *tag, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief 통계를 채웁니다.
+ */
+void logger_get_stats(LoggerStats *out);
+
+/**
+ * @brief 남은 레코드를 모두 쓰고 백그라운드 스레드를 멈춥니다. (다른 스레드가 모두 멈춘 뒤 호출)
+ */
+void logger_shutdown(void);
+
+#endif
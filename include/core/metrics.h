@@ -0,0 +1,95 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <time.h>
+
+// 카운터 (단조 증가)
+typedef enum {
+    M_CONN_ACCEPTED = 0,        // 수락해 epoll에 등록한 연결
+    M_CONN_CLOSED,              // 닫은 연결 (http_close_client)
+    M_SENDFILE_BYTES,           // sendfile로 보낸 바이트
+    M_QUEUE_REJECTED_REQUEST,   // 큐가 가득 차 제출 실패 (풀별)
+    M_QUEUE_REJECTED_AUTH,
+    M_COUNTER_COUNT
+} MetricCounter;
+
+// 지연 히스토그램
+typedef enum {
+    // 작업 큐 대기 (제출 ~ 워커가 꺼낼 때)
+    H_QUEUE_WAIT_REQUEST = 0,
+    H_QUEUE_WAIT_AUTH,
+    H_QUEUE_WAIT_DEVICE,
+    // 경로별 지연 (라우팅 시작 ~ 응답 완료, 스트리밍은 헤더를 다 보낼 때까지)
+    H_ROUTE_LOGIN,
+    H_ROUTE_REGISTER,
+    H_ROUTE_LOGOUT,
+    H_ROUTE_HISTORY,
+    H_ROUTE_VIDEOS,
+    H_ROUTE_CONTINUE,
+    H_ROUTE_SEARCH,
+    H_ROUTE_STATS,
+    H_ROUTE_STREAM,
+    H_ROUTE_STATIC,
+    // SQLite 쿼리 (db_handler의 QueryId 순서와 같음)
+    H_DB_USER_PASSWORD,
+    H_DB_UPDATE_HISTORY,
+    H_DB_USER_POSITIONS,
+    H_DB_CREATE_USER,
+    H_DB_UPDATE_PASSWORD,
+    H_DB_RECENT_HISTORY,
+    H_DB_HISTORY_BATCH,
+    H_DB_LIBRARY_BATCH,
+    H_COUNT
+} MetricHistogram;
+
+/**
+ * @brief 카운터를 올립니다.
+ * * 스레드마다 캐시 라인 정렬된 전용 샤드에 더하므로 락/원자적 RMW가 없습니다.
+ *   (스레드가 256개를 넘으면 넘친 스레드는 공용 샤드에 원자적으로 더함)
+ */
+void metrics_add(MetricCounter counter, unsigned long long value);
+
+/**
+ * @brief 지연 시간 하나를 히스토그램에 기록합니다.
+ * * 버킷은 1us부터 옥타브마다 2개(1, 2, 3, 4, 6, 8, 12, 16 ...us ~ 약 134초)라 상대 오차가 50% 이내입니다.
+ * @param ns 지연 시간 (나노초, 음수는 0)
+ */
+void metrics_observe(MetricHistogram hist, long long ns);
+
+static inline long long metrics_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static inline void metrics_observe_since(MetricHistogram hist, long long start_ns) {
+    metrics_observe(hist, metrics_now_ns() - start_ns);
+}
+
+/**
+ * @brief 수집 시점에 값을 읽어 오는 게이지를 등록합니다. (큐 깊이, 세션 수 등)
+ * * 콜백은 수집 스레드에서 호출되므로 요청 경로를 오래 막지 않는 값이어야 합니다. (순간값 읽기, 짧은 읽기 락 정도)
+ * @param name 메트릭 이름 (같은 이름은 레이블로 구분)
+ * @param labels 레이블 (예: "pool=\"request\"", 없으면 빈 문자열)
+ * @param help HELP 설명 (같은 이름의 첫 등록 것을 사용)
+ * @return 성공 0, 실패 -1 (등록 수 초과)
+ */
+int metrics_register_gauge(const char *name, const char *labels, const char *help,
+                           double (*fn)(void *arg), void *arg);
+
+/**
+ * @brief 수집용 리스너를 시작합니다. (GET /metrics, Prometheus 텍스트 형식 0.0.4)
+ * * 전용 스레드가 연결을 하나씩 받아 응답하고 닫으므로 요청 워커 큐를 거치지 않습니다.
+ * * 모든 스레드의 샤드는 이 때만 합산합니다. (기록하는 쪽은 합산을 기다리지 않음)
+ * @param bind_addr 바인딩 주소 (예: "127.0.0.1")
+ * @param port 포트 (0이면 비활성)
+ * @return 성공 0, 실패/비활성 -1
+ */
+int metrics_start(const char *bind_addr, int port);
+
+/**
+ * @brief 리스너를 멈춥니다.
+ */
+void metrics_shutdown(void);
+
+#endif
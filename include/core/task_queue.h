@@ -8,6 +8,7 @@
 typedef struct{
     void (*function)(void* arg);
     void* arg;
+    long long enqueued_ns;  // 제출 시각 (대기 시간을 재는 풀만 기록, 아니면 0)
 } Task;
 
 typedef struct{
@@ -33,7 +34,11 @@ void task_queue_shutdown(TaskQueue* q);
 void task_queue_free(TaskQueue* q);
 
 // 연산
-void task_queue_enqueue(TaskQueue* q, Task task);  // 꽉 차면 대기 
+/**
+ * @brief 큐에 작업을 넣음 (꽉 차면 빈 자리가 날 때까지 대기)
+ * @return 성공시 0, 큐가 종료되었으면 -2 (작업은 넣지 않음, arg 정리는 호출자 몫)
+ */
+int task_queue_enqueue(TaskQueue* q, Task task);
 /**
  * @brief 큐에 작업을 넣으려 시도함 (Non-blocking)
  * @return 성공시 0, 큐가 꽉 찼으면 -1
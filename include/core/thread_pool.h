@@ -8,6 +8,8 @@ typedef struct ThreadPool{
     TaskQueue queue;        // 임베딩 구조체
     pthread_t* threads;     // 일꾼 스레드들의 ID 배열 (동적 할당 예정)
     int num_threads;        // 스레드 개수
+    int wait_histogram;     // 큐 대기 시간을 기록할 MetricHistogram (-1: 기록 안 함)
+    int reject_counter;     // 큐가 가득 차 거절한 수를 셀 MetricCounter (-1: 세지 않음)
 } ThreadPool;
 
 
@@ -30,6 +32,15 @@ int thread_pool_init(ThreadPool* pool, int num_threads, int queue_capacity);
  */
 int thread_pool_submit(ThreadPool* pool, void (*function)(void*), void* arg);
 
+/**
+ * @brief 풀을 메트릭에 연결합니다. (thread_pool_init 직후, 작업을 넣기 전에 호출)
+ * * 큐 대기 시간(제출 ~ 워커가 꺼낼 때)과 거절 수를 기록하고, 큐 깊이 게이지를 등록합니다.
+ * @param name 게이지의 pool 레이블 값
+ * @param wait_histogram MetricHistogram (-1이면 기록 안 함)
+ * @param reject_counter MetricCounter (-1이면 세지 않음)
+ */
+void thread_pool_set_metrics(ThreadPool* pool, const char* name, int wait_histogram, int reject_counter);
+
 /**
  * @brief 종료 1단계: 폐점 선언 (Non-blocking)
  * 더 이상 작업을 받지 않고, 대기 중인 스레드를 깨움.
@@ -0,0 +1,74 @@
+#ifndef URING_READER_H
+#define URING_READER_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+// O_DIRECT 읽기의 오프셋/버퍼 정렬 단위
+#define URING_READER_ALIGN 4096
+
+/**
+ * @brief 읽기 완료 콜백 (완료 스레드에서 호출됨)
+ * @param arg 제출 시 넘긴 인자
+ * @param buf_idx 데이터가 담긴 버퍼 (사용 후 uring_reader_release 필수)
+ * @param data 버퍼 시작 주소 (요청한 정렬 오프셋의 데이터)
+ * @param result 읽은 바이트 수, 실패 시 -errno
+ */
+typedef void (*UringReadCallback)(void *arg, int buf_idx, const char *data, int result);
+
+// 통계 스냅샷
+typedef struct {
+    unsigned long long reads_submitted;
+    unsigned long long reads_failed;
+    unsigned long long bytes_read;
+    unsigned long long pool_exhausted;  // 버퍼가 없어 sendfile로 넘긴 횟수
+    int buffers_total;
+    int buffers_in_use;
+    int fixed_buffers;                  // 버퍼 등록(READ_FIXED) 성공 여부
+} UringReaderStats;
+
+/**
+ * @brief io_uring 인스턴스와 정렬된 버퍼 풀을 만들고 완료 스레드를 시작합니다.
+ * * 1. 버퍼를 커널에 등록하여 READ_FIXED로 읽습니다. (등록 실패 시 일반 READ로 동작)
+ * 2. liburing 없이 io_uring_setup/enter/register 시스템 콜을 직접 사용합니다.
+ * * @param buf_count 버퍼 개수 (동시에 진행 가능한 읽기 수)
+ * @param buf_size 버퍼 하나의 크기 (URING_READER_ALIGN의 배수로 올림)
+ * @return 성공 0, 실패 -1 (커널 미지원 등 -> 호출자는 sendfile 사용)
+ */
+int uring_reader_init(int buf_count, size_t buf_size);
+
+/**
+ * @brief fd의 offset부터 버퍼 하나 크기만큼 비동기로 읽습니다.
+ * @param fd O_DIRECT로 연 파일
+ * @param offset URING_READER_ALIGN 배수여야 함
+ * @return 제출 성공 0, 버퍼 고갈/실패 -1 (콜백은 호출되지 않음)
+ */
+int uring_reader_read(int fd, off_t offset, UringReadCallback cb, void *arg);
+
+/**
+ * @brief 완료 콜백으로 받은 버퍼를 풀에 반납합니다.
+ */
+void uring_reader_release(int buf_idx);
+
+/**
+ * @brief 엔진이 초기화되어 사용 가능한지 반환합니다.
+ */
+int uring_reader_enabled(void);
+
+/**
+ * @brief 버퍼 하나의 크기를 반환합니다.
+ */
+size_t uring_reader_buf_size(void);
+
+/**
+ * @brief 통계 스냅샷을 복사합니다.
+ */
+void uring_reader_get_stats(UringReaderStats *out);
+
+/**
+ * @brief 완료 스레드를 멈추고 링과 버퍼를 해제합니다.
+ * 워커 스레드 풀을 정리한 뒤에 호출해야 합니다.
+ */
+void uring_reader_shutdown(void);
+
+#endif
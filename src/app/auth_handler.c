@@ -1,6 +1,9 @@
 #define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
 #include <string.h>
+#include <unistd.h>
 #include <sys/socket.h>
 #include <errno.h>
 #include <sys/epoll.h>
@@ -9,7 +12,12 @@
 #include "app/db_handler.h"
 #include "app/session_manager.h"
 #include "app/client_context.h"
+#include "app/password_hash.h"
 #include "core/reactor.h"
+#include "core/thread_pool.h"
+#include "core/metrics.h"
+#include "core/logger.h"
+#include <openssl/crypto.h>
 
 #define JSON_LOGIN_SUCCESS "{\"success\": true}"
 #define JSON_LOGIN_FAIL    "{\"success\": false, \"message\": \"Invalid credentials\"}"
@@ -17,27 +25,188 @@
 #define JSON_LOGOUT_SUCCESS "{\"success\": true, \"message\": \"Logged out\"}"
 #define JSON_REG_SUCCESS "{\"success\": true, \"message\": \"User created\"}"
 #define JSON_REG_FAIL    "{\"success\": false, \"message\": \"Username already exists\"}"   
+#define JSON_AUTH_BUSY   "{\"success\": false, \"message\": \"Server busy, please retry\"}"
+
+typedef enum {
+    AUTH_LOGIN,
+    AUTH_REGISTER
+} AuthJobType;
+
+// 인증 스레드로 넘기는 작업 (요청 버퍼는 넘긴 뒤 재사용될 수 있으므로 파싱한 값을 복사)
+typedef struct {
+    ClientContext *ctx;
+    AuthJobType type;
+    char username[64];
+    char password[64];
+} AuthJob;
+
+// 해시 전용 풀 (스트리밍 워커와 분리해, 로그인이 몰려도 영상 전송 워커를 점유하지 않음)
+static ThreadPool g_auth_pool;
+static bool g_pool_started = false;
+
+// 내부 헬퍼 함수
+static void submit_auth_job(ClientContext *ctx, AuthJobType type);
+static void auth_job_func(void *arg);
+static void do_login(ClientContext *ctx, const char *username, const char *password);
+static void do_register(ClientContext *ctx, const char *username, const char *password);
+static void send_auth_busy(ClientContext *ctx);
+
+int auth_pool_init(int num_threads, int queue_capacity) {
+    if (num_threads <= 0) {
+        printf("[Auth] Password hashing runs on request workers (no auth pool).\n");
+        return -1;
+    }
+    if (thread_pool_init(&g_auth_pool, num_threads, queue_capacity) != 0) {
+        fprintf(stderr, "[Auth] Failed to init auth pool, hashing on request workers.\n");
+        return -1;
+    }
+    thread_pool_set_metrics(&g_auth_pool, "auth", H_QUEUE_WAIT_AUTH, M_QUEUE_REJECTED_AUTH);
+    g_pool_started = true;
+    printf("[Auth] Auth pool: %d threads, queue %d.\n", num_threads, queue_capacity);
+    return 0;
+}
+
+void auth_pool_shutdown(void) {
+    if (!g_pool_started) return;
+    // 큐에 남은 작업까지 처리한 뒤 종료
+    thread_pool_shutdown(&g_auth_pool);
+    thread_pool_wait(&g_auth_pool);
+    thread_pool_cleanup(&g_auth_pool);
+    g_pool_started = false;
+}
 
 void handle_login(ClientContext *ctx) {
+    submit_auth_job(ctx, AUTH_LOGIN);
+}
+
+void handle_logout(ClientContext *ctx) {
+    if (strlen(ctx->session_id) > 0) {
+        session_remove(ctx->session_id);
+        // 메모리 상의 ID도 지워줌 (이중 삭제 방지)
+        memset(ctx->session_id, 0, sizeof(ctx->session_id));
+        LOG_DEBUG("Auth", "Session removed via logout");
+    }
+
+    // 응답 (쿠키 만료 처리: Max-Age=0)
+    int header_len = snprintf(ctx->buffer, sizeof(ctx->buffer),
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: %zu\r\n"
+        "Set-Cookie: session_id=; Path=/; HttpOnly; Max-Age=0\r\n"
+        "Connection: keep-alive\r\n\r\n",
+        strlen(JSON_LOGOUT_SUCCESS));
+
+    send_all_blocking(ctx->client_fd, ctx->buffer, header_len);
+    send_all_blocking(ctx->client_fd, JSON_LOGOUT_SUCCESS, strlen(JSON_LOGOUT_SUCCESS));
+
+    // 3. 재장전
+    ctx->state = STATE_REQ_RECEIVING;
+    ctx->buffer_len = 0;
+    
+    if (reactor_update_event(ctx->epoll_fd, ctx->client_fd, EPOLLIN | EPOLLONESHOT, ctx) < 0) {
+        http_close_client(ctx);
+    }
+}
+
+void handle_register(ClientContext *ctx) {
+    submit_auth_job(ctx, AUTH_REGISTER);
+}
+
+// =========================================================
+// 내부 헬퍼
+// =========================================================
+
+static void submit_auth_job(ClientContext *ctx, AuthJobType type) {
     const char *body = ctx->body_ptr;
     if (!body) {
         send_error_response(ctx, 400);
         return;
     }
 
-    char username[64] = {0};
-    char password[64] = {0};
+    AuthJob *job = (AuthJob *)calloc(1, sizeof(AuthJob));
+    if (!job) {
+        send_error_response(ctx, 500);
+        return;
+    }
+    job->ctx = ctx;
+    job->type = type;
 
     // 파싱 유틸리티 사용
-    if (http_get_form_param(body, "username", username, sizeof(username)) < 0 ||
-        http_get_form_param(body, "password", password, sizeof(password)) < 0) {
+    if (http_get_form_param(body, "username", job->username, sizeof(job->username)) < 0 ||
+        http_get_form_param(body, "password", job->password, sizeof(job->password)) < 0) {
+        free(job);
         send_error_response(ctx, 400); // Bad Request
         return;
     }
 
-    // DB 자격 증명 확인 (db_handler)
-    int user_id = db_verify_user(username, password);
-    char final_response[1024] = {0};
+    if (!g_pool_started) {
+        auth_job_func(job);
+        return;
+    }
+
+    // 큐가 가득 차면 기다리지 않고 503 (요청 워커가 막히면 스트리밍도 멈춤)
+    if (thread_pool_submit(&g_auth_pool, auth_job_func, job) != 0) {
+        OPENSSL_cleanse(job, sizeof(*job));
+        free(job);
+        send_auth_busy(ctx);
+    }
+    // 성공하면 ctx는 인증 스레드 소유 (응답 후 그 스레드가 epoll에 재등록)
+}
+
+static void auth_job_func(void *arg) {
+    AuthJob *job = (AuthJob *)arg;
+    // 응답 뒤 ctx는 다른 스레드 소관이므로 시작 시각을 미리 복사 (큐 대기 + 해시 포함)
+    long long start = job->ctx->req_start_ns;
+    if (job->type == AUTH_LOGIN) do_login(job->ctx, job->username, job->password);
+    else do_register(job->ctx, job->username, job->password);
+    metrics_observe_since(job->type == AUTH_LOGIN ? H_ROUTE_LOGIN : H_ROUTE_REGISTER, start);
+
+    OPENSSL_cleanse(job, sizeof(*job));
+    free(job);
+}
+
+static void send_auth_busy(ClientContext *ctx) {
+    int header_len = snprintf(ctx->buffer, sizeof(ctx->buffer),
+        "HTTP/1.1 503 Service Unavailable\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: %zu\r\n"
+        "Retry-After: 1\r\n"
+        "Connection: keep-alive\r\n\r\n", strlen(JSON_AUTH_BUSY));
+
+    send_all_blocking(ctx->client_fd, ctx->buffer, header_len);
+    send_all_blocking(ctx->client_fd, JSON_AUTH_BUSY, strlen(JSON_AUTH_BUSY));
+    LOG_WARN("Auth", "Auth queue full, rejected with 503");
+
+    ctx->state = STATE_REQ_RECEIVING;
+    ctx->buffer_len = 0;
+    if (reactor_update_event(ctx->epoll_fd, ctx->client_fd, EPOLLIN | EPOLLONESHOT, ctx) < 0) {
+        http_close_client(ctx);
+    }
+}
+
+static void do_login(ClientContext *ctx, const char *username, const char *password) {
+    // 저장된 해시 조회 (db_handler) 후 scrypt 검증 (password_hash)
+    int user_id = -1;
+    char stored[PASSWORD_HASH_LEN];
+    int found = db_get_user_password(username, &user_id, stored, sizeof(stored));
+    if (found == -2) {
+        send_error_response(ctx, 500);
+        return;
+    }
+
+    // 없는 아이디도 해시 1회 비용을 치름 (응답 시간으로 존재 여부가 드러나지 않게)
+    int needs_rehash = 0;
+    if (password_verify(password, (found == 0) ? stored : NULL, &needs_rehash) != 0) {
+        user_id = -1;
+    } else if (needs_rehash) {
+        // 평문 또는 이전 비용 파라미터 -> 현재 설정으로 다시 저장
+        char upgraded[PASSWORD_HASH_LEN];
+        if (password_hash(password, upgraded, sizeof(upgraded)) == 0 &&
+            db_update_password(user_id, upgraded) == 0) {
+            LOG_INFO("Auth", "Upgraded stored password hash for %s", username);
+        }
+    }
+    OPENSSL_cleanse(stored, sizeof(stored));
     int header_len = 0;
 
     if (user_id <= 0) {
@@ -71,7 +240,7 @@ void handle_login(ClientContext *ctx) {
             send_all_blocking(ctx->client_fd, JSON_LOGIN_SUCCESS, strlen(JSON_LOGIN_SUCCESS));
         }
 
-        printf("[Auth] User %s logged in. Session: %s\n", username, session_id);
+        LOG_INFO("Auth", "User %s logged in", username);
     }
 
     // 상태 초기화 및 Epoll 재장전
@@ -80,55 +249,14 @@ void handle_login(ClientContext *ctx) {
     reactor_update_event(ctx->epoll_fd, ctx->client_fd, EPOLLIN | EPOLLONESHOT, ctx);
 }
 
-void handle_logout(ClientContext *ctx) {
-    if (strlen(ctx->session_id) > 0) {
-        session_remove(ctx->session_id);
-        // 메모리 상의 ID도 지워줌 (이중 삭제 방지)
-        memset(ctx->session_id, 0, sizeof(ctx->session_id));
-        printf("[Auth] Session removed via logout.\n");
-    }
-
-    // 응답 (쿠키 만료 처리: Max-Age=0)
-    int header_len = snprintf(ctx->buffer, sizeof(ctx->buffer),
-        "HTTP/1.1 200 OK\r\n"
-        "Content-Type: application/json\r\n"
-        "Content-Length: %zu\r\n"
-        "Set-Cookie: session_id=; Path=/; HttpOnly; Max-Age=0\r\n"
-        "Connection: keep-alive\r\n\r\n",
-        strlen(JSON_LOGOUT_SUCCESS));
-
-    send_all_blocking(ctx->client_fd, ctx->buffer, header_len);
-    send_all_blocking(ctx->client_fd, JSON_LOGOUT_SUCCESS, strlen(JSON_LOGOUT_SUCCESS));
-
-    // 3. 재장전
-    ctx->state = STATE_REQ_RECEIVING;
-    ctx->buffer_len = 0;
-    
-    if (reactor_update_event(ctx->epoll_fd, ctx->client_fd, EPOLLIN | EPOLLONESHOT, ctx) < 0) {
-        close(ctx->client_fd);
-        free(ctx);
-    }
-}
-
-void handle_register(ClientContext *ctx) {
-    // 1. 바디 파싱 (로그인과 동일 로직)
-    char *body = ctx->body_ptr;
-    if (!body) {
-        send_error_response(ctx, 400);
+static void do_register(ClientContext *ctx, const char *username, const char *password) {
+    // 1. 해시 후 DB 생성 호출 (평문은 저장하지 않음)
+    char hashed[PASSWORD_HASH_LEN];
+    if (password_hash(password, hashed, sizeof(hashed)) != 0) {
+        send_error_response(ctx, 500);
         return;
     }
-
-    char username[64] = {0};
-    char password[64] = {0};
-
-    if (http_get_form_param(body, "username", username, sizeof(username)) < 0 ||
-        http_get_form_param(body, "password", password, sizeof(password)) < 0) {
-        send_error_response(ctx, 400);
-        return;
-    }
-
-    // 2. DB 생성 호출
-    int result = db_create_user(username, password);
+    int result = db_create_user(username, hashed);
     int header_len = 0;
 
     if (result == 0) {
@@ -141,7 +269,7 @@ void handle_register(ClientContext *ctx) {
         
         send_all_blocking(ctx->client_fd, ctx->buffer, header_len);
         send_all_blocking(ctx->client_fd, JSON_REG_SUCCESS, strlen(JSON_REG_SUCCESS));
-        printf("[Auth] New user registered: %s\n", username);
+        LOG_INFO("Auth", "New user registered: %s", username);
     } else {
         // 실패 (중복 등)
         header_len = snprintf(ctx->buffer, sizeof(ctx->buffer),
@@ -154,8 +282,8 @@ void handle_register(ClientContext *ctx) {
         send_all_blocking(ctx->client_fd, JSON_REG_FAIL, strlen(JSON_REG_FAIL));
     }
 
-    // 3. 재장전
+    // 2. 재장전
     ctx->state = STATE_REQ_RECEIVING;
     ctx->buffer_len = 0;
     reactor_update_event(ctx->epoll_fd, ctx->client_fd, EPOLLIN | EPOLLONESHOT, ctx);
-}
\ No newline at end of file
+}
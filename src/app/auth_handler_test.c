@@ -0,0 +1,299 @@
+// 로그인 폭주 중 스트리밍 처리량 벤치마크 (make bench -> build/bin/test/app/auth_handler_test)
+// 실행 중인 서버에 붙는 부하 생성기입니다. (서버 오브젝트는 쓰지 않음)
+// 사용법: auth_handler_test <port> <video url> <로그인 스레드 수> <스트리밍 스레드 수> [초=10] [user] [password]
+// 예: auth_handler_test 8080 /videos/test.mp4 32 8
+// 1. 로그인 스레드는 keep-alive 연결로 POST /login 을 쉬지 않고 보냅니다. (200/503/기타를 셈)
+// 2. 스트리밍 스레드는 세션 쿠키로 1MB Range 요청을 반복하며 처리량과 요청당 지연을 잽니다.
+// 로그인 0 / 스트리밍 0 으로 각각 단독 기준치를 재고, 둘 다 주어 동시에 돌린 결과와 비교합니다.
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#define RANGE_BYTES     (1024 * 1024)
+#define MAX_SAMPLES     200000
+#define RESP_HEAD_LEN   4096
+
+typedef struct {
+    int is_stream;
+    long ok;                // 200 / 206
+    long busy;              // 503
+    long failed;            // 그 밖의 응답, 연결 실패
+    long long bytes;
+    long *lat_us;           // 요청당 지연 (스트리밍)
+    long samples;
+} Worker;
+
+static int g_port;
+static const char *g_video;
+static const char *g_user = "user1";
+static const char *g_password = "1234";
+static char g_cookie[128];
+static long long g_video_size;
+static volatile int g_stop = 0;
+
+static long now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000L + ts.tv_nsec / 1000;
+}
+
+static void sleep_ms(long ms) {
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+static int cmp_long(const void *a, const void *b) {
+    long x = *(const long *)a, y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+static int connect_server(void) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons((uint16_t)g_port)};
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int send_str(int fd, const char *s, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, s, len, MSG_NOSIGNAL);
+        if (n <= 0) return -1;
+        s += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// 응답 하나를 읽음: 상태 코드 반환, 본문은 버림 (-1: 연결 끊김)
+// head에는 헤더를 남김 (Set-Cookie/Content-Range 파싱용), keep_alive는 연결 재사용 가능 여부
+static int read_response(int fd, char *head, size_t head_cap, long long *body_len, int *keep_alive) {
+    size_t used = 0;
+    char *end = NULL;
+    while (!end) {
+        if (used + 1 >= head_cap) return -1;
+        ssize_t n = recv(fd, head + used, head_cap - used - 1, 0);
+        if (n <= 0) return -1;
+        used += (size_t)n;
+        head[used] = '\0';
+        end = strstr(head, "\r\n\r\n");
+    }
+
+    int status = atoi(head + 9);
+    long long content_length = 0;
+    char *cl = strstr(head, "Content-Length:");
+    if (cl && cl < end) content_length = atoll(cl + 15);
+    *keep_alive = !(strstr(head, "Connection: close") && strstr(head, "Connection: close") < end);
+
+    // 헤더 뒤에 이미 받은 본문
+    long long have = (long long)(used - (size_t)(end + 4 - head));
+    char buf[65536];
+    while (have < content_length) {
+        size_t want = sizeof(buf);
+        if ((long long)want > content_length - have) want = (size_t)(content_length - have);
+        ssize_t n = recv(fd, buf, want, 0);
+        if (n <= 0) return -1;
+        have += n;
+    }
+    *end = '\0';
+    *body_len = content_length;
+    return status;
+}
+
+static int login_once(int *fd, char *head, size_t head_cap) {
+    char req[512];
+    char body[128];
+    int body_len = snprintf(body, sizeof(body), "username=%s&password=%s", g_user, g_password);
+    int len = snprintf(req, sizeof(req),
+        "POST /login HTTP/1.1\r\nHost: bench\r\n"
+        "Content-Type: application/x-www-form-urlencoded\r\n"
+        "Content-Length: %d\r\n\r\n%s", body_len, body);
+
+    if (*fd < 0 && (*fd = connect_server()) < 0) return -1;
+    long long got;
+    int keep_alive = 0;
+    int status = -1;
+    if (send_str(*fd, req, (size_t)len) == 0) {
+        status = read_response(*fd, head, head_cap, &got, &keep_alive);
+    }
+    if (status < 0 || !keep_alive) {
+        close(*fd);
+        *fd = -1;
+    }
+    return status;
+}
+
+static void* login_worker(void *arg) {
+    Worker *w = (Worker *)arg;
+    char head[RESP_HEAD_LEN];
+    int fd = -1;
+    while (!g_stop) {
+        int status = login_once(&fd, head, sizeof(head));
+        if (status == 200) w->ok++;
+        else if (status == 503) w->busy++;
+        else w->failed++;
+        if (status == 503) sleep_ms(1); // 바로 재시도하되 Retry-After를 완전히 무시하진 않음
+    }
+    if (fd >= 0) close(fd);
+    return NULL;
+}
+
+static void* stream_worker(void *arg) {
+    Worker *w = (Worker *)arg;
+    char head[RESP_HEAD_LEN];
+    char req[512];
+    int fd = -1;
+    long long offset = 0;
+    while (!g_stop) {
+        if (offset >= g_video_size) offset = 0;
+        long long last = offset + RANGE_BYTES - 1;
+        if (last >= g_video_size) last = g_video_size - 1;
+        int len = snprintf(req, sizeof(req),
+            "GET %s HTTP/1.1\r\nHost: bench\r\nCookie: session_id=%s\r\nRange: bytes=%lld-%lld\r\n\r\n",
+            g_video, g_cookie, offset, last);
+
+        if (fd < 0 && (fd = connect_server()) < 0) {
+            w->failed++;
+            sleep_ms(1);
+            continue;
+        }
+        long t = now_us();
+        long long got = 0;
+        int keep_alive = 0;
+        int status = (send_str(fd, req, (size_t)len) == 0)
+            ? read_response(fd, head, sizeof(head), &got, &keep_alive) : -1;
+        if (status == 206) {
+            w->ok++;
+            w->bytes += got;
+            if (w->samples < MAX_SAMPLES) w->lat_us[w->samples++] = now_us() - t;
+            offset = last + 1;
+        } else {
+            w->failed++;
+        }
+        if (status < 0 || !keep_alive) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    if (fd >= 0) close(fd);
+    return NULL;
+}
+
+// 쿠키를 받고 Content-Range에서 파일 크기를 읽음
+static int prepare(void) {
+    char head[RESP_HEAD_LEN];
+    int fd = -1;
+    if (login_once(&fd, head, sizeof(head)) != 200) return -1;
+    char *c = strstr(head, "session_id=");
+    if (!c) return -1;
+    c += strlen("session_id=");
+    size_t n = strcspn(c, ";\r\n");
+    if (n >= sizeof(g_cookie)) return -1;
+    memcpy(g_cookie, c, n);
+    g_cookie[n] = '\0';
+
+    if (fd < 0 && (fd = connect_server()) < 0) return -1;
+    char req[512];
+    int len = snprintf(req, sizeof(req),
+        "GET %s HTTP/1.1\r\nHost: bench\r\nCookie: session_id=%s\r\nRange: bytes=0-0\r\n\r\n", g_video, g_cookie);
+    long long got;
+    int keep_alive;
+    int status = (send_str(fd, req, (size_t)len) == 0)
+        ? read_response(fd, head, sizeof(head), &got, &keep_alive) : -1;
+    close(fd);
+    char *range = strstr(head, "Content-Range: bytes 0-0/");
+    if (status != 206 || !range) return -1;
+    g_video_size = atoll(range + strlen("Content-Range: bytes 0-0/"));
+    return g_video_size > 0 ? 0 : -1;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 5) {
+        fprintf(stderr, "usage: %s <port> <video url> <login threads> <stream threads> [seconds] [user] [password]\n",
+                argv[0]);
+        return 1;
+    }
+    g_port = atoi(argv[1]);
+    g_video = argv[2];
+    int n_login = atoi(argv[3]);
+    int n_stream = atoi(argv[4]);
+    int seconds = (argc > 5) ? atoi(argv[5]) : 10;
+    if (argc > 6) g_user = argv[6];
+    if (argc > 7) g_password = argv[7];
+
+    if (prepare() != 0) {
+        fprintf(stderr, "login as %s or first range request for %s failed\n", g_user, g_video);
+        return 1;
+    }
+
+    int total = n_login + n_stream;
+    Worker *workers = calloc((size_t)(total > 0 ? total : 1), sizeof(Worker));
+    pthread_t *tids = calloc((size_t)(total > 0 ? total : 1), sizeof(pthread_t));
+    if (!workers || !tids) return 1;
+
+    for (int i = 0; i < total; i++) {
+        workers[i].is_stream = (i >= n_login);
+        if (workers[i].is_stream) {
+            workers[i].lat_us = malloc(sizeof(long) * MAX_SAMPLES);
+            if (!workers[i].lat_us) return 1;
+        }
+        pthread_create(&tids[i], NULL, workers[i].is_stream ? stream_worker : login_worker, &workers[i]);
+    }
+
+    long start = now_us();
+    sleep((unsigned int)seconds);
+    g_stop = 1;
+    for (int i = 0; i < total; i++) pthread_join(tids[i], NULL);
+    double elapsed = (now_us() - start) / 1e6;
+
+    long logins = 0, busy = 0, login_failed = 0, ranges = 0, stream_failed = 0, samples = 0;
+    long long bytes = 0;
+    for (int i = 0; i < total; i++) {
+        if (workers[i].is_stream) {
+            ranges += workers[i].ok;
+            stream_failed += workers[i].failed;
+            bytes += workers[i].bytes;
+            samples += workers[i].samples;
+        } else {
+            logins += workers[i].ok;
+            busy += workers[i].busy;
+            login_failed += workers[i].failed;
+        }
+    }
+
+    printf("login threads=%d stream threads=%d %.1fs\n", n_login, n_stream, elapsed);
+    if (n_login > 0) {
+        printf("  logins: %.1f/s ok, %.1f/s 503, %ld other\n", logins / elapsed, busy / elapsed, login_failed);
+    }
+    if (n_stream > 0) {
+        long *all = malloc(sizeof(long) * (size_t)(samples > 0 ? samples : 1));
+        long k = 0;
+        for (int i = 0; i < total; i++) {
+            for (long j = 0; all && j < workers[i].samples; j++) all[k++] = workers[i].lat_us[j];
+        }
+        if (all && k > 0) qsort(all, (size_t)k, sizeof(long), cmp_long);
+        printf("  stream: %.1f MB/s, %ld ranges, %ld failed, 1MB range p50 %.2f ms p99 %.2f ms\n",
+               bytes / elapsed / 1048576.0, ranges, stream_failed,
+               (all && k > 0) ? all[k / 2] / 1000.0 : 0.0, (all && k > 0) ? all[k * 99 / 100] / 1000.0 : 0.0);
+        free(all);
+    }
+
+    for (int i = 0; i < total; i++) free(workers[i].lat_us);
+    free(tids);
+    free(workers);
+    return 0;
+}
@@ -0,0 +1,623 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+
+#include "app/catalog.h"
+#include "app/client_context.h"
+#include "app/db_handler.h"
+#include "app/history_buffer.h"
+#include "app/http_utils.h"
+#include "app/search_index.h"
+#include "app/session_manager.h"
+#include "app/signed_url.h"
+#include "core/json_writer.h"
+#include "core/reactor.h"
+#include "core/logger.h"
+
+#define URL_BUF_LEN         768
+#define CHUNK_SEND_TIMEOUT_MS 5000  // 응답 조각(chunk, 검색 결과 본문) 하나를 보낼 때 소켓이 쓰기 가능해지길 기다리는 상한
+#define ETAG_LEN            48
+#define PARAM_LEN           16
+#define DEFAULT_PAGE_MAX    200
+#define SEARCH_DEFAULT      20
+#define SEARCH_MAX          50
+#define QUERY_LEN           256
+
+// 문자열 리터럴을 길이 계산 없이 씀
+#define WRITE_LIT(w, lit)   json_write_raw((w), (lit), sizeof(lit) - 1)
+#define FNV_OFFSET          0xcbf29ce484222325ULL
+#define FNV_PRIME           0x100000001b3ULL
+
+// 비디오 1건의 미리 직렬화된 조각
+// 응답 = head + (서명) URL + tail + last_pos + "}"
+typedef struct {
+    int id;
+    int duration;           // 초 (0이면 모름)
+    char *head;             // {"id":1, "title":"..", "url":"   (이스케이프 완료)
+    size_t head_len;
+    char *tail;             // ", "thumbnail":"..", ..., "last_pos":   (이스케이프 완료)
+    size_t tail_len;
+    char *path;             // 서명 대상 URL 경로 (퍼센트 인코딩됨, 응답에 쓸 때 이스케이프)
+    size_t path_len;
+    char *title;            // 제목 원문 (검색 색인용)
+} CatalogItem;
+
+// 불변 스냅샷. 만든 뒤에는 읽기만 하므로 락 없이 여러 요청이 공유
+typedef struct {
+    int refcount;
+    uint64_t version;       // 모든 조각의 내용 해시
+    CatalogItem *items;     // id 오름차순
+    int count;
+    int cap;
+    SearchIndex *search;    // 제목 역색인 (문서 번호 = items 인덱스)
+} CatalogSnapshot;
+
+// 사용자의 이어보기 위치 (video_id 오름차순)
+typedef struct {
+    int *video_ids;
+    int *positions;
+    int count;
+    int cap;
+} PositionList;
+
+// 내부 전역 변수
+static CatalogSnapshot *g_current = NULL;
+static pthread_mutex_t g_current_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t g_refresh_mutex = PTHREAD_MUTEX_INITIALIZER; // 재구성은 한 번에 하나만
+static int g_page_max = DEFAULT_PAGE_MAX;
+
+// 내부 헬퍼 함수
+static CatalogSnapshot* acquire_snapshot(void);
+static void release_snapshot(CatalogSnapshot *snap);
+static void collect_item_cb(int id, const char *title, const char *filepath, const char *thumbnail,
+                            int duration, void *arg);
+static void collect_position_cb(int video_id, int last_pos, void *arg);
+static int find_page_start(const CatalogSnapshot *snap, int cursor);
+static int chunk_sink(void *arg, const char *data, size_t len);
+static int send_list_header(ClientContext *ctx, int status, const char *etag, int next_cursor);
+static void finish_response(ClientContext *ctx);
+static const CatalogItem* find_item(const CatalogSnapshot *snap, int id);
+static void write_item(JsonWriter *w, const CatalogItem *item, int user_id, long long expiry, int last_pos);
+static SearchIndex* build_search_index(const CatalogSnapshot *snap);
+static int lookup_position(const PositionList *list, int video_id);
+
+static inline uint64_t fnv1a(uint64_t h, const void *data, size_t len) {
+    const unsigned char *p = (const unsigned char *)data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+void catalog_init(int page_max) {
+    g_page_max = (page_max > 0) ? page_max : DEFAULT_PAGE_MAX;
+    printf("[Catalog] Video list pages up to %d items.\n", g_page_max);
+}
+
+int catalog_refresh(void) {
+    CatalogSnapshot *snap = (CatalogSnapshot *)calloc(1, sizeof(CatalogSnapshot));
+    if (!snap) return -1;
+    snap->refcount = 1; // g_current가 가진 참조
+    snap->version = FNV_OFFSET;
+
+    pthread_mutex_lock(&g_refresh_mutex);
+    int rc = db_for_each_catalog_item(collect_item_cb, snap);
+    if (rc != 0 || snap->count < 0) {
+        pthread_mutex_unlock(&g_refresh_mutex);
+        LOG_ERROR("Catalog", "Failed to load videos, keeping the previous snapshot");
+        release_snapshot(snap);
+        return -1;
+    }
+
+    // 내용이 그대로면 새 스냅샷을 버림 (검색 색인을 다시 만들지 않고, 이전 스냅샷의 ETag도 유지)
+    pthread_mutex_lock(&g_current_mutex);
+    int unchanged = g_current && g_current->version == snap->version;
+    pthread_mutex_unlock(&g_current_mutex);
+    if (unchanged) {
+        pthread_mutex_unlock(&g_refresh_mutex);
+        release_snapshot(snap);
+        return 0;
+    }
+
+    // 색인은 교체 전에 만듦 (요청 경로에서 만들지 않음). 실패해도 목록은 제공하고 검색만 빈 결과
+    snap->search = build_search_index(snap);
+
+    // 교체: 이전 스냅샷은 마지막 요청이 놓을 때 해제
+    pthread_mutex_lock(&g_current_mutex);
+    CatalogSnapshot *old = g_current;
+    g_current = snap;
+    pthread_mutex_unlock(&g_current_mutex);
+    pthread_mutex_unlock(&g_refresh_mutex);
+
+    LOG_INFO("Catalog", "Snapshot %016llx: %d videos, search index %zu KB",
+             (unsigned long long)snap->version, snap->count, search_index_memory(snap->search) / 1024);
+    release_snapshot(old);
+    return 0;
+}
+
+void handle_api_video_list(ClientContext *ctx) {
+    // 1. 세션에서 user_id 추출 (이미 http_handler에서 검증했으므로 있다고 가정)
+    // 만약 세션이 없으면 user_id = 0 (이력 없음)으로 처리
+    int user_id = 0;
+    if (strlen(ctx->session_id) > 0) {
+        user_id = session_get_user(ctx->session_id);
+        if (user_id < 0) user_id = 0;
+    }
+
+    // 2. 페이지 파라미터: ?limit=N&cursor=<이전 페이지 마지막 id> (없으면 처음부터 최대 크기)
+    int limit = g_page_max;
+    int cursor = 0;
+    char param[PARAM_LEN];
+    if (http_get_form_param(ctx->query, "limit", param, sizeof(param)) == 0) {
+        char *end;
+        long v = strtol(param, &end, 10);
+        if (*end != '\0' || v <= 0) {
+            send_error_response(ctx, 400);
+            return;
+        }
+        if (v < limit) limit = (int)v;
+    }
+    if (http_get_form_param(ctx->query, "cursor", param, sizeof(param)) == 0) {
+        char *end;
+        long v = strtol(param, &end, 10);
+        if (*end != '\0' || v < 0 || v > 0x7FFFFFFF) {
+            send_error_response(ctx, 400);
+            return;
+        }
+        cursor = (int)v;
+    }
+
+    CatalogSnapshot *snap = acquire_snapshot();
+    if (!snap) {
+        // 기동 직후 등 스냅샷이 없으면 한 번 만들어 봄
+        catalog_refresh();
+        snap = acquire_snapshot();
+    }
+    if (!snap) {
+        send_error_response(ctx, 500);
+        return;
+    }
+
+    // id 순 정렬이므로 커서 다음 위치는 이진 탐색 (OFFSET처럼 앞 항목을 건너뛰며 세지 않음)
+    int first = find_page_start(snap, cursor);
+    int last = first + limit;
+    if (last > snap->count) last = snap->count;
+    int next_cursor = (last < snap->count) ? snap->items[last - 1].id : 0;
+
+    // 3. 사용자 위치: (user_id, video_id) 기본 키 범위 조회 + 쓰기 지연 버퍼
+    PositionList list = {0};
+    if (user_id > 0 && last > first) db_for_each_user_position(user_id, collect_position_cb, &list);
+
+    int page_len = last - first;
+    int *positions = (int *)calloc(page_len > 0 ? (size_t)page_len : 1, sizeof(int));
+    if (!positions) {
+        release_snapshot(snap);
+        free(list.video_ids);
+        free(list.positions);
+        send_error_response(ctx, 500);
+        return;
+    }
+
+    long long expiry = (user_id > 0) ? signed_url_expiry() : 0;
+    uint64_t h = fnv1a(FNV_OFFSET, &user_id, sizeof(user_id));
+    h = fnv1a(h, &expiry, sizeof(expiry));
+    h = fnv1a(h, &first, sizeof(first));
+    h = fnv1a(h, &last, sizeof(last));
+
+    // 페이지와 위치 목록 모두 id 순이므로 병합으로 맞춤
+    int j = 0;
+    for (int i = 0; i < page_len; i++) {
+        int id = snap->items[first + i].id;
+        while (j < list.count && list.video_ids[j] < id) j++;
+        if (j < list.count && list.video_ids[j] == id) positions[i] = list.positions[j];
+        if (user_id > 0) history_buffer_get(user_id, id, &positions[i]);
+        if (positions[i]) {
+            h = fnv1a(h, &id, sizeof(id));
+            h = fnv1a(h, &positions[i], sizeof(positions[i]));
+        }
+    }
+    free(list.video_ids);
+    free(list.positions);
+
+    char etag[ETAG_LEN];
+    snprintf(etag, sizeof(etag), "W/\"%016llx-%016llx\"",
+             (unsigned long long)snap->version, (unsigned long long)h);
+
+    // 4. 바뀐 것이 없으면 본문 없이 304
+    if (ctx->if_none_match[0] && strcmp(ctx->if_none_match, etag) == 0) {
+        free(positions);
+        release_snapshot(snap);
+        if (send_list_header(ctx, 304, etag, next_cursor) == 0) finish_response(ctx);
+        return;
+    }
+
+    if (send_list_header(ctx, 200, etag, next_cursor) < 0) {
+        free(positions);
+        release_snapshot(snap);
+        return;
+    }
+
+    // 5. 조각 사이에 URL과 위치를 끼워 넣으며 청크(16KB) 단위로 바로 전송 (메모리는 청크 하나로 고정)
+    JsonWriter w;
+    json_writer_init(&w, chunk_sink, ctx);
+    WRITE_LIT(&w, "[");
+
+    for (int i = 0; i < page_len && !json_writer_error(&w); i++) {
+        if (i > 0) WRITE_LIT(&w, ",");
+        write_item(&w, &snap->items[first + i], user_id, expiry, positions[i]);
+    }
+    WRITE_LIT(&w, "]");
+
+    int rc = json_writer_flush(&w);
+    size_t total = w.total;
+    json_writer_release(&w);
+    free(positions);
+    release_snapshot(snap);
+
+    // 마지막 0 크기 청크로 본문 종료
+    if (rc != 0 || send_all_wait(ctx->client_fd, "0\r\n\r\n", 5, CHUNK_SEND_TIMEOUT_MS) < 0) {
+        LOG_DEBUG("API", "Failed to send JSON body: %m");
+        http_close_client(ctx);
+        return;
+    }
+    LOG_DEBUG("API", "Sent video list (%d items, %zu bytes)", page_len, total);
+    finish_response(ctx);
+}
+
+void handle_api_search(ClientContext *ctx) {
+    int user_id = 0;
+    if (strlen(ctx->session_id) > 0) {
+        user_id = session_get_user(ctx->session_id);
+        if (user_id < 0) user_id = 0;
+    }
+
+    // 1. ?q=<검색어>&limit=N (q는 URL 인코딩된 UTF-8)
+    char query[QUERY_LEN] = "";
+    if (http_get_form_param(ctx->query, "q", query, sizeof(query)) == 0) http_url_decode(query);
+
+    int limit = SEARCH_DEFAULT;
+    char param[PARAM_LEN];
+    if (http_get_form_param(ctx->query, "limit", param, sizeof(param)) == 0) {
+        char *end;
+        long v = strtol(param, &end, 10);
+        if (*end != '\0' || v <= 0) {
+            send_error_response(ctx, 400);
+            return;
+        }
+        limit = (v < SEARCH_MAX) ? (int)v : SEARCH_MAX;
+    }
+
+    CatalogSnapshot *snap = acquire_snapshot();
+    if (!snap) {
+        catalog_refresh();
+        snap = acquire_snapshot();
+    }
+    if (!snap) {
+        send_error_response(ctx, 500);
+        return;
+    }
+
+    // 2. 색인 조회 (스냅샷과 함께 만든 불변 색인이므로 락 없음)
+    int docs[SEARCH_MAX];
+    int found = search_index_query(snap->search, query, docs, limit);
+
+    // 3. 결과 항목의 이어보기 위치 (결과가 있을 때만 조회)
+    PositionList list = {0};
+    if (user_id > 0 && found > 0) db_for_each_user_position(user_id, collect_position_cb, &list);
+
+    long long expiry = (user_id > 0) ? signed_url_expiry() : 0;
+    JsonWriter w;
+    json_writer_init(&w, NULL, NULL);
+    WRITE_LIT(&w, "[");
+    for (int i = 0; i < found; i++) {
+        const CatalogItem *item = &snap->items[docs[i]];
+        int pos = lookup_position(&list, item->id);
+        if (user_id > 0) history_buffer_get(user_id, item->id, &pos);
+        if (i > 0) WRITE_LIT(&w, ",");
+        write_item(&w, item, user_id, expiry, pos);
+    }
+    WRITE_LIT(&w, "]");
+    free(list.video_ids);
+    free(list.positions);
+    release_snapshot(snap);
+
+    size_t body_len = 0;
+    char *body = json_writer_dup(&w, &body_len);
+    json_writer_release(&w);
+    if (!body) {
+        send_error_response(ctx, 500);
+        return;
+    }
+
+    // 4. 결과는 사용자 위치와 서명 URL을 담으므로 캐시하지 않음
+    int header_len = snprintf(ctx->buffer, sizeof(ctx->buffer),
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json; charset=utf-8\r\n"
+        "Content-Length: %zu\r\n"
+        "Cache-Control: private, no-store\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n", body_len);
+
+    // 본문이 소켓 버퍼보다 클 수 있으므로 쓸 수 있을 때까지 기다리며 보냄
+    if (send_all_wait(ctx->client_fd, ctx->buffer, (size_t)header_len, CHUNK_SEND_TIMEOUT_MS) < 0 ||
+        send_all_wait(ctx->client_fd, body, body_len, CHUNK_SEND_TIMEOUT_MS) < 0) {
+        free(body);
+        LOG_DEBUG("API", "Failed to send search results: %m");
+        http_close_client(ctx);
+        return;
+    }
+    free(body);
+    finish_response(ctx);
+}
+
+int catalog_write_in_progress(JsonWriter *w, int user_id, const int *video_ids, const int *positions,
+                              int count, int max_items) {
+    CatalogSnapshot *snap = acquire_snapshot();
+    long long expiry = (user_id > 0) ? signed_url_expiry() : 0;
+    int written = 0;
+
+    WRITE_LIT(w, "[");
+    for (int i = 0; snap && i < count && written < max_items; i++) {
+        const CatalogItem *item = find_item(snap, video_ids[i]);
+        if (!item || positions[i] <= 0) continue; // 라이브러리에서 빠진 비디오
+        // 끝부분(크레딧)까지 본 것은 다 본 것으로 취급
+        if (item->duration > 0 && positions[i] >= item->duration - item->duration / 20) continue;
+
+        if (written > 0) WRITE_LIT(w, ",");
+        write_item(w, item, user_id, expiry, positions[i]);
+        written++;
+    }
+    WRITE_LIT(w, "]");
+
+    release_snapshot(snap);
+    return written;
+}
+
+void catalog_cleanup(void) {
+    pthread_mutex_lock(&g_current_mutex);
+    CatalogSnapshot *old = g_current;
+    g_current = NULL;
+    pthread_mutex_unlock(&g_current_mutex);
+    release_snapshot(old);
+}
+
+// =========================================================
+// 내부 헬퍼
+// =========================================================
+
+static CatalogSnapshot* acquire_snapshot(void) {
+    pthread_mutex_lock(&g_current_mutex);
+    CatalogSnapshot *snap = g_current;
+    if (snap) __atomic_add_fetch(&snap->refcount, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&g_current_mutex);
+    return snap;
+}
+
+static void release_snapshot(CatalogSnapshot *snap) {
+    if (!snap || __atomic_sub_fetch(&snap->refcount, 1, __ATOMIC_ACQ_REL) != 0) return;
+
+    for (int i = 0; i < snap->count; i++) free(snap->items[i].head); // 조각/경로/제목이 한 블록
+    search_index_free(snap->search);
+    free(snap->items);
+    free(snap);
+}
+
+static void collect_item_cb(int id, const char *title, const char *filepath, const char *thumbnail,
+                            int duration, void *arg) {
+    CatalogSnapshot *snap = (CatalogSnapshot *)arg;
+    if (snap->count < 0) return; // 이전 항목에서 할당 실패
+
+    if (snap->count == snap->cap) {
+        int new_cap = snap->cap ? snap->cap * 2 : 64;
+        CatalogItem *grown = (CatalogItem *)realloc(snap->items, (size_t)new_cap * sizeof(CatalogItem));
+        if (!grown) goto fail;
+        snap->items = grown;
+        snap->cap = new_cap;
+    }
+
+    // 제목/썸네일/경로는 파일명에서 오므로 따옴표나 제어 문자가 있을 수 있음 -> 이스케이프해서 조각으로
+    JsonWriter w;
+    json_writer_init(&w, NULL, NULL);
+    WRITE_LIT(&w, "{\"id\":");
+    json_write_int(&w, id);
+    WRITE_LIT(&w, ", \"title\":");
+    json_write_string(&w, title);
+    WRITE_LIT(&w, ", \"url\":\"");
+    size_t head_len = w.total;
+
+    WRITE_LIT(&w, "\", \"thumbnail\":");
+    json_write_string(&w, thumbnail);
+    WRITE_LIT(&w, ", \"trickplay\":\"/static/trickplay/");
+    json_write_int(&w, id);
+    WRITE_LIT(&w, "/index.vtt\", \"duration\":");
+    json_write_int(&w, duration);
+    WRITE_LIT(&w, ", \"last_pos\":");
+
+    size_t frag_len = 0;
+    char *block = json_writer_dup(&w, &frag_len);
+    json_writer_release(&w);
+    if (!block) goto fail;
+
+    if (!filepath) filepath = "";
+    if (!title) title = "";
+
+    // URL은 퍼센트 인코딩해 둠 (공백/한글은 물론 ?, #, &가 들어간 파일명도 경로로 전달되도록)
+    size_t url_cap = strlen(filepath) * 3 + 1;
+    char *url_path = (char *)malloc(url_cap);
+    if (!url_path || http_url_encode_path(filepath, url_path, url_cap) < 0) {
+        free(url_path);
+        free(block);
+        goto fail;
+    }
+    filepath = url_path;
+    size_t path_len = strlen(filepath);
+    size_t title_len = strlen(title);
+    char *grown_block = (char *)realloc(block, frag_len + 1 + path_len + 1 + title_len + 1);
+    if (!grown_block) {
+        free(url_path);
+        free(block);
+        goto fail;
+    }
+    block = grown_block;
+
+    // 한 블록: head | tail | '\0' | path | '\0' | title | '\0'
+    CatalogItem *item = &snap->items[snap->count++];
+    item->id = id;
+    item->duration = duration;
+    item->head = block;
+    item->head_len = head_len;
+    item->tail = block + head_len;
+    item->tail_len = frag_len - head_len;
+    item->path = block + frag_len + 1;
+    item->path_len = path_len;
+    memcpy(item->path, filepath, path_len + 1);
+    free(url_path);
+    item->title = item->path + path_len + 1;
+    memcpy(item->title, title, title_len + 1);
+
+    snap->version = fnv1a(snap->version, item->head, item->head_len);
+    snap->version = fnv1a(snap->version, item->path, item->path_len);
+    snap->version = fnv1a(snap->version, item->tail, item->tail_len);
+    return;
+
+fail:
+    for (int i = 0; i < snap->count; i++) free(snap->items[i].head);
+    snap->count = -1;
+}
+
+static void collect_position_cb(int video_id, int last_pos, void *arg) {
+    PositionList *list = (PositionList *)arg;
+    if (list->count == list->cap) {
+        int new_cap = list->cap ? list->cap * 2 : 32;
+        int *ids = (int *)realloc(list->video_ids, (size_t)new_cap * sizeof(int));
+        if (!ids) return;
+        list->video_ids = ids;
+        int *pos = (int *)realloc(list->positions, (size_t)new_cap * sizeof(int));
+        if (!pos) return;
+        list->positions = pos;
+        list->cap = new_cap;
+    }
+    list->video_ids[list->count] = video_id;
+    list->positions[list->count] = last_pos;
+    list->count++;
+}
+
+static const CatalogItem* find_item(const CatalogSnapshot *snap, int id) {
+    int i = find_page_start(snap, id - 1);
+    return (i < snap->count && snap->items[i].id == id) ? &snap->items[i] : NULL;
+}
+
+// 조각 사이에 URL과 위치를 끼워 넣어 비디오 객체 1개를 씀
+static void write_item(JsonWriter *w, const CatalogItem *item, int user_id, long long expiry, int last_pos) {
+    json_write_raw(w, item->head, item->head_len);
+
+    // 서명 URL: 스트리밍 요청이 세션 조회 없이 인증됨 (실패 시 원래 URL)
+    char url[URL_BUF_LEN];
+    if (expiry > 0 && signed_url_make(item->path, user_id, expiry, url, sizeof(url)) == 0) {
+        json_write_escaped(w, url, strlen(url));
+    } else {
+        json_write_escaped(w, item->path, item->path_len);
+    }
+
+    json_write_raw(w, item->tail, item->tail_len);
+    json_write_int(w, last_pos);
+    WRITE_LIT(w, "}");
+}
+
+static SearchIndex* build_search_index(const CatalogSnapshot *snap) {
+    const char **titles = (const char **)malloc((size_t)(snap->count > 0 ? snap->count : 1) * sizeof(char *));
+    if (!titles) return NULL;
+    for (int i = 0; i < snap->count; i++) titles[i] = snap->items[i].title;
+
+    SearchIndex *idx = search_index_build(titles, snap->count);
+    free(titles);
+    return idx;
+}
+
+// 위치 목록(video_id 오름차순)에서 이진 탐색, 없으면 0
+static int lookup_position(const PositionList *list, int video_id) {
+    int lo = 0, hi = list->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (list->video_ids[mid] < video_id) lo = mid + 1;
+        else hi = mid;
+    }
+    return (lo < list->count && list->video_ids[lo] == video_id) ? list->positions[lo] : 0;
+}
+
+// 첫 항목 중 id > cursor 인 위치
+static int find_page_start(const CatalogSnapshot *snap, int cursor) {
+    int lo = 0, hi = snap->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (snap->items[mid].id <= cursor) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// JsonWriter sink: 가득 찬 청크를 HTTP chunk 하나로 보냄
+static int chunk_sink(void *arg, const char *data, size_t len) {
+    ClientContext *ctx = (ClientContext *)arg;
+    char size_line[20];
+    int n = snprintf(size_line, sizeof(size_line), "%zx\r\n", len);
+
+    if (send_all_wait(ctx->client_fd, size_line, (size_t)n, CHUNK_SEND_TIMEOUT_MS) < 0 ||
+        send_all_wait(ctx->client_fd, data, len, CHUNK_SEND_TIMEOUT_MS) < 0 ||
+        send_all_wait(ctx->client_fd, "\r\n", 2, CHUNK_SEND_TIMEOUT_MS) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// 실패 시 연결을 닫고 ctx를 해제한 뒤 -1
+static int send_list_header(ClientContext *ctx, int status, const char *etag, int next_cursor) {
+    char next_header[48] = "";
+    if (next_cursor > 0) {
+        snprintf(next_header, sizeof(next_header), "X-Next-Cursor: %d\r\n", next_cursor);
+    }
+
+    int header_len;
+    if (status == 304) {
+        header_len = snprintf(ctx->buffer, sizeof(ctx->buffer),
+            "HTTP/1.1 304 Not Modified\r\n"
+            "ETag: %s\r\n"
+            "%s"
+            "Cache-Control: private, no-cache\r\n"
+            "Connection: keep-alive\r\n"
+            "\r\n", etag, next_header);
+    } else {
+        header_len = snprintf(ctx->buffer, sizeof(ctx->buffer),
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: application/json; charset=utf-8\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "ETag: %s\r\n"
+            "%s"
+            "Cache-Control: private, no-cache\r\n"
+            "Connection: keep-alive\r\n"
+            "\r\n", etag, next_header);
+    }
+
+    if (send_all_blocking(ctx->client_fd, ctx->buffer, header_len) < 0) {
+        LOG_DEBUG("API", "Failed to send header: %m");
+        http_close_client(ctx);
+        return -1;
+    }
+    return 0;
+}
+
+static void finish_response(ClientContext *ctx) {
+    // 다음 요청 대기 (Rearm)
+    ctx->state = STATE_REQ_RECEIVING;
+    ctx->buffer_len = 0;
+
+    if (reactor_update_event(ctx->epoll_fd, ctx->client_fd, EPOLLIN | EPOLLONESHOT, ctx) < 0) {
+        http_close_client(ctx);
+    }
+}
@@ -0,0 +1,209 @@
+// 검색 응답 전송 테스트 (make bench -> build/bin/test/app/catalog_test)
+// 사용법: catalog_test [비디오 수=200] [읽기 시작 지연 ms=200]
+// 임시 DB로 카탈로그를 만든 뒤, 송신 버퍼를 최소로 줄인 논블로킹 소켓으로 /api/search 결과(서명 URL 포함 50건)를 보냅니다.
+// 받는 쪽은 잠시 읽지 않다가 읽기 시작하므로, 본문이 소켓 버퍼보다 크면 EAGAIN을 반드시 거칩니다.
+// Content-Length만큼 온전히 받았는지, 연결이 다음 요청을 위해 살아 있는지 확인합니다.
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include "app/catalog.h"
+#include "app/client_context.h"
+#include "app/db_handler.h"
+#include "app/hmac_keyring.h"
+#include "app/session_manager.h"
+#include "app/signed_url.h"
+
+#define SEARCH_LIMIT 50
+
+static int g_failed = 0;
+
+#define CHECK(cond, ...)                                \
+    do {                                                \
+        if (!(cond)) {                                  \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__);                        \
+            printf("\n");                               \
+            g_failed++;                                 \
+        }                                               \
+    } while (0)
+
+typedef struct {
+    int fd;
+    int delay_ms;
+    char *data;         // 받은 응답 (헤더 + 본문)
+    size_t len;
+    size_t body_len;    // Content-Length
+    size_t header_len;
+} Reader;
+
+static void sleep_ms(long ms) {
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+// 잠시 읽지 않다가 응답 하나(헤더 + Content-Length)를 끝까지 읽음 (끊기면 중단)
+static void* reader_func(void *arg) {
+    Reader *r = (Reader *)arg;
+    sleep_ms(r->delay_ms);
+
+    size_t cap = 64 * 1024;
+    r->data = malloc(cap);
+    while (r->data) {
+        if (r->len + 1 >= cap) {
+            char *grown = realloc(r->data, cap * 2);
+            if (!grown) break;
+            r->data = grown;
+            cap *= 2;
+        }
+        ssize_t n = recv(r->fd, r->data + r->len, cap - r->len - 1, 0);
+        if (n <= 0) break;
+        r->len += (size_t)n;
+        r->data[r->len] = '\0';
+
+        char *end = strstr(r->data, "\r\n\r\n");
+        if (end && r->header_len == 0) {
+            r->header_len = (size_t)(end + 4 - r->data);
+            char *cl = strstr(r->data, "Content-Length: ");
+            if (cl && cl < end) r->body_len = (size_t)atol(cl + 16);
+        }
+        if (r->header_len > 0 && r->len >= r->header_len + r->body_len) break;
+    }
+    return NULL;
+}
+
+static int count_occurrences(const char *s, const char *needle) {
+    int count = 0;
+    for (const char *p = strstr(s, needle); p; p = strstr(p + 1, needle)) count++;
+    return count;
+}
+
+int main(int argc, char **argv) {
+    int videos = (argc > 1) ? atoi(argv[1]) : 200;
+    int delay_ms = (argc > 2) ? atoi(argv[2]) : 200;
+    if (videos < SEARCH_LIMIT || delay_ms < 0) {
+        fprintf(stderr, "usage: %s [videos >= %d] [read delay ms]\n", argv[0], SEARCH_LIMIT);
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    // 1. 임시 DB에 긴 제목의 비디오를 채우고 카탈로그 스냅샷 생성
+    char dir[] = "/tmp/catalog_test_XXXXXX";
+    if (!mkdtemp(dir)) return 1;
+    char path[64];
+    snprintf(path, sizeof(path), "%s/test.db", dir);
+    if (db_init(path, 2) != 0) return 1;
+
+    VideoRecord *records = calloc((size_t)videos, sizeof(VideoRecord));
+    char (*paths)[128] = calloc((size_t)videos, sizeof(*paths));
+    char (*titles)[128] = calloc((size_t)videos, sizeof(*titles));
+    if (!records || !paths || !titles) return 1;
+    for (int i = 0; i < videos; i++) {
+        snprintf(paths[i], sizeof(paths[i]), "/videos/documentary/ocean series %04d.mp4", i);
+        snprintf(titles[i], sizeof(titles[i]), "Ocean documentary series, a long title for episode %04d", i);
+        records[i].filepath = paths[i];
+        records[i].title = titles[i];
+        records[i].thumbnail = "";
+        records[i].duration = 3000;
+    }
+    if (db_apply_library_batch(records, videos, NULL, 0, NULL) != 0) return 1;
+
+    if (hmac_keyring_init(NULL) != 0 || signed_url_init(3600) != 0 ||
+        session_system_init("table", 0, 0, NULL) != 0) {
+        return 1;
+    }
+    catalog_init(0);
+    if (catalog_refresh() != 0) return 1;
+
+    // 2. 송신 버퍼를 최소로 줄인 논블로킹 소켓 (요청 워커가 쓰는 클라이언트 소켓과 같은 조건)
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0) return 1;
+    int small = 4096;
+    setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+    setsockopt(sv[1], SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+    fcntl(sv[0], F_SETFL, fcntl(sv[0], F_GETFL) | O_NONBLOCK);
+    int sndbuf = 0;
+    socklen_t optlen = sizeof(sndbuf);
+    getsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, &optlen);
+
+    // 응답 후 EPOLLIN 재등록이 되도록 epoll에 올려 둠
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    ClientContext *ctx = calloc(1, sizeof(ClientContext));
+    if (epoll_fd < 0 || !ctx) return 1;
+    struct epoll_event ev = {.events = EPOLLIN | EPOLLONESHOT, .data.ptr = ctx};
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sv[0], &ev) != 0) return 1;
+
+    ctx->epoll_fd = epoll_fd;
+    ctx->client_fd = sv[0];
+    ctx->file_fd = -1;
+    ctx->direct_fd = -1;
+    ctx->io_buf = -1;
+    ctx->io_dev = -1;
+    ctx->state = STATE_PROCESSING;
+    snprintf(ctx->client_ip, sizeof(ctx->client_ip), "127.0.0.1");
+    snprintf(ctx->request_path, sizeof(ctx->request_path), "/api/search");
+    snprintf(ctx->query, sizeof(ctx->query), "q=ocean&limit=%d", SEARCH_LIMIT);
+    if (session_create(1, ctx->session_id, sizeof(ctx->session_id)) != 0) return 1;
+
+    // 3. 받는 쪽이 늦게 읽는 동안 응답
+    Reader reader = {.fd = sv[1], .delay_ms = delay_ms};
+    pthread_t tid;
+    pthread_create(&tid, NULL, reader_func, &reader);
+    handle_api_search(ctx);
+    pthread_join(tid, NULL);
+
+    CHECK(reader.data != NULL && reader.header_len > 0, "no response header");
+    if (reader.data && reader.header_len > 0) {
+        const char *body = reader.data + reader.header_len;
+        CHECK(strncmp(reader.data, "HTTP/1.1 200 ", 13) == 0, "status line: %.20s", reader.data);
+        CHECK(reader.body_len > (size_t)sndbuf, "body %zu bytes does not exceed SO_SNDBUF %d", reader.body_len,
+              sndbuf);
+        CHECK(reader.len == reader.header_len + reader.body_len, "received %zu of %zu body bytes",
+              reader.len - reader.header_len, reader.body_len);
+        CHECK(body[0] == '[' && reader.data[reader.len - 1] == ']', "body is not a complete JSON array");
+        CHECK(count_occurrences(body, "\"id\":") == SEARCH_LIMIT, "%d items, want %d",
+              count_occurrences(body, "\"id\":"), SEARCH_LIMIT);
+        CHECK(count_occurrences(body, "&s=") == SEARCH_LIMIT, "signed URLs missing");
+        printf("search body %zu bytes through SO_SNDBUF %d, received %zu\n", reader.body_len, sndbuf,
+               reader.len - reader.header_len);
+    }
+
+    // 응답이 끝나면 연결은 다음 요청을 기다림 (실패 경로는 ctx를 닫고 해제하므로 건드리지 않음)
+    bool complete = reader.header_len > 0 && reader.len == reader.header_len + reader.body_len;
+    if (complete) {
+        CHECK(ctx->state == STATE_REQ_RECEIVING, "connection was not re-armed");
+        close(ctx->client_fd);
+        free(ctx);
+    }
+    close(sv[1]);
+    close(epoll_fd);
+    free(reader.data);
+
+    catalog_cleanup();
+    session_system_cleanup();
+    hmac_keyring_cleanup();
+    db_cleanup();
+    free(titles);
+    free(paths);
+    free(records);
+
+    const char *suffixes[] = {"", "-wal", "-shm"};
+    for (int i = 0; i < 3; i++) {
+        char file[80];
+        snprintf(file, sizeof(file), "%s%s", path, suffixes[i]);
+        unlink(file);
+    }
+    rmdir(dir);
+
+    printf("%s (%d failed)\n", g_failed ? "FAILED" : "OK", g_failed);
+    return g_failed ? 1 : 0;
+}
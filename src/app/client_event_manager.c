@@ -4,6 +4,7 @@
 #include "app/stream_handler.h"
 #include "app/client_event_manager.h"
 #include "app/client_context.h"
+#include "app/device_io.h"
 
 
 void handle_client_event(void* arg) {
@@ -17,7 +18,9 @@ void handle_client_event(void* arg) {
 
         case STATE_RES_SENDING_HEADER:
         case STATE_RES_SENDING_BODY:
-            handle_streaming_request(ctx); // 스트리밍 처리기 호출
+            // 응답을 시작한 핸들러(스트리밍/정적)를 해당 장치 큐에서 이어서 실행
+            if (ctx->io_handler) device_io_resume(ctx);
+            else handle_streaming_request(ctx);
             break;
             
         case STATE_CLOSED:
@@ -0,0 +1,396 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+
+#include "app/continue_watching.h"
+#include "app/catalog.h"
+#include "app/client_context.h"
+#include "app/db_handler.h"
+#include "app/history_buffer.h"
+#include "app/http_utils.h"
+#include "app/session_manager.h"
+#include "core/json_writer.h"
+#include "core/reactor.h"
+#include "core/logger.h"
+
+#define DEFAULT_LIMIT   10
+// 다 본 비디오나 라이브러리에서 빠진 비디오는 응답에서 건너뛰므로 상한보다 넉넉히 읽어 둠
+#define FETCH_ROWS      (CONTINUE_MAX_ITEMS + 12)
+
+#define JSON_AUTH_FAIL "{\"success\": false, \"message\": \"Unauthorized\"}"
+
+typedef struct {
+    int video_id;
+    int last_pos;
+    long long updated_at;
+} RecentItem;
+
+// 사용자 1명의 최근 시청 목록 (updated_at 내림차순)
+typedef struct CacheEntry {
+    int user_id;
+    int count;
+    RecentItem items[FETCH_ROWS];
+    struct CacheEntry *hash_next;
+    struct CacheEntry *lru_prev;    // 최근 사용 쪽
+    struct CacheEntry *lru_next;    // 오래된 쪽
+} CacheEntry;
+
+// 내부 전역 변수
+static CacheEntry **g_buckets = NULL;
+static size_t g_bucket_mask = 0;
+static size_t g_capacity = 0;
+static size_t g_size = 0;
+static CacheEntry *g_lru_head = NULL;
+static CacheEntry *g_lru_tail = NULL;
+static unsigned long long g_write_seq = 0;     // 캐시 밖에서 DB를 읽는 동안 기록이 있었는지 확인
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// 통계
+static unsigned long long g_hits = 0;
+static unsigned long long g_misses = 0;
+static unsigned long long g_updates = 0;
+static unsigned long long g_evictions = 0;
+
+// 내부 헬퍼 함수
+static CacheEntry* lookup(int user_id);
+static void lru_unlink(CacheEntry *e);
+static void lru_push_front(CacheEntry *e);
+static void remove_entry(CacheEntry *e);
+static void insert_entry(const CacheEntry *loaded);
+static int load_from_db(int user_id, CacheEntry *out);
+static void collect_recent_cb(int video_id, int last_pos, long long updated_at, void *arg);
+static void merge_buffered_cb(int video_id, int last_pos, long long updated_at, void *arg);
+static void send_continue_json(ClientContext *ctx, int status, const char *body, size_t body_len);
+
+static inline size_t bucket_of(int user_id) {
+    uint32_t h = (uint32_t)user_id * 0x9E3779B1u;
+    return (size_t)(h ^ (h >> 16)) & g_bucket_mask;
+}
+
+int continue_watching_init(int cache_users) {
+    if (cache_users <= 0) {
+        printf("[Continue] Cache disabled (every request reads the index).\n");
+        return -1;
+    }
+
+    size_t buckets = 1;
+    while (buckets < (size_t)cache_users * 2) buckets <<= 1;
+    g_buckets = (CacheEntry **)calloc(buckets, sizeof(CacheEntry *));
+    if (!g_buckets) return -1;
+
+    g_bucket_mask = buckets - 1;
+    g_capacity = (size_t)cache_users;
+    printf("[Continue] Per-user cache: %d users (%zu KB max).\n",
+           cache_users, g_capacity * sizeof(CacheEntry) / 1024);
+    return 0;
+}
+
+void continue_watching_on_write(int user_id, int video_id, int last_pos) {
+    if (!g_buckets) return;
+
+    pthread_mutex_lock(&g_mutex);
+    g_write_seq++;
+
+    CacheEntry *e = lookup(user_id);
+    if (!e) {
+        pthread_mutex_unlock(&g_mutex);
+        return;
+    }
+
+    if (last_pos <= 0) {
+        // 목록에서 빠지면 그 아래 행을 알 수 없으므로 다음 조회 때 다시 읽음
+        remove_entry(e);
+        pthread_mutex_unlock(&g_mutex);
+        return;
+    }
+
+    // 방금 본 비디오가 가장 최근 -> 맨 앞으로 (기존 위치는 제거, 넘치면 가장 오래된 것 탈락)
+    int found = e->count;
+    for (int i = 0; i < e->count; i++) {
+        if (e->items[i].video_id == video_id) {
+            found = i;
+            break;
+        }
+    }
+    if (found == e->count && e->count < FETCH_ROWS) e->count++;
+    if (found == FETCH_ROWS) found = FETCH_ROWS - 1;
+    memmove(&e->items[1], &e->items[0], (size_t)found * sizeof(RecentItem));
+
+    e->items[0].video_id = video_id;
+    e->items[0].last_pos = last_pos;
+    e->items[0].updated_at = (long long)time(NULL);
+    g_updates++;
+
+    pthread_mutex_unlock(&g_mutex);
+}
+
+void handle_api_continue(ClientContext *ctx) {
+    int user_id = -1;
+    if (strlen(ctx->session_id) > 0) {
+        user_id = session_get_user(ctx->session_id);
+    }
+    if (user_id <= 0) {
+        send_continue_json(ctx, 401, JSON_AUTH_FAIL, strlen(JSON_AUTH_FAIL));
+        return;
+    }
+
+    int limit = DEFAULT_LIMIT;
+    char param[16];
+    if (http_get_form_param(ctx->query, "limit", param, sizeof(param)) == 0) {
+        limit = atoi(param);
+        if (limit <= 0) {
+            send_error_response(ctx, 400);
+            return;
+        }
+        if (limit > CONTINUE_MAX_ITEMS) limit = CONTINUE_MAX_ITEMS;
+    }
+
+    // 1. 캐시 조회 (히트면 복사만 하고 바로 락 해제)
+    CacheEntry snap;
+    bool hit = false;
+    unsigned long long seq = 0;
+
+    pthread_mutex_lock(&g_mutex);
+    CacheEntry *e = g_buckets ? lookup(user_id) : NULL;
+    if (e) {
+        snap.count = e->count;
+        memcpy(snap.items, e->items, (size_t)e->count * sizeof(RecentItem));
+        lru_unlink(e);
+        lru_push_front(e);
+        g_hits++;
+        hit = true;
+    } else {
+        g_misses++;
+        seq = g_write_seq;
+    }
+    pthread_mutex_unlock(&g_mutex);
+
+    // 2. 미스: 인덱스에서 상위 몇 행 (락 밖에서)
+    if (!hit) {
+        if (load_from_db(user_id, &snap) != 0) {
+            send_error_response(ctx, 500);
+            return;
+        }
+        pthread_mutex_lock(&g_mutex);
+        // 읽는 사이에 기록이 있었다면 방금 읽은 목록이 이미 낡았을 수 있으므로 캐시하지 않음
+        if (g_buckets && seq == g_write_seq && !lookup(user_id)) insert_entry(&snap);
+        pthread_mutex_unlock(&g_mutex);
+    }
+
+    int video_ids[FETCH_ROWS];
+    int positions[FETCH_ROWS];
+    for (int i = 0; i < snap.count; i++) {
+        video_ids[i] = snap.items[i].video_id;
+        positions[i] = snap.items[i].last_pos;
+    }
+
+    // 3. 카탈로그 조각으로 응답 (항목 수가 작으므로 메모리에 모아 Content-Length로)
+    JsonWriter w;
+    json_writer_init(&w, NULL, NULL);
+    catalog_write_in_progress(&w, user_id, video_ids, positions, snap.count, limit);
+
+    size_t body_len = 0;
+    char *body = json_writer_dup(&w, &body_len);
+    json_writer_release(&w);
+    if (!body) {
+        send_error_response(ctx, 500);
+        return;
+    }
+
+    send_continue_json(ctx, 200, body, body_len);
+    free(body);
+}
+
+void continue_watching_get_stats(ContinueStats *out) {
+    memset(out, 0, sizeof(*out));
+    pthread_mutex_lock(&g_mutex);
+    out->cached_users = g_size;
+    out->capacity = g_capacity;
+    out->hits = g_hits;
+    out->misses = g_misses;
+    out->updates = g_updates;
+    out->evictions = g_evictions;
+    pthread_mutex_unlock(&g_mutex);
+}
+
+void continue_watching_cleanup(void) {
+    pthread_mutex_lock(&g_mutex);
+    CacheEntry *e = g_lru_head;
+    while (e) {
+        CacheEntry *next = e->lru_next;
+        free(e);
+        e = next;
+    }
+    free(g_buckets);
+    g_buckets = NULL;
+    g_lru_head = g_lru_tail = NULL;
+    g_size = 0;
+    pthread_mutex_unlock(&g_mutex);
+}
+
+// =========================================================
+// 내부 헬퍼 (g_mutex 보유 상태에서 호출)
+// =========================================================
+
+static CacheEntry* lookup(int user_id) {
+    for (CacheEntry *e = g_buckets[bucket_of(user_id)]; e; e = e->hash_next) {
+        if (e->user_id == user_id) return e;
+    }
+    return NULL;
+}
+
+static void lru_unlink(CacheEntry *e) {
+    if (e->lru_prev) e->lru_prev->lru_next = e->lru_next;
+    else g_lru_head = e->lru_next;
+    if (e->lru_next) e->lru_next->lru_prev = e->lru_prev;
+    else g_lru_tail = e->lru_prev;
+    e->lru_prev = e->lru_next = NULL;
+}
+
+static void lru_push_front(CacheEntry *e) {
+    e->lru_prev = NULL;
+    e->lru_next = g_lru_head;
+    if (g_lru_head) g_lru_head->lru_prev = e;
+    g_lru_head = e;
+    if (!g_lru_tail) g_lru_tail = e;
+}
+
+static void remove_entry(CacheEntry *e) {
+    CacheEntry **link = &g_buckets[bucket_of(e->user_id)];
+    while (*link != e) link = &(*link)->hash_next;
+    *link = e->hash_next;
+    lru_unlink(e);
+    free(e);
+    g_size--;
+}
+
+static void insert_entry(const CacheEntry *loaded) {
+    CacheEntry *e;
+    if (g_size >= g_capacity && g_lru_tail) {
+        // 가장 오래 조회되지 않은 사용자를 내보내고 그 메모리를 재사용
+        e = g_lru_tail;
+        CacheEntry **link = &g_buckets[bucket_of(e->user_id)];
+        while (*link != e) link = &(*link)->hash_next;
+        *link = e->hash_next;
+        lru_unlink(e);
+        g_evictions++;
+    } else {
+        e = (CacheEntry *)malloc(sizeof(CacheEntry));
+        if (!e) return;
+        g_size++;
+    }
+
+    e->user_id = loaded->user_id;
+    e->count = loaded->count;
+    memcpy(e->items, loaded->items, (size_t)loaded->count * sizeof(RecentItem));
+
+    size_t b = bucket_of(e->user_id);
+    e->hash_next = g_buckets[b];
+    g_buckets[b] = e;
+    lru_push_front(e);
+}
+
+// =========================================================
+// 내부 헬퍼 (락 없이 호출)
+// =========================================================
+
+static int load_from_db(int user_id, CacheEntry *out) {
+    out->user_id = user_id;
+    out->count = 0;
+    if (db_for_each_recent_history(user_id, FETCH_ROWS, collect_recent_cb, out) != 0) return -1;
+
+    // 아직 DB에 쓰지 않은 하트비트가 최신 (플러시 주기 안에 처음 본 비디오도 여기서만 보임)
+    if (history_buffer_for_each_user(user_id, merge_buffered_cb, out) > 0) {
+        // 버퍼의 updated_at 기준으로 다시 최근 순 정렬 (항목이 적으므로 삽입 정렬)
+        for (int i = 1; i < out->count; i++) {
+            RecentItem item = out->items[i];
+            int j = i;
+            while (j > 0 && out->items[j - 1].updated_at < item.updated_at) {
+                out->items[j] = out->items[j - 1];
+                j--;
+            }
+            out->items[j] = item;
+        }
+    }
+    return 0;
+}
+
+// 버퍼 항목을 DB에서 읽은 목록에 반영 (스트라이프 락 아래에서 호출되므로 배열 조작만)
+static void merge_buffered_cb(int video_id, int last_pos, long long updated_at, void *arg) {
+    CacheEntry *e = (CacheEntry *)arg;
+    int found = -1;
+    for (int i = 0; i < e->count; i++) {
+        if (e->items[i].video_id == video_id) {
+            found = i;
+            break;
+        }
+    }
+
+    if (last_pos <= 0) {
+        // 처음부터 다시 보거나 다 본 비디오 -> 목록에서 제외 (DB 조회 조건과 같음)
+        if (found >= 0) {
+            memmove(&e->items[found], &e->items[found + 1], (size_t)(e->count - found - 1) * sizeof(RecentItem));
+            e->count--;
+        }
+        return;
+    }
+
+    if (found < 0) {
+        if (e->count < FETCH_ROWS) {
+            found = e->count++;
+        } else {
+            // 가득 찼으면 가장 오래된 항목보다 최근일 때만 그 자리를 차지 (정렬 전이라 최솟값을 찾음)
+            int oldest = 0;
+            for (int i = 1; i < e->count; i++) {
+                if (e->items[i].updated_at < e->items[oldest].updated_at) oldest = i;
+            }
+            if (e->items[oldest].updated_at >= updated_at) return;
+            found = oldest;
+        }
+        e->items[found].video_id = video_id;
+    }
+    // 버퍼 값은 DB에 쓴 값보다 항상 같거나 최신
+    e->items[found].last_pos = last_pos;
+    e->items[found].updated_at = updated_at;
+}
+
+static void collect_recent_cb(int video_id, int last_pos, long long updated_at, void *arg) {
+    CacheEntry *e = (CacheEntry *)arg;
+    if (e->count >= FETCH_ROWS) return;
+    e->items[e->count].video_id = video_id;
+    e->items[e->count].last_pos = last_pos;
+    e->items[e->count].updated_at = updated_at;
+    e->count++;
+}
+
+static void send_continue_json(ClientContext *ctx, int status, const char *body, size_t body_len) {
+    int header_len = snprintf(ctx->buffer, sizeof(ctx->buffer),
+        "HTTP/1.1 %s\r\n"
+        "Content-Type: application/json; charset=utf-8\r\n"
+        "Content-Length: %zu\r\n"
+        "Cache-Control: private, no-store\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n", (status == 200) ? "200 OK" : "401 Unauthorized", body_len);
+
+    if (send_all_blocking(ctx->client_fd, ctx->buffer, header_len) < 0 ||
+        send_all_blocking(ctx->client_fd, body, body_len) < 0) {
+        LOG_DEBUG("API", "Failed to send continue list: %m");
+        http_close_client(ctx);
+        return;
+    }
+
+    // 다음 요청 대기 (Rearm)
+    ctx->state = STATE_REQ_RECEIVING;
+    ctx->buffer_len = 0;
+
+    if (reactor_update_event(ctx->epoll_fd, ctx->client_fd, EPOLLIN | EPOLLONESHOT, ctx) < 0) {
+        http_close_client(ctx);
+    }
+}
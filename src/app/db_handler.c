@@ -4,25 +4,86 @@
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
-#include <sys/socket.h>
-#include <sys/epoll.h>
+#include <pthread.h>
 #include <sqlite3.h>
 #include "app/db_handler.h"
-#include "app/http_utils.h"
-#include "app/client_context.h"
-#include "core/reactor.h"
-
-#define FFMPEG_CMD_TEMPLATE "ffmpeg -i \"%s\" -ss 00:00:05 -vframes 1 \"%s\" -y > /dev/null 2>&1"
+#include "core/metrics.h"
 
 // 데이터베이스 연결 객체 (파일 내부 전역 변수)
 // 외부에서는 접근하지 못하도록 static으로 숨깁니다.
 static sqlite3 *g_db = NULL;
 
-// 내부 헬퍼 함수
-static int seed_initial_data();
-static int generate_thumbnail_ffmpeg(const char *video_path, const char *out_thumb_path);
+// 라이브러리 스캐너 전용 쓰기 연결
+// g_db는 모든 워커가 공유하므로 그 위에서 BEGIN을 하면 다른 스레드의 쿼리가
+// 스캐너 트랜잭션에 섞여 들어감 -> 배치 쓰기는 별도 연결에서 수행
+static sqlite3 *g_writer_db = NULL;
+static pthread_mutex_t g_writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char g_db_path[512];
+
+// 요청마다 실행되는 쿼리 (연결마다 한 번만 prepare 해두고 reset으로 재사용)
+typedef enum {
+    Q_USER_PASSWORD = 0,
+    Q_UPDATE_HISTORY,
+    Q_USER_POSITIONS,
+    Q_CREATE_USER,
+    Q_UPDATE_PASSWORD,
+    Q_RECENT_HISTORY,
+    Q_COUNT
+} QueryId;
+
+// 쿼리별 지연 히스토그램은 H_DB_USER_PASSWORD + QueryId
+_Static_assert(H_DB_RECENT_HISTORY - H_DB_USER_PASSWORD + 1 == Q_COUNT, "metrics.h DB histograms out of sync");
+
+static const char *const QUERY_SQL[Q_COUNT] = {
+    [Q_USER_PASSWORD] = "SELECT id, password FROM users WHERE username = ?;",
+    // 라이브러리에서 빠진 비디오에는 이력을 만들지 않음 (고아 행 방지)
+    [Q_UPDATE_HISTORY] = "INSERT OR REPLACE INTO watch_history (user_id, video_id, last_pos, updated_at) "
+                         "SELECT ?1, ?2, ?3, CURRENT_TIMESTAMP WHERE EXISTS (SELECT 1 FROM videos WHERE id = ?2);",
+    [Q_USER_POSITIONS] = "SELECT video_id, last_pos FROM watch_history "
+                         "WHERE user_id = ? AND last_pos > 0 ORDER BY video_id;",
+    [Q_CREATE_USER] = "INSERT INTO users (username, password) VALUES (?, ?);",
+    [Q_UPDATE_PASSWORD] = "UPDATE users SET password = ? WHERE id = ?;",
+    // idx_history_recent만으로 응답 (테이블 행을 읽지 않음)
+    [Q_RECENT_HISTORY] = "SELECT video_id, last_pos, CAST(strftime('%s', updated_at) AS INTEGER) "
+                         "FROM watch_history WHERE user_id = ? AND last_pos > 0 "
+                         "ORDER BY updated_at DESC LIMIT ?;",
+};
+
+// 연결 + 쿼리별 준비된 문장 캐시 (한 번에 한 스레드만 사용)
+typedef struct {
+    sqlite3 *db;
+    sqlite3_stmt *stmts[Q_COUNT];
+    QueryId active;         // 빌려 간 문장 (get_stmt ~ put_stmt 지연 측정)
+    long long started_ns;
+} DbConn;
+
+// g_db의 문장 캐시. 문장은 스레드 간 동시 사용이 안 되므로 g_main_mutex로 빌려줌
+static DbConn g_main_conn = {0};
+static pthread_mutex_t g_main_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// 읽기 전용 연결 풀
+// g_db는 SQLite의 serialized 뮤텍스로 한 번에 한 쿼리만 실행하므로, 조회는 각자 연결을 빌려 병렬 실행
+// 빌린 스레드만 쓰므로 연결 자체는 NOMUTEX (WAL이라 쓰기 중에도 읽기가 막히지 않음)
+static DbConn **g_readers = NULL;
+static int g_reader_count = 0;
+static int g_reader_free = 0;           // g_readers[0..g_reader_free)가 빌려줄 수 있는 연결
+static pthread_mutex_t g_reader_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_reader_cond = PTHREAD_COND_INITIALIZER;
 
-int db_init(const char *db_path) {
+// 내부 헬퍼 함수
+static void migrate_videos_table(void);
+static sqlite3* get_writer_db(void);
+static int open_reader_pool(int pool_size);
+static DbConn* acquire_reader(void);
+static void release_reader(DbConn *conn);
+static DbConn* acquire_main(void);
+static void release_main(DbConn *conn);
+static sqlite3_stmt* get_stmt(DbConn *conn, QueryId id);
+static void put_stmt(DbConn *conn, sqlite3_stmt *stmt);
+static void close_conn(DbConn *conn);
+
+int db_init(const char *db_path, int read_pool_size) {
+    snprintf(g_db_path, sizeof(g_db_path), "%s", db_path);
     int rc = sqlite3_open(db_path, &g_db);
     if (rc != SQLITE_OK) {
         fprintf(stderr, "[DB] Cannot open database: %s\n", sqlite3_errmsg(g_db));
@@ -80,11 +141,23 @@ int db_init(const char *db_path) {
         return -1;
     }
 
+    // 이전 버전이 비디오 삭제 시 남긴 시청 이력 정리 (이후로는 삭제 배치가 함께 지움)
+    sqlite3_exec(g_db, "DELETE FROM watch_history WHERE video_id NOT IN (SELECT id FROM videos);", 0, 0, 0);
+
+    // 이어보기 목록용 커버링 인덱스: 사용자별 최근 시청 순으로 정렬된 채 위치까지 포함
+    if (sqlite3_exec(g_db,
+            "CREATE INDEX IF NOT EXISTS idx_history_recent "
+            "ON watch_history(user_id, updated_at DESC, video_id, last_pos);",
+            0, 0, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "[DB] Create history index failed: %s\n", err_msg);
+        sqlite3_free(err_msg);
+    }
+
     const char *sql_create_users = 
         "CREATE TABLE IF NOT EXISTS users ("
         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
         "username TEXT NOT NULL UNIQUE, "
-        "password TEXT NOT NULL" // 실제 운영 시 해시값 저장 필수
+        "password TEXT NOT NULL" // scrypt 해시 문자열 (password_hash.h), 이전 버전의 평문은 로그인 시 교체
         ");";
 
     if (sqlite3_exec(g_db, sql_create_users, 0, 0, 0) != SQLITE_OK) {
@@ -94,154 +167,224 @@ int db_init(const char *db_path) {
         return -1;
     }
 
+    // 데모 계정 (평문으로 넣어 두면 첫 로그인 때 해시로 교체됨)
     sqlite3_exec(g_db, "INSERT OR IGNORE INTO users (username, password) VALUES ('user1', '1234');", 0, 0, 0);
 
-    // 초기 데이터 주입
-    seed_initial_data();
+    // 라이브러리 스캐너용 컬럼/인덱스 (기존 DB 호환)
+    migrate_videos_table();
+
+    g_main_conn.db = g_db;
+
+    // 스키마가 준비된 뒤 읽기 연결을 열어야 함 (실패하면 g_db로 조회)
+    open_reader_pool(read_pool_size);
     return 0;
 }
 
 void db_cleanup() {
+    pthread_mutex_lock(&g_reader_mutex);
+    for (int i = 0; i < g_reader_free; i++) {
+        close_conn(g_readers[i]);
+        free(g_readers[i]);
+    }
+    free(g_readers);
+    g_readers = NULL;
+    g_reader_count = g_reader_free = 0;
+    pthread_cond_broadcast(&g_reader_cond);
+    pthread_mutex_unlock(&g_reader_mutex);
+
+    pthread_mutex_lock(&g_writer_mutex);
+    if (g_writer_db) {
+        sqlite3_close(g_writer_db);
+        g_writer_db = NULL;
+    }
+    pthread_mutex_unlock(&g_writer_mutex);
+
+    pthread_mutex_lock(&g_main_mutex);
     if (g_db) {
-        sqlite3_close(g_db);
+        close_conn(&g_main_conn); // 캐시된 문장을 먼저 finalize해야 닫힘
         g_db = NULL;
     }
+    pthread_mutex_unlock(&g_main_mutex);
 }
 
-// [내부 함수] 초기 데이터 주입
-static int seed_initial_data() {
-    int rc;
-    sqlite3_stmt *stmt;
-    int count = 0;
-
-    // A. 데이터 개수 확인
-    const char *sql_count = "SELECT count(*) FROM videos;";
-    rc = sqlite3_prepare_v2(g_db, sql_count, -1, &stmt, 0);
-    if (rc == SQLITE_OK) {
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            count = sqlite3_column_int(stmt, 0);
-        }
-    }
-    sqlite3_finalize(stmt);
+// [내부 함수] 라이브러리 스캐너가 쓰는 컬럼 추가
+// 변경 감지용 file_size / file_mtime, upsert용 filepath UNIQUE 인덱스
+static void migrate_videos_table(void) {
+    // 이미 컬럼이 있으면 "duplicate column" 에러가 나므로 결과는 무시
+    sqlite3_exec(g_db, "ALTER TABLE videos ADD COLUMN file_size INTEGER DEFAULT 0;", 0, 0, 0);
+    sqlite3_exec(g_db, "ALTER TABLE videos ADD COLUMN file_mtime INTEGER DEFAULT 0;", 0, 0, 0);
 
-    // 데이터가 이미 있으면 스킵
-    if (count > 0) return 0;
+    char *err_msg = 0;
+    if (sqlite3_exec(g_db, "CREATE UNIQUE INDEX IF NOT EXISTS idx_videos_filepath ON videos(filepath);",
+                     0, 0, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "[DB] Create filepath index failed: %s\n", err_msg);
+        sqlite3_free(err_msg);
+    }
+}
 
-    printf("[DB] Seeding initial data...\n");
+// [내부 함수] 스캐너 전용 쓰기 연결 (g_writer_mutex 보유 상태에서 호출)
+static sqlite3* get_writer_db(void) {
+    if (g_writer_db) return g_writer_db;
 
-    const char *vid1_phys = "./videos/test.mp4";
-    const char *thumb1_phys = "./static/thumb1.jpg";
-    
-    const char *vid2_phys = "./videos/test2.mp4";
-    const char *thumb2_phys = "./static/thumb2.jpg";
+    if (sqlite3_open(g_db_path, &g_writer_db) != SQLITE_OK) {
+        fprintf(stderr, "[DB] Cannot open writer connection: %s\n", sqlite3_errmsg(g_writer_db));
+        sqlite3_close(g_writer_db);
+        g_writer_db = NULL;
+        return NULL;
+    }
+    sqlite3_exec(g_writer_db, "PRAGMA synchronous=NORMAL;", 0, 0, 0);
+    sqlite3_busy_timeout(g_writer_db, 5000);
+    return g_writer_db;
+}
 
-    generate_thumbnail_ffmpeg(vid1_phys, thumb1_phys);
-    generate_thumbnail_ffmpeg(vid2_phys, thumb2_phys);
+// [내부 함수] 읽기 전용 연결 pool_size개 생성
+static int open_reader_pool(int pool_size) {
+    if (pool_size <= 0) return 0;
+
+    g_readers = (DbConn **)calloc((size_t)pool_size, sizeof(DbConn *));
+    if (!g_readers) return -1;
+
+    int flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX;
+    for (int i = 0; i < pool_size; i++) {
+        DbConn *conn = (DbConn *)calloc(1, sizeof(DbConn));
+        if (!conn) break;
+        if (sqlite3_open_v2(g_db_path, &conn->db, flags, NULL) != SQLITE_OK) {
+            fprintf(stderr, "[DB] Cannot open read connection: %s\n", sqlite3_errmsg(conn->db));
+            sqlite3_close(conn->db);
+            free(conn);
+            break;
+        }
+        sqlite3_busy_timeout(conn->db, 5000);
+        g_readers[g_reader_count++] = conn;
+    }
+    g_reader_free = g_reader_count;
 
-    // B. 더미 데이터 삽입
-    // 주의: filepath는 route_request 로직에 맞춰 '/test.mp4' 등으로 설정해야 함
-    const char *sql_insert = 
-        "INSERT INTO videos (title, filepath, thumbnail) VALUES "
-        "('Test Video', '/videos/test.mp4', '/thumb1.jpg'), "
-        "('Iron Man', '/videos/test2.mp4', '/thumb2.jpg');";
+    printf("[DB] Read pool: %d read-only connections.\n", g_reader_count);
+    return g_reader_count > 0 ? 0 : -1;
+}
 
-    char *err_msg = 0;
-    rc = sqlite3_exec(g_db, sql_insert, 0, 0, &err_msg);
+// [내부 함수] 읽기 연결을 하나 빌림 (모두 사용 중이면 반납될 때까지 대기, 풀이 없으면 g_db)
+static DbConn* acquire_reader(void) {
+    if (g_reader_count == 0) return acquire_main();
 
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "[DB] SQL error (Insert): %s\n", err_msg);
-        sqlite3_free(err_msg);
-        return -1;
+    pthread_mutex_lock(&g_reader_mutex);
+    while (g_reader_free == 0 && g_readers) {
+        pthread_cond_wait(&g_reader_cond, &g_reader_mutex);
     }
-
-    printf("[DB] Seed data inserted.\n");
-    return 0;
+    DbConn *conn = g_readers ? g_readers[--g_reader_free] : NULL;
+    pthread_mutex_unlock(&g_reader_mutex);
+    return conn ? conn : acquire_main();
 }
 
-void handle_api_video_list(ClientContext *ctx) {
-    // 1. 세션에서 user_id 추출 (이미 http_handler에서 검증했으므로 있다고 가정)
-    // 만약 세션이 없으면 user_id = 0 (이력 없음)으로 처리
-    int user_id = 0;
-    if (strlen(ctx->session_id) > 0) {
-        user_id = session_get_user(ctx->session_id);
-        if (user_id < 0) user_id = 0;
+static void release_reader(DbConn *conn) {
+    if (conn == &g_main_conn) {
+        release_main(conn);
+        return;
     }
 
-    // 2. JSON 생성 (Join 쿼리 실행)
-    char *json_body = db_get_video_list_json(user_id);
-    if (!json_body) {
-        send_error_response(ctx, 500);
-        return;
+    pthread_mutex_lock(&g_reader_mutex);
+    if (g_readers) {
+        g_readers[g_reader_free++] = conn;
+        pthread_cond_signal(&g_reader_cond);
+    } else {
+        close_conn(conn); // cleanup 이후 반납
+        free(conn);
     }
+    pthread_mutex_unlock(&g_reader_mutex);
+}
 
-    // 3. 전송
-    size_t body_len = strlen(json_body);
-    int header_len = snprintf(ctx->buffer, sizeof(ctx->buffer),
-        "HTTP/1.1 200 OK\r\n"
-        "Content-Type: application/json; charset=utf-8\r\n"
-        "Content-Length: %zu\r\n"
-        "Connection: keep-alive\r\n"
-        "\r\n", body_len
-    );
+// [내부 함수] 쓰기 연결(g_db)의 문장 캐시를 독점 (쓰기는 어차피 SQLite 안에서 직렬화됨)
+static DbConn* acquire_main(void) {
+    pthread_mutex_lock(&g_main_mutex);
+    return &g_main_conn;
+}
 
-    // =========================================================
-    // [수정] 안전한 전송 로직 (Partial Send 방지)
-    // =========================================================
-    
-    // 1. 헤더 전송 (Blocking Loop)
-    if (send_all_blocking(ctx->client_fd, ctx->buffer, header_len) < 0) {
-        perror("[API] Failed to send header");
-        free(json_body);
-        // 이미 망가졌으므로 연결 종료 처리
-        close(ctx->client_fd);
-        free(ctx);
-        return;
-    }
+static void release_main(DbConn *conn) {
+    (void)conn;
+    pthread_mutex_unlock(&g_main_mutex);
+}
 
-    // 2. 바디 전송 (Blocking Loop)
-    if (send_all_blocking(ctx->client_fd, json_body, body_len) < 0) {
-        perror("[API] Failed to send JSON body");
-        // 로그만 남기고 자원 정리는 아래에서
-    } else {
-        printf("[API] Sent video list (%zu bytes)\n", body_len);
+// [내부 함수] 준비된 문장 반환 (첫 사용 시에만 prepare, 실패 시 NULL)
+static sqlite3_stmt* get_stmt(DbConn *conn, QueryId id) {
+    if (!conn->db) return NULL;
+    if (!conn->stmts[id]) {
+        // PERSISTENT: 오래 재사용할 문장임을 알려 lookaside 대신 힙에 할당
+        if (sqlite3_prepare_v3(conn->db, QUERY_SQL[id], -1, SQLITE_PREPARE_PERSISTENT,
+                               &conn->stmts[id], NULL) != SQLITE_OK) {
+            fprintf(stderr, "[DB] Prepare failed (query %d): %s\n", id, sqlite3_errmsg(conn->db));
+            conn->stmts[id] = NULL;
+            return NULL;
+        }
     }
+    conn->active = id;
+    conn->started_ns = metrics_now_ns();
+    return conn->stmts[id];
+}
 
-    free(json_body);
+// [내부 함수] 다음 사용을 위해 문장을 되돌림 (읽기 트랜잭션/바인딩한 문자열 해제)
+// 쿼리 지연은 바인딩부터 reset까지 (연결을 기다린 시간은 제외)
+static void put_stmt(DbConn *conn, sqlite3_stmt *stmt) {
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    metrics_observe_since((MetricHistogram)(H_DB_USER_PASSWORD + conn->active), conn->started_ns);
+}
 
-    // 다음 요청 대기 (Rearm)
-    // 전송 실패했어도 여기서 EPOLLIN 걸면(소켓 살아있다면) 복구 시도 가능하나,
-    // 보통은 send 실패 시 close 하는 게 맞음. 여기서는 성공 가정하에 진행.
-    ctx->state = STATE_REQ_RECEIVING;
-    ctx->buffer_len = 0;
-    
-    if (reactor_update_event(ctx->epoll_fd, ctx->client_fd, EPOLLIN | EPOLLONESHOT, ctx) < 0) {
-         close(ctx->client_fd);
-         free(ctx);
+static void close_conn(DbConn *conn) {
+    for (int i = 0; i < Q_COUNT; i++) {
+        sqlite3_finalize(conn->stmts[i]);
+        conn->stmts[i] = NULL;
     }
+    sqlite3_close(conn->db);
+    conn->db = NULL;
 }
 
-int db_verify_user(const char *username, const char *password) {
+int db_get_user_password(const char *username, int *out_user_id, char *out_hash, size_t out_len) {
     if (!g_db) return -2;
 
-    sqlite3_stmt *stmt;
-    // SQL Injection 방지를 위한 바인딩 쿼리
-    const char *sql = "SELECT id FROM users WHERE username = ? AND password = ?;";
-    
-    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, 0) != SQLITE_OK) {
+    // SQL Injection 방지를 위한 바인딩 쿼리 (연결별 캐시된 문장)
+    DbConn *conn = acquire_reader();
+    sqlite3_stmt *stmt = get_stmt(conn, Q_USER_PASSWORD);
+    if (!stmt) {
+        release_reader(conn);
         return -2;
     }
 
     // 파라미터 바인딩
     sqlite3_bind_text(stmt, 1, username, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, password, -1, SQLITE_STATIC);
 
-    int user_id = -1;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        user_id = sqlite3_column_int(stmt, 0);
+    int result = -1;
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        const char *stored = (const char *)sqlite3_column_text(stmt, 1);
+        *out_user_id = sqlite3_column_int(stmt, 0);
+        snprintf(out_hash, out_len, "%s", stored ? stored : "");
+        result = 0;
+    } else if (rc != SQLITE_DONE) {
+        result = -2;
     }
 
-    sqlite3_finalize(stmt);
-    return user_id;
+    put_stmt(conn, stmt);
+    release_reader(conn);
+    return result;
+}
+
+int db_update_password(int user_id, const char *password_hash) {
+    if (!g_db) return -1;
+
+    DbConn *conn = acquire_main();
+    sqlite3_stmt *stmt = get_stmt(conn, Q_UPDATE_PASSWORD);
+    if (!stmt) {
+        release_main(conn);
+        return -1;
+    }
+
+    sqlite3_bind_text(stmt, 1, password_hash, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, user_id);
+
+    int rc = sqlite3_step(stmt);
+    put_stmt(conn, stmt);
+    release_main(conn);
+    return (rc == SQLITE_DONE) ? 0 : -1;
 }
 
 // 시청 이력 저장 (Upsert)
@@ -249,88 +392,87 @@ int db_update_history(int user_id, int video_id, int timestamp) {
     if (!g_db) return -1;
     
     // SQLite의 INSERT OR REPLACE 문법 사용
-    const char *sql = "INSERT OR REPLACE INTO watch_history (user_id, video_id, last_pos, updated_at) VALUES (?, ?, ?, CURRENT_TIMESTAMP);";
-    
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, 0) != SQLITE_OK) return -1;
+    DbConn *conn = acquire_main();
+    sqlite3_stmt *stmt = get_stmt(conn, Q_UPDATE_HISTORY);
+    if (!stmt) {
+        release_main(conn);
+        return -1;
+    }
     
     sqlite3_bind_int(stmt, 1, user_id);
     sqlite3_bind_int(stmt, 2, video_id);
     sqlite3_bind_int(stmt, 3, timestamp);
     
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    put_stmt(conn, stmt);
+    release_main(conn);
     
     return (rc == SQLITE_DONE) ? 0 : -1;
 }
 
-// 비디오 목록 + 시청 이력 조회 (기존 handle_api_video_list 대체용 헬퍼)
-char* db_get_video_list_json(int user_id) {
-    if (!g_db) return NULL;
+// 사용자의 이어보기 위치 (기본 키 (user_id, video_id) 범위 조회라 비디오 수와 무관)
+int db_for_each_user_position(int user_id, void (*callback)(int video_id, int last_pos, void *arg),
+                              void *arg) {
+    if (!g_db || !callback) return -1;
 
-    // LEFT JOIN을 사용하여 시청 기록이 없으면 last_pos가 NULL(0 처리)이 되게 함
-    const char *sql = 
-        "SELECT v.id, v.title, v.filepath, v.thumbnail, v.duration, "
-        "COALESCE(h.last_pos, 0) as last_pos "
-        "FROM videos v "
-        "LEFT JOIN watch_history h ON v.id = h.video_id AND h.user_id = ? "
-        "ORDER BY v.id ASC;";
+    DbConn *conn = acquire_reader();
+    sqlite3_stmt *stmt = get_stmt(conn, Q_USER_POSITIONS);
+    if (!stmt) {
+        release_reader(conn);
+        return -1;
+    }
+    sqlite3_bind_int(stmt, 1, user_id);
 
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, 0) != SQLITE_OK) return NULL;
-    
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        callback(sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1), arg);
+    }
+
+    put_stmt(conn, stmt);
+    release_reader(conn);
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+int db_for_each_recent_history(int user_id, int limit,
+                               void (*callback)(int video_id, int last_pos, long long updated_at, void *arg),
+                               void *arg) {
+    if (!g_db || !callback) return -1;
+
+    DbConn *conn = acquire_reader();
+    sqlite3_stmt *stmt = get_stmt(conn, Q_RECENT_HISTORY);
+    if (!stmt) {
+        release_reader(conn);
+        return -1;
+    }
     sqlite3_bind_int(stmt, 1, user_id);
+    sqlite3_bind_int(stmt, 2, limit);
 
-    // JSON 버퍼 (충분히 크게 잡음)
-    size_t cap = 16384;
-    char *json = (char*)malloc(cap);
-    if (!json) { sqlite3_finalize(stmt); return NULL; }
-    
-    char *p = json;
-    size_t rem = cap;
-    int len = snprintf(p, rem, "[");
-    p += len; rem -= len;
-
-    int is_first = 1;
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        if (!is_first) { if (rem > 2) { *p++ = ','; rem--; } }
-        is_first = 0;
-
-        int id = sqlite3_column_int(stmt, 0);
-        const char *title = (const char*)sqlite3_column_text(stmt, 1);
-        const char *path = (const char*)sqlite3_column_text(stmt, 2);
-        const char *thumb = (const char*)sqlite3_column_text(stmt, 3);
-        int duration = sqlite3_column_int(stmt, 4);
-        int last_pos = sqlite3_column_int(stmt, 5); // [핵심] 이어보기 위치
-
-        len = snprintf(p, rem, 
-            "{\"id\":%d, \"title\":\"%s\", \"url\":\"%s\", \"thumbnail\":\"%s\", \"duration\":%d, \"last_pos\":%d}",
-            id, title?title:"", path?path:"", thumb?thumb:"", duration, last_pos);
-        
-        if (len < 0 || (size_t)len >= rem) break;
-        p += len; rem -= len;
-    }
-    if (rem > 2) strcpy(p, "]");
-    
-    sqlite3_finalize(stmt);
-    return json;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        callback(sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1), sqlite3_column_int64(stmt, 2), arg);
+    }
+
+    put_stmt(conn, stmt);
+    release_reader(conn);
+    return (rc == SQLITE_DONE) ? 0 : -1;
 }
 
-int db_create_user(const char *username, const char *password) {
+int db_create_user(const char *username, const char *password_hash) {
     if (!g_db) return -2;
 
-    sqlite3_stmt *stmt;
-    const char *sql = "INSERT INTO users (username, password) VALUES (?, ?);";
-
-    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, 0) != SQLITE_OK) {
+    DbConn *conn = acquire_main();
+    sqlite3_stmt *stmt = get_stmt(conn, Q_CREATE_USER);
+    if (!stmt) {
+        release_main(conn);
         return -2;
     }
 
     sqlite3_bind_text(stmt, 1, username, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, password, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, password_hash, -1, SQLITE_STATIC);
 
     int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    put_stmt(conn, stmt);
+    release_main(conn);
 
     if (rc == SQLITE_DONE) return 0; // 성공
     if (rc == SQLITE_CONSTRAINT) return -1; // 아이디 중복 (UNIQUE 제약조건)
@@ -338,23 +480,268 @@ int db_create_user(const char *username, const char *password) {
     return -2; // 기타 에러
 }
 
-static int generate_thumbnail_ffmpeg(const char *video_path, const char *out_thumb_path) {
-    char command[512];
-    
-    // 명령어 조합
-    snprintf(command, sizeof(command), FFMPEG_CMD_TEMPLATE, video_path, out_thumb_path);
-    
-    printf("[FFmpeg] Executing: %s\n", command);
-    
-    // 외부 명령어 실행 (Blocking)
-    int ret = system(command);
-    
-    if (ret == 0) {
-        printf("[FFmpeg] Thumbnail generated successfully: %s\n", out_thumb_path);
-        return 0;
-    } else {
-        fprintf(stderr, "[FFmpeg] Failed to generate thumbnail (code: %d)\n", ret);
-        // 썸네일 생성 실패가 서버 죽을 일은 아니므로 에러 로그만 남김
+int db_for_each_video(void (*callback)(int id, const char *filepath, const char *thumbnail, void *arg),
+                      void *arg) {
+    if (!g_db || !callback) return -1;
+
+    sqlite3_stmt *stmt;
+    const char *sql = "SELECT id, filepath, thumbnail FROM videos ORDER BY id ASC;";
+    DbConn *conn = acquire_reader();
+    if (sqlite3_prepare_v2(conn->db, sql, -1, &stmt, 0) != SQLITE_OK) {
+        release_reader(conn);
+        return -1;
+    }
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        callback(sqlite3_column_int(stmt, 0),
+                 (const char*)sqlite3_column_text(stmt, 1),
+                 (const char*)sqlite3_column_text(stmt, 2),
+                 arg);
+    }
+
+    sqlite3_finalize(stmt);
+    release_reader(conn);
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+int db_for_each_prewarm_target(int window_days, int top_n,
+                               void (*callback)(int video_id, const char *filepath, int duration,
+                                                int last_pos, void *arg),
+                               void *arg) {
+    if (!g_db || !callback || top_n <= 0) return -1;
+
+    // 최근 활동 순위 -> 비디오 정보 + 이어보기 위치
+    const char *sql =
+        "WITH ranked AS ("
+        "  SELECT video_id, COUNT(*) AS viewers, MAX(updated_at) AS latest "
+        "  FROM watch_history WHERE updated_at >= datetime('now', ?1) "
+        "  GROUP BY video_id ORDER BY viewers DESC, latest DESC LIMIT ?2) "
+        "SELECT v.id, v.filepath, v.duration, COALESCE(h.last_pos, 0) "
+        "FROM ranked r JOIN videos v ON v.id = r.video_id "
+        "LEFT JOIN watch_history h ON h.video_id = r.video_id AND h.last_pos > 0 "
+        "  AND h.updated_at >= datetime('now', ?1) "
+        "ORDER BY r.viewers DESC, r.latest DESC, v.id ASC;";
+
+    DbConn *conn = acquire_reader();
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn->db, sql, -1, &stmt, 0) != SQLITE_OK) {
+        release_reader(conn);
+        return -1;
+    }
+
+    char window[32];
+    snprintf(window, sizeof(window), "-%d days", window_days);
+    sqlite3_bind_text(stmt, 1, window, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 2, top_n);
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        callback(sqlite3_column_int(stmt, 0),
+                 (const char*)sqlite3_column_text(stmt, 1),
+                 sqlite3_column_int(stmt, 2),
+                 sqlite3_column_int(stmt, 3),
+                 arg);
+    }
+
+    sqlite3_finalize(stmt);
+    release_reader(conn);
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+int db_for_each_catalog_item(void (*callback)(int id, const char *title, const char *filepath,
+                                               const char *thumbnail, int duration, void *arg),
+                             void *arg) {
+    if (!g_db || !callback) return -1;
+
+    DbConn *conn = acquire_reader();
+    sqlite3_stmt *stmt;
+    const char *sql = "SELECT id, title, filepath, thumbnail, duration FROM videos ORDER BY id ASC;";
+    if (sqlite3_prepare_v2(conn->db, sql, -1, &stmt, 0) != SQLITE_OK) {
+        release_reader(conn);
+        return -1;
+    }
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        callback(sqlite3_column_int(stmt, 0),
+                 (const char*)sqlite3_column_text(stmt, 1),
+                 (const char*)sqlite3_column_text(stmt, 2),
+                 (const char*)sqlite3_column_text(stmt, 3),
+                 sqlite3_column_int(stmt, 4),
+                 arg);
+    }
+
+    sqlite3_finalize(stmt);
+    release_reader(conn);
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+int db_for_each_library_entry(void (*callback)(int id, const char *filepath,
+                                                long long file_size, long long file_mtime, void *arg),
+                              void *arg) {
+    if (!g_db || !callback) return -1;
+
+    sqlite3_stmt *stmt;
+    const char *sql = "SELECT id, filepath, file_size, file_mtime FROM videos;";
+    DbConn *conn = acquire_reader();
+    if (sqlite3_prepare_v2(conn->db, sql, -1, &stmt, 0) != SQLITE_OK) {
+        release_reader(conn);
+        return -1;
+    }
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        callback(sqlite3_column_int(stmt, 0),
+                 (const char*)sqlite3_column_text(stmt, 1),
+                 sqlite3_column_int64(stmt, 2),
+                 sqlite3_column_int64(stmt, 3),
+                 arg);
+    }
+
+    sqlite3_finalize(stmt);
+    release_reader(conn);
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+int db_apply_library_batch(const VideoRecord *upserts, int n_upserts,
+                           const char *const *removed, int n_removed, int *out_ids) {
+    if (n_upserts <= 0 && n_removed <= 0) return 0;
+
+    pthread_mutex_lock(&g_writer_mutex);
+    sqlite3 *db = get_writer_db();
+    if (!db) {
+        pthread_mutex_unlock(&g_writer_mutex);
         return -1;
     }
+
+    // filepath 충돌 시 기존 id를 유지한 채 메타데이터만 갱신 (시청 이력 보존)
+    const char *sql_upsert =
+        "INSERT INTO videos (title, filepath, thumbnail, duration, file_size, file_mtime) "
+        "VALUES (?, ?, ?, ?, ?, ?) "
+        "ON CONFLICT(filepath) DO UPDATE SET "
+        "title=excluded.title, thumbnail=excluded.thumbnail, duration=excluded.duration, "
+        "file_size=excluded.file_size, file_mtime=excluded.file_mtime "
+        "RETURNING id;";
+    // '/'로 끝나는 경로는 디렉토리 삭제 -> 하위 전체 삭제
+    // 시청 이력을 먼저 지운 뒤 비디오 삭제 (이어보기/프리웜 조회에 고아 행이 남지 않도록)
+    const char *sql_delete =
+        "DELETE FROM watch_history WHERE video_id IN (SELECT id FROM videos WHERE filepath = ?1);"
+        "DELETE FROM videos WHERE filepath = ?1;";
+    const char *sql_delete_prefix =
+        "DELETE FROM watch_history WHERE video_id IN "
+        "(SELECT id FROM videos WHERE substr(filepath, 1, ?1) = ?2);"
+        "DELETE FROM videos WHERE substr(filepath, 1, ?1) = ?2;";
+
+    sqlite3_stmt *up = NULL, *del_hist = NULL, *del = NULL, *del_hist_prefix = NULL, *del_prefix = NULL;
+    int result = -1;
+    long long start = metrics_now_ns();
+
+    // 전체 배치를 하나의 트랜잭션으로 (WAL fsync 1회)
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, 0) != SQLITE_OK) goto out;
+
+    // 삭제 SQL은 두 문장 (이력, 비디오)이라 tail로 이어서 prepare
+    const char *tail = NULL, *tail_prefix = NULL;
+    if (sqlite3_prepare_v2(db, sql_upsert, -1, &up, 0) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, sql_delete, -1, &del_hist, &tail) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, tail, -1, &del, 0) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, sql_delete_prefix, -1, &del_hist_prefix, &tail_prefix) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, tail_prefix, -1, &del_prefix, 0) != SQLITE_OK) {
+        goto rollback;
+    }
+
+    for (int i = 0; i < n_upserts; i++) {
+        const VideoRecord *r = &upserts[i];
+        sqlite3_bind_text(up, 1, r->title, -1, SQLITE_STATIC);
+        sqlite3_bind_text(up, 2, r->filepath, -1, SQLITE_STATIC);
+        sqlite3_bind_text(up, 3, r->thumbnail, -1, SQLITE_STATIC);
+        sqlite3_bind_int(up, 4, r->duration);
+        sqlite3_bind_int64(up, 5, r->file_size);
+        sqlite3_bind_int64(up, 6, r->file_mtime);
+
+        if (sqlite3_step(up) != SQLITE_ROW) goto rollback;
+        if (out_ids) out_ids[i] = sqlite3_column_int(up, 0);
+        sqlite3_reset(up);
+    }
+
+    for (int i = 0; i < n_removed; i++) {
+        size_t len = strlen(removed[i]);
+        int is_dir = (len > 0 && removed[i][len - 1] == '/');
+        sqlite3_stmt *pair[2] = { is_dir ? del_hist_prefix : del_hist, is_dir ? del_prefix : del };
+        for (int k = 0; k < 2; k++) {
+            sqlite3_stmt *stmt = pair[k];
+            if (is_dir) {
+                sqlite3_bind_int(stmt, 1, (int)len);
+                sqlite3_bind_text(stmt, 2, removed[i], -1, SQLITE_STATIC);
+            } else {
+                sqlite3_bind_text(stmt, 1, removed[i], -1, SQLITE_STATIC);
+            }
+            if (sqlite3_step(stmt) != SQLITE_DONE) goto rollback;
+            sqlite3_reset(stmt);
+        }
+    }
+
+    if (sqlite3_exec(db, "COMMIT;", 0, 0, 0) == SQLITE_OK) {
+        result = 0;
+        goto out;
+    }
+
+rollback:
+    fprintf(stderr, "[DB] Library batch failed: %s\n", sqlite3_errmsg(db));
+    sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+out:
+    sqlite3_finalize(up);
+    sqlite3_finalize(del_hist);
+    sqlite3_finalize(del);
+    sqlite3_finalize(del_hist_prefix);
+    sqlite3_finalize(del_prefix);
+    metrics_observe_since(H_DB_LIBRARY_BATCH, start);
+    pthread_mutex_unlock(&g_writer_mutex);
+    return result;
+}
+
+int db_apply_history_batch(const HistoryRecord *records, int count) {
+    if (count <= 0) return 0;
+
+    pthread_mutex_lock(&g_writer_mutex);
+    sqlite3 *db = get_writer_db();
+    if (!db) {
+        pthread_mutex_unlock(&g_writer_mutex);
+        return -1;
+    }
+
+    const char *sql =
+        "INSERT OR REPLACE INTO watch_history (user_id, video_id, last_pos, updated_at) "
+        "SELECT ?1, ?2, ?3, datetime(?4, 'unixepoch') WHERE EXISTS (SELECT 1 FROM videos WHERE id = ?2);";
+
+    sqlite3_stmt *stmt = NULL;
+    int result = -1;
+    long long start = metrics_now_ns();
+
+    // 배치 전체가 WAL fsync 1회
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, 0) != SQLITE_OK) goto out;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK) goto rollback;
+
+    for (int i = 0; i < count; i++) {
+        sqlite3_bind_int(stmt, 1, records[i].user_id);
+        sqlite3_bind_int(stmt, 2, records[i].video_id);
+        sqlite3_bind_int(stmt, 3, records[i].last_pos);
+        sqlite3_bind_int64(stmt, 4, records[i].updated_at);
+        if (sqlite3_step(stmt) != SQLITE_DONE) goto rollback;
+        sqlite3_reset(stmt);
+    }
+
+    if (sqlite3_exec(db, "COMMIT;", 0, 0, 0) == SQLITE_OK) {
+        result = 0;
+        goto out;
+    }
+
+rollback:
+    fprintf(stderr, "[DB] History batch failed: %s\n", sqlite3_errmsg(db));
+    sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+out:
+    sqlite3_finalize(stmt);
+    metrics_observe_since(H_DB_HISTORY_BATCH, start);
+    pthread_mutex_unlock(&g_writer_mutex);
+    return result;
 }
@@ -0,0 +1,131 @@
+// 요청 경로 쿼리 지연 벤치마크 (make bench -> build/bin/test/app/db_handler_test)
+// 사용법: db_handler_test [쿼리별 반복 수=20000] [비디오 수=500]
+// 임시 DB에 사용자/비디오/이력을 채운 뒤, 요청마다 실행되는 쿼리 4개의 호출당 지연(p50/p99)을 잽니다.
+// (로그인 확인, 이력 upsert, 사용자 위치 목록, 회원가입)
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "app/db_handler.h"
+
+#define USER_COUNT 1000
+
+typedef struct {
+    const char *name;
+    void (*run)(int i);
+} QueryBench;
+
+static int g_videos;
+
+static long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static int cmp_long(const void *a, const void *b) {
+    long x = *(const long *)a, y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+static void run_login(int i) {
+    char name[32], hash[256];
+    int user_id;
+    snprintf(name, sizeof(name), "bench%d", i % USER_COUNT);
+    db_get_user_password(name, &user_id, hash, sizeof(hash));
+}
+
+static void run_history(int i) {
+    db_update_history(i % USER_COUNT + 1, i % g_videos + 1, i);
+}
+
+static void count_position(int video_id, int last_pos, void *arg) {
+    (void)video_id;
+    (void)last_pos;
+    (*(int *)arg)++;
+}
+
+static void run_positions(int i) {
+    int n = 0;
+    db_for_each_user_position(i % USER_COUNT + 1, count_position, &n);
+}
+
+static void run_create(int i) {
+    char name[32];
+    snprintf(name, sizeof(name), "new%d", i);
+    db_create_user(name, "$bench$0$hash");
+}
+
+int main(int argc, char **argv) {
+    int iters = (argc > 1) ? atoi(argv[1]) : 20000;
+    g_videos = (argc > 2) ? atoi(argv[2]) : 500;
+    if (iters < 100 || g_videos < 1) {
+        fprintf(stderr, "usage: %s [iterations >= 100] [videos]\n", argv[0]);
+        return 1;
+    }
+
+    char dir[] = "/tmp/db_bench_XXXXXX";
+    if (!mkdtemp(dir)) return 1;
+    char path[64];
+    snprintf(path, sizeof(path), "%s/bench.db", dir);
+    if (db_init(path, 4) != 0) return 1;
+
+    // 비디오, 사용자, 사용자당 이력 몇 건
+    VideoRecord *videos = calloc((size_t)g_videos, sizeof(VideoRecord));
+    char (*paths)[32] = calloc((size_t)g_videos, sizeof(*paths));
+    if (!videos || !paths) return 1;
+    for (int i = 0; i < g_videos; i++) {
+        snprintf(paths[i], sizeof(paths[i]), "/videos/v%d.mp4", i);
+        videos[i].filepath = paths[i];
+        videos[i].title = paths[i];
+        videos[i].thumbnail = "";
+        videos[i].duration = 600;
+    }
+    if (db_apply_library_batch(videos, g_videos, NULL, 0, NULL) != 0) return 1;
+
+    for (int u = 0; u < USER_COUNT; u++) {
+        char name[32];
+        snprintf(name, sizeof(name), "bench%d", u);
+        db_create_user(name, "$bench$0$hash");
+        for (int k = 0; k < 10; k++) db_update_history(u + 1, (u * 7 + k) % g_videos + 1, 30 + k);
+    }
+
+    QueryBench benches[] = {
+        {"login (user password)", run_login},
+        {"history upsert", run_history},
+        {"user positions", run_positions},
+        {"create user", run_create},
+    };
+
+    long *lat = malloc(sizeof(long) * (size_t)iters);
+    if (!lat) return 1;
+    for (size_t b = 0; b < sizeof(benches) / sizeof(benches[0]); b++) {
+        long total = 0;
+        for (int i = 0; i < iters; i++) {
+            long t = now_ns();
+            benches[b].run(i);
+            lat[i] = now_ns() - t;
+            total += lat[i];
+        }
+        qsort(lat, (size_t)iters, sizeof(long), cmp_long);
+        printf("%-22s mean %6.1f us  p50 %6.1f us  p99 %6.1f us\n", benches[b].name,
+               total / 1000.0 / iters, lat[iters / 2] / 1000.0, lat[iters * 99 / 100] / 1000.0);
+    }
+
+    free(lat);
+    free(paths);
+    free(videos);
+    db_cleanup();
+
+    const char *suffixes[] = {"", "-wal", "-shm"};
+    for (int i = 0; i < 3; i++) {
+        char file[80];
+        snprintf(file, sizeof(file), "%s%s", path, suffixes[i]);
+        unlink(file);
+    }
+    rmdir(dir);
+    return 0;
+}
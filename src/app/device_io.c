@@ -0,0 +1,290 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+
+#include "app/device_io.h"
+#include "app/http_utils.h"
+#include "app/stream_handler.h"
+#include "core/thread_pool.h"
+#include "core/metrics.h"
+#include "core/logger.h"
+
+#define MAX_PREFIXES 64
+#define PREFIX_LEN   512
+#define QUEUE_CAPACITY 4096         // 재개 작업은 연결당 최대 1개 -> 장치당 동시 전송 연결이 이만큼 넘으면 닫음
+
+typedef struct {
+    dev_t dev;
+    char first_path[PREFIX_LEN];    // 통계 표시용
+    ThreadPool pool;
+
+    pthread_mutex_t mutex;          // 아래 카운터 보호
+    int queued;                     // 큐에서 대기 중인 작업 수
+    int running;                    // 장치 워커가 실행 중인 작업 수 (EAGAIN으로 주차하면 반납)
+    unsigned long long tasks;
+    unsigned long long rejected;    // 대기+실행 작업이 max_active 이상이라 새 요청에 503
+    unsigned long long dropped;     // 큐가 가득 차 전송 중인 연결을 닫은 수
+    double wait_sum_ms;
+    double wait_max_ms;
+    double service_sum_ms;
+    double service_max_ms;
+} Device;
+
+typedef struct {
+    char prefix[PREFIX_LEN];        // "./" 제거, 끝 '/' 제거
+    size_t len;
+    int dev_idx;
+} PathPrefix;
+
+// 내부 전역 변수 (등록은 기동 시 main 스레드에서만 수행)
+static Device g_devices[DEVICE_IO_MAX_DEVICES];
+static int g_device_count = 0;
+static PathPrefix g_prefixes[MAX_PREFIXES];
+static int g_prefix_count = 0;
+static int g_threads_per_device = 2;
+static int g_max_active = 64;
+static bool g_initialized = false;
+
+// 내부 헬퍼 함수
+static const char* normalize_path(const char *path);
+static int find_device(const char *path);
+static void device_task(void *arg);
+static void close_response(ClientContext *ctx);
+static long long now_ns(void);
+
+int device_io_init(int threads_per_device, int max_active_per_device) {
+    g_threads_per_device = (threads_per_device > 0) ? threads_per_device : 1;
+    g_max_active = (max_active_per_device > 0) ? max_active_per_device : 1;
+    g_device_count = 0;
+    g_prefix_count = 0;
+    g_initialized = true;
+    return 0;
+}
+
+int device_io_register_path(const char *path) {
+    if (!g_initialized || !path) return -1;
+
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "[DevIO] Cannot stat %s, requests will run on generic workers.\n", path);
+        return -1;
+    }
+
+    int idx = -1;
+    for (int i = 0; i < g_device_count; i++) {
+        if (g_devices[i].dev == st.st_dev) {
+            idx = i;
+            break;
+        }
+    }
+
+    if (idx < 0) {
+        if (g_device_count == DEVICE_IO_MAX_DEVICES) {
+            fprintf(stderr, "[DevIO] Too many devices (max %d). Ignoring: %s\n",
+                    DEVICE_IO_MAX_DEVICES, path);
+            return -1;
+        }
+
+        Device *d = &g_devices[g_device_count];
+        memset(d, 0, sizeof(*d));
+        d->dev = st.st_dev;
+        snprintf(d->first_path, sizeof(d->first_path), "%s", path);
+        pthread_mutex_init(&d->mutex, NULL);
+
+        if (thread_pool_init(&d->pool, g_threads_per_device, QUEUE_CAPACITY) != 0) {
+            fprintf(stderr, "[DevIO] Failed to create pool for %s\n", path);
+            pthread_mutex_destroy(&d->mutex);
+            return -1;
+        }
+        idx = g_device_count++;
+        printf("[DevIO] Device %u:%u (%s): %d threads, 503 above %d queued/running tasks\n",
+               major(st.st_dev), minor(st.st_dev), path, g_threads_per_device, g_max_active);
+    }
+
+    if (g_prefix_count < MAX_PREFIXES) {
+        PathPrefix *p = &g_prefixes[g_prefix_count];
+        snprintf(p->prefix, sizeof(p->prefix), "%s", normalize_path(path));
+        p->len = strlen(p->prefix);
+        while (p->len > 1 && p->prefix[p->len - 1] == '/') p->prefix[--p->len] = '\0';
+        p->dev_idx = idx;
+        g_prefix_count++;
+    }
+    return idx;
+}
+
+void device_io_dispatch(ClientContext *ctx, DeviceIoHandler handler, bool bulk) {
+    ctx->io_handler = handler;
+    ctx->io_dev = -1;
+
+    int idx = g_initialized ? find_device(ctx->request_path) : -1;
+    if (idx < 0) {
+        handler(ctx);
+        return;
+    }
+
+    // 짧은 Range(탐색, 메타데이터 probe)는 대용량으로 보지 않음
+    if (bulk && ctx->range_end >= 0 && ctx->range_end - ctx->range_start < DEVICE_IO_SMALL_BYTES) bulk = false;
+
+    // 디스크가 밀려 있을 때만 거절 (소켓을 기다리는 시청자는 세지 않음)
+    Device *d = &g_devices[idx];
+    pthread_mutex_lock(&d->mutex);
+    if (bulk && d->queued + d->running >= g_max_active) {
+        d->rejected++;
+        pthread_mutex_unlock(&d->mutex);
+        ctx->io_handler = NULL;
+        LOG_WARN("DevIO", "Device %s saturated, rejecting %s", d->first_path, ctx->request_path);
+        send_error_response(ctx, ERR_SERVICE_UNAVAILABLE);
+        return;
+    }
+    pthread_mutex_unlock(&d->mutex);
+
+    ctx->io_dev = idx;
+    device_io_resume(ctx);
+}
+
+void device_io_resume(ClientContext *ctx) {
+    if (ctx->io_dev < 0) {
+        if (ctx->io_handler) ctx->io_handler(ctx);
+        return;
+    }
+
+    Device *d = &g_devices[ctx->io_dev];
+    ctx->io_enqueued_ns = now_ns();
+
+    pthread_mutex_lock(&d->mutex);
+    d->queued++;
+    pthread_mutex_unlock(&d->mutex);
+
+    if (thread_pool_submit(&d->pool, device_task, ctx) != 0) {
+        // 범용 워커에서 대신 처리하면 장치 상한을 벗어나므로, 응답을 끝냄
+        pthread_mutex_lock(&d->mutex);
+        d->queued--;
+        d->dropped++;
+        pthread_mutex_unlock(&d->mutex);
+        LOG_WARN("DevIO", "Queue for %s is full, closing %s", d->first_path, ctx->client_ip);
+        if (ctx->state == STATE_REQ_RECEIVING || ctx->state == STATE_PROCESSING) {
+            device_io_release(ctx);
+            send_error_response(ctx, ERR_SERVICE_UNAVAILABLE); // 아직 아무것도 보내지 않음
+        } else {
+            close_response(ctx);
+        }
+    }
+}
+
+void device_io_release(ClientContext *ctx) {
+    ctx->io_dev = -1;
+    ctx->io_handler = NULL;
+}
+
+int device_io_stats_json(char *buf, size_t cap) {
+    size_t len = 0;
+    len += snprintf(buf + len, cap - len, "[");
+
+    for (int i = 0; i < g_device_count && len < cap; i++) {
+        Device *d = &g_devices[i];
+        pthread_mutex_lock(&d->mutex);
+        double wait_avg = d->tasks ? d->wait_sum_ms / d->tasks : 0.0;
+        double service_avg = d->tasks ? d->service_sum_ms / d->tasks : 0.0;
+        len += snprintf(buf + len, cap - len,
+            "%s{\"dev\":\"%u:%u\", \"path\":\"%s\", \"threads\":%d, \"running\":%d, "
+            "\"queue_depth\":%d, \"tasks\":%llu, \"rejected\":%llu, \"dropped\":%llu, "
+            "\"wait_avg_ms\":%.3f, \"wait_max_ms\":%.3f, "
+            "\"service_avg_ms\":%.3f, \"service_max_ms\":%.3f}",
+            i ? ", " : "", major(d->dev), minor(d->dev), d->first_path,
+            g_threads_per_device, d->running, d->queued, d->tasks, d->rejected, d->dropped,
+            wait_avg, d->wait_max_ms, service_avg, d->service_max_ms);
+        pthread_mutex_unlock(&d->mutex);
+    }
+
+    if (len < cap) len += snprintf(buf + len, cap - len, "]");
+    return (int)len;
+}
+
+void device_io_shutdown(void) {
+    for (int i = 0; i < g_device_count; i++) {
+        thread_pool_shutdown(&g_devices[i].pool);
+    }
+    for (int i = 0; i < g_device_count; i++) {
+        thread_pool_wait(&g_devices[i].pool);
+        thread_pool_cleanup(&g_devices[i].pool);
+        pthread_mutex_destroy(&g_devices[i].mutex);
+    }
+    g_device_count = 0;
+    g_prefix_count = 0;
+    g_initialized = false;
+}
+
+// =========================================================
+// 내부 헬퍼
+// =========================================================
+
+// 장치 워커에서 실행: 대기 시간/서비스 시간 측정 후 실제 핸들러 호출
+static void device_task(void *arg) {
+    ClientContext *ctx = (ClientContext *)arg;
+    Device *d = &g_devices[ctx->io_dev];
+    DeviceIoHandler handler = ctx->io_handler;
+
+    long long start = now_ns();
+    double wait_ms = (start - ctx->io_enqueued_ns) / 1e6;
+    metrics_observe(H_QUEUE_WAIT_DEVICE, start - ctx->io_enqueued_ns);
+
+    pthread_mutex_lock(&d->mutex);
+    d->queued--;
+    d->running++;
+    pthread_mutex_unlock(&d->mutex);
+
+    // 응답을 끝내거나 EAGAIN으로 EPOLLOUT을 걸고 돌아옴 (이후 ctx는 해제되었을 수 있음)
+    handler(ctx);
+
+    double service_ms = (now_ns() - start) / 1e6;
+
+    pthread_mutex_lock(&d->mutex);
+    d->running--;
+    d->tasks++;
+    d->wait_sum_ms += wait_ms;
+    d->service_sum_ms += service_ms;
+    if (wait_ms > d->wait_max_ms) d->wait_max_ms = wait_ms;
+    if (service_ms > d->service_max_ms) d->service_max_ms = service_ms;
+    pthread_mutex_unlock(&d->mutex);
+}
+
+// 전송 중인 응답을 중간에 끝냄 (헤더/본문 일부가 이미 나갔으므로 오류 응답 대신 연결을 닫음)
+static void close_response(ClientContext *ctx) {
+    stream_release_io(ctx);
+    if (ctx->file_fd > 0) close(ctx->file_fd);
+    http_close_client(ctx);
+}
+
+static const char* normalize_path(const char *path) {
+    while (path[0] == '.' && path[1] == '/') path += 2;
+    return path;
+}
+
+// 가장 긴 접두사가 일치하는 장치 (경로 구분자 경계에서만 일치로 인정)
+static int find_device(const char *path) {
+    path = normalize_path(path);
+
+    int best = -1;
+    size_t best_len = 0;
+    for (int i = 0; i < g_prefix_count; i++) {
+        PathPrefix *p = &g_prefixes[i];
+        if (p->len < best_len || strncmp(path, p->prefix, p->len) != 0) continue;
+        if (path[p->len] != '/' && path[p->len] != '\0') continue;
+        best = p->dev_idx;
+        best_len = p->len;
+    }
+    return best;
+}
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
@@ -0,0 +1,202 @@
+// 느린 시청자 테스트 (make bench -> build/bin/test/app/device_io_test)
+// 실행 중인 서버에 붙는 클라이언트입니다. (서버 오브젝트는 쓰지 않음)
+// 사용법: device_io_test <port> <video url> [느린 시청자 수=100] [user] [password]
+// 예: device_io_test 8080 /videos/test.mp4 100
+// 1. 시청자마다 bytes=0- 요청을 보내고 헤더만 읽은 뒤 멈춥니다. (일시정지한 플레이어, 소켓 버퍼가 가득 참)
+// 2. 모두 멈춘 상태에서 새 동영상 요청, 짧은 Range 요청, 정적 파일 요청이 503 없이 처리되는지 봅니다.
+// 3. 멈췄던 시청자 몇 개가 다시 읽기 시작해 본문을 끝까지 받는지 봅니다.
+// 시청자 수가 DEVICE_IO_MAX_ACTIVE(기본 64)를 넘어도 모두 206이어야 합니다.
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define RESP_HEAD_LEN   4096
+#define SLOW_RCVBUF     (16 * 1024)
+#define DRAIN_READERS   3
+
+static int g_failed = 0;
+
+#define CHECK(cond, ...)                                \
+    do {                                                \
+        if (!(cond)) {                                  \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__);                        \
+            printf("\n");                               \
+            g_failed++;                                 \
+        }                                               \
+    } while (0)
+
+typedef struct {
+    int fd;
+    int status;
+    long long content_length;
+    long long have;         // 헤더와 함께 받은 본문
+} SlowReader;
+
+static int g_port;
+static const char *g_video;
+static const char *g_user = "user1";
+static const char *g_password = "1234";
+static char g_cookie[128];
+
+static int connect_server(int rcvbuf) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    // 연결 전에 줄여야 윈도우가 작게 잡힘
+    if (rcvbuf > 0) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons((uint16_t)g_port)};
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int send_str(int fd, const char *s, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, s, len, MSG_NOSIGNAL);
+        if (n <= 0) return -1;
+        s += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// 응답 헤더까지만 읽음: 상태 코드 반환 (-1: 연결 끊김), 헤더 뒤에 함께 온 본문 길이는 have
+static int read_head(int fd, char *head, size_t head_cap, long long *content_length, long long *have) {
+    size_t used = 0;
+    char *end = NULL;
+    while (!end) {
+        if (used + 1 >= head_cap) return -1;
+        ssize_t n = recv(fd, head + used, head_cap - used - 1, 0);
+        if (n <= 0) return -1;
+        used += (size_t)n;
+        head[used] = '\0';
+        end = strstr(head, "\r\n\r\n");
+    }
+    char *cl = strstr(head, "Content-Length:");
+    *content_length = (cl && cl < end) ? atoll(cl + 15) : 0;
+    *have = (long long)(used - (size_t)(end + 4 - head));
+    *end = '\0';
+    return atoi(head + 9);
+}
+
+// 남은 본문을 끝까지 읽음 (받은 총 본문 길이 반환)
+static long long drain_body(int fd, long long have, long long content_length) {
+    char buf[65536];
+    while (have < content_length) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        have += n;
+    }
+    return have;
+}
+
+// 요청 하나를 새 연결로 보내고 본문까지 받음 (상태 코드 반환)
+static int request_once(const char *path, const char *range, long long *body_len) {
+    int fd = connect_server(0);
+    if (fd < 0) return -1;
+    char req[512];
+    int len = snprintf(req, sizeof(req),
+        "GET %s HTTP/1.1\r\nHost: test\r\nCookie: session_id=%s\r\n%s%s%s\r\n",
+        path, g_cookie, range ? "Range: bytes=" : "", range ? range : "", range ? "\r\n" : "");
+    char head[RESP_HEAD_LEN];
+    long long content_length = 0, have = 0;
+    int status = (send_str(fd, req, (size_t)len) == 0)
+        ? read_head(fd, head, sizeof(head), &content_length, &have) : -1;
+    if (status > 0) *body_len = drain_body(fd, have, content_length);
+    close(fd);
+    return status;
+}
+
+static int login(void) {
+    char req[512], body[128], head[RESP_HEAD_LEN];
+    int body_len = snprintf(body, sizeof(body), "username=%s&password=%s", g_user, g_password);
+    int len = snprintf(req, sizeof(req),
+        "POST /login HTTP/1.1\r\nHost: test\r\n"
+        "Content-Type: application/x-www-form-urlencoded\r\n"
+        "Content-Length: %d\r\n\r\n%s", body_len, body);
+
+    int fd = connect_server(0);
+    if (fd < 0) return -1;
+    long long content_length, have;
+    int status = (send_str(fd, req, (size_t)len) == 0)
+        ? read_head(fd, head, sizeof(head), &content_length, &have) : -1;
+    close(fd);
+    char *c = (status == 200) ? strstr(head, "session_id=") : NULL;
+    if (!c) return -1;
+    c += strlen("session_id=");
+    size_t n = strcspn(c, ";\r\n");
+    if (n >= sizeof(g_cookie)) return -1;
+    memcpy(g_cookie, c, n);
+    g_cookie[n] = '\0';
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <port> <video url> [slow readers] [user] [password]\n", argv[0]);
+        return 1;
+    }
+    g_port = atoi(argv[1]);
+    g_video = argv[2];
+    int n_slow = (argc > 3) ? atoi(argv[3]) : 100;
+    if (argc > 4) g_user = argv[4];
+    if (argc > 5) g_password = argv[5];
+    if (n_slow < DRAIN_READERS) {
+        fprintf(stderr, "need at least %d slow readers\n", DRAIN_READERS);
+        return 1;
+    }
+    if (login() != 0) {
+        fprintf(stderr, "login as %s failed\n", g_user);
+        return 1;
+    }
+
+    // 1. 헤더만 읽고 멈춘 시청자들
+    SlowReader *readers = calloc((size_t)n_slow, sizeof(SlowReader));
+    if (!readers) return 1;
+    int ok = 0, busy = 0;
+    for (int i = 0; i < n_slow; i++) {
+        SlowReader *r = &readers[i];
+        char req[512], head[RESP_HEAD_LEN];
+        int len = snprintf(req, sizeof(req),
+            "GET %s HTTP/1.1\r\nHost: test\r\nCookie: session_id=%s\r\nRange: bytes=0-\r\n\r\n", g_video, g_cookie);
+        r->fd = connect_server(SLOW_RCVBUF);
+        r->status = (r->fd >= 0 && send_str(r->fd, req, (size_t)len) == 0)
+            ? read_head(r->fd, head, sizeof(head), &r->content_length, &r->have) : -1;
+        if (r->status == 206) ok++;
+        else if (r->status == 503) busy++;
+    }
+    CHECK(ok == n_slow, "%d of %d paused readers got 206 (%d got 503)", ok, n_slow, busy);
+
+    // 2. 모두 멈춘 상태에서 새 요청
+    long long got = 0;
+    int status = request_once(g_video, "0-", &got);
+    CHECK(status == 206, "new full stream: status %d", status);
+    status = request_once(g_video, "0-65535", &got);
+    CHECK(status == 206 && got == 65536, "short range: status %d, %lld bytes", status, got);
+    status = request_once("/", NULL, &got);
+    CHECK(status == 200 && got > 0, "static page: status %d, %lld bytes", status, got);
+
+    // 3. 멈췄던 시청자가 다시 읽으면 끝까지 받음
+    for (int i = 0; i < DRAIN_READERS; i++) {
+        SlowReader *r = &readers[i];
+        if (r->status != 206) continue;
+        long long body = drain_body(r->fd, r->have, r->content_length);
+        CHECK(body == r->content_length, "reader %d resumed: %lld of %lld bytes", i, body, r->content_length);
+    }
+
+    printf("paused readers: %d x 206, %d x 503 (of %d)\n", ok, busy, n_slow);
+    for (int i = 0; i < n_slow; i++) {
+        if (readers[i].fd >= 0) close(readers[i].fd);
+    }
+    free(readers);
+    printf("%s (%d failed)\n", g_failed ? "FAILED" : "OK", g_failed);
+    return g_failed ? 1 : 0;
+}
@@ -0,0 +1,358 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "app/history_buffer.h"
+#include "app/db_handler.h"
+
+#define STRIPE_COUNT        64      // 락 분할 수 (2의 거듭제곱)
+#define BUCKETS_PER_STRIPE  1024    // 스트라이프당 체인 버킷 수 (2의 거듭제곱)
+
+typedef struct HistEntry {
+    int user_id;
+    int video_id;
+    int last_pos;
+    bool dirty;                 // DB에 아직 쓰지 않은 값
+    long long updated_at;       // 마지막 하트비트 시각 (DB updated_at으로 기록)
+    struct HistEntry *next;
+} HistEntry;
+
+typedef struct {
+    pthread_mutex_t lock;
+    HistEntry *buckets[BUCKETS_PER_STRIPE];
+    size_t count;
+    size_t dirty;
+} Stripe;
+
+// 내부 전역 변수
+static Stripe *g_stripes = NULL;
+static int g_interval = 0;
+static size_t g_max_per_stripe = 0;
+static pthread_t g_thread;
+static bool g_started = false;
+static bool g_stop = false;
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cond = PTHREAD_COND_INITIALIZER;
+
+// 통계 (플러시 스레드 외에는 relaxed atomic으로 증가)
+static unsigned long long g_puts = 0;
+static unsigned long long g_coalesced = 0;
+static unsigned long long g_flushes = 0;
+static unsigned long long g_rows_flushed = 0;
+static unsigned long long g_write_through = 0;
+static double g_last_flush_ms = 0.0;
+
+// 내부 헬퍼 함수
+static void* flusher_thread_func(void *arg);
+static void flush_all(void);
+static void requeue(const HistoryRecord *records, int count);
+
+static inline uint32_t hash_pair(int user_id, int video_id) {
+    uint32_t h = (uint32_t)user_id * 0x9E3779B1u ^ (uint32_t)video_id * 0x85EBCA77u;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 13;
+    return h;
+}
+
+static inline Stripe* stripe_for(uint32_t h) {
+    return &g_stripes[h & (STRIPE_COUNT - 1)];
+}
+
+static inline HistEntry** bucket_for(Stripe *stripe, uint32_t h) {
+    return &stripe->buckets[(h >> 6) & (BUCKETS_PER_STRIPE - 1)];
+}
+
+// 스트라이프 락을 잡은 상태에서 호출
+static HistEntry* find_entry(Stripe *stripe, uint32_t h, int user_id, int video_id) {
+    for (HistEntry *e = *bucket_for(stripe, h); e; e = e->next) {
+        if (e->user_id == user_id && e->video_id == video_id) return e;
+    }
+    return NULL;
+}
+
+int history_buffer_init(int flush_interval_sec, int max_entries) {
+    if (flush_interval_sec <= 0) {
+        printf("[History] Write-behind disabled (every heartbeat is written immediately).\n");
+        return -1;
+    }
+
+    g_stripes = (Stripe *)calloc(STRIPE_COUNT, sizeof(Stripe));
+    if (!g_stripes) return -1;
+    for (int i = 0; i < STRIPE_COUNT; i++) {
+        pthread_mutex_init(&g_stripes[i].lock, NULL);
+    }
+
+    g_interval = flush_interval_sec;
+    g_max_per_stripe = (max_entries > 0) ? ((size_t)max_entries + STRIPE_COUNT - 1) / STRIPE_COUNT : 0;
+    g_stop = false;
+
+    if (pthread_create(&g_thread, NULL, flusher_thread_func, NULL) != 0) {
+        perror("[History] Failed to create flusher thread");
+        free(g_stripes);
+        g_stripes = NULL;
+        return -1;
+    }
+    g_started = true;
+
+    printf("[History] Write-behind enabled (flush every %ds, max %d entries).\n",
+           flush_interval_sec, max_entries);
+    return 0;
+}
+
+int history_buffer_put(int user_id, int video_id, int last_pos) {
+    if (!g_stripes) return db_update_history(user_id, video_id, last_pos);
+
+    __atomic_fetch_add(&g_puts, 1, __ATOMIC_RELAXED);
+    uint32_t h = hash_pair(user_id, video_id);
+    Stripe *stripe = stripe_for(h);
+    long long now = (long long)time(NULL);
+
+    pthread_mutex_lock(&stripe->lock);
+
+    HistEntry *e = find_entry(stripe, h, user_id, video_id);
+    if (e) {
+        // 같은 시청자의 다음 하트비트 -> 위치만 덮어씀 (DB 쓰기 1회로 합쳐짐)
+        if (e->dirty) __atomic_fetch_add(&g_coalesced, 1, __ATOMIC_RELAXED);
+        else stripe->dirty++;
+        e->last_pos = last_pos;
+        e->updated_at = now;
+        e->dirty = true;
+        pthread_mutex_unlock(&stripe->lock);
+        return 0;
+    }
+
+    if (g_max_per_stripe && stripe->count >= g_max_per_stripe) {
+        pthread_mutex_unlock(&stripe->lock);
+        __atomic_fetch_add(&g_write_through, 1, __ATOMIC_RELAXED);
+        return db_update_history(user_id, video_id, last_pos);
+    }
+
+    e = (HistEntry *)malloc(sizeof(HistEntry));
+    if (!e) {
+        pthread_mutex_unlock(&stripe->lock);
+        return db_update_history(user_id, video_id, last_pos);
+    }
+    e->user_id = user_id;
+    e->video_id = video_id;
+    e->last_pos = last_pos;
+    e->updated_at = now;
+    e->dirty = true;
+
+    HistEntry **bucket = bucket_for(stripe, h);
+    e->next = *bucket;
+    *bucket = e;
+    stripe->count++;
+    stripe->dirty++;
+
+    pthread_mutex_unlock(&stripe->lock);
+    return 0;
+}
+
+int history_buffer_get(int user_id, int video_id, int *out_pos) {
+    if (!g_stripes) return 0;
+
+    uint32_t h = hash_pair(user_id, video_id);
+    Stripe *stripe = stripe_for(h);
+    int found = 0;
+
+    pthread_mutex_lock(&stripe->lock);
+    HistEntry *e = find_entry(stripe, h, user_id, video_id);
+    if (e) {
+        *out_pos = e->last_pos;
+        found = 1;
+    }
+    pthread_mutex_unlock(&stripe->lock);
+    return found;
+}
+
+int history_buffer_for_each_user(int user_id,
+                                 void (*callback)(int video_id, int last_pos, long long updated_at, void *arg),
+                                 void *arg) {
+    if (!g_stripes) return 0;
+
+    int visited = 0;
+    for (int i = 0; i < STRIPE_COUNT; i++) {
+        Stripe *stripe = &g_stripes[i];
+        pthread_mutex_lock(&stripe->lock);
+        for (int b = 0; b < BUCKETS_PER_STRIPE && stripe->count > 0; b++) {
+            for (HistEntry *e = stripe->buckets[b]; e; e = e->next) {
+                if (e->user_id != user_id) continue;
+                callback(e->video_id, e->last_pos, e->updated_at, arg);
+                visited++;
+            }
+        }
+        pthread_mutex_unlock(&stripe->lock);
+    }
+    return visited;
+}
+
+void history_buffer_get_stats(HistoryBufferStats *out) {
+    memset(out, 0, sizeof(*out));
+    if (!g_stripes) return;
+
+    for (int i = 0; i < STRIPE_COUNT; i++) {
+        Stripe *stripe = &g_stripes[i];
+        pthread_mutex_lock(&stripe->lock);
+        out->buffered += stripe->count;
+        out->dirty += stripe->dirty;
+        pthread_mutex_unlock(&stripe->lock);
+    }
+    out->puts = __atomic_load_n(&g_puts, __ATOMIC_RELAXED);
+    out->coalesced = __atomic_load_n(&g_coalesced, __ATOMIC_RELAXED);
+    out->write_through = __atomic_load_n(&g_write_through, __ATOMIC_RELAXED);
+
+    pthread_mutex_lock(&g_mutex);
+    out->flushes = g_flushes;
+    out->rows_flushed = g_rows_flushed;
+    out->last_flush_ms = g_last_flush_ms;
+    pthread_mutex_unlock(&g_mutex);
+}
+
+void history_buffer_shutdown(void) {
+    if (!g_started) return;
+
+    pthread_mutex_lock(&g_mutex);
+    g_stop = true;
+    pthread_cond_signal(&g_cond);
+    pthread_mutex_unlock(&g_mutex);
+
+    pthread_join(g_thread, NULL);
+    g_started = false;
+
+    // 마지막 배치 (플러시 스레드가 멈춘 뒤라 경쟁 없음)
+    flush_all();
+
+    for (int i = 0; i < STRIPE_COUNT; i++) {
+        Stripe *stripe = &g_stripes[i];
+        if (stripe->dirty) {
+            fprintf(stderr, "[History] %zu positions could not be written.\n", stripe->dirty);
+        }
+        for (int b = 0; b < BUCKETS_PER_STRIPE; b++) {
+            HistEntry *e = stripe->buckets[b];
+            while (e) {
+                HistEntry *next = e->next;
+                free(e);
+                e = next;
+            }
+        }
+        pthread_mutex_destroy(&stripe->lock);
+    }
+    free(g_stripes);
+    g_stripes = NULL;
+
+    printf("[History] Write-behind buffer flushed and freed.\n");
+}
+
+// =========================================================
+// 내부 헬퍼
+// =========================================================
+
+static void* flusher_thread_func(void *arg) {
+    (void)arg;
+
+    while (1) {
+        pthread_mutex_lock(&g_mutex);
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_sec += g_interval;
+        while (!g_stop) {
+            if (pthread_cond_timedwait(&g_cond, &g_mutex, &until) != 0) break; // 타임아웃
+        }
+        bool stop = g_stop;
+        pthread_mutex_unlock(&g_mutex);
+        if (stop) break;
+
+        flush_all();
+    }
+    return NULL;
+}
+
+// 스트라이프마다 락을 잠깐 잡고 변경분을 복사한 뒤, DB 쓰기는 락 밖에서 한 트랜잭션으로
+static void flush_all(void) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    size_t cap = 0, count = 0;
+    HistoryRecord *records = NULL;
+
+    for (int i = 0; i < STRIPE_COUNT; i++) {
+        Stripe *stripe = &g_stripes[i];
+        pthread_mutex_lock(&stripe->lock);
+
+        if (count + stripe->dirty > cap) {
+            size_t new_cap = cap ? cap : 256;
+            while (count + stripe->dirty > new_cap) new_cap *= 2;
+            HistoryRecord *grown = (HistoryRecord *)realloc(records, new_cap * sizeof(HistoryRecord));
+            if (!grown) {
+                pthread_mutex_unlock(&stripe->lock);
+                break; // 남은 스트라이프는 다음 주기에
+            }
+            records = grown;
+            cap = new_cap;
+        }
+
+        for (int b = 0; b < BUCKETS_PER_STRIPE; b++) {
+            HistEntry **link = &stripe->buckets[b];
+            while (*link) {
+                HistEntry *e = *link;
+                if (!e->dirty) {
+                    // 지난 주기에 이미 커밋된 값 -> 이제 DB가 최신이므로 버퍼에서 제거
+                    *link = e->next;
+                    free(e);
+                    stripe->count--;
+                    continue;
+                }
+                HistoryRecord *r = &records[count++];
+                r->user_id = e->user_id;
+                r->video_id = e->video_id;
+                r->last_pos = e->last_pos;
+                r->updated_at = e->updated_at;
+                e->dirty = false; // 커밋 전까지는 버퍼에 남아 조회에 사용됨
+                link = &e->next;
+            }
+        }
+        stripe->dirty = 0;
+
+        pthread_mutex_unlock(&stripe->lock);
+    }
+
+    if (count > 0) {
+        if (db_apply_history_batch(records, (int)count) != 0) {
+            fprintf(stderr, "[History] Batch of %zu positions failed, retrying next cycle.\n", count);
+            requeue(records, (int)count);
+            count = 0;
+        }
+    }
+    free(records);
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (count > 0) {
+        pthread_mutex_lock(&g_mutex);
+        g_flushes++;
+        g_rows_flushed += count;
+        g_last_flush_ms = (t1.tv_sec - t0.tv_sec) * 1000.0 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+        pthread_mutex_unlock(&g_mutex);
+    }
+}
+
+// 실패한 배치를 다시 변경 상태로 (그사이 새 하트비트가 왔다면 이미 dirty)
+static void requeue(const HistoryRecord *records, int count) {
+    for (int i = 0; i < count; i++) {
+        uint32_t h = hash_pair(records[i].user_id, records[i].video_id);
+        Stripe *stripe = stripe_for(h);
+
+        pthread_mutex_lock(&stripe->lock);
+        HistEntry *e = find_entry(stripe, h, records[i].user_id, records[i].video_id);
+        if (e && !e->dirty) {
+            e->dirty = true;
+            stripe->dirty++;
+        }
+        pthread_mutex_unlock(&stripe->lock);
+    }
+}
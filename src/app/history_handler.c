@@ -7,7 +7,8 @@
 
 #include "app/history_handler.h"
 #include "app/http_utils.h"    // 파싱 및 전송 유틸리티
-#include "app/db_handler.h"    // DB 업데이트
+#include "app/history_buffer.h" // 쓰기 지연 버퍼 (주기적으로 DB에 일괄 반영)
+#include "app/continue_watching.h" // 이어보기 목록 캐시 갱신
 #include "app/session_manager.h" // 세션 검증
 #include "core/reactor.h"
 
@@ -54,10 +55,10 @@ void handle_api_history(ClientContext *ctx) {
     int video_id = atoi(vid_str);
     int timestamp = atoi(time_str);
 
-    // 3. DB 업데이트 (Write-Back)
-    // 여기서 DB를 호출합니다.
-    if (db_update_history(user_id, video_id, timestamp) == 0) {
-        // 성공
+    // 3. 버퍼에 최신 위치만 기록 (Write-Back, 플러시 스레드가 한 트랜잭션으로 DB에 반영)
+    if (history_buffer_put(user_id, video_id, timestamp) == 0) {
+        // 성공 (캐시된 이어보기 목록도 맨 앞으로 갱신)
+        continue_watching_on_write(user_id, video_id, timestamp);
         int len = snprintf(ctx->buffer, sizeof(ctx->buffer),
             "HTTP/1.1 200 OK\r\n"
             "Content-Type: application/json\r\n"
@@ -0,0 +1,175 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+#include <openssl/hmac.h>
+#include <openssl/evp.h>
+#include <openssl/crypto.h>
+
+#include "app/hmac_keyring.h"
+
+#define MAX_KEYS        256
+#define MAX_KEY_BYTES   64
+#define MIN_KEY_BYTES   16
+
+typedef struct {
+    int present;
+    uint8_t key[MAX_KEY_BYTES];
+    size_t len;
+} SigningKey;
+
+// 내부 전역 변수 (init 이후 읽기 전용)
+static SigningKey g_keys[MAX_KEYS];
+static int g_active_kid = -1;
+
+static const char B64URL[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// 내부 헬퍼 함수
+static int load_key_file(const char *path);
+static int parse_hex(const char *hex, uint8_t *out, size_t cap, size_t *out_len);
+
+int hmac_keyring_init(const char *key_file) {
+    memset(g_keys, 0, sizeof(g_keys));
+    g_active_kid = -1;
+
+    if (key_file && key_file[0]) {
+        if (load_key_file(key_file) != 0) return -1;
+        printf("[Keyring] Loaded signing keys from %s (active kid=%d).\n", key_file, g_active_kid);
+        return 0;
+    }
+
+    // 키 파일이 없으면 프로세스 수명 동안만 유효한 키 생성
+    SigningKey *k = &g_keys[0];
+    if (getrandom(k->key, 32, 0) != 32) {
+        perror("[Keyring] getrandom failed");
+        return -1;
+    }
+    k->len = 32;
+    k->present = 1;
+    g_active_kid = 0;
+    printf("[Keyring] No SESSION_KEY_FILE, using an ephemeral key (signatures die on restart).\n");
+    return 0;
+}
+
+int hmac_keyring_active_kid(void) {
+    return g_active_kid;
+}
+
+int hmac_keyring_sign(int kid, const void *data, size_t len, uint8_t *mac) {
+    if (kid < 0 || kid >= MAX_KEYS || !g_keys[kid].present) return -1;
+
+    uint8_t full[EVP_MAX_MD_SIZE];
+    unsigned int full_len = 0;
+    if (!HMAC(EVP_sha256(), g_keys[kid].key, (int)g_keys[kid].len,
+              (const unsigned char *)data, len, full, &full_len)) {
+        return -1;
+    }
+    memcpy(mac, full, HMAC_KEYRING_MAC_LEN);
+    return 0;
+}
+
+int hmac_keyring_verify(int kid, const void *data, size_t len, const uint8_t *mac) {
+    uint8_t expected[HMAC_KEYRING_MAC_LEN];
+    if (hmac_keyring_sign(kid, data, len, expected) != 0) return -1;
+    return CRYPTO_memcmp(expected, mac, HMAC_KEYRING_MAC_LEN) == 0 ? 0 : -1;
+}
+
+void b64url_encode(const uint8_t *in, size_t len, char *out) {
+    size_t o = 0;
+    uint32_t acc = 0;
+    int bits = 0;
+    for (size_t i = 0; i < len; i++) {
+        acc = (acc << 8) | in[i];
+        bits += 8;
+        while (bits >= 6) {
+            bits -= 6;
+            out[o++] = B64URL[(acc >> bits) & 0x3F];
+        }
+    }
+    if (bits > 0) out[o++] = B64URL[(acc << (6 - bits)) & 0x3F];
+    out[o] = '\0';
+}
+
+int b64url_decode(const char *in, size_t in_len, uint8_t *out, size_t out_len) {
+    size_t o = 0;
+    uint32_t acc = 0;
+    int bits = 0;
+    for (size_t i = 0; i < in_len; i++) {
+        if (in[i] == '\0') return -1;
+        const char *pos = memchr(B64URL, in[i], sizeof(B64URL) - 1);
+        if (!pos) return -1;
+        acc = (acc << 6) | (uint32_t)(pos - B64URL);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            if (o == out_len) return -1;
+            out[o++] = (uint8_t)(acc >> bits);
+        }
+    }
+    return (o == out_len) ? 0 : -1;
+}
+
+void hmac_keyring_cleanup(void) {
+    OPENSSL_cleanse(g_keys, sizeof(g_keys));
+    g_active_kid = -1;
+}
+
+// =========================================================
+// 내부 헬퍼
+// =========================================================
+
+static int load_key_file(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "[Keyring] Cannot open key file: %s\n", path);
+        return -1;
+    }
+
+    char line[512];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        line_no++;
+        char *p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') continue;
+
+        int kid;
+        char hex[MAX_KEY_BYTES * 2 + 2];
+        if (sscanf(p, "%d %130s", &kid, hex) != 2 || kid < 0 || kid >= MAX_KEYS) {
+            fprintf(stderr, "[Keyring] %s:%d: expected \"<kid> <hex key>\"\n", path, line_no);
+            continue;
+        }
+
+        SigningKey *k = &g_keys[kid];
+        if (parse_hex(hex, k->key, sizeof(k->key), &k->len) != 0 || k->len < MIN_KEY_BYTES) {
+            fprintf(stderr, "[Keyring] %s:%d: key must be %d-%d bytes of hex\n",
+                    path, line_no, MIN_KEY_BYTES, MAX_KEY_BYTES);
+            memset(k, 0, sizeof(*k));
+            continue;
+        }
+        k->present = 1;
+        if (g_active_kid < 0) g_active_kid = kid; // 첫 번째 키로 서명
+    }
+    fclose(fp);
+    OPENSSL_cleanse(line, sizeof(line));
+
+    if (g_active_kid < 0) {
+        fprintf(stderr, "[Keyring] No usable key in %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static int parse_hex(const char *hex, uint8_t *out, size_t cap, size_t *out_len) {
+    size_t n = strlen(hex);
+    if (n % 2 != 0 || n / 2 > cap) return -1;
+
+    for (size_t i = 0; i < n / 2; i++) {
+        unsigned int byte;
+        if (sscanf(hex + i * 2, "%2x", &byte) != 1) return -1;
+        out[i] = (uint8_t)byte;
+    }
+    *out_len = n / 2;
+    return 0;
+}
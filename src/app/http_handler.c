@@ -14,8 +14,17 @@
 #include "app/static_handler.h"
 #include "app/auth_handler.h"
 #include "app/session_manager.h"
+#include "app/signed_url.h"
 #include "app/db_handler.h"
+#include "app/catalog.h"
+#include "app/continue_watching.h"
+#include "app/library_scanner.h"
+#include "app/stats_handler.h"
+#include "app/device_io.h"
+#include "app/tiering.h"
 #include "core/reactor.h"
+#include "core/logger.h"
+#include "core/metrics.h"
 
 static const enum {
     READ_BLOCK = -2,
@@ -38,15 +47,13 @@ void handle_http_request(ClientContext *ctx) {
     int read_status = try_read_request(ctx);
 
     if (read_status == READ_ERR) {
-        printf("Client error: %s\n", ctx->client_ip);
-        close(ctx->client_fd);
-        free(ctx);
+        LOG_DEBUG("HTTP", "Client error: %s", ctx->client_ip);
+        http_close_client(ctx);
         return;
     }
     if (read_status == READ_EOF) {
-        printf("[Info] Client %d closed connection (EOF)\n", ctx->client_fd);
-        close(ctx->client_fd);
-        free(ctx);
+        LOG_DEBUG("HTTP", "Client %d closed connection (EOF)", ctx->client_fd);
+        http_close_client(ctx);
         return;
     }
     if (read_status == READ_BLOCK) {
@@ -75,7 +82,7 @@ static int try_read_request(ClientContext *ctx) {
     int remaining = (sizeof(ctx->buffer) - 1) - ctx->buffer_len;
 
     if (remaining <= 0){
-        fprintf(stderr, "Error: Request Header too large (Buffer Full)\n");
+        LOG_WARN("HTTP", "Request header too large (fd %d)", ctx->client_fd);
         return READ_ERR;
     }
 
@@ -95,7 +102,7 @@ static int try_read_request(ClientContext *ctx) {
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
             return READ_BLOCK;
         }
-        perror("recv() failed.");
+        LOG_DEBUG("HTTP", "recv() failed: %m");
         return READ_ERR;
     }
 }
@@ -120,7 +127,7 @@ static int parse_request(ClientContext *ctx) {
     char proto_str[16] = {0};
 
     if (sscanf(line, "%15s %511s %15s", method_str, path_str, proto_str) != 3) {
-        fprintf(stderr, "Malformed HTTP Request\n");
+        LOG_WARN("HTTP", "Malformed request line");
         return PARSE_ERROR;
     }
 
@@ -129,7 +136,16 @@ static int parse_request(ClientContext *ctx) {
     else if (strcmp(method_str, "OPTIONS") == 0) ctx->method = HTTP_OPTIONS;
     else ctx->method = HTTP_UNKNOWN;
 
-    // path 저장
+    // 쿼리 문자열 분리 후 path 저장
+    ctx->query[0] = '\0';
+    ctx->if_none_match[0] = '\0';
+    ctx->url_max_age = 0;
+    char *query = strchr(path_str, '?');
+    if (query) {
+        *query++ = '\0';
+        strncpy(ctx->query, query, sizeof(ctx->query) - 1);
+        ctx->query[sizeof(ctx->query) - 1] = '\0';
+    }
     strncpy(ctx->request_path, path_str, sizeof(ctx->request_path) - 1);
     ctx->request_path[sizeof(ctx->request_path) - 1] = '\0';
 
@@ -165,6 +181,14 @@ static int parse_request(ClientContext *ctx) {
             } // if "bytes="
         } // if "Range:"
 
+        // 조건부 요청 (ETag 비교용)
+        if (strncasecmp(line, "If-None-Match:", 14) == 0) {
+            char *value = line + 14;
+            while (*value == ' ') value++;
+            strncpy(ctx->if_none_match, value, sizeof(ctx->if_none_match) - 1);
+            ctx->if_none_match[sizeof(ctx->if_none_match) - 1] = '\0';
+        }
+
         // Cookie 헤더 파싱
         if (strncasecmp(line, "Cookie:", 7) == 0) {
             char *p = line + 7;
@@ -175,7 +199,7 @@ static int parse_request(ClientContext *ctx) {
                 
                 // 값 추출 (세미콜론, 줄바꿈, 공백 등을 만날 때까지)
                 int i = 0;
-                while (i < 32 && sess_ptr[i] != '\0' && sess_ptr[i] != ';' && 
+                while (i < (int)sizeof(ctx->session_id) - 1 && sess_ptr[i] != '\0' && sess_ptr[i] != ';' && 
                        sess_ptr[i] != '\r' && sess_ptr[i] != '\n' && sess_ptr[i] != ' ') {
                     ctx->session_id[i] = sess_ptr[i];
                     i++;
@@ -188,8 +212,12 @@ static int parse_request(ClientContext *ctx) {
 }
 
 static void route_request(ClientContext *ctx) {
+    // 동기 API는 응답을 다 보낸 뒤 여기서 기록 (핸들러가 돌아오면 ctx는 이미 다른 스레드 소관일 수 있음)
+    long long start = metrics_now_ns();
+    ctx->req_start_ns = start;
+
     if (strstr(ctx->request_path, "..")) {
-        fprintf(stderr, "[Security] Blocked traversal attempt: %s\n", ctx->request_path);
+        LOG_WARN("Security", "Blocked traversal attempt from %s: %s", ctx->client_ip, ctx->request_path);
         send_error_response(ctx, ERR_FORBIDDEN);
         return;
     }
@@ -202,6 +230,7 @@ static void route_request(ClientContext *ctx) {
     // [API 처리] 로그아웃 (POST /logout)
     if (strcmp(ctx->request_path, "/logout") == 0 && ctx->method == HTTP_POST) {
         handle_logout(ctx); // auth_handler.c
+        metrics_observe_since(H_ROUTE_LOGOUT, start);
         return;
     }
 
@@ -214,6 +243,7 @@ static void route_request(ClientContext *ctx) {
     // [API 처리] 시청 이력 저장 (POST /api/history)
     if (strcmp(ctx->request_path, "/api/history") == 0 && ctx->method == HTTP_POST) {
         handle_api_history(ctx);
+        metrics_observe_since(H_ROUTE_HISTORY, start);
         return;
     }
     
@@ -225,10 +255,45 @@ static void route_request(ClientContext *ctx) {
             return;
         }
         handle_api_video_list(ctx);
+        metrics_observe_since(H_ROUTE_VIDEOS, start);
+        return;
+    }
+
+    // [API 처리] 이어보기 목록 (GET /api/continue)
+    if (strcmp(ctx->request_path, "/api/continue") == 0 && ctx->method == HTTP_GET) {
+        if (strlen(ctx->session_id) == 0 || session_get_user(ctx->session_id) < 0) {
+            send_error_response(ctx, 401);
+            return;
+        }
+        handle_api_continue(ctx);
+        metrics_observe_since(H_ROUTE_CONTINUE, start);
+        return;
+    }
+
+    // [API 처리] 제목 검색 (GET /api/search)
+    if (strcmp(ctx->request_path, "/api/search") == 0 && ctx->method == HTTP_GET) {
+        if (strlen(ctx->session_id) == 0 || session_get_user(ctx->session_id) < 0) {
+            send_error_response(ctx, 401);
+            return;
+        }
+        handle_api_search(ctx);
+        metrics_observe_since(H_ROUTE_SEARCH, start);
+        return;
+    }
+
+    // [API 처리] 서버 통계 (GET /api/stats)
+    if (strcmp(ctx->request_path, "/api/stats") == 0 && ctx->method == HTTP_GET) {
+        if (strlen(ctx->session_id) == 0 || session_get_user(ctx->session_id) < 0) {
+            send_error_response(ctx, 401);
+            return;
+        }
+        handle_api_stats(ctx);
+        metrics_observe_since(H_ROUTE_STATS, start);
         return;
     }
 
     char file_path[512] = {0};
+    int is_video = 0;
 
     // [경로 매핑] 루트 경로("/") -> "static/index.html"
     if (strcmp(ctx->request_path, "/") == 0) {
@@ -236,9 +301,18 @@ static void route_request(ClientContext *ctx) {
     }
     // [경로 매핑] 나머지 정적 파일들 
     // 앞의 '/'를 제거하고 'static/'을 붙임
-    else if (strncmp(ctx->request_path, "/videos/", 8) == 0) {
-        // 이미 경로에 /videos/가 포함되어 있으므로 앞에 점(.)만 붙여서 현재 디렉토리로 인식시킴
-        snprintf(file_path, sizeof(file_path), ".%s", ctx->request_path);
+    else if (strncmp(ctx->request_path, "/videos", 7) == 0) {
+        // 서명 URL이면 세션 조회 없이 통과 (경로 매핑 전의 URL 경로로 서명 검증)
+        if (signed_url_verify(ctx->request_path, ctx->query, &ctx->url_max_age) < 0) {
+            ctx->url_max_age = 0;
+        }
+
+        // 미디어 루트 매핑: /videos/... -> 루트0, /videos1/... -> 루트1 ...
+        if (library_resolve_url(ctx->request_path, file_path, sizeof(file_path)) < 0) {
+            send_error_response(ctx, 404);
+            return;
+        }
+        is_video = 1;
     }
     else {
         // 확장자 추출
@@ -248,7 +322,8 @@ static void route_request(ClientContext *ctx) {
         int is_static = 0;
         if (ext && (strcasecmp(ext, ".html") == 0 || strcasecmp(ext, ".css") == 0 || 
                     strcasecmp(ext, ".js") == 0   || strcasecmp(ext, ".png") == 0 || 
-                    strcasecmp(ext, ".jpg") == 0  || strcasecmp(ext, ".ico") == 0)) {
+                    strcasecmp(ext, ".jpg") == 0  || strcasecmp(ext, ".ico") == 0 ||
+                    strcasecmp(ext, ".webp") == 0 || strcasecmp(ext, ".vtt") == 0)) {
             is_static = 1;
         }
 
@@ -274,28 +349,36 @@ static void route_request(ClientContext *ctx) {
     if (ext && strcasecmp(ext, ".mp4") == 0) {
         // [세션 검증]
         // 쿠키가 없거나 유효하지 않으면 거부
-        if (strlen(ctx->session_id) == 0 || session_get_user(ctx->session_id) < 0) {
-            printf("[Access] Denied for %s (Invalid Session)\n", ctx->client_ip);
+        if (ctx->url_max_age <= 0 &&
+            (strlen(ctx->session_id) == 0 || session_get_user(ctx->session_id) < 0)) {
+            LOG_INFO("Access", "Denied for %s (invalid session)", ctx->client_ip);
             send_error_response(ctx, 401); // 401 Unauthorized
             return;
         }
         // 인증 성공 -> 스트리밍 진행
+        // 인기도 기록 + 빠른 계층 사본이 있으면 그 경로로 (인증된 요청만)
+        if (is_video) {
+            tiering_resolve(ctx->request_path, sizeof(ctx->request_path));
+            ext = strrchr(ctx->request_path, '.'); // 경로가 바뀌었을 수 있음
+        }
     }
 
     // [파일 핸들러 분배] 확장자 기반
     if (ext) {
         if (strcasecmp(ext, ".mp4") == 0) {
-            // 동영상 스트리밍 (Range 지원)
-            handle_streaming_request(ctx);
+            // 동영상 스트리밍 (Range 지원), 파일이 있는 장치의 I/O 큐에서 처리
+            device_io_dispatch(ctx, handle_streaming_request, true);
         } 
         else if (strcasecmp(ext, ".html") == 0 || 
                  strcasecmp(ext, ".css") == 0 ||
                  strcasecmp(ext, ".js") == 0 ||
                  strcasecmp(ext, ".png") == 0 ||
                  strcasecmp(ext, ".jpg") == 0 ||
+                 strcasecmp(ext, ".webp") == 0 ||
+                 strcasecmp(ext, ".vtt") == 0 ||
                  strcasecmp(ext, ".ico") == 0) {
-            // 정적 파일 전송 (단순 전송)
-            handle_static_request(ctx);
+            // 정적 파일 전송 (단순 전송), 장치가 밀려 있어도 거절하지 않음
+            device_io_dispatch(ctx, handle_static_request, false);
         } 
         else {
             // 지원하지 않는 파일 형식
@@ -332,8 +415,7 @@ static void rearm_epoll(ClientContext *ctx) {
     
     if (reactor_update_event(ctx->epoll_fd, ctx->client_fd, events, ctx) < 0) {
         // epoll 등록 실패 시 연결 종료 (치명적 오류)
-        perror("rearm_epoll failed");
-        close(ctx->client_fd);
-        free(ctx);
+        LOG_WARN("HTTP", "rearm_epoll failed: %m");
+        http_close_client(ctx);
     }
 }
\ No newline at end of file
@@ -2,11 +2,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <poll.h>
 #include <unistd.h>
 #include <errno.h>
 
 #include "app/http_utils.h"
 #include "app/client_context.h"
+#include "app/stream_handler.h"
+#include "core/metrics.h"
+#include "core/logger.h"
 
 static const char* get_status_text(int code) {
     switch (code) {
@@ -28,10 +32,10 @@ void send_error_response(ClientContext *ctx, int status_code) {
     // [안전장치] 이미 파일 데이터를 보내던 중이라면 에러 헤더를 보낼 수 없음
     // 프로토콜이 깨지므로 그냥 조용히 연결을 끊는 것이 상책
     if (ctx->state == STATE_RES_SENDING_BODY) {
-        printf("[Error] Error occurred during streaming. Closing connection.\n");
+        LOG_DEBUG("Stream", "Error during streaming to %s, closing connection", ctx->client_ip);
+        stream_release_io(ctx);
         if (ctx->file_fd > 0) close(ctx->file_fd);
-        close(ctx->client_fd);
-        free(ctx);
+        http_close_client(ctx);
         return;
     }
 
@@ -56,15 +60,21 @@ void send_error_response(ClientContext *ctx, int status_code) {
 
     // [자원 정리]
     // 스트리밍을 위해 열어둔 파일이 있다면 닫기
+    stream_release_io(ctx);
     if (ctx->file_fd > 0) {
         close(ctx->file_fd);
     }
 
-    printf("[Response] Sent Error %d to %s.  %s\n", status_code, ctx->client_ip, ctx->request_path);
+    LOG_DEBUG("Response", "Sent error %d to %s: %s", -status_code, ctx->client_ip, ctx->request_path);
 
     // 소켓 닫기 및 메모리 해제
+    http_close_client(ctx);
+}
+
+void http_close_client(ClientContext *ctx) {
     close(ctx->client_fd);
     free(ctx);
+    metrics_add(M_CONN_CLOSED, 1);
 }
 
 int http_get_form_param(const char *body, const char *key, char *out_buf, size_t out_len){
@@ -104,6 +114,66 @@ int http_get_form_param(const char *body, const char *key, char *out_buf, size_t
     return -1; // 찾지 못함
 }
 
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void http_url_decode(char *s) {
+    char *out = s;
+    for (const char *p = s; *p; p++) {
+        if (*p == '+') {
+            *out++ = ' ';
+        } else if (*p == '%' && hex_digit(p[1]) >= 0 && hex_digit(p[2]) >= 0 &&
+                   (hex_digit(p[1]) | hex_digit(p[2])) != 0) {
+            *out++ = (char)(hex_digit(p[1]) * 16 + hex_digit(p[2])); // %00은 문자열을 자르므로 제외
+            p += 2;
+        } else {
+            *out++ = *p;
+        }
+    }
+    *out = '\0';
+}
+
+int http_url_encode_path(const char *in, char *out, size_t out_len) {
+    static const char hex[] = "0123456789ABCDEF";
+    size_t o = 0;
+    for (const unsigned char *p = (const unsigned char *)in; *p; p++) {
+        int plain = (*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9') ||
+                     *p == '-' || *p == '.' || *p == '_' || *p == '~' || *p == '/';
+        if (o + (plain ? 1 : 3) >= out_len) return -1;
+        if (plain) {
+            out[o++] = (char)*p;
+        } else {
+            out[o++] = '%';
+            out[o++] = hex[*p >> 4];
+            out[o++] = hex[*p & 0x0F];
+        }
+    }
+    if (o >= out_len) return -1;
+    out[o] = '\0';
+    return (int)o;
+}
+
+int http_url_decode_path(const char *in, char *out, size_t out_len) {
+    size_t o = 0;
+    for (const char *p = in; *p; p++) {
+        if (o + 1 >= out_len) return -1;
+        if (*p == '%' && hex_digit(p[1]) >= 0 && hex_digit(p[2]) >= 0 &&
+            (hex_digit(p[1]) | hex_digit(p[2])) != 0) {
+            out[o++] = (char)(hex_digit(p[1]) * 16 + hex_digit(p[2]));
+            p += 2;
+        } else {
+            out[o++] = *p;
+        }
+    }
+    if (o >= out_len) return -1;
+    out[o] = '\0';
+    return (int)o;
+}
+
 int send_all_blocking(int fd, const char *data, size_t len) {
     size_t total_sent = 0;
     while (total_sent < len) {
@@ -128,4 +198,27 @@ int send_all_blocking(int fd, const char *data, size_t len) {
         }
     }
     return 0; // 성공
-}
\ No newline at end of file
+}
+
+int send_all_wait(int fd, const char *data, size_t len, int timeout_ms) {
+    size_t total_sent = 0;
+    while (total_sent < len) {
+        ssize_t sent = send(fd, data + total_sent, len - total_sent, 0);
+        if (sent > 0) {
+            total_sent += sent;
+            continue;
+        }
+        if (sent == 0) return -1; // Connection closed
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) return -1;
+
+        // 소켓 버퍼가 빌 때까지 대기 (중간에 끊으면 응답 본문이 잘림)
+        struct pollfd pfd = {.fd = fd, .events = POLLOUT};
+        int ready;
+        do {
+            ready = poll(&pfd, 1, timeout_ms);
+        } while (ready < 0 && errno == EINTR);
+        if (ready <= 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) return -1;
+    }
+    return 0;
+}
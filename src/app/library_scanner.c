@@ -0,0 +1,897 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include <libavformat/avformat.h>
+
+#include "app/library_scanner.h"
+#include "app/db_handler.h"
+#include "app/thumbnail_worker.h"
+#include "app/catalog.h"
+#include "app/http_utils.h"
+#include "core/thread_pool.h"
+
+#define LIB_PATH_LEN        1024
+#define URL_INDEX_BUCKETS   (1 << 16)
+#define PROBE_CHUNK         16      // probe 작업 1건당 처리할 파일 수
+#define BATCH_QUIET_MS      500     // 마지막 이벤트 후 이 시간 동안 조용하면 배치 반영
+#define BATCH_MAX_DELAY_SEC 2       // 이벤트가 계속 와도 이 시간이 지나면 반영
+#define BATCH_MAX_CHANGES   512     // 한 배치에 모을 최대 변경 수
+
+#define WATCH_MASK (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ONLYDIR)
+
+typedef struct {
+    char path[LIB_PATH_LEN];    // 루트 물리 경로 (끝의 '/' 제거)
+    char url_prefix[32];        // "/videos/", "/videos1/", ...
+    bool ok;                    // 초기 스캔 시 디렉토리를 열 수 있었는지
+} LibraryRoot;
+
+// 스캔으로 발견한 미디어 파일 1건
+typedef struct {
+    int root_idx;
+    char *rel;                  // 루트 기준 상대 경로 ("drama/ep1.mp4")
+    long long size;
+    long long mtime;
+    int duration;               // probe 결과 (변경된 파일만 채움)
+} ScanEntry;
+
+typedef struct {
+    ScanEntry *items;
+    int count;
+    int cap;
+} ScanEntryList;
+
+// 병렬 스캔 공용 상태 (pending이 0이 되면 완료)
+typedef struct {
+    ThreadPool pool;
+    pthread_mutex_t mutex;
+    pthread_cond_t done;
+    int pending;
+    ScanEntryList found;
+} ScanContext;
+
+typedef struct {
+    ScanContext *sc;
+    int root_idx;
+    char *rel;
+} DirJob;
+
+typedef struct {
+    ScanContext *sc;
+    ScanEntry **entries;
+    int count;
+} ProbeJob;
+
+// DB에 저장된 기존 라이브러리 (url -> size, mtime)
+typedef struct IndexNode {
+    char *url;
+    long long size;
+    long long mtime;
+    bool seen;
+    struct IndexNode *next;
+} IndexNode;
+
+// inotify 배치에 모이는 변경 1건
+typedef struct {
+    int root_idx;
+    char *rel;
+    bool removed;
+    bool is_dir;
+} PendingChange;
+
+// 내부 전역 변수
+static LibraryRoot g_roots[LIBRARY_MAX_ROOTS];
+static int g_root_count = 0;
+static int g_scan_threads = 4;
+static char g_thumb_ext[8] = "jpg";
+
+static pthread_t g_indexer;
+static bool g_indexer_started = false;
+static volatile bool g_stop = false;
+static int g_wake_pipe[2] = {-1, -1};
+
+// inotify 감시 디스크립터 -> (루트, 디렉토리 상대 경로)
+static int g_inotify_fd = -1;
+static pthread_mutex_t g_watch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char **g_watch_rel = NULL;
+static int *g_watch_root = NULL;
+static int g_watch_cap = 0;
+
+static PendingChange *g_pending = NULL;
+static int g_pending_count = 0;
+static int g_pending_cap = 0;
+
+// 내부 헬퍼 함수
+static void* indexer_thread_func(void *arg);
+static int full_scan(void);
+static int walk_dir(ScanContext *sc, int root_idx, const char *rel);
+static void spawn_dir(ScanContext *sc, int root_idx, const char *rel);
+static void dir_job_func(void *arg);
+static void probe_job_func(void *arg);
+static void scan_wait(ScanContext *sc);
+static int probe_duration(const char *path);
+static void add_watch(int root_idx, const char *rel, const char *full_path);
+static void watch_new_tree(int root_idx, const char *rel);
+static void handle_inotify_events(void);
+static void add_pending(int root_idx, const char *rel, bool removed, bool is_dir);
+static void flush_pending(void);
+static int apply_changes(ScanEntry **changed, int n_changed, char **removed, int n_removed);
+static bool is_media_file(const char *name);
+static int stat_entry(int dir_fd, const char *name, struct stat *st);
+// 디렉토리 항목 stat: 파일 심볼릭 링크는 따라가지만 디렉토리 링크는 건너뜀
+// (상위 디렉토리를 가리키는 링크가 있으면 병렬 스캔/감시 등록이 끝없이 재귀하므로)
+static int stat_entry(int dir_fd, const char *name, struct stat *st) {
+    if (fstatat(dir_fd, name, st, AT_SYMLINK_NOFOLLOW) != 0) return -1;
+    if (!S_ISLNK(st->st_mode)) return 0;
+    if (fstatat(dir_fd, name, st, 0) != 0 || S_ISDIR(st->st_mode)) return -1;
+    return 0;
+}
+
+static void build_url(int root_idx, const char *rel, char *out, size_t out_len);
+static void build_phys(int root_idx, const char *rel, char *out, size_t out_len);
+static char* join_rel(const char *dir_rel, const char *name);
+static unsigned long hash_str(const char *str);
+
+int library_init(const char *roots_csv, int scan_threads, const char *thumb_format) {
+    g_root_count = 0;
+    g_scan_threads = (scan_threads > 0) ? scan_threads : 1;
+    snprintf(g_thumb_ext, sizeof(g_thumb_ext), "%s",
+             (thumb_format && strcasecmp(thumb_format, "webp") == 0) ? "webp" : "jpg");
+
+    char buf[LIB_PATH_LEN * 2];
+    snprintf(buf, sizeof(buf), "%s", roots_csv ? roots_csv : "./videos");
+
+    char *saveptr;
+    for (char *tok = strtok_r(buf, ",", &saveptr); tok; tok = strtok_r(NULL, ",", &saveptr)) {
+        while (*tok == ' ' || *tok == '\t') tok++;
+        size_t len = strlen(tok);
+        while (len > 0 && (tok[len - 1] == ' ' || tok[len - 1] == '\t' || tok[len - 1] == '/')) {
+            tok[--len] = '\0';
+        }
+        if (len == 0) continue;
+
+        if (g_root_count == LIBRARY_MAX_ROOTS) {
+            fprintf(stderr, "[Library] Too many media roots (max %d). Ignoring: %s\n",
+                    LIBRARY_MAX_ROOTS, tok);
+            continue;
+        }
+
+        LibraryRoot *root = &g_roots[g_root_count];
+        snprintf(root->path, sizeof(root->path), "%s", tok);
+        if (g_root_count == 0) {
+            snprintf(root->url_prefix, sizeof(root->url_prefix), "/videos/");
+        } else {
+            snprintf(root->url_prefix, sizeof(root->url_prefix), "/videos%d/", g_root_count);
+        }
+        root->ok = false;
+        printf("[Library] Root %d: %s -> %s\n", g_root_count, root->path, root->url_prefix);
+        g_root_count++;
+    }
+
+    return (g_root_count > 0) ? 0 : -1;
+}
+
+int library_start(void) {
+    if (g_root_count == 0 || g_indexer_started) return -1;
+
+    if (pipe(g_wake_pipe) != 0) {
+        perror("[Library] pipe failed");
+        return -1;
+    }
+
+    g_stop = false;
+    if (pthread_create(&g_indexer, NULL, indexer_thread_func, NULL) != 0) {
+        perror("[Library] Failed to create indexer thread");
+        close(g_wake_pipe[0]);
+        close(g_wake_pipe[1]);
+        return -1;
+    }
+    g_indexer_started = true;
+    return 0;
+}
+
+void library_shutdown(void) {
+    if (g_indexer_started) {
+        g_stop = true;
+        ssize_t n = write(g_wake_pipe[1], "x", 1); // poll 깨우기
+        (void)n;
+        pthread_join(g_indexer, NULL);
+        g_indexer_started = false;
+    }
+
+    if (g_wake_pipe[0] >= 0) close(g_wake_pipe[0]);
+    if (g_wake_pipe[1] >= 0) close(g_wake_pipe[1]);
+    g_wake_pipe[0] = g_wake_pipe[1] = -1;
+
+    if (g_inotify_fd >= 0) {
+        close(g_inotify_fd);
+        g_inotify_fd = -1;
+    }
+
+    for (int i = 0; i < g_watch_cap; i++) free(g_watch_rel[i]);
+    free(g_watch_rel);
+    free(g_watch_root);
+    g_watch_rel = NULL;
+    g_watch_root = NULL;
+    g_watch_cap = 0;
+
+    for (int i = 0; i < g_pending_count; i++) free(g_pending[i].rel);
+    free(g_pending);
+    g_pending = NULL;
+    g_pending_count = g_pending_cap = 0;
+}
+
+int library_resolve_url(const char *url, char *out_path, size_t out_len) {
+    if (!url) return -1;
+
+    for (int i = 0; i < g_root_count; i++) {
+        size_t plen = strlen(g_roots[i].url_prefix);
+        if (strncmp(url, g_roots[i].url_prefix, plen) != 0) continue;
+
+        // 퍼센트 디코딩 (브라우저가 공백 등을 %20으로 보냄, 서명 URL 검증과 같은 규칙)
+        char rel[LIB_PATH_LEN];
+        if (http_url_decode_path(url + plen, rel, sizeof(rel)) < 0) return -1;
+
+        // 디코딩 후 다시 검사 (%2e%2e 로 route_request의 ".." 검사를 우회하는 것 방지)
+        if (rel[0] == '\0' || strstr(rel, "..")) return -1;
+
+        int n = snprintf(out_path, out_len, "%s/%s", g_roots[i].path, rel);
+        if (n < 0 || (size_t)n >= out_len) return -1;
+        return i;
+    }
+    return -1;
+}
+
+int library_root_count(void) {
+    return g_root_count;
+}
+
+const char* library_root_path(int idx) {
+    if (idx < 0 || idx >= g_root_count) return NULL;
+    return g_roots[idx].path;
+}
+
+// =========================================================
+// 인덱서 스레드: 초기 스캔 -> inotify 감시
+// =========================================================
+
+static void* indexer_thread_func(void *arg) {
+    (void)arg;
+
+    // 감시를 스캔보다 먼저 켜서 스캔 중에 추가된 파일도 놓치지 않음
+    // (중복 이벤트는 size/mtime 비교로 걸러짐)
+    g_inotify_fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (g_inotify_fd < 0) {
+        perror("[Library] inotify_init1 failed (watch disabled)");
+    }
+
+    full_scan();
+
+    if (g_inotify_fd < 0) return NULL;
+
+    time_t first_pending = 0;
+    while (!g_stop) {
+        struct pollfd fds[2] = {
+            {.fd = g_inotify_fd, .events = POLLIN},
+            {.fd = g_wake_pipe[0], .events = POLLIN},
+        };
+        int timeout = (g_pending_count > 0) ? BATCH_QUIET_MS : -1;
+
+        int n = poll(fds, 2, timeout);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("[Library] poll failed");
+            break;
+        }
+        if (fds[1].revents & POLLIN) break;
+
+        if (n == 0) { // 조용해짐 -> 배치 반영
+            flush_pending();
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            if (g_pending_count == 0) first_pending = time(NULL);
+            handle_inotify_events();
+        }
+
+        // 대량 복사처럼 이벤트가 끊이지 않는 경우에도 주기적으로 반영
+        if (g_pending_count >= BATCH_MAX_CHANGES ||
+            (g_pending_count > 0 && time(NULL) - first_pending >= BATCH_MAX_DELAY_SEC)) {
+            flush_pending();
+        }
+    }
+
+    if (g_pending_count > 0) flush_pending();
+    return NULL;
+}
+
+static void index_add_cb(int id, const char *filepath, long long size, long long mtime, void *arg) {
+    (void)id;
+    IndexNode **index = (IndexNode **)arg;
+    if (!filepath) return;
+
+    IndexNode *node = (IndexNode *)calloc(1, sizeof(IndexNode));
+    if (!node) return;
+    node->url = strdup(filepath);
+    if (!node->url) {
+        free(node);
+        return;
+    }
+    node->size = size;
+    node->mtime = mtime;
+
+    unsigned long b = hash_str(filepath) % URL_INDEX_BUCKETS;
+    node->next = index[b];
+    index[b] = node;
+}
+
+static IndexNode* index_find(IndexNode **index, const char *url) {
+    for (IndexNode *n = index[hash_str(url) % URL_INDEX_BUCKETS]; n; n = n->next) {
+        if (strcmp(n->url, url) == 0) return n;
+    }
+    return NULL;
+}
+
+// 해당 URL이 속한 루트가 이번 스캔에서 접근 불가였는지 (마운트 해제 등)
+// -> 그 루트의 행은 지우지 않음 (시청 이력이 video_id와 함께 날아가는 것 방지)
+static bool url_in_unavailable_root(const char *url) {
+    for (int i = 0; i < g_root_count; i++) {
+        if (strncmp(url, g_roots[i].url_prefix, strlen(g_roots[i].url_prefix)) == 0) {
+            return !g_roots[i].ok;
+        }
+    }
+    return false; // 어느 루트에도 속하지 않음 (설정에서 빠진 루트) -> 삭제 대상
+}
+
+// 전체 스캔: 병렬 stat walk -> DB와 비교 -> 변경분만 병렬 probe -> 단일 트랜잭션
+static int full_scan(void) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    ScanContext sc;
+    memset(&sc, 0, sizeof(sc));
+    pthread_mutex_init(&sc.mutex, NULL);
+    pthread_cond_init(&sc.done, NULL);
+
+    if (thread_pool_init(&sc.pool, g_scan_threads, 1024) != 0) {
+        fprintf(stderr, "[Library] Failed to init scan pool.\n");
+        pthread_mutex_destroy(&sc.mutex);
+        pthread_cond_destroy(&sc.done);
+        return -1;
+    }
+
+    // 1. 병렬 stat walk (디렉토리 단위로 풀에 분배)
+    for (int i = 0; i < g_root_count; i++) {
+        struct stat st;
+        g_roots[i].ok = (stat(g_roots[i].path, &st) == 0 && S_ISDIR(st.st_mode));
+        if (!g_roots[i].ok) {
+            fprintf(stderr, "[Library] Root not accessible: %s\n", g_roots[i].path);
+            continue;
+        }
+        spawn_dir(&sc, i, "");
+    }
+    scan_wait(&sc);
+
+    // 2. DB의 기존 목록과 (size, mtime) 비교
+    int result = -1;
+    IndexNode **index = (IndexNode **)calloc(URL_INDEX_BUCKETS, sizeof(IndexNode *));
+    ScanEntry **changed = (ScanEntry **)malloc(sizeof(ScanEntry *) * (sc.found.count + 1));
+    char **removed = NULL;
+    int n_changed = 0, n_removed = 0, removed_cap = 0;
+
+    if (!index || !changed) {
+        fprintf(stderr, "[Library] Out of memory during scan.\n");
+        goto cleanup;
+    }
+    if (db_for_each_library_entry(index_add_cb, index) != 0) {
+        fprintf(stderr, "[Library] Failed to load library index.\n");
+        goto cleanup;
+    }
+
+    char url[LIB_PATH_LEN + 32];
+    for (int i = 0; i < sc.found.count; i++) {
+        ScanEntry *e = &sc.found.items[i];
+        build_url(e->root_idx, e->rel, url, sizeof(url));
+
+        IndexNode *node = index_find(index, url);
+        if (node) {
+            node->seen = true;
+            if (node->size == e->size && node->mtime == e->mtime) continue; // 변경 없음
+        }
+        changed[n_changed++] = e;
+    }
+
+    for (int b = 0; b < URL_INDEX_BUCKETS; b++) {
+        for (IndexNode *n = index[b]; n; n = n->next) {
+            if (n->seen || url_in_unavailable_root(n->url)) continue;
+            if (n_removed == removed_cap) {
+                int new_cap = removed_cap ? removed_cap * 2 : 64;
+                char **grown = (char **)realloc(removed, sizeof(char *) * new_cap);
+                if (!grown) break;
+                removed = grown;
+                removed_cap = new_cap;
+            }
+            removed[n_removed++] = n->url; // index 해제 시 같이 해제
+        }
+    }
+
+    // 3. 변경된 파일만 병렬 probe
+    for (int i = 0; i < n_changed; i += PROBE_CHUNK) {
+        ProbeJob *job = (ProbeJob *)malloc(sizeof(ProbeJob));
+        if (!job) break;
+        job->sc = &sc;
+        job->entries = &changed[i];
+        job->count = (n_changed - i < PROBE_CHUNK) ? n_changed - i : PROBE_CHUNK;
+
+        pthread_mutex_lock(&sc.mutex);
+        sc.pending++;
+        pthread_mutex_unlock(&sc.mutex);
+        if (thread_pool_submit(&sc.pool, probe_job_func, job) != 0) {
+            probe_job_func(job); // 큐가 꽉 차면 직접 처리
+        }
+    }
+    scan_wait(&sc);
+
+    // 4. 단일 트랜잭션으로 반영
+    result = apply_changes(changed, n_changed, removed, n_removed);
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("[Library] Scan done: %d files, %d changed, %d removed (%.1f ms)\n",
+           sc.found.count, n_changed, n_removed,
+           (t1.tv_sec - t0.tv_sec) * 1000.0 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+
+cleanup:
+    thread_pool_shutdown(&sc.pool);
+    thread_pool_wait(&sc.pool);
+    thread_pool_cleanup(&sc.pool);
+    pthread_mutex_destroy(&sc.mutex);
+    pthread_cond_destroy(&sc.done);
+
+    if (index) {
+        for (int b = 0; b < URL_INDEX_BUCKETS; b++) {
+            IndexNode *n = index[b];
+            while (n) {
+                IndexNode *next = n->next;
+                free(n->url);
+                free(n);
+                n = next;
+            }
+        }
+        free(index);
+    }
+    free(removed);
+    free(changed);
+    for (int i = 0; i < sc.found.count; i++) free(sc.found.items[i].rel);
+    free(sc.found.items);
+    return result;
+}
+
+// 디렉토리 하나를 읽어 미디어 파일은 수집하고 하위 디렉토리는 풀에 분배
+static int walk_dir(ScanContext *sc, int root_idx, const char *rel) {
+    char full[LIB_PATH_LEN];
+    build_phys(root_idx, rel, full, sizeof(full));
+
+    DIR *d = opendir(full);
+    if (!d) return -1;
+
+    add_watch(root_idx, rel, full);
+
+    struct dirent *ent;
+    while ((ent = readdir(d)) != NULL && !g_stop) {
+        if (ent->d_name[0] == '.') continue; // ".", "..", 숨김 파일
+
+        struct stat st;
+        if (stat_entry(dirfd(d), ent->d_name, &st) != 0) continue;
+
+        if (S_ISDIR(st.st_mode)) {
+            char *child = join_rel(rel, ent->d_name);
+            if (child) {
+                spawn_dir(sc, root_idx, child);
+                free(child);
+            }
+        } else if (S_ISREG(st.st_mode) && is_media_file(ent->d_name)) {
+            char *child = join_rel(rel, ent->d_name);
+            if (!child) continue;
+
+            pthread_mutex_lock(&sc->mutex);
+            ScanEntryList *list = &sc->found;
+            if (list->count == list->cap) {
+                int new_cap = list->cap ? list->cap * 2 : 256;
+                ScanEntry *grown = (ScanEntry *)realloc(list->items, sizeof(ScanEntry) * new_cap);
+                if (!grown) {
+                    pthread_mutex_unlock(&sc->mutex);
+                    free(child);
+                    continue;
+                }
+                list->items = grown;
+                list->cap = new_cap;
+            }
+            ScanEntry *e = &list->items[list->count++];
+            e->root_idx = root_idx;
+            e->rel = child;
+            e->size = (long long)st.st_size;
+            e->mtime = (long long)st.st_mtime;
+            e->duration = 0;
+            pthread_mutex_unlock(&sc->mutex);
+        }
+    }
+
+    closedir(d);
+    return 0;
+}
+
+static void spawn_dir(ScanContext *sc, int root_idx, const char *rel) {
+    DirJob *job = (DirJob *)malloc(sizeof(DirJob));
+    char *rel_copy = strdup(rel);
+    if (!job || !rel_copy) {
+        free(job);
+        free(rel_copy);
+        return;
+    }
+    job->sc = sc;
+    job->root_idx = root_idx;
+    job->rel = rel_copy;
+
+    pthread_mutex_lock(&sc->mutex);
+    sc->pending++;
+    pthread_mutex_unlock(&sc->mutex);
+
+    // 큐가 꽉 차면 현재 스레드에서 바로 처리 (교착 방지)
+    if (thread_pool_submit(&sc->pool, dir_job_func, job) != 0) {
+        dir_job_func(job);
+    }
+}
+
+static void job_finished(ScanContext *sc) {
+    pthread_mutex_lock(&sc->mutex);
+    if (--sc->pending == 0) pthread_cond_broadcast(&sc->done);
+    pthread_mutex_unlock(&sc->mutex);
+}
+
+static void dir_job_func(void *arg) {
+    DirJob *job = (DirJob *)arg;
+    walk_dir(job->sc, job->root_idx, job->rel);
+
+    ScanContext *sc = job->sc;
+    free(job->rel);
+    free(job);
+    job_finished(sc);
+}
+
+static void probe_job_func(void *arg) {
+    ProbeJob *job = (ProbeJob *)arg;
+    char phys[LIB_PATH_LEN];
+
+    for (int i = 0; i < job->count && !g_stop; i++) {
+        ScanEntry *e = job->entries[i];
+        build_phys(e->root_idx, e->rel, phys, sizeof(phys));
+        e->duration = probe_duration(phys);
+    }
+
+    ScanContext *sc = job->sc;
+    free(job);
+    job_finished(sc);
+}
+
+static void scan_wait(ScanContext *sc) {
+    pthread_mutex_lock(&sc->mutex);
+    while (sc->pending > 0) {
+        pthread_cond_wait(&sc->done, &sc->mutex);
+    }
+    pthread_mutex_unlock(&sc->mutex);
+}
+
+// 컨테이너 헤더만 읽어 재생 시간(초)을 얻음. 실패 시 0
+static int probe_duration(const char *path) {
+    AVFormatContext *fmt = NULL;
+    if (avformat_open_input(&fmt, path, NULL, NULL) < 0) return 0;
+
+    // MP4는 moov만 읽어도 duration이 나오므로 무거운 find_stream_info는 필요할 때만
+    if (fmt->duration == AV_NOPTS_VALUE) {
+        avformat_find_stream_info(fmt, NULL);
+    }
+
+    int duration = (fmt->duration != AV_NOPTS_VALUE) ? (int)(fmt->duration / AV_TIME_BASE) : 0;
+    avformat_close_input(&fmt);
+    return duration;
+}
+
+// 변경분 DB 반영 + 썸네일/trickplay 예약
+static int apply_changes(ScanEntry **changed, int n_changed, char **removed, int n_removed) {
+    if (n_changed == 0 && n_removed == 0) return 0;
+
+    VideoRecord *records = (VideoRecord *)calloc(n_changed + 1, sizeof(VideoRecord));
+    char (*urls)[LIB_PATH_LEN + 32] = calloc(n_changed + 1, LIB_PATH_LEN + 32);
+    char (*titles)[256] = calloc(n_changed + 1, 256);
+    char (*thumbs)[64] = calloc(n_changed + 1, 64);
+    int *ids = (int *)calloc(n_changed + 1, sizeof(int));
+    int result = -1;
+
+    if (!records || !urls || !titles || !thumbs || !ids) goto out;
+
+    for (int i = 0; i < n_changed; i++) {
+        ScanEntry *e = changed[i];
+        build_url(e->root_idx, e->rel, urls[i], sizeof(urls[i]));
+
+        // 제목: 파일명에서 확장자 제거
+        const char *base = strrchr(e->rel, '/');
+        base = base ? base + 1 : e->rel;
+        snprintf(titles[i], sizeof(titles[i]), "%s", base);
+        char *dot = strrchr(titles[i], '.');
+        if (dot && dot != titles[i]) *dot = '\0';
+
+        // 썸네일 이름은 URL 해시 (id 없이도 결정 가능)
+        snprintf(thumbs[i], sizeof(thumbs[i]), "/thumbs/%016lx.%s", hash_str(urls[i]), g_thumb_ext);
+
+        records[i].filepath = urls[i];
+        records[i].title = titles[i];
+        records[i].thumbnail = thumbs[i];
+        records[i].duration = e->duration;
+        records[i].file_size = e->size;
+        records[i].file_mtime = e->mtime;
+    }
+
+    result = db_apply_library_batch(records, n_changed, (const char *const *)removed, n_removed, ids);
+    if (result != 0) goto out;
+
+    // /api/videos가 새 목록을 보도록 스냅샷 교체
+    catalog_refresh();
+
+    // 썸네일 워커 큐가 꽉 차면 여기서 대기하지만 인덱서 스레드이므로 무방
+    char phys[LIB_PATH_LEN];
+    char thumb_phys[128];
+    for (int i = 0; i < n_changed && !g_stop; i++) {
+        build_phys(changed[i]->root_idx, changed[i]->rel, phys, sizeof(phys));
+        snprintf(thumb_phys, sizeof(thumb_phys), "static%s", thumbs[i]);
+        thumbnail_worker_submit(phys, thumb_phys);
+        thumbnail_worker_submit_trickplay(ids[i], phys);
+    }
+
+out:
+    free(records);
+    free(urls);
+    free(titles);
+    free(thumbs);
+    free(ids);
+    return result;
+}
+
+// =========================================================
+// inotify
+// =========================================================
+
+// walk_dir에서 (스캔 스레드들이 동시에) 호출될 수 있으므로 mutex로 보호
+static void add_watch(int root_idx, const char *rel, const char *full_path) {
+    if (g_inotify_fd < 0) return;
+
+    int wd = inotify_add_watch(g_inotify_fd, full_path, WATCH_MASK);
+    if (wd < 0) {
+        if (errno == ENOSPC) {
+            fprintf(stderr, "[Library] inotify watch limit reached (fs.inotify.max_user_watches)\n");
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&g_watch_mutex);
+    if (wd >= g_watch_cap) {
+        int new_cap = g_watch_cap ? g_watch_cap : 256;
+        while (new_cap <= wd) new_cap *= 2;
+        char **rels = (char **)realloc(g_watch_rel, sizeof(char *) * new_cap);
+        if (rels) g_watch_rel = rels;
+        int *roots = (int *)realloc(g_watch_root, sizeof(int) * new_cap);
+        if (roots) g_watch_root = roots;
+        if (!rels || !roots) {
+            pthread_mutex_unlock(&g_watch_mutex);
+            return;
+        }
+        for (int i = g_watch_cap; i < new_cap; i++) {
+            g_watch_rel[i] = NULL;
+            g_watch_root[i] = -1;
+        }
+        g_watch_cap = new_cap;
+    }
+
+    free(g_watch_rel[wd]); // 같은 디렉토리를 다시 add하면 같은 wd가 나옴
+    g_watch_rel[wd] = strdup(rel);
+    g_watch_root[wd] = root_idx;
+    pthread_mutex_unlock(&g_watch_mutex);
+}
+
+// 새로 생긴(또는 옮겨온) 디렉토리: 감시 등록 + 안의 파일을 변경 목록에 추가
+static void watch_new_tree(int root_idx, const char *rel) {
+    char full[LIB_PATH_LEN];
+    build_phys(root_idx, rel, full, sizeof(full));
+
+    DIR *d = opendir(full);
+    if (!d) return;
+    add_watch(root_idx, rel, full);
+
+    struct dirent *ent;
+    while ((ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+
+        struct stat st;
+        if (stat_entry(dirfd(d), ent->d_name, &st) != 0) continue;
+
+        char *child = join_rel(rel, ent->d_name);
+        if (!child) continue;
+        if (S_ISDIR(st.st_mode)) {
+            watch_new_tree(root_idx, child);
+        } else if (S_ISREG(st.st_mode) && is_media_file(ent->d_name)) {
+            add_pending(root_idx, child, false, false);
+        }
+        free(child);
+    }
+    closedir(d);
+}
+
+static void handle_inotify_events(void) {
+    // inotify_event는 가변 길이 -> 정렬된 버퍼로 읽음
+    char buf[16384] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    while (1) {
+        ssize_t len = read(g_inotify_fd, buf, sizeof(buf));
+        if (len <= 0) break; // EAGAIN: 다 읽음
+
+        for (char *p = buf; p < buf + len; ) {
+            struct inotify_event *ev = (struct inotify_event *)p;
+            p += sizeof(struct inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW) {
+                // 이벤트 유실 -> 전체 재스캔 (stat walk + 변경분만 probe)
+                fprintf(stderr, "[Library] inotify queue overflow, rescanning.\n");
+                full_scan();
+                continue;
+            }
+
+            if (ev->wd < 0 || ev->wd >= g_watch_cap || !g_watch_rel[ev->wd]) continue;
+
+            if (ev->mask & IN_IGNORED) { // 감시 대상 디렉토리가 사라짐
+                free(g_watch_rel[ev->wd]);
+                g_watch_rel[ev->wd] = NULL;
+                continue;
+            }
+            if (ev->len == 0 || ev->name[0] == '.') continue;
+
+            int root_idx = g_watch_root[ev->wd];
+            char *rel = join_rel(g_watch_rel[ev->wd], ev->name);
+            if (!rel) continue;
+
+            bool is_dir = (ev->mask & IN_ISDIR) != 0;
+            if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                if (is_dir || is_media_file(ev->name)) add_pending(root_idx, rel, true, is_dir);
+            } else if (is_dir && (ev->mask & (IN_CREATE | IN_MOVED_TO))) {
+                watch_new_tree(root_idx, rel);
+            } else if (!is_dir && (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))) {
+                // IN_CREATE(파일)는 무시: 복사가 끝난 시점(IN_CLOSE_WRITE)에 반영
+                if (is_media_file(ev->name)) add_pending(root_idx, rel, false, false);
+            }
+            free(rel);
+        }
+    }
+}
+
+static void add_pending(int root_idx, const char *rel, bool removed, bool is_dir) {
+    // 같은 파일의 이벤트는 마지막 상태만 유지
+    for (int i = 0; i < g_pending_count; i++) {
+        if (g_pending[i].root_idx == root_idx && strcmp(g_pending[i].rel, rel) == 0) {
+            g_pending[i].removed = removed;
+            g_pending[i].is_dir = is_dir;
+            return;
+        }
+    }
+
+    if (g_pending_count == g_pending_cap) {
+        int new_cap = g_pending_cap ? g_pending_cap * 2 : 64;
+        PendingChange *grown = (PendingChange *)realloc(g_pending, sizeof(PendingChange) * new_cap);
+        if (!grown) return;
+        g_pending = grown;
+        g_pending_cap = new_cap;
+    }
+
+    char *copy = strdup(rel);
+    if (!copy) return;
+    g_pending[g_pending_count].root_idx = root_idx;
+    g_pending[g_pending_count].rel = copy;
+    g_pending[g_pending_count].removed = removed;
+    g_pending[g_pending_count].is_dir = is_dir;
+    g_pending_count++;
+}
+
+// 모인 변경분을 stat/probe 후 한 번의 트랜잭션으로 반영
+static void flush_pending(void) {
+    int n = g_pending_count;
+    ScanEntry *entries = (ScanEntry *)calloc(n + 1, sizeof(ScanEntry));
+    ScanEntry **changed = (ScanEntry **)calloc(n + 1, sizeof(ScanEntry *));
+    char **removed = (char **)calloc(n + 1, sizeof(char *));
+    int n_changed = 0, n_removed = 0;
+
+    if (!entries || !changed || !removed) goto out;
+
+    char phys[LIB_PATH_LEN];
+    char url[LIB_PATH_LEN + 32];
+    for (int i = 0; i < n; i++) {
+        PendingChange *pc = &g_pending[i];
+        struct stat st;
+        build_phys(pc->root_idx, pc->rel, phys, sizeof(phys));
+
+        if (pc->removed || stat(phys, &st) != 0 || !S_ISREG(st.st_mode)) {
+            build_url(pc->root_idx, pc->rel, url, sizeof(url));
+            if (pc->is_dir) strncat(url, "/", sizeof(url) - strlen(url) - 1);
+            removed[n_removed] = strdup(url);
+            if (removed[n_removed]) n_removed++;
+            continue;
+        }
+
+        ScanEntry *e = &entries[n_changed];
+        e->root_idx = pc->root_idx;
+        e->rel = pc->rel;
+        e->size = (long long)st.st_size;
+        e->mtime = (long long)st.st_mtime;
+        e->duration = probe_duration(phys);
+        changed[n_changed++] = e;
+    }
+
+    if (apply_changes(changed, n_changed, removed, n_removed) == 0) {
+        printf("[Library] Applied %d changed, %d removed.\n", n_changed, n_removed);
+    }
+
+out:
+    for (int i = 0; i < n_removed; i++) free(removed[i]);
+    free(removed);
+    free(changed);
+    free(entries);
+
+    for (int i = 0; i < g_pending_count; i++) free(g_pending[i].rel);
+    g_pending_count = 0;
+}
+
+// =========================================================
+// 경로 헬퍼
+// =========================================================
+
+static bool is_media_file(const char *name) {
+    const char *ext = strrchr(name, '.');
+    return ext && strcasecmp(ext, ".mp4") == 0; // 스트리밍 핸들러가 지원하는 포맷만
+}
+
+static void build_url(int root_idx, const char *rel, char *out, size_t out_len) {
+    snprintf(out, out_len, "%s%s", g_roots[root_idx].url_prefix, rel);
+}
+
+static void build_phys(int root_idx, const char *rel, char *out, size_t out_len) {
+    if (rel[0] == '\0') snprintf(out, out_len, "%s", g_roots[root_idx].path);
+    else snprintf(out, out_len, "%s/%s", g_roots[root_idx].path, rel);
+}
+
+static char* join_rel(const char *dir_rel, const char *name) {
+    size_t len = strlen(dir_rel) + strlen(name) + 2;
+    char *out = (char *)malloc(len);
+    if (!out) return NULL;
+    if (dir_rel[0] == '\0') snprintf(out, len, "%s", name);
+    else snprintf(out, len, "%s/%s", dir_rel, name);
+    return out;
+}
+
+// FNV-1a 64bit
+static unsigned long hash_str(const char *str) {
+    uint64_t h = 1469598103934665603ULL;
+    while (*str) {
+        h ^= (unsigned char)*str++;
+        h *= 1099511628211ULL;
+    }
+    return (unsigned long)h;
+}
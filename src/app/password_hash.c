@@ -0,0 +1,129 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/random.h>
+#include <openssl/evp.h>
+#include <openssl/crypto.h>
+
+#include "app/password_hash.h"
+#include "app/hmac_keyring.h"
+
+#define HASH_PREFIX     "$scrypt$"
+#define SALT_BYTES      16
+#define SALT_CHARS      22      // 16바이트의 base64url 길이
+#define KEY_BYTES       32
+#define KEY_CHARS       43      // 32바이트의 base64url 길이
+
+#define DEFAULT_LOG2_N  14
+#define DEFAULT_R       8
+#define DEFAULT_P       1
+
+// 내부 전역 변수 (init 이후 읽기 전용)
+static int g_log2_n = DEFAULT_LOG2_N;
+static int g_r = DEFAULT_R;
+static int g_p = DEFAULT_P;
+
+// 내부 헬퍼 함수
+static int derive(const char *password, const uint8_t *salt, int log2_n, int r, int p, uint8_t *out);
+
+int password_hash_init(int log2_n, int r, int p) {
+    if (log2_n < 10 || log2_n > 22 || r < 1 || r > 32 || p < 1 || p > 16) {
+        fprintf(stderr, "[Password] Invalid scrypt cost (ln=%d r=%d p=%d), using ln=%d r=%d p=%d.\n",
+                log2_n, r, p, DEFAULT_LOG2_N, DEFAULT_R, DEFAULT_P);
+        g_log2_n = DEFAULT_LOG2_N;
+        g_r = DEFAULT_R;
+        g_p = DEFAULT_P;
+        return -1;
+    }
+
+    g_log2_n = log2_n;
+    g_r = r;
+    g_p = p;
+    printf("[Password] scrypt N=2^%d r=%d p=%d (%zu KB per hash).\n",
+           log2_n, r, p, ((size_t)128 * r << log2_n) / 1024);
+    return 0;
+}
+
+int password_hash(const char *password, char *out, size_t out_len) {
+    uint8_t salt[SALT_BYTES];
+    uint8_t key[KEY_BYTES];
+    if (getrandom(salt, sizeof(salt), 0) != (ssize_t)sizeof(salt)) {
+        perror("[Password] getrandom failed");
+        return -1;
+    }
+    if (derive(password, salt, g_log2_n, g_r, g_p, key) != 0) return -1;
+
+    char salt_b64[SALT_CHARS + 1];
+    char key_b64[KEY_CHARS + 1];
+    b64url_encode(salt, sizeof(salt), salt_b64);
+    b64url_encode(key, sizeof(key), key_b64);
+    OPENSSL_cleanse(key, sizeof(key));
+
+    int n = snprintf(out, out_len, HASH_PREFIX "%d$%d$%d$%s$%s", g_log2_n, g_r, g_p, salt_b64, key_b64);
+    return (n > 0 && (size_t)n < out_len) ? 0 : -1;
+}
+
+int password_verify(const char *password, const char *stored, int *needs_rehash) {
+    if (needs_rehash) *needs_rehash = 0;
+
+    if (!stored) {
+        // 없는 사용자: 같은 비용을 치르고 실패
+        uint8_t salt[SALT_BYTES] = {0};
+        uint8_t key[KEY_BYTES];
+        derive(password, salt, g_log2_n, g_r, g_p, key);
+        return -1;
+    }
+
+    if (strncmp(stored, HASH_PREFIX, sizeof(HASH_PREFIX) - 1) != 0) {
+        // 이전 버전이 저장한 평문 -> 맞으면 호출자가 해시로 교체
+        size_t len = strlen(password);
+        if (len != strlen(stored) || CRYPTO_memcmp(password, stored, len) != 0) return -1;
+        if (needs_rehash) *needs_rehash = 1;
+        return 0;
+    }
+
+    int log2_n, r, p, consumed = 0;
+    const char *fields = stored + sizeof(HASH_PREFIX) - 1;
+    if (sscanf(fields, "%d$%d$%d$%n", &log2_n, &r, &p, &consumed) != 3 || consumed == 0) return -1;
+    if (log2_n < 1 || log2_n > 30 || r < 1 || p < 1) return -1;
+
+    const char *salt_b64 = fields + consumed;
+    const char *key_b64 = strchr(salt_b64, '$');
+    if (!key_b64 || key_b64 - salt_b64 != SALT_CHARS) return -1;
+    key_b64++;
+    if (strlen(key_b64) != KEY_CHARS) return -1;
+
+    uint8_t salt[SALT_BYTES];
+    uint8_t expected[KEY_BYTES];
+    uint8_t actual[KEY_BYTES];
+    if (b64url_decode(salt_b64, SALT_CHARS, salt, sizeof(salt)) != 0 ||
+        b64url_decode(key_b64, KEY_CHARS, expected, sizeof(expected)) != 0) {
+        return -1;
+    }
+    if (derive(password, salt, log2_n, r, p, actual) != 0) return -1;
+
+    int rc = (CRYPTO_memcmp(expected, actual, KEY_BYTES) == 0) ? 0 : -1;
+    OPENSSL_cleanse(actual, sizeof(actual));
+
+    if (rc == 0 && needs_rehash && (log2_n != g_log2_n || r != g_r || p != g_p)) *needs_rehash = 1;
+    return rc;
+}
+
+// =========================================================
+// 내부 헬퍼
+// =========================================================
+
+static int derive(const char *password, const uint8_t *salt, int log2_n, int r, int p, uint8_t *out) {
+    uint64_t n = (uint64_t)1 << log2_n;
+    // OpenSSL 기본 상한(32MB)으로는 큰 비용을 못 쓰므로 필요한 만큼 + 여유
+    uint64_t maxmem = (uint64_t)128 * (uint64_t)r * (n + (uint64_t)p + 2) + (1u << 20);
+
+    if (EVP_PBE_scrypt(password, strlen(password), salt, SALT_BYTES,
+                       n, (uint64_t)r, (uint64_t)p, maxmem, out, KEY_BYTES) != 1) {
+        fprintf(stderr, "[Password] scrypt failed (ln=%d r=%d p=%d).\n", log2_n, r, p);
+        return -1;
+    }
+    return 0;
+}
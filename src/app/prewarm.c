@@ -0,0 +1,249 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "app/prewarm.h"
+#include "app/db_handler.h"
+#include "app/library_scanner.h"
+
+#define PREWARM_PATH_LEN    1024
+#define WINDOW_DAYS         7                   // 순위 집계 대상 기간
+#define EDGE_BYTES          (2LL * 1024 * 1024) // 파일 앞/뒤 (ftyp, moov)
+#define RESUME_BEFORE       (512LL * 1024)      // 이어보기 위치 앞 (키프레임 탐색 여유)
+#define RESUME_AFTER        (4LL * 1024 * 1024) // 이어보기 위치 뒤 (첫 Range 요청들)
+
+// 프리웜 대상 비디오 1건 (이어보기 위치 여러 개)
+typedef struct {
+    char url[PREWARM_PATH_LEN];
+    int duration;
+    int *positions;
+    int n_positions;
+    int cap_positions;
+} Target;
+
+typedef struct {
+    Target *items;
+    int count;
+    int cap;
+    int last_video_id;
+} TargetList;
+
+// 읽을 구간
+typedef struct {
+    long long start;
+    long long end;  // exclusive
+} Range;
+
+// 내부 전역 변수
+static pthread_t g_thread;
+static bool g_started = false;
+static bool g_stop = false;
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cond = PTHREAD_COND_INITIALIZER;
+static int g_top_n = 0;
+static long long g_budget = 0;
+static int g_interval = 0;
+
+// 내부 헬퍼 함수
+static void* prewarm_thread_func(void *arg);
+static void run_prewarm(void);
+static void collect_target_cb(int video_id, const char *filepath, int duration, int last_pos, void *arg);
+static long long prewarm_file(const Target *t, long long budget_left);
+static int compare_range(const void *a, const void *b);
+
+int prewarm_start(int top_n, int budget_mb, int interval_sec) {
+    if (top_n <= 0 || budget_mb <= 0) {
+        printf("[Prewarm] Disabled.\n");
+        return -1;
+    }
+
+    g_top_n = top_n;
+    g_budget = (long long)budget_mb * 1024 * 1024;
+    g_interval = interval_sec;
+    g_stop = false;
+
+    if (pthread_create(&g_thread, NULL, prewarm_thread_func, NULL) != 0) {
+        perror("[Prewarm] Failed to create thread");
+        return -1;
+    }
+    g_started = true;
+    return 0;
+}
+
+void prewarm_shutdown(void) {
+    if (!g_started) return;
+
+    pthread_mutex_lock(&g_mutex);
+    g_stop = true;
+    pthread_cond_signal(&g_cond);
+    pthread_mutex_unlock(&g_mutex);
+
+    pthread_join(g_thread, NULL);
+    g_started = false;
+}
+
+static void* prewarm_thread_func(void *arg) {
+    (void)arg;
+
+    while (1) {
+        run_prewarm();
+        if (g_interval <= 0) break;
+
+        pthread_mutex_lock(&g_mutex);
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_sec += g_interval;
+        while (!g_stop) {
+            if (pthread_cond_timedwait(&g_cond, &g_mutex, &until) != 0) break; // 타임아웃
+        }
+        bool stop = g_stop;
+        pthread_mutex_unlock(&g_mutex);
+        if (stop) break;
+    }
+    return NULL;
+}
+
+static void run_prewarm(void) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    TargetList list = {0};
+    list.last_video_id = -1;
+    if (db_for_each_prewarm_target(WINDOW_DAYS, g_top_n, collect_target_cb, &list) != 0) {
+        fprintf(stderr, "[Prewarm] Failed to rank videos.\n");
+    }
+
+    long long used = 0;
+    int warmed = 0;
+    for (int i = 0; i < list.count && used < g_budget && !g_stop; i++) {
+        long long n = prewarm_file(&list.items[i], g_budget - used);
+        if (n > 0) {
+            used += n;
+            warmed++;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (list.count > 0) {
+        printf("[Prewarm] %d/%d videos, %lld MB (%.1f ms)\n", warmed, list.count,
+               used / (1024 * 1024),
+               (t1.tv_sec - t0.tv_sec) * 1000.0 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+    }
+
+    for (int i = 0; i < list.count; i++) free(list.items[i].positions);
+    free(list.items);
+}
+
+// 같은 비디오의 행은 연속으로 옴 -> 비디오가 바뀔 때만 새 항목
+static void collect_target_cb(int video_id, const char *filepath, int duration, int last_pos, void *arg) {
+    TargetList *list = (TargetList *)arg;
+    if (!filepath) return;
+
+    if (video_id != list->last_video_id) {
+        if (list->count == list->cap) {
+            int new_cap = list->cap ? list->cap * 2 : 32;
+            Target *grown = (Target *)realloc(list->items, sizeof(Target) * new_cap);
+            if (!grown) return;
+            list->items = grown;
+            list->cap = new_cap;
+        }
+        Target *t = &list->items[list->count++];
+        memset(t, 0, sizeof(*t));
+        snprintf(t->url, sizeof(t->url), "%s", filepath);
+        t->duration = duration;
+        list->last_video_id = video_id;
+    }
+
+    Target *t = &list->items[list->count - 1];
+    if (last_pos <= 0) return;
+
+    if (t->n_positions == t->cap_positions) {
+        int new_cap = t->cap_positions ? t->cap_positions * 2 : 8;
+        int *grown = (int *)realloc(t->positions, sizeof(int) * new_cap);
+        if (!grown) return;
+        t->positions = grown;
+        t->cap_positions = new_cap;
+    }
+    t->positions[t->n_positions++] = last_pos;
+}
+
+// 앞/뒤 + 이어보기 위치 주변 구간을 합쳐 readahead. 실제로 요청한 바이트 수 반환
+static long long prewarm_file(const Target *t, long long budget_left) {
+    char path[PREWARM_PATH_LEN];
+    if (library_resolve_url(t->url, path, sizeof(path)) < 0) return 0;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return 0;
+    }
+    long long size = st.st_size;
+
+    int max_ranges = 2 + t->n_positions;
+    Range *ranges = (Range *)malloc(sizeof(Range) * max_ranges);
+    if (!ranges) {
+        close(fd);
+        return 0;
+    }
+
+    int n = 0;
+    ranges[n++] = (Range){0, EDGE_BYTES};
+    ranges[n++] = (Range){size - EDGE_BYTES, size};
+
+    // 재생 위치(초) -> 바이트 오프셋 (평균 비트레이트 가정)
+    if (t->duration > 0) {
+        for (int i = 0; i < t->n_positions; i++) {
+            long long off = (long long)((double)t->positions[i] / t->duration * size);
+            ranges[n++] = (Range){off - RESUME_BEFORE, off + RESUME_AFTER};
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (ranges[i].start < 0) ranges[i].start = 0;
+        if (ranges[i].end > size) ranges[i].end = size;
+    }
+
+    // 겹치는 구간 병합 (여러 시청자가 비슷한 위치에 있는 경우)
+    qsort(ranges, n, sizeof(Range), compare_range);
+    long long used = 0;
+    long long cur_start = ranges[0].start, cur_end = ranges[0].end;
+
+    for (int i = 1; i <= n && used < budget_left; i++) {
+        if (i < n && ranges[i].start <= cur_end) {
+            if (ranges[i].end > cur_end) cur_end = ranges[i].end;
+            continue;
+        }
+
+        long long len = cur_end - cur_start;
+        if (len > budget_left - used) len = budget_left - used;
+        if (len > 0) {
+            readahead(fd, cur_start, (size_t)len);
+            used += len;
+        }
+
+        if (i < n) {
+            cur_start = ranges[i].start;
+            cur_end = ranges[i].end;
+        }
+    }
+
+    free(ranges);
+    close(fd);
+    return used;
+}
+
+static int compare_range(const void *a, const void *b) {
+    long long sa = ((const Range *)a)->start;
+    long long sb = ((const Range *)b)->start;
+    return (sa > sb) - (sa < sb);
+}
@@ -0,0 +1,482 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "app/search_index.h"
+
+#define MAX_TOKEN_BYTES     64      // 더 긴 단어는 코드포인트 경계에서 자름
+#define MAX_QUERY_TOKENS    8
+#define MAX_DOC_WORDS       255     // 제목 하나에서 위치를 세는 단어 수 상한
+
+#define SCORE_EXACT         100
+#define SCORE_PREFIX        60
+#define SCORE_FIRST_WORD    15
+
+// 용어 (바이트 순 정렬). 게시 목록 = postings[post_off .. 다음 용어의 post_off)
+typedef struct {
+    uint32_t text_off;
+    uint32_t len;
+    uint32_t post_off;
+} Term;
+
+// 게시 항목. 용어 안에서는 rank 오름차순 = 이 용어만으로 얻는 점수 내림차순 (조기 종료용)
+typedef struct {
+    uint32_t doc;
+    uint32_t rank;          // 초성 여부 << 16 | 단어 위치 << 8 | min(문서 토큰 수, 63), 문서에서 가장 좋은 출현
+} Posting;
+
+// 문서의 토큰 (점수 계산과 두 번째 이후 검색어 확인에 사용)
+typedef struct {
+    uint32_t term;
+    uint8_t pos;            // 제목 안에서 몇 번째 단어인지
+    uint8_t choseong;       // 초성 용어면 1
+} DocToken;
+
+struct SearchIndex {
+    int doc_count;
+    uint32_t term_count;
+    Term *terms;            // term_count + 1 (마지막은 post_off 경계용)
+    char *text;             // 용어 문자열 (중복 없음, NULL 종료 없음)
+    Posting *postings;
+    uint32_t *doc_tok_off;  // doc_count + 1
+    DocToken *doc_tokens;
+    size_t bytes;
+};
+
+// 빌드 중 임시 토큰
+typedef struct {
+    const char *text;
+    uint32_t text_off;
+    uint32_t len;
+    uint32_t doc;
+    uint8_t pos;
+    uint8_t choseong;
+} RawToken;
+
+typedef struct {
+    RawToken *toks;
+    size_t count;
+    size_t cap;
+    char *arena;
+    size_t arena_len;
+    size_t arena_cap;
+    uint32_t doc;
+    int failed;
+} BuildState;
+
+typedef struct {
+    char text[MAX_QUERY_TOKENS][MAX_TOKEN_BYTES];
+    uint32_t len[MAX_QUERY_TOKENS];
+    uint32_t lo[MAX_QUERY_TOKENS];
+    uint32_t hi[MAX_QUERY_TOKENS];
+    int count;
+} QueryTokens;
+
+// 한글 음절 초성 -> 호환용 자모 (ㄱ ㄲ ㄴ ㄷ ㄸ ㄹ ㅁ ㅂ ㅃ ㅅ ㅆ ㅇ ㅈ ㅉ ㅊ ㅋ ㅌ ㅍ ㅎ)
+static const uint32_t CHOSEONG[19] = {
+    0x3131, 0x3132, 0x3134, 0x3137, 0x3138, 0x3139, 0x3141, 0x3142, 0x3143, 0x3145,
+    0x3146, 0x3147, 0x3148, 0x3149, 0x314A, 0x314B, 0x314C, 0x314D, 0x314E
+};
+
+typedef void (*TokenFn)(const char *tok, size_t len, int pos, int choseong, void *arg);
+
+// 내부 헬퍼 함수
+static void tokenize(const char *s, TokenFn fn, void *arg);
+static void build_token_cb(const char *tok, size_t len, int pos, int choseong, void *arg);
+static void query_token_cb(const char *tok, size_t len, int pos, int choseong, void *arg);
+static int raw_token_cmp(const void *a, const void *b);
+static int posting_cmp(const void *a, const void *b);
+static uint32_t term_bound(const SearchIndex *idx, const char *q, uint32_t qlen, int upper);
+static int score_doc(const SearchIndex *idx, uint32_t doc, const QueryTokens *qt);
+
+// 검색 단어 하나가 제목 단어 하나와 맞았을 때의 점수
+static inline int token_score(int base, int choseong, int pos) {
+    int s = choseong ? base * 6 / 10 : base;
+    return s + ((pos == 0) ? SCORE_FIRST_WORD : (pos < 8 ? 8 - pos : 0));
+}
+
+static inline int is_hangul_syllable(uint32_t cp) {
+    return cp >= 0xAC00 && cp <= 0xD7A3;
+}
+
+static int is_word_cp(uint32_t cp) {
+    if (cp < 0x80) {
+        return (cp >= '0' && cp <= '9') || (cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z');
+    }
+    if (cp <= 0xBF || cp == 0xD7 || cp == 0xF7) return 0;      // C1 제어, Latin-1 기호
+    if (cp >= 0x2000 && cp <= 0x206F) return 0;                 // 일반 구두점
+    if (cp >= 0x3000 && cp <= 0x303F) return 0;                 // CJK 기호 (「」、。 등)
+    if (cp >= 0xFE30 && cp <= 0xFE4F) return 0;
+    if ((cp >= 0xFF00 && cp <= 0xFF0F) || (cp >= 0xFF1A && cp <= 0xFF20) ||
+        (cp >= 0xFF3B && cp <= 0xFF40) || (cp >= 0xFF5B && cp <= 0xFF65)) return 0; // 전각 기호
+    if (cp == 0xFFFD) return 0;                                 // 잘못된 UTF-8
+    return 1;
+}
+
+static uint32_t decode_utf8(const unsigned char **pp) {
+    const unsigned char *p = *pp;
+    uint32_t cp;
+    int extra;
+    if (p[0] < 0x80) { cp = p[0]; extra = 0; }
+    else if ((p[0] & 0xE0) == 0xC0) { cp = p[0] & 0x1F; extra = 1; }
+    else if ((p[0] & 0xF0) == 0xE0) { cp = p[0] & 0x0F; extra = 2; }
+    else if ((p[0] & 0xF8) == 0xF0) { cp = p[0] & 0x07; extra = 3; }
+    else { *pp = p + 1; return 0xFFFD; }
+
+    for (int i = 1; i <= extra; i++) {
+        if ((p[i] & 0xC0) != 0x80) { *pp = p + 1; return 0xFFFD; }
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    *pp = p + 1 + extra;
+    return cp;
+}
+
+static int encode_utf8(uint32_t cp, char *out) {
+    if (cp < 0x80) { out[0] = (char)cp; return 1; }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+SearchIndex* search_index_build(const char *const *titles, int count) {
+    if (count < 0) return NULL;
+
+    BuildState st = {0};
+    for (int i = 0; i < count && !st.failed; i++) {
+        st.doc = (uint32_t)i;
+        tokenize(titles[i] ? titles[i] : "", build_token_cb, &st);
+    }
+
+    SearchIndex *idx = (SearchIndex *)calloc(1, sizeof(SearchIndex));
+    uint32_t *doc_fill = (uint32_t *)calloc((size_t)count + 1, sizeof(uint32_t));
+    if (st.failed || !idx || !doc_fill) goto fail;
+
+    // 아레나가 다 자란 뒤에 포인터로 바꿔 정렬
+    for (size_t i = 0; i < st.count; i++) st.toks[i].text = st.arena + st.toks[i].text_off;
+    qsort(st.toks, st.count, sizeof(RawToken), raw_token_cmp);
+
+    idx->doc_count = count;
+    idx->terms = (Term *)malloc((st.count + 1) * sizeof(Term));
+    idx->text = (char *)malloc(st.arena_len + 1);
+    idx->postings = (Posting *)malloc((st.count + 1) * sizeof(Posting));
+    idx->doc_tok_off = (uint32_t *)calloc((size_t)count + 1, sizeof(uint32_t));
+    idx->doc_tokens = (DocToken *)malloc((st.count + 1) * sizeof(DocToken));
+    if (!idx->terms || !idx->text || !idx->postings || !idx->doc_tok_off || !idx->doc_tokens) goto fail;
+
+    // 문서별 토큰 위치 (계수 정렬)
+    for (size_t i = 0; i < st.count; i++) idx->doc_tok_off[st.toks[i].doc + 1]++;
+    for (int d = 0; d < count; d++) idx->doc_tok_off[d + 1] += idx->doc_tok_off[d];
+
+    // 정렬된 토큰을 훑어 중복 없는 용어 + 게시 목록
+    uint32_t n_terms = 0, n_post = 0, text_len = 0;
+    for (size_t i = 0; i < st.count; i++) {
+        const RawToken *t = &st.toks[i];
+        int new_term = (i == 0) || t->len != st.toks[i - 1].len ||
+                       memcmp(t->text, st.toks[i - 1].text, t->len) != 0;
+        if (new_term) {
+            Term *term = &idx->terms[n_terms++];
+            term->text_off = text_len;
+            term->len = t->len;
+            term->post_off = n_post;
+            memcpy(idx->text + text_len, t->text, t->len);
+            text_len += t->len;
+        }
+        // 같은 용어 안에서 (문서, 초성 여부, 위치) 순이므로 문서마다 첫 출현이 가장 좋은 출현
+        if (new_term || t->doc != st.toks[i - 1].doc) {
+            uint32_t tok_count = idx->doc_tok_off[t->doc + 1] - idx->doc_tok_off[t->doc];
+            Posting *post = &idx->postings[n_post++];
+            post->doc = t->doc;
+            post->rank = ((uint32_t)t->choseong << 16) | ((uint32_t)t->pos << 8) | (tok_count < 63 ? tok_count : 63);
+        }
+
+        DocToken *dt = &idx->doc_tokens[idx->doc_tok_off[t->doc] + doc_fill[t->doc]++];
+        dt->term = n_terms - 1;
+        dt->pos = t->pos;
+        dt->choseong = t->choseong;
+    }
+    idx->terms[n_terms].post_off = n_post;
+    idx->term_count = n_terms;
+
+    // 용어별 게시 목록을 점수 순으로 (조회 시 상위 결과가 다 차면 나머지를 보지 않음)
+    for (uint32_t i = 0; i < n_terms; i++) {
+        uint32_t off = idx->terms[i].post_off;
+        qsort(idx->postings + off, idx->terms[i + 1].post_off - off, sizeof(Posting), posting_cmp);
+    }
+
+    idx->bytes = sizeof(SearchIndex) + (n_terms + 1) * sizeof(Term) + text_len +
+                 n_post * sizeof(Posting) + ((size_t)count + 1) * sizeof(uint32_t) +
+                 st.count * sizeof(DocToken);
+
+    free(doc_fill);
+    free(st.toks);
+    free(st.arena);
+    return idx;
+
+fail:
+    fprintf(stderr, "[Search] Failed to build index (%d titles).\n", count);
+    free(doc_fill);
+    free(st.toks);
+    free(st.arena);
+    search_index_free(idx);
+    return NULL;
+}
+
+int search_index_query(const SearchIndex *idx, const char *query, int *out_docs, int max_results) {
+    if (!idx || !query || max_results <= 0 || idx->doc_count == 0) return 0;
+
+    QueryTokens qt;
+    qt.count = 0;
+    tokenize(query, query_token_cb, &qt);
+    if (qt.count == 0) return 0;
+
+    // 검색어마다 접두어 용어 범위, 게시 목록이 가장 짧은 단어가 후보를 만듦
+    int driver = 0;
+    uint32_t driver_size = UINT32_MAX;
+    for (int i = 0; i < qt.count; i++) {
+        qt.lo[i] = term_bound(idx, qt.text[i], qt.len[i], 0);
+        qt.hi[i] = term_bound(idx, qt.text[i], qt.len[i], 1);
+        if (qt.lo[i] == qt.hi[i]) return 0; // 이 단어로 시작하는 용어가 없음
+        uint32_t size = idx->terms[qt.hi[i]].post_off - idx->terms[qt.lo[i]].post_off;
+        if (size < driver_size) {
+            driver_size = size;
+            driver = i;
+        }
+    }
+
+    int *scores = (int *)malloc((size_t)max_results * sizeof(int));
+    if (!scores) return 0;
+
+    // 후보: 가장 희귀한 단어의 접두어 범위에 속한 용어들의 게시 목록
+    int other_max = (qt.count - 1) * (SCORE_EXACT + SCORE_FIRST_WORD);
+    int n = 0;
+    for (uint32_t term = qt.lo[driver]; term < qt.hi[driver]; term++) {
+        int base = (idx->terms[term].len == qt.len[driver]) ? SCORE_EXACT : SCORE_PREFIX;
+        uint32_t end = idx->terms[term + 1].post_off;
+
+        for (uint32_t p = idx->terms[term].post_off; p < end; p++) {
+            const Posting *post = &idx->postings[p];
+            // 점수 상한 (뒤 항목은 이 항목 이하) -> 상위 목록에 못 들어가면 이 용어는 끝
+            int bound = (token_score(base, (int)(post->rank >> 16), (int)((post->rank >> 8) & 0xFF)) + other_max) * 64 -
+                        (int)(post->rank & 0x3F);
+            if (n == max_results && bound < scores[n - 1]) break;
+
+            // 접두어 범위의 다른 용어로 이미 본 문서 (점수가 같으므로 목록에 없으면 다시 봐도 탈락)
+            int doc = (int)post->doc;
+            int dup = 0;
+            for (int i = 0; i < n && !dup; i++) dup = (out_docs[i] == doc);
+            if (dup) continue;
+
+            int score = score_doc(idx, post->doc, &qt);
+            if (score < 0) continue;
+
+            // 상위 max_results개만 유지 (점수 내림차순, 같으면 문서 번호 오름차순)
+            if (n == max_results &&
+                (score < scores[n - 1] || (score == scores[n - 1] && doc > out_docs[n - 1]))) {
+                continue;
+            }
+            int at = (n < max_results) ? n++ : n - 1;
+            while (at > 0 && (scores[at - 1] < score || (scores[at - 1] == score && out_docs[at - 1] > doc))) {
+                scores[at] = scores[at - 1];
+                out_docs[at] = out_docs[at - 1];
+                at--;
+            }
+            scores[at] = score;
+            out_docs[at] = doc;
+        }
+    }
+
+    free(scores);
+    return n;
+}
+
+size_t search_index_memory(const SearchIndex *idx) {
+    return idx ? idx->bytes : 0;
+}
+
+void search_index_free(SearchIndex *idx) {
+    if (!idx) return;
+    free(idx->terms);
+    free(idx->text);
+    free(idx->postings);
+    free(idx->doc_tok_off);
+    free(idx->doc_tokens);
+    free(idx);
+}
+
+// =========================================================
+// 내부 헬퍼
+// =========================================================
+
+// 단어마다 fn(소문자 단어) 호출, 한글이 섞인 단어는 fn(초성 문자열)도 호출
+static void tokenize(const char *s, TokenFn fn, void *arg) {
+    const unsigned char *p = (const unsigned char *)s;
+    int pos = 0;
+
+    while (*p) {
+        const unsigned char *before = p;
+        uint32_t cp = decode_utf8(&p);
+        if (!is_word_cp(cp)) continue;
+
+        char word[MAX_TOKEN_BYTES];
+        char cho[MAX_TOKEN_BYTES];
+        size_t wlen = 0, clen = 0;
+        int has_hangul = 0;
+        int full = 0;
+
+        p = before;
+        while (*p) {
+            const unsigned char *start = p;
+            cp = decode_utf8(&p);
+            if (!is_word_cp(cp)) {
+                p = start;
+                break;
+            }
+            if (cp >= 'A' && cp <= 'Z') cp += 'a' - 'A';
+
+            char buf[4];
+            int n = encode_utf8(cp, buf);
+            if (full || wlen + (size_t)n > sizeof(word)) { // 너무 긴 단어는 앞부분만
+                full = 1;
+                continue;
+            }
+
+            memcpy(word + wlen, buf, (size_t)n);
+            wlen += (size_t)n;
+
+            uint32_t ccp = cp;
+            if (is_hangul_syllable(cp)) {
+                ccp = CHOSEONG[(cp - 0xAC00) / 588];
+                has_hangul = 1;
+            }
+            int cn = encode_utf8(ccp, buf);
+            if (clen + (size_t)cn <= sizeof(cho)) {
+                memcpy(cho + clen, buf, (size_t)cn);
+                clen += (size_t)cn;
+            }
+        }
+
+        fn(word, wlen, pos, 0, arg);
+        if (has_hangul) fn(cho, clen, pos, 1, arg);
+        if (pos < MAX_DOC_WORDS) pos++;
+    }
+}
+
+static void build_token_cb(const char *tok, size_t len, int pos, int choseong, void *arg) {
+    BuildState *st = (BuildState *)arg;
+    if (st->failed) return;
+
+    if (st->count == st->cap) {
+        size_t new_cap = st->cap ? st->cap * 2 : 1024;
+        RawToken *grown = (RawToken *)realloc(st->toks, new_cap * sizeof(RawToken));
+        if (!grown) {
+            st->failed = 1;
+            return;
+        }
+        st->toks = grown;
+        st->cap = new_cap;
+    }
+    if (st->arena_len + len > st->arena_cap) {
+        size_t new_cap = st->arena_cap ? st->arena_cap * 2 : 16384;
+        while (st->arena_len + len > new_cap) new_cap *= 2;
+        char *grown = (char *)realloc(st->arena, new_cap);
+        if (!grown) {
+            st->failed = 1;
+            return;
+        }
+        st->arena = grown;
+        st->arena_cap = new_cap;
+    }
+
+    RawToken *t = &st->toks[st->count++];
+    t->text = NULL;
+    t->text_off = (uint32_t)st->arena_len;
+    t->len = (uint32_t)len;
+    t->doc = st->doc;
+    t->pos = (uint8_t)pos;
+    t->choseong = (uint8_t)choseong;
+    memcpy(st->arena + st->arena_len, tok, len);
+    st->arena_len += len;
+}
+
+static void query_token_cb(const char *tok, size_t len, int pos, int choseong, void *arg) {
+    (void)pos;
+    QueryTokens *qt = (QueryTokens *)arg;
+    // 검색어의 초성 변환은 쓰지 않음 (사용자가 초성으로 치면 그 자체가 초성 용어와 맞음)
+    if (choseong || qt->count >= MAX_QUERY_TOKENS || len == 0) return;
+    memcpy(qt->text[qt->count], tok, len);
+    qt->len[qt->count] = (uint32_t)len;
+    qt->count++;
+}
+
+static int raw_token_cmp(const void *a, const void *b) {
+    const RawToken *x = (const RawToken *)a;
+    const RawToken *y = (const RawToken *)b;
+    uint32_t n = (x->len < y->len) ? x->len : y->len;
+    int c = memcmp(x->text, y->text, n);
+    if (c != 0) return c;
+    if (x->len != y->len) return (x->len < y->len) ? -1 : 1;
+    if (x->doc != y->doc) return (x->doc < y->doc) ? -1 : 1;
+    if (x->choseong != y->choseong) return (int)x->choseong - (int)y->choseong;
+    return (int)x->pos - (int)y->pos;
+}
+
+static int posting_cmp(const void *a, const void *b) {
+    const Posting *x = (const Posting *)a;
+    const Posting *y = (const Posting *)b;
+    if (x->rank != y->rank) return (x->rank < y->rank) ? -1 : 1;
+    return (x->doc < y->doc) ? -1 : (x->doc > y->doc);
+}
+
+// upper = 0: q로 시작하거나 q보다 큰 첫 용어, upper = 1: q로 시작하지 않으면서 q보다 큰 첫 용어
+static uint32_t term_bound(const SearchIndex *idx, const char *q, uint32_t qlen, int upper) {
+    uint32_t lo = 0, hi = idx->term_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        const Term *t = &idx->terms[mid];
+        uint32_t n = (t->len < qlen) ? t->len : qlen;
+        int c = memcmp(idx->text + t->text_off, q, n);
+        if (c == 0 && t->len < qlen) c = -1;    // q의 앞부분일 뿐인 더 짧은 용어
+        if (c < 0 || (upper && c == 0)) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// 모든 검색어가 문서 토큰의 접두어로 나오면 점수, 하나라도 없으면 -1
+static int score_doc(const SearchIndex *idx, uint32_t doc, const QueryTokens *qt) {
+    const DocToken *toks = &idx->doc_tokens[idx->doc_tok_off[doc]];
+    uint32_t tok_count = idx->doc_tok_off[doc + 1] - idx->doc_tok_off[doc];
+    int total = 0;
+
+    for (int q = 0; q < qt->count; q++) {
+        int best = 0;
+        for (uint32_t i = 0; i < tok_count; i++) {
+            const DocToken *t = &toks[i];
+            if (t->term < qt->lo[q] || t->term >= qt->hi[q]) continue;
+
+            int base = (idx->terms[t->term].len == qt->len[q]) ? SCORE_EXACT : SCORE_PREFIX;
+            int s = token_score(base, t->choseong, t->pos);
+            if (s > best) best = s;
+        }
+        if (best == 0) return -1;
+        total += best;
+    }
+
+    // 같은 점수면 짧은 제목 우선
+    return total * 64 - (int)(tok_count < 63 ? tok_count : 63);
+}
@@ -0,0 +1,102 @@
+// 제목 검색 색인 벤치마크 (make bench -> build/bin/test/app/search_index_test)
+// 사용법: search_index_test [제목 수=100000] [쿼리당 반복 수=2000]
+// 40개 단어(영문/한글)로 2~6단어짜리 합성 제목을 만들어 색인한 뒤, 빌드 시간/메모리와 쿼리 지연(p50/p99)을 잽니다.
+// 목표: 10만 제목에서 p99 < 1ms
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "app/search_index.h"
+
+#define MAX_RESULTS 20
+
+static const char *const WORDS[] = {
+    "the", "dark", "knight", "아이언맨", "어벤져스", "기생충", "star", "wars", "return", "of",
+    "king", "love", "story", "한국", "영화", "드라마", "episode", "season", "매트릭스", "인터스텔라",
+    "lord", "rings", "harry", "potter", "밤", "바다", "사랑", "전쟁", "city", "night",
+    "blue", "red", "movie", "final", "cut", "part", "첫", "번째", "이야기", "ocean",
+};
+
+// 흔한 단어, 한 글자 접두어, 초성, 여러 단어, 없는 단어를 고루 섞음
+static const char *const QUERIES[] = {
+    "the", "s", "아이", "ㅇㅇㅇㅁ", "dark knight", "star wars 12", "기생",
+    "ㄱㅅㅊ", "lo", "1234", "zzz", "영화 사랑", "a", "e",
+};
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv) {
+    int count = (argc > 1) ? atoi(argv[1]) : 100000;
+    int rounds = (argc > 2) ? atoi(argv[2]) : 2000;
+    if (count < 1 || rounds < 1) {
+        fprintf(stderr, "usage: %s [titles] [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    // 고정 시드로 합성 제목 생성 (끝에 번호를 붙여 모두 다른 제목)
+    int n_words = (int)(sizeof(WORDS) / sizeof(WORDS[0]));
+    char **titles = (char **)malloc((size_t)count * sizeof(char *));
+    if (!titles) return 1;
+    srand(1);
+    for (int i = 0; i < count; i++) {
+        char buf[256];
+        int len = 0;
+        int words = 2 + rand() % 5;
+        for (int j = 0; j < words; j++) {
+            len += snprintf(buf + len, sizeof(buf) - (size_t)len, "%s%s", j ? " " : "", WORDS[rand() % n_words]);
+        }
+        snprintf(buf + len, sizeof(buf) - (size_t)len, " %d", i);
+        titles[i] = strdup(buf);
+        if (!titles[i]) return 1;
+    }
+
+    double start = now_us();
+    SearchIndex *idx = search_index_build((const char *const *)titles, count);
+    if (!idx) return 1;
+    printf("titles=%d build %.1f ms, index %zu KB\n", count, (now_us() - start) / 1e3,
+           search_index_memory(idx) / 1024);
+
+    int n_queries = (int)(sizeof(QUERIES) / sizeof(QUERIES[0]));
+    double *lat = (double *)malloc((size_t)rounds * (size_t)n_queries * sizeof(double));
+    double *worst = (double *)calloc((size_t)n_queries, sizeof(double));
+    if (!lat || !worst) return 1;
+
+    int out[MAX_RESULTS];
+    int samples = 0;
+    for (int r = 0; r < rounds; r++) {
+        for (int q = 0; q < n_queries; q++) {
+            double t = now_us();
+            int found = search_index_query(idx, QUERIES[q], out, MAX_RESULTS);
+            double d = now_us() - t;
+            lat[samples++] = d;
+            if (d > worst[q]) worst[q] = d;
+            if (r == 0) {
+                printf("  %-14s %2d hits, first: %s\n", QUERIES[q], found, found ? titles[out[0]] : "-");
+            }
+        }
+    }
+
+    for (int q = 0; q < n_queries; q++) printf("  %-14s worst %.0f us\n", QUERIES[q], worst[q]);
+    qsort(lat, (size_t)samples, sizeof(double), cmp_double);
+    double p99 = lat[samples * 99 / 100];
+    printf("queries=%d p50 %.1f us, p99 %.1f us, max %.1f us -> %s\n", samples, lat[samples / 2], p99,
+           lat[samples - 1], p99 < 1000.0 ? "OK (p99 < 1ms)" : "SLOW (p99 >= 1ms)");
+
+    search_index_free(idx);
+    for (int i = 0; i < count; i++) free(titles[i]);
+    free(titles);
+    free(lat);
+    free(worst);
+    return p99 < 1000.0 ? 0 : 1;
+}
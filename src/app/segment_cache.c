@@ -0,0 +1,365 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "app/segment_cache.h"
+
+#define HUGEPAGE_SIZE       (2 * 1024 * 1024)
+#define SKETCH_DEPTH        4
+#define SKETCH_MAX_COUNT    15      // 4bit 카운터와 같은 상한
+#define SKETCH_SAMPLE_MULT  10      // width * 10 회 기록마다 전체 카운터 절반으로 (노화)
+#define ADMIT_MIN_FREQ      2       // 빈 슬롯이라도 최소 두 번은 요청된 청크만 입장
+
+typedef enum {
+    SLOT_EMPTY,
+    SLOT_FILLING,   // 디스크에서 읽는 중 (다른 요청에게는 미스)
+    SLOT_READY
+} SlotState;
+
+typedef struct {
+    dev_t dev;
+    ino_t ino;
+    time_t mtime;
+    off_t chunk_idx;
+    uint64_t hash;
+    size_t len;         // 청크의 유효 바이트 수 (파일 끝 청크는 짧음)
+    SlotState state;
+    int refcount;       // 전송 중인 참조 수 (0일 때만 교체 가능)
+    bool referenced;    // CLOCK 참조 비트
+    int next;           // 해시 체인
+} Slot;
+
+// 내부 전역 변수 (모든 메타데이터는 g_lock으로 보호, 청크 데이터는 refcount로 보호)
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static char *g_arena = NULL;
+static size_t g_arena_size = 0;
+static Slot *g_slots = NULL;
+static int g_slot_count = 0;
+static int *g_buckets = NULL;
+static uint64_t g_bucket_mask = 0;
+static int *g_free_slots = NULL;
+static int g_free_count = 0;
+static int g_clock_hand = 0;
+
+static uint8_t *g_sketch = NULL;    // SKETCH_DEPTH x g_sketch_width
+static uint64_t g_sketch_mask = 0;
+static uint64_t g_sketch_additions = 0;
+
+static SegmentCacheStats g_stats;
+
+// 내부 헬퍼 함수
+static uint64_t key_hash(dev_t dev, ino_t ino, time_t mtime, off_t chunk_idx);
+static void sketch_increment(uint64_t hash);
+static int sketch_estimate(uint64_t hash);
+static int index_find(dev_t dev, ino_t ino, time_t mtime, off_t chunk_idx, uint64_t hash);
+static void index_remove(int slot);
+static int clock_pick_victim(void);
+static size_t next_pow2(size_t v);
+
+int segment_cache_init(size_t budget_mb) {
+    if (budget_mb == 0) {
+        printf("[SegCache] Disabled.\n");
+        return -1;
+    }
+
+    // 휴지페이지 경계로 올림
+    size_t size = budget_mb * 1024 * 1024;
+    size = (size + HUGEPAGE_SIZE - 1) & ~((size_t)HUGEPAGE_SIZE - 1);
+
+    // 1. 명시적 휴지페이지 (vm.nr_hugepages 예약이 있어야 성공)
+    void *mem = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mem != MAP_FAILED) {
+        g_stats.hugepages = 1;
+    } else {
+        // 2. 일반 페이지 + THP 힌트
+        mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            perror("[SegCache] mmap failed");
+            return -1;
+        }
+        madvise(mem, size, MADV_HUGEPAGE);
+        g_stats.hugepages = 0;
+    }
+
+    g_arena = (char *)mem;
+    g_arena_size = size;
+    g_slot_count = (int)(size / SEGMENT_CHUNK_SIZE);
+
+    size_t bucket_count = next_pow2((size_t)g_slot_count * 2);
+    size_t sketch_width = next_pow2((size_t)g_slot_count * 8);
+
+    g_slots = (Slot *)calloc(g_slot_count, sizeof(Slot));
+    g_buckets = (int *)malloc(sizeof(int) * bucket_count);
+    g_free_slots = (int *)malloc(sizeof(int) * g_slot_count);
+    g_sketch = (uint8_t *)calloc(SKETCH_DEPTH * sketch_width, 1);
+
+    if (!g_slots || !g_buckets || !g_free_slots || !g_sketch) {
+        fprintf(stderr, "[SegCache] Failed to allocate metadata.\n");
+        segment_cache_cleanup();
+        return -1;
+    }
+
+    for (size_t i = 0; i < bucket_count; i++) g_buckets[i] = -1;
+    g_bucket_mask = bucket_count - 1;
+    g_sketch_mask = sketch_width - 1;
+
+    // 낮은 번호 슬롯부터 쓰이도록 역순으로 쌓음
+    g_free_count = 0;
+    for (int i = g_slot_count - 1; i >= 0; i--) {
+        g_slots[i].state = SLOT_EMPTY;
+        g_slots[i].next = -1;
+        g_free_slots[g_free_count++] = i;
+    }
+
+    g_stats.slots_total = g_slot_count;
+    printf("[SegCache] %zu MB, %d chunks of %d KB (hugepages: %s)\n",
+           size / (1024 * 1024), g_slot_count, SEGMENT_CHUNK_SIZE / 1024,
+           g_stats.hugepages ? "yes" : "no, THP hint");
+    return 0;
+}
+
+int segment_cache_enabled(void) {
+    return g_slots != NULL;
+}
+
+int segment_cache_get(dev_t dev, ino_t ino, time_t mtime, off_t file_size,
+                      int fd, off_t offset, SegmentRef *ref) {
+    if (!g_slots || offset < 0 || offset >= file_size) return -1;
+
+    off_t chunk_idx = offset / SEGMENT_CHUNK_SIZE;
+    off_t chunk_start = chunk_idx * SEGMENT_CHUNK_SIZE;
+    uint64_t hash = key_hash(dev, ino, mtime, chunk_idx);
+
+    pthread_mutex_lock(&g_lock);
+    sketch_increment(hash);
+
+    int slot = index_find(dev, ino, mtime, chunk_idx, hash);
+    if (slot >= 0) {
+        Slot *s = &g_slots[slot];
+        if (s->state == SLOT_READY && chunk_start + (off_t)s->len > offset) {
+            s->refcount++;
+            s->referenced = true;
+            g_stats.hits++;
+            pthread_mutex_unlock(&g_lock);
+
+            ref->slot = slot;
+            ref->data = g_arena + (size_t)slot * SEGMENT_CHUNK_SIZE + (offset - chunk_start);
+            ref->len = s->len - (size_t)(offset - chunk_start);
+            return 0;
+        }
+        // 다른 스레드가 채우는 중 -> 기다리지 않고 sendfile
+        g_stats.misses++;
+        pthread_mutex_unlock(&g_lock);
+        return -1;
+    }
+
+    g_stats.misses++;
+
+    // [입장 결정] TinyLFU: 후보의 빈도가 희생자보다 높을 때만 교체
+    int freq = sketch_estimate(hash);
+    int victim = -1;
+    if (g_free_count > 0) {
+        if (freq >= ADMIT_MIN_FREQ) victim = g_free_slots[--g_free_count];
+    } else {
+        victim = clock_pick_victim();
+        if (victim >= 0 && freq <= sketch_estimate(g_slots[victim].hash)) victim = -1;
+        if (victim >= 0) {
+            index_remove(victim);
+            g_stats.evictions++;
+            g_stats.slots_used--;
+        }
+    }
+
+    if (victim < 0) {
+        g_stats.rejections++;
+        pthread_mutex_unlock(&g_lock);
+        return -1;
+    }
+
+    size_t chunk_len = (size_t)(file_size - chunk_start);
+    if (chunk_len > SEGMENT_CHUNK_SIZE) chunk_len = SEGMENT_CHUNK_SIZE;
+
+    // 채우는 동안에도 인덱스에 올려두어 같은 청크를 중복으로 읽지 않게 함
+    Slot *s = &g_slots[victim];
+    s->dev = dev;
+    s->ino = ino;
+    s->mtime = mtime;
+    s->chunk_idx = chunk_idx;
+    s->hash = hash;
+    s->len = chunk_len;
+    s->state = SLOT_FILLING;
+    s->refcount = 1;
+    s->referenced = true;
+    uint64_t b = hash & g_bucket_mask;
+    s->next = g_buckets[b];
+    g_buckets[b] = victim;
+    g_stats.admissions++;
+    g_stats.slots_used++;
+    pthread_mutex_unlock(&g_lock);
+
+    // 디스크 읽기는 락 밖에서 (FILLING 슬롯은 refcount로 보호됨)
+    char *dst = g_arena + (size_t)victim * SEGMENT_CHUNK_SIZE;
+    size_t done = 0;
+    while (done < chunk_len) {
+        ssize_t n = pread(fd, dst + done, chunk_len - done, chunk_start + (off_t)done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += (size_t)n;
+    }
+
+    pthread_mutex_lock(&g_lock);
+    if (done < chunk_len) {
+        // 읽기 실패 (파일이 잘렸거나 I/O 오류) -> 슬롯 반납
+        index_remove(victim);
+        s->state = SLOT_EMPTY;
+        s->refcount = 0;
+        g_free_slots[g_free_count++] = victim;
+        g_stats.admissions--;
+        g_stats.slots_used--;
+        pthread_mutex_unlock(&g_lock);
+        return -1;
+    }
+    s->state = SLOT_READY;
+    pthread_mutex_unlock(&g_lock);
+
+    ref->slot = victim;
+    ref->data = dst + (offset - chunk_start);
+    ref->len = chunk_len - (size_t)(offset - chunk_start);
+    return 0;
+}
+
+void segment_cache_release(SegmentRef *ref, size_t bytes_sent) {
+    if (!ref || ref->slot < 0) return;
+
+    pthread_mutex_lock(&g_lock);
+    g_slots[ref->slot].refcount--;
+    g_stats.bytes_from_ram += bytes_sent;
+    pthread_mutex_unlock(&g_lock);
+
+    ref->slot = -1;
+    ref->data = NULL;
+    ref->len = 0;
+}
+
+void segment_cache_get_stats(SegmentCacheStats *out) {
+    pthread_mutex_lock(&g_lock);
+    *out = g_stats;
+    pthread_mutex_unlock(&g_lock);
+}
+
+void segment_cache_cleanup(void) {
+    if (g_arena) munmap(g_arena, g_arena_size);
+    free(g_slots);
+    free(g_buckets);
+    free(g_free_slots);
+    free(g_sketch);
+
+    g_arena = NULL;
+    g_arena_size = 0;
+    g_slots = NULL;
+    g_buckets = NULL;
+    g_free_slots = NULL;
+    g_sketch = NULL;
+    g_slot_count = 0;
+    g_free_count = 0;
+}
+
+// =========================================================
+// 내부 헬퍼
+// =========================================================
+
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+static uint64_t key_hash(dev_t dev, ino_t ino, time_t mtime, off_t chunk_idx) {
+    uint64_t h = mix64((uint64_t)dev ^ 0x9e3779b97f4a7c15ULL);
+    h = mix64(h ^ (uint64_t)ino);
+    h = mix64(h ^ (uint64_t)mtime);
+    return mix64(h ^ (uint64_t)chunk_idx);
+}
+
+// Count-Min Sketch: 행마다 다른 위치 (double hashing)
+static void sketch_increment(uint64_t hash) {
+    uint64_t h2 = (hash >> 32) | 1;
+    for (int i = 0; i < SKETCH_DEPTH; i++) {
+        uint8_t *c = &g_sketch[i * (g_sketch_mask + 1) + ((hash + i * h2) & g_sketch_mask)];
+        if (*c < SKETCH_MAX_COUNT) (*c)++;
+    }
+
+    // 노화: 과거 인기도가 영원히 남지 않도록 주기적으로 절반
+    if (++g_sketch_additions >= (g_sketch_mask + 1) * SKETCH_SAMPLE_MULT) {
+        size_t total = SKETCH_DEPTH * (g_sketch_mask + 1);
+        for (size_t i = 0; i < total; i++) g_sketch[i] >>= 1;
+        g_sketch_additions /= 2;
+    }
+}
+
+static int sketch_estimate(uint64_t hash) {
+    uint64_t h2 = (hash >> 32) | 1;
+    int min = SKETCH_MAX_COUNT;
+    for (int i = 0; i < SKETCH_DEPTH; i++) {
+        int c = g_sketch[i * (g_sketch_mask + 1) + ((hash + i * h2) & g_sketch_mask)];
+        if (c < min) min = c;
+    }
+    return min;
+}
+
+static int index_find(dev_t dev, ino_t ino, time_t mtime, off_t chunk_idx, uint64_t hash) {
+    for (int i = g_buckets[hash & g_bucket_mask]; i >= 0; i = g_slots[i].next) {
+        Slot *s = &g_slots[i];
+        if (s->hash == hash && s->chunk_idx == chunk_idx && s->ino == ino &&
+            s->dev == dev && s->mtime == mtime) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void index_remove(int slot) {
+    int *link = &g_buckets[g_slots[slot].hash & g_bucket_mask];
+    while (*link >= 0) {
+        if (*link == slot) {
+            *link = g_slots[slot].next;
+            break;
+        }
+        link = &g_slots[*link].next;
+    }
+    g_slots[slot].next = -1;
+}
+
+// CLOCK: 참조 비트가 켜진 슬롯은 한 번 봐주고, 전송 중인 슬롯은 건너뜀
+static int clock_pick_victim(void) {
+    for (int step = 0; step < g_slot_count * 2; step++) {
+        int i = g_clock_hand;
+        g_clock_hand = (g_clock_hand + 1) % g_slot_count;
+
+        Slot *s = &g_slots[i];
+        if (s->state != SLOT_READY || s->refcount > 0) continue;
+        if (s->referenced) {
+            s->referenced = false;
+            continue;
+        }
+        return i;
+    }
+    return -1;
+}
+
+static size_t next_pow2(size_t v) {
+    size_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
@@ -2,204 +2,931 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <time.h>
 #include <pthread.h>
 #include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/random.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "app/session_manager.h"
-
-typedef struct SessionNode {
-    char session_id[SESSION_ID_LENGTH]; // Key (32 bytes + NULL)
-    int user_id;                         // Value
-    time_t last_accessed;               // Expiry Check용
-    struct SessionNode *next;           // Collision 처리용 (Chaining)
-} SessionNode;
+#include "app/session_token.h"
+#include "core/logger.h"
+#include "core/metrics.h"
+
+#define SESSION_SHARD_COUNT     16  // 2의 거듭제곱 (해시 하위 비트로 샤드 선택)
+#define INITIAL_SHARD_SLOTS     256 // 샤드당 초기 슬롯 수 (2의 거듭제곱)
+#define MAX_LOAD_PERCENT        85  // 사용률이 이를 넘으면 슬롯 배열 2배 확장
+#define SWEEP_TICK_MS           100 // 청소 스레드 주기
+#define SWEEP_SLOTS_PER_TICK    1024 // 한 번 락을 잡을 때 검사하는 슬롯 수 (샤드당)
+#define EVICT_SAMPLE_NODES      16  // 상한 초과 시 비교할 후보 수 (근사 LRU)
+#define SESSION_KEY_BYTES       16  // 32자리 hex ID를 디코딩한 바이너리 키
+#define SNAPSHOT_MAGIC          "OTTSESS"
+#define SNAPSHOT_VERSION        1
+#define SNAPSHOT_PATH_LEN       1024
+#define SHM_MAGIC               "OTTSHM1"
+#define SHM_VERSION             1
+#define SHM_ATTACH_WAIT_MS      5000 // 다른 프로세스가 세그먼트를 초기화하는 동안 기다리는 시간
+
+// 열린 주소법 슬롯 (32바이트, 캐시 라인 하나에 2개)
+typedef struct {
+    uint8_t key[SESSION_KEY_BYTES];     // 바이너리 세션 ID
+    uint32_t tag;                       // 해시 상위 32비트 (키 비교 전 빠른 거름)
+    int32_t user_id;                    // Value
+    uint32_t last_accessed;             // Expiry Check용 (읽기 락 아래에서 relaxed atomic으로 갱신)
+    uint16_t dist;                      // 홈 슬롯으로부터의 거리 + 1 (0이면 빈 슬롯)
+    uint16_t reserved;
+} SessionSlot;
+
+// 샤드마다 독립된 슬롯 배열과 락. 조회(대부분)는 읽기 락만 잡음
+// shm 모드에서는 구조체 전체가 공유 메모리에 있고 락은 프로세스 공유 robust 뮤텍스를 사용
+typedef struct {
+    pthread_rwlock_t lock;
+    pthread_mutex_t shm_lock;           // shm 모드 전용
+    SessionSlot *slots;                 // Robin Hood 해시 테이블 (세션당 malloc 없음)
+    size_t slots_offset;                // shm 모드: 세그먼트 시작부터 슬롯 배열까지 (주소는 프로세스마다 다름)
+    size_t slot_count;                  // 슬롯 수 (2의 거듭제곱)
+    size_t node_count;
+    size_t sweep_cursor;                // 다음 청소를 시작할 슬롯
+    unsigned long long created;         // 아래 카운터는 쓰기 락 아래에서 갱신
+    unsigned long long expired;
+    unsigned long long evicted;
+    char pad[64];                       // 이웃 샤드의 락과 캐시 라인 공유 방지
+} SessionShard;
 
 typedef struct {
-    SessionNode **buckets;              // 노드 포인터 배열 (Bucket)
-    int bucket_count;                   // 버킷 크기
-    pthread_mutex_t mutex;              // Thread-safe 확보
+    SessionShard shards[SESSION_SHARD_COUNT];
 } SessionTable;
 
+// 공유 메모리 세그먼트 형식: 헤더 + SessionTable + 샤드별 고정 크기 슬롯 배열
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t shard_count;
+    uint64_t slots_per_shard;
+    uint64_t total_bytes;
+    uint32_t ready;                     // 만든 프로세스가 초기화를 마치면 1 (release)
+    uint32_t reserved;
+} ShmHeader;
+
+// 스냅샷 파일 형식: 헤더 + 엔트리 배열 (리틀 엔디언, 같은 호스트에서만 읽음)
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint32_t saved_at;
+    uint32_t reserved;
+} SnapshotHeader;
+
+typedef struct {
+    uint8_t key[SESSION_KEY_BYTES];
+    int32_t user_id;
+    uint32_t last_accessed;
+} SnapshotEntry;
+
 // 내부 전역 변수
 static SessionTable *g_session_table = NULL;
-static const int HASH_TABLE_SIZE = 1024; // 버킷 수
+static int g_token_mode = 0;            // 1이면 테이블 없이 서명 토큰으로 동작
+static char *g_shm_base = NULL;         // shm 모드면 매핑된 세그먼트 시작 (아니면 NULL)
+static size_t g_shm_size = 0;
+static int g_shm_created = 0;           // 이 프로세스가 세그먼트를 새로 만들었는지
+static size_t g_max_per_shard = 0;      // 0이면 상한 없음
+static pthread_t g_sweeper;
+static int g_sweeper_started = 0;
+static int g_sweeper_stop = 0;
+static pthread_mutex_t g_sweeper_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_sweeper_cond = PTHREAD_COND_INITIALIZER;
+static char g_snapshot_path[SNAPSHOT_PATH_LEN] = {0};  // 비어 있으면 스냅샷 비활성
+static int g_snapshot_interval = 0;
+static unsigned long long g_restored = 0;
 
 // 내부 헬퍼 함수
-static unsigned long hash_djb2(const char *str); // DJB2 해시 함수: 문자열을 인덱스 정수로 변환
-static void generate_session_id(char *buf, size_t len); // 무작위 세션 ID 생성
+static uint64_t hash_key(const uint8_t *key); // 바이너리 키 -> 비트 섞기
+static int generate_session_key(uint8_t *key); // 무작위 세션 키 생성
+static int decode_session_id(const char *session_id, uint8_t *key); // 32자리 hex -> 16바이트
+static void encode_session_id(const uint8_t *key, char *out); // 16바이트 -> 32자리 hex
+static long find_slot(const SessionShard *shard, uint64_t h, const uint8_t *key);
+static void insert_slot(SessionShard *shard, SessionSlot entry);
+static void remove_slot(SessionShard *shard, size_t idx);
+static void maybe_grow(SessionShard *shard);
+static void evict_one(SessionShard *shard, size_t start_slot);
+static void sweep_shard(SessionShard *shard, uint32_t now);
+static void* sweeper_thread_func(void *arg);
+static int snapshot_save(void);
+static int snapshot_restore(const char *path);
+static int shm_attach(const char *name, size_t max_per_shard);
+static void repair_shard(SessionShard *shard);
+static double sessions_gauge(void *arg);
+
+static inline SessionSlot* shard_slots(const SessionShard *shard) {
+    return g_shm_base ? (SessionSlot *)(g_shm_base + shard->slots_offset) : shard->slots;
+}
 
-int session_system_init(void) {
-    // 테이블 본체 할당
-    g_session_table = (SessionTable *)malloc(sizeof(SessionTable));
-    if (!g_session_table) return -1;
+// 다른 프로세스가 락을 잡은 채 죽었으면 슬롯 배열이 옮기는 중간일 수 있으므로 재구성 후 사용
+static inline void shm_lock(SessionShard *shard) {
+    if (pthread_mutex_lock(&shard->shm_lock) == EOWNERDEAD) {
+        fprintf(stderr, "[Session] Lock owner died, repairing shard.\n");
+        repair_shard(shard);
+        pthread_mutex_consistent(&shard->shm_lock);
+    }
+}
 
-    // 버킷 배열 할당 (전부 NULL로 초기화)
-    g_session_table->buckets = (SessionNode **)calloc(HASH_TABLE_SIZE, sizeof(SessionNode *));
-    if (!g_session_table->buckets) {
-        free(g_session_table);
-        return -1;
+static inline void shard_read_lock(SessionShard *shard) {
+    if (g_shm_base) shm_lock(shard);
+    else pthread_rwlock_rdlock(&shard->lock);
+}
+
+static inline void shard_write_lock(SessionShard *shard) {
+    if (g_shm_base) shm_lock(shard);
+    else pthread_rwlock_wrlock(&shard->lock);
+}
+
+static inline void shard_unlock(SessionShard *shard) {
+    if (g_shm_base) pthread_mutex_unlock(&shard->shm_lock);
+    else pthread_rwlock_unlock(&shard->lock);
+}
+
+static inline SessionShard* shard_for(uint64_t h) {
+    return &g_session_table->shards[h & (SESSION_SHARD_COUNT - 1)];
+}
+
+// 샤드 선택에 쓴 하위 비트는 제외하고 홈 슬롯 계산
+static inline size_t home_slot(size_t slot_count, uint64_t h) {
+    return (size_t)(h >> 4) & (slot_count - 1);
+}
+
+static inline int key_equal(const uint8_t *a, const uint8_t *b) {
+#ifdef __SSE2__
+    __m128i va = _mm_loadu_si128((const __m128i *)a);
+    __m128i vb = _mm_loadu_si128((const __m128i *)b);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) == 0xFFFF;
+#else
+    return memcmp(a, b, SESSION_KEY_BYTES) == 0;
+#endif
+}
+
+static inline uint32_t now_sec(void) {
+    return (uint32_t)time(NULL);
+}
+
+// 부호 있는 차이로 비교 (다른 스레드가 방금 더 큰 값을 기록했어도 만료로 보지 않음)
+static inline int is_expired(uint32_t now, uint32_t last) {
+    return (int32_t)(now - last) > SESSION_TTL_SEC;
+}
+
+int session_system_init(const char *mode, int max_sessions, int revoke_capacity, const char *shm_name) {
+    // 토큰 모드: 공유 상태 없이 서명만 검증 (테이블/청소 스레드 불필요)
+    g_token_mode = (mode && strcmp(mode, "token") == 0);
+    if (g_token_mode) {
+        return session_token_init(revoke_capacity);
     }
 
-    g_session_table->bucket_count = HASH_TABLE_SIZE;
+    // 상한은 샤드별로 나눠 적용 (샤드 락 하나만으로 퇴출 결정)
+    g_max_per_shard = (max_sessions > 0)
+        ? ((size_t)max_sessions + SESSION_SHARD_COUNT - 1) / SESSION_SHARD_COUNT : 0;
 
-    // Mutex 초기화
-    if (pthread_mutex_init(&g_session_table->mutex, NULL) != 0) {
-        free(g_session_table->buckets);
-        free(g_session_table);
-        return -1;
+    if (mode && strcmp(mode, "shm") == 0) {
+        // 공유 메모리 슬롯 배열은 늘릴 수 없으므로 상한이 크기를 정함
+        if (!g_max_per_shard) {
+            fprintf(stderr, "[Session] SESSION_MODE=shm needs SESSION_MAX_COUNT > 0.\n");
+            return -1;
+        }
+        if (shm_attach(shm_name, g_max_per_shard) != 0) return -1;
+        goto start_sweeper;
+    }
+    if (mode && mode[0] && strcmp(mode, "table") != 0) {
+        fprintf(stderr, "[Session] Unknown SESSION_MODE '%s', using table.\n", mode);
     }
 
-    // 난수 생성을 위한 시드 초기화 (세션 ID 생성용)
-    srand((unsigned int)time(NULL));
+    // 테이블 본체 할당
+    g_session_table = (SessionTable *)calloc(1, sizeof(SessionTable));
+    if (!g_session_table) return -1;
+
+    for (int i = 0; i < SESSION_SHARD_COUNT; i++) {
+        SessionShard *shard = &g_session_table->shards[i];
 
-    printf("[Session] System initialized with %d buckets.\n", HASH_TABLE_SIZE);
+        // 슬롯 배열 할당 (전부 빈 슬롯으로 초기화)
+        shard->slots = (SessionSlot *)calloc(INITIAL_SHARD_SLOTS, sizeof(SessionSlot));
+        if (!shard->slots || pthread_rwlock_init(&shard->lock, NULL) != 0) {
+            free(shard->slots);
+            for (int j = 0; j < i; j++) {
+                free(g_session_table->shards[j].slots);
+                pthread_rwlock_destroy(&g_session_table->shards[j].lock);
+            }
+            free(g_session_table);
+            g_session_table = NULL;
+            return -1;
+        }
+        shard->slot_count = INITIAL_SHARD_SLOTS;
+    }
+    printf("[Session] System initialized with %d shards x %d slots, max %d sessions.\n",
+           SESSION_SHARD_COUNT, INITIAL_SHARD_SLOTS, max_sessions);
+
+start_sweeper:
+    metrics_register_gauge("ott_sessions", "", "Sessions in the session table", sessions_gauge, NULL);
+
+    // shm 모드에서는 프로세스마다 청소 스레드가 돌지만 샤드 락으로 직렬화되므로 무해
+    g_sweeper_stop = 0;
+    if (pthread_create(&g_sweeper, NULL, sweeper_thread_func, NULL) == 0) {
+        g_sweeper_started = 1;
+    } else {
+        perror("[Session] Failed to start sweeper (expired sessions reclaimed on lookup only)");
+    }
     return 0;
 }
 
-static unsigned long hash_djb2(const char *str) {
-    unsigned long hash = 5381;
-    int c;
-    while ((c = *str++))
-        hash = ((hash << 5) + hash) + c; // hash * 33 + c
+static uint64_t hash_key(const uint8_t *key) {
+    uint64_t lo, hi;
+    memcpy(&lo, key, 8);
+    memcpy(&hi, key + 8, 8);
+
+    // 저장되는 키는 무작위지만 조회 키는 클라이언트가 보내므로 섞어서 분산
+    uint64_t hash = lo ^ (hi * 0x9e3779b97f4a7c15ULL);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
     return hash;
 }
-static void generate_session_id(char *buf, size_t len) {
-    static const char charset[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
-    for (size_t i = 0; i < len - 1; i++) {
-        int key = rand() % (int)(sizeof(charset) - 1);
-        buf[i] = charset[key];
+
+static int generate_session_key(uint8_t *key) {
+    size_t got = 0;
+    while (got < SESSION_KEY_BYTES) {
+        ssize_t n = getrandom(key + got, SESSION_KEY_BYTES - got, 0);
+        if (n < 0) return -1;
+        got += (size_t)n;
+    }
+    return 0;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static int decode_session_id(const char *session_id, uint8_t *key) {
+    for (int i = 0; i < SESSION_KEY_BYTES; i++) {
+        int hi = hex_value(session_id[i * 2]);
+        if (hi < 0) return -1;
+        int lo = hex_value(session_id[i * 2 + 1]);
+        if (lo < 0) return -1;
+        key[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return session_id[SESSION_KEY_BYTES * 2] == '\0' ? 0 : -1;
+}
+
+static void encode_session_id(const uint8_t *key, char *out) {
+    static const char digits[] = "0123456789abcdef";
+    for (int i = 0; i < SESSION_KEY_BYTES; i++) {
+        out[i * 2] = digits[key[i] >> 4];
+        out[i * 2 + 1] = digits[key[i] & 0x0F];
+    }
+    out[SESSION_KEY_BYTES * 2] = '\0';
+}
+
+// 호출자가 샤드 락(읽기 또는 쓰기)을 잡고 있어야 함. 슬롯 인덱스 또는 -1
+static long find_slot(const SessionShard *shard, uint64_t h, const uint8_t *key) {
+    size_t mask = shard->slot_count - 1;
+    size_t idx = home_slot(shard->slot_count, h);
+    uint32_t tag = (uint32_t)(h >> 32);
+
+    // Robin Hood 불변식: 거리가 현재 탐색 거리보다 짧은 슬롯을 만나면 더 뒤에는 없음
+    for (uint32_t dist = 1; ; dist++, idx = (idx + 1) & mask) {
+        const SessionSlot *slot = &shard_slots(shard)[idx];
+        if (slot->dist < dist) return -1;
+        if (slot->tag == tag && key_equal(slot->key, key)) return (long)idx;
+    }
+}
+
+// 쓰기 락을 잡은 상태에서 호출. 빈 슬롯이 있어야 함
+static void insert_slot(SessionShard *shard, SessionSlot entry) {
+    size_t mask = shard->slot_count - 1;
+    size_t idx = home_slot(shard->slot_count, hash_key(entry.key));
+    entry.dist = 1;
+
+    while (1) {
+        SessionSlot *slot = &shard_slots(shard)[idx];
+        if (slot->dist == 0) {
+            *slot = entry;
+            return;
+        }
+        // 홈에서 더 가까운 항목의 자리를 빼앗고, 그 항목을 계속 밀어냄
+        if (slot->dist < entry.dist) {
+            SessionSlot displaced = *slot;
+            *slot = entry;
+            entry = displaced;
+        }
+        entry.dist++;
+        idx = (idx + 1) & mask;
+    }
+}
+
+// 쓰기 락을 잡은 상태에서 호출. 뒤따르는 항목을 한 칸씩 당김 (tombstone 없음)
+static void remove_slot(SessionShard *shard, size_t idx) {
+    size_t mask = shard->slot_count - 1;
+    size_t next = (idx + 1) & mask;
+
+    while (shard_slots(shard)[next].dist > 1) {
+        shard_slots(shard)[idx] = shard_slots(shard)[next];
+        shard_slots(shard)[idx].dist--;
+        idx = next;
+        next = (next + 1) & mask;
+    }
+    memset(&shard_slots(shard)[idx], 0, sizeof(SessionSlot));
+    shard->node_count--;
+}
+
+// 쓰기 락을 잡은 상태에서 호출. 사용률을 넘으면 슬롯 배열을 2배로 재배치
+static void maybe_grow(SessionShard *shard) {
+    if (g_shm_base) return; // 공유 메모리 슬롯 배열은 고정 크기
+    if ((shard->node_count + 1) * 100 <= shard->slot_count * MAX_LOAD_PERCENT) return;
+
+    size_t old_count = shard->slot_count;
+    SessionSlot *old_slots = shard->slots;
+    SessionSlot *new_slots = (SessionSlot *)calloc(old_count * 2, sizeof(SessionSlot));
+    if (!new_slots) return; // 확장 실패 시 탐색이 길어질 뿐 동작은 유지
+
+    shard->slots = new_slots;
+    shard->slot_count = old_count * 2;
+    for (size_t i = 0; i < old_count; i++) {
+        if (old_slots[i].dist) insert_slot(shard, old_slots[i]);
     }
-    buf[len - 1] = '\0';
+    free(old_slots);
 }
 
 int session_create(int user_id, char *out_buf, size_t buf_len) {
+    if (g_token_mode) return session_token_issue(user_id, SESSION_TTL_SEC, out_buf, buf_len);
     if (!g_session_table || buf_len < SESSION_ID_LENGTH) return -1;
 
-    // 세션 노드 생성 및 초기화
-    SessionNode *new_node = (SessionNode *)malloc(sizeof(SessionNode));
-    if (!new_node) return -1;
-
-    generate_session_id(new_node->session_id, SESSION_ID_LENGTH);
-    new_node->user_id = user_id;
-    new_node->last_accessed = time(NULL);
-    new_node->next = NULL;
+    // 세션 슬롯 값 준비
+    SessionSlot entry;
+    memset(&entry, 0, sizeof(entry));
+    if (generate_session_key(entry.key) != 0) {
+        LOG_ERROR("Session", "getrandom failed: %m");
+        return -1;
+    }
+    entry.user_id = user_id;
+    entry.last_accessed = now_sec();
 
     // 해시 계산
-    unsigned long h = hash_djb2(new_node->session_id);
-    int bucket_idx = h % g_session_table->bucket_count;
+    uint64_t h = hash_key(entry.key);
+    entry.tag = (uint32_t)(h >> 32);
+    SessionShard *shard = shard_for(h);
+
+    // 임계 영역 (Critical Section): 해당 샤드만 잠금
+    shard_write_lock(shard);
 
-    // 임계 영역 (Critical Section): 해시 테이블 조작
-    pthread_mutex_lock(&g_session_table->mutex);
-    
-    // 리스트 맨 앞에 삽입 (O(1))
-    new_node->next = g_session_table->buckets[bucket_idx];
-    g_session_table->buckets[bucket_idx] = new_node;
+    if (g_max_per_shard && shard->node_count >= g_max_per_shard) {
+        evict_one(shard, (size_t)(h >> 24));
+    }
+    maybe_grow(shard);
+    if (shard->node_count + 1 >= shard->slot_count) {
+        // 확장에 실패해 빈 슬롯이 없는 경우
+        shard_unlock(shard);
+        return -1;
+    }
+    insert_slot(shard, entry);
+    shard->node_count++;
+    shard->created++;
 
-    pthread_mutex_unlock(&g_session_table->mutex);
+    shard_unlock(shard);
 
     // 생성된 ID 반환
-    strncpy(out_buf, new_node->session_id, buf_len);
-    
-    printf("[Session] Created: ID=%s for User=%d at Bucket[%d]\n", 
-            new_node->session_id, user_id, bucket_idx);
-            
+    encode_session_id(entry.key, out_buf);
+
+    // 세션 ID는 로그에 남기지 않음 (로그 파일만으로 로그인을 가로챌 수 있으므로)
+    LOG_DEBUG("Session", "Created for user %d at shard %d", user_id, (int)(h & (SESSION_SHARD_COUNT - 1)));
+
     return 0;
 }
 
 int session_get_user(const char *session_id) {
+    if (g_token_mode) return session_token_verify(session_id);
     if (!g_session_table || !session_id) return -1;
 
-    // 1. 해시 계산 및 버킷 특정
-    unsigned long h = hash_djb2(session_id);
-    int bucket_idx = h % g_session_table->bucket_count;
-    
-    time_t now = time(NULL);
+    // 1. 디코딩 (형식이 맞지 않으면 테이블을 볼 필요도 없음) 및 샤드 특정
+    uint8_t key[SESSION_KEY_BYTES];
+    if (decode_session_id(session_id, key) != 0) return -1;
+    uint64_t h = hash_key(key);
+    SessionShard *shard = shard_for(h);
+
+    uint32_t now = now_sec();
     int found_user_id = -1;
+    int expired = 0;
+
+    // 2. 읽기 락: 같은 샤드의 조회끼리는 서로 막지 않음
+    shard_read_lock(shard);
+
+    long idx = find_slot(shard, h, key);
+    if (idx >= 0) {
+        SessionSlot *slot = &shard_slots(shard)[idx];
+        uint32_t last = __atomic_load_n(&slot->last_accessed, __ATOMIC_RELAXED);
+        if (is_expired(now, last)) {
+            expired = 1; // 삭제는 쓰기 락에서
+        } else {
+            // 유효함 -> 마지막 접근 시간 갱신 (Sliding Window)
+            // 같은 초 안의 반복 요청은 쓰지 않아 캐시 라인 공유를 줄임
+            if (last != now) __atomic_store_n(&slot->last_accessed, now, __ATOMIC_RELAXED);
+            found_user_id = slot->user_id;
+        }
+    }
 
-    // 2. 임계 영역 시작
-    pthread_mutex_lock(&g_session_table->mutex);
-
-    SessionNode *curr = g_session_table->buckets[bucket_idx];
-    SessionNode *prev = NULL;
-
-    while (curr) {
-        if (strcmp(curr->session_id, session_id) == 0) {
-            // [검증] 만료 여부 확인
-            if (now - curr->last_accessed > SESSION_TTL_SEC) {
-                // 만료됨 -> 리스트에서 연결 끊기 및 메모리 해제
-                if (prev) prev->next = curr->next;
-                else g_session_table->buckets[bucket_idx] = curr->next;
-
-                free(curr);
-                printf("[Session] Expired and removed: %s\n", session_id);
-                // found_user_id는 -1 유지
-            } else {
-                // 유효함 -> 마지막 접근 시간 갱신 (Sliding Window)
-                curr->last_accessed = now;
-                found_user_id = curr->user_id;
-            }
-            break; // 찾았으므로 루프 탈출
+    shard_unlock(shard);
+
+    if (expired) {
+        // 락을 놓은 사이 다른 요청이 갱신/삭제했을 수 있으므로 다시 확인
+        shard_write_lock(shard);
+        idx = find_slot(shard, h, key);
+        if (idx >= 0 && is_expired(now, shard_slots(shard)[idx].last_accessed)) {
+            // 만료됨 -> 슬롯 비우기
+            remove_slot(shard, (size_t)idx);
+            shard->expired++;
+            LOG_DEBUG("Session", "Expired session removed");
         }
-        prev = curr;
-        curr = curr->next;
+        shard_unlock(shard);
     }
 
-    pthread_mutex_unlock(&g_session_table->mutex);
     return found_user_id;
 }
 
 void session_remove(const char *session_id) {
+    if (g_token_mode) {
+        if (session_id) session_token_revoke(session_id);
+        return;
+    }
     if (!g_session_table || !session_id) return;
 
-    unsigned long h = hash_djb2(session_id);
-    int bucket_idx = h % g_session_table->bucket_count;
+    uint8_t key[SESSION_KEY_BYTES];
+    if (decode_session_id(session_id, key) != 0) return;
+    uint64_t h = hash_key(key);
+    SessionShard *shard = shard_for(h);
+
+    shard_write_lock(shard);
+
+    long idx = find_slot(shard, h, key);
+    if (idx >= 0) {
+        remove_slot(shard, (size_t)idx);
+        LOG_DEBUG("Session", "Session removed");
+    }
 
-    pthread_mutex_lock(&g_session_table->mutex);
+    shard_unlock(shard);
+}
 
-    SessionNode *curr = g_session_table->buckets[bucket_idx];
-    SessionNode *prev = NULL;
+int session_persist_init(const char *path, int interval_sec) {
+    if (g_token_mode || !g_session_table || !path || !path[0]) return -1;
 
-    while (curr) {
-        if (strcmp(curr->session_id, session_id) == 0) {
-            // [연결 끊기] 
-            if (prev) prev->next = curr->next;
-            else g_session_table->buckets[bucket_idx] = curr->next;
+    snprintf(g_snapshot_path, sizeof(g_snapshot_path), "%s", path);
+    g_snapshot_interval = interval_sec;
 
-            free(curr);
-            printf("[Session] Manually removed: %s\n", session_id);
-            break;
-        }
-        prev = curr;
-        curr = curr->next;
+    // 이미 있던 공유 세그먼트에 붙었다면 다른 프로세스가 채워 둔 세션이 더 최신
+    if (g_shm_base && !g_shm_created) return 0;
+    return snapshot_restore(g_snapshot_path);
+}
+
+// 수집 스레드에서 호출 (샤드 읽기 락만 잠깐 잡음)
+static double sessions_gauge(void *arg) {
+    (void)arg;
+    SessionStats stats;
+    session_get_stats(&stats);
+    return (double)stats.live;
+}
+
+void session_get_stats(SessionStats *out) {
+    memset(out, 0, sizeof(*out));
+    out->token_mode = g_token_mode;
+    out->shm_mode = (g_shm_base != NULL);
+    if (g_token_mode) {
+        out->revoked = session_token_revoked_count();
+        return;
     }
+    if (!g_session_table) return;
 
-    pthread_mutex_unlock(&g_session_table->mutex);
+    for (int s = 0; s < SESSION_SHARD_COUNT; s++) {
+        SessionShard *shard = &g_session_table->shards[s];
+        shard_read_lock(shard);
+        out->live += shard->node_count;
+        out->created += shard->created;
+        out->expired += shard->expired;
+        out->evicted += shard->evicted;
+        out->table_bytes += shard->slot_count * sizeof(SessionSlot);
+        shard_unlock(shard);
+    }
+    out->max_sessions = g_max_per_shard * SESSION_SHARD_COUNT;
+    out->restored = g_restored;
 }
 
 void session_system_cleanup(void) {
+    if (g_token_mode) {
+        session_token_cleanup();
+        g_token_mode = 0;
+        printf("[Session] System cleaned up and resources freed.\n");
+        return;
+    }
     if (!g_session_table) return;
 
-    pthread_mutex_lock(&g_session_table->mutex);
+    if (g_sweeper_started) {
+        pthread_mutex_lock(&g_sweeper_mutex);
+        g_sweeper_stop = 1;
+        pthread_cond_signal(&g_sweeper_cond);
+        pthread_mutex_unlock(&g_sweeper_mutex);
+        pthread_join(g_sweeper, NULL);
+        g_sweeper_started = 0;
+    }
+
+    // 종료 직전 상태를 남겨 재시작 후에도 로그인 유지
+    if (g_snapshot_path[0]) snapshot_save();
 
-    // 1. 모든 버킷을 순회하며 노드들 삭제
-    for (int i = 0; i < g_session_table->bucket_count; i++) {
-        SessionNode *curr = g_session_table->buckets[i];
-        while (curr) {
-            SessionNode *temp = curr;
-            curr = curr->next;
-            free(temp); // 개별 노드 해제
-        }
+    if (g_shm_base) {
+        // 다른 프로세스가 계속 쓰므로 매핑만 해제 (세그먼트와 락은 그대로 남김)
+        munmap(g_shm_base, g_shm_size);
+        g_shm_base = NULL;
+        g_session_table = NULL;
+        printf("[Session] Detached from shared session segment.\n");
+        return;
     }
 
-    // 2. 버킷 배열 및 테이블 본체 해제
-    free(g_session_table->buckets);
-    
-    // Mutex 해제를 위해 Lock 해제 후 Destroy
-    pthread_mutex_unlock(&g_session_table->mutex);
-    pthread_mutex_destroy(&g_session_table->mutex);
+    for (int s = 0; s < SESSION_SHARD_COUNT; s++) {
+        SessionShard *shard = &g_session_table->shards[s];
+        shard_write_lock(shard);
+
+        // 슬롯 배열만 해제하면 됨 (세션별 할당 없음)
+        free(shard->slots);
+        shard->slots = NULL;
+        shard_unlock(shard);
+        pthread_rwlock_destroy(&shard->lock);
+    }
 
     free(g_session_table);
     g_session_table = NULL;
 
     printf("[Session] System cleaned up and resources freed.\n");
-}
\ No newline at end of file
+}
+
+// 쓰기 락을 잡은 상태에서 호출.
+// 임의 위치부터 후보 몇 개를 모아 가장 오래 접근되지 않은 세션을 퇴출
+static void evict_one(SessionShard *shard, size_t start_slot) {
+    long victim = -1;
+    int sampled = 0;
+
+    for (size_t n = 0; n < shard->slot_count && sampled < EVICT_SAMPLE_NODES; n++) {
+        size_t idx = (start_slot + n) & (shard->slot_count - 1);
+        const SessionSlot *slot = &shard_slots(shard)[idx];
+        if (slot->dist == 0) continue;
+        sampled++;
+        if (victim < 0 || slot->last_accessed < shard_slots(shard)[victim].last_accessed) {
+            victim = (long)idx;
+        }
+    }
+
+    if (victim >= 0) {
+        remove_slot(shard, (size_t)victim);
+        shard->evicted++;
+    }
+}
+
+// 커서 위치부터 슬롯 몇 개만 검사해 만료된 세션 회수 (락 보유 시간을 짧게 유지)
+static void sweep_shard(SessionShard *shard, uint32_t now) {
+    shard_write_lock(shard);
+
+    size_t idx = shard->sweep_cursor;
+    if (idx >= shard->slot_count) idx = 0; // 확장 후 범위 보정
+
+    for (int n = 0; n < SWEEP_SLOTS_PER_TICK; n++) {
+        SessionSlot *slot = &shard_slots(shard)[idx];
+        if (slot->dist && is_expired(now, slot->last_accessed)) {
+            // 뒤 항목이 이 자리로 당겨지므로 같은 인덱스를 다시 검사
+            remove_slot(shard, idx);
+            shard->expired++;
+            continue;
+        }
+        idx = (idx + 1) & (shard->slot_count - 1);
+        if (idx == 0) break; // 한 바퀴 끝 (다음 틱에 처음부터)
+    }
+    shard->sweep_cursor = idx;
+
+    shard_unlock(shard);
+}
+
+static void* sweeper_thread_func(void *arg) {
+    (void)arg;
+    uint32_t last_snapshot = now_sec();
+
+    while (1) {
+        uint32_t now = now_sec();
+        for (int s = 0; s < SESSION_SHARD_COUNT; s++) {
+            sweep_shard(&g_session_table->shards[s], now);
+        }
+
+        if (g_snapshot_path[0] && g_snapshot_interval > 0 &&
+            (int32_t)(now - last_snapshot) >= g_snapshot_interval) {
+            snapshot_save();
+            last_snapshot = now;
+        }
+
+        pthread_mutex_lock(&g_sweeper_mutex);
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_nsec += SWEEP_TICK_MS * 1000000L;
+        if (until.tv_nsec >= 1000000000L) {
+            until.tv_sec++;
+            until.tv_nsec -= 1000000000L;
+        }
+        while (!g_sweeper_stop) {
+            if (pthread_cond_timedwait(&g_sweeper_cond, &g_sweeper_mutex, &until) != 0) break;
+        }
+        int stop = g_sweeper_stop;
+        pthread_mutex_unlock(&g_sweeper_mutex);
+        if (stop) break;
+    }
+    return NULL;
+}
+
+// 샤드마다 읽기 락을 잠깐 잡고 복사한 뒤, 파일 쓰기는 락 밖에서 (tmp -> fsync -> rename)
+static int snapshot_save(void) {
+    size_t cap = 1024, count = 0;
+    SnapshotEntry *entries = (SnapshotEntry *)malloc(cap * sizeof(SnapshotEntry));
+    if (!entries) return -1;
+
+    for (int s = 0; s < SESSION_SHARD_COUNT; s++) {
+        SessionShard *shard = &g_session_table->shards[s];
+        shard_read_lock(shard);
+
+        if (count + shard->node_count > cap) {
+            size_t new_cap = cap;
+            while (count + shard->node_count > new_cap) new_cap *= 2;
+            SnapshotEntry *grown = (SnapshotEntry *)realloc(entries, new_cap * sizeof(SnapshotEntry));
+            if (!grown) {
+                shard_unlock(shard);
+                free(entries);
+                return -1;
+            }
+            entries = grown;
+            cap = new_cap;
+        }
+
+        for (size_t i = 0; i < shard->slot_count; i++) {
+            const SessionSlot *slot = &shard_slots(shard)[i];
+            if (!slot->dist) continue;
+            SnapshotEntry *e = &entries[count++];
+            memcpy(e->key, slot->key, SESSION_KEY_BYTES);
+            e->user_id = slot->user_id;
+            e->last_accessed = __atomic_load_n(&slot->last_accessed, __ATOMIC_RELAXED);
+        }
+        shard_unlock(shard);
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.count = (uint32_t)count;
+    header.saved_at = now_sec();
+
+    char tmp_path[SNAPSHOT_PATH_LEN + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", g_snapshot_path);
+
+    // 세션 키가 들어 있으므로 소유자만 읽을 수 있게
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        perror("[Session] Failed to open snapshot");
+        free(entries);
+        return -1;
+    }
+
+    int ok = write(fd, &header, sizeof(header)) == (ssize_t)sizeof(header);
+    size_t bytes = count * sizeof(SnapshotEntry);
+    const char *p = (const char *)entries;
+    while (ok && bytes > 0) {
+        ssize_t n = write(fd, p, bytes);
+        if (n <= 0) {
+            ok = 0;
+            break;
+        }
+        p += n;
+        bytes -= (size_t)n;
+    }
+    if (ok && fsync(fd) != 0) ok = 0;
+    close(fd);
+    free(entries);
+
+    if (!ok || rename(tmp_path, g_snapshot_path) != 0) {
+        perror("[Session] Failed to write snapshot");
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+// mmap으로 읽어 만료되지 않은 세션만 테이블에 넣음 (청소 스레드가 이미 돌고 있으므로 샤드 락 사용)
+static int snapshot_restore(const char *path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0; // 첫 기동
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader)) {
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("[Session] Failed to map snapshot");
+        return -1;
+    }
+
+    const SnapshotHeader *header = (const SnapshotHeader *)map;
+    size_t expected = sizeof(SnapshotHeader) + (size_t)header->count * sizeof(SnapshotEntry);
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        header->version != SNAPSHOT_VERSION || (size_t)st.st_size != expected) {
+        fprintf(stderr, "[Session] Ignoring invalid snapshot %s\n", path);
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+
+    const SnapshotEntry *entries = (const SnapshotEntry *)(header + 1);
+    uint32_t now = now_sec();
+    unsigned long long restored = 0, skipped = 0;
+
+    for (uint32_t i = 0; i < header->count; i++) {
+        const SnapshotEntry *e = &entries[i];
+        if (is_expired(now, e->last_accessed)) {
+            skipped++;
+            continue;
+        }
+
+        SessionSlot entry;
+        memset(&entry, 0, sizeof(entry));
+        memcpy(entry.key, e->key, SESSION_KEY_BYTES);
+        entry.user_id = e->user_id;
+        entry.last_accessed = e->last_accessed;
+        uint64_t h = hash_key(entry.key);
+        entry.tag = (uint32_t)(h >> 32);
+
+        SessionShard *shard = shard_for(h);
+        shard_write_lock(shard);
+        int full = g_max_per_shard && shard->node_count >= g_max_per_shard;
+        if (!full && find_slot(shard, h, entry.key) < 0) {
+            maybe_grow(shard);
+            full = shard->node_count + 1 >= shard->slot_count;
+            if (!full) {
+                insert_slot(shard, entry);
+                shard->node_count++;
+                restored++;
+            }
+        }
+        shard_unlock(shard);
+        if (full) skipped++;
+    }
+
+    munmap(map, (size_t)st.st_size);
+    g_restored = restored;
+    printf("[Session] Restored %llu sessions from %s (%llu expired/skipped).\n", restored, path, skipped);
+    return 0;
+}
+
+// 이름 있는 공유 메모리 세그먼트를 만들거나 이미 있으면 붙음 (같은 호스트의 여러 프로세스가 공유)
+static int shm_attach(const char *name, size_t max_per_shard) {
+    if (!name || name[0] != '/') {
+        fprintf(stderr, "[Session] SESSION_SHM_NAME must start with '/'.\n");
+        return -1;
+    }
+
+    size_t slots = INITIAL_SHARD_SLOTS;
+    while (slots * MAX_LOAD_PERCENT < (max_per_shard + 1) * 100) slots <<= 1;
+    size_t table_off = (sizeof(ShmHeader) + 63) & ~(size_t)63;
+    size_t slots_off = (table_off + sizeof(SessionTable) + 63) & ~(size_t)63;
+    size_t total = slots_off + SESSION_SHARD_COUNT * slots * sizeof(SessionSlot);
+
+    int created = 1;
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        created = 0;
+        fd = shm_open(name, O_RDWR | O_CLOEXEC, 0600);
+    }
+    if (fd < 0) {
+        perror("[Session] shm_open failed");
+        return -1;
+    }
+
+    if (created) {
+        if (ftruncate(fd, (off_t)total) != 0) {
+            perror("[Session] ftruncate on shared segment failed");
+            close(fd);
+            shm_unlink(name);
+            return -1;
+        }
+    } else {
+        // 만든 프로세스가 ftruncate를 마칠 때까지 대기, 크기는 기존 세그먼트를 따름
+        struct stat st;
+        int waited = 0;
+        while (1) {
+            if (fstat(fd, &st) != 0) {
+                perror("[Session] fstat on shared segment failed");
+                close(fd);
+                return -1;
+            }
+            if ((size_t)st.st_size >= sizeof(ShmHeader) || waited >= SHM_ATTACH_WAIT_MS) break;
+            nanosleep(&(struct timespec){0, 10000000L}, NULL);
+            waited += 10;
+        }
+        if ((size_t)st.st_size < sizeof(ShmHeader)) {
+            fprintf(stderr, "[Session] Shared segment %s is still %lld bytes after %d ms "
+                            "(remove /dev/shm%s once all servers are stopped).\n",
+                    name, (long long)st.st_size, SHM_ATTACH_WAIT_MS, name);
+            close(fd);
+            return -1;
+        }
+        total = (size_t)st.st_size;
+    }
+
+    char *base = (char *)mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("[Session] mmap of shared segment failed");
+        if (created) shm_unlink(name);
+        return -1;
+    }
+    ShmHeader *header = (ShmHeader *)base;
+
+    if (created) {
+        SessionTable *table = (SessionTable *)(base + table_off);
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        for (int s = 0; s < SESSION_SHARD_COUNT; s++) {
+            SessionShard *shard = &table->shards[s];
+            pthread_mutex_init(&shard->shm_lock, &attr);
+            shard->slots_offset = slots_off + (size_t)s * slots * sizeof(SessionSlot);
+            shard->slot_count = slots;
+        }
+        pthread_mutexattr_destroy(&attr);
+
+        memcpy(header->magic, SHM_MAGIC, sizeof(SHM_MAGIC));
+        header->version = SHM_VERSION;
+        header->shard_count = SESSION_SHARD_COUNT;
+        header->slots_per_shard = slots;
+        header->total_bytes = total;
+        __atomic_store_n(&header->ready, 1, __ATOMIC_RELEASE);
+    } else {
+        int waited = 0;
+        while (!__atomic_load_n(&header->ready, __ATOMIC_ACQUIRE) && waited < SHM_ATTACH_WAIT_MS) {
+            nanosleep(&(struct timespec){0, 10000000L}, NULL);
+            waited += 10;
+        }
+        if (!header->ready || memcmp(header->magic, SHM_MAGIC, sizeof(SHM_MAGIC)) != 0 ||
+            header->version != SHM_VERSION || header->shard_count != SESSION_SHARD_COUNT ||
+            header->total_bytes != total) {
+            fprintf(stderr, "[Session] Shared segment %s is incompatible or was never initialized "
+                            "(remove /dev/shm%s once all servers are stopped).\n", name, name);
+            munmap(base, total);
+            return -1;
+        }
+    }
+
+    g_shm_base = base;
+    g_shm_size = total;
+    g_shm_created = created;
+    g_session_table = (SessionTable *)(base + table_off);
+
+    printf("[Session] %s shared segment %s (%d shards x %llu slots, %zu KB).\n",
+           created ? "Created" : "Attached to", name, SESSION_SHARD_COUNT,
+           (unsigned long long)header->slots_per_shard, total / 1024);
+    return 0;
+}
+
+// 락 주인이 슬롯을 옮기던 중 죽었을 수 있음: 남은 항목을 모아 빈 배열에 다시 삽입
+static void repair_shard(SessionShard *shard) {
+    SessionSlot *slots = shard_slots(shard);
+    SessionSlot *saved = (SessionSlot *)malloc(shard->slot_count * sizeof(SessionSlot));
+    if (!saved) {
+        // 복구할 메모리도 없으면 샤드를 비움 (해당 사용자만 다시 로그인)
+        memset(slots, 0, shard->slot_count * sizeof(SessionSlot));
+        shard->node_count = 0;
+        return;
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < shard->slot_count; i++) {
+        if (slots[i].dist) saved[count++] = slots[i];
+    }
+    memset(slots, 0, shard->slot_count * sizeof(SessionSlot));
+    shard->node_count = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        uint64_t h = hash_key(saved[i].key);
+        if (find_slot(shard, h, saved[i].key) >= 0) continue; // 옮기던 중 생긴 중복
+        if (shard->node_count + 1 >= shard->slot_count) break;
+        saved[i].tag = (uint32_t)(h >> 32);
+        insert_slot(shard, saved[i]);
+        shard->node_count++;
+    }
+    free(saved);
+}
@@ -0,0 +1,147 @@
+// 세션 테이블 벤치마크 (make bench -> build/bin/test/app/session_manager_test)
+// 사용법: session_manager_test [스레드 수=32] [세션 수=100000] [스레드당 조회 수=1000000] [쓰기 비율 1/N=64]
+// 1. 세션을 만들며 늘어난 RSS로 세션당 메모리를 잽니다.
+// 2. 한 스레드에서 조회 하나하나의 지연을 재서 p50/p99를 냅니다.
+// 3. 스레드마다 미리 만든 세션을 무작위로 조회하고, N번에 한 번씩 로그인/로그아웃(생성+삭제)을 섞습니다.
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "app/session_manager.h"
+
+typedef struct {
+    int id;
+    long ops;
+    int write_every;
+    long misses;
+} Worker;
+
+static char (*g_ids)[SESSION_ID_LENGTH];
+static int g_session_count;
+static pthread_barrier_t g_start;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long rss_bytes(void) {
+    long pages = 0, resident = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    if (fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    fclose(f);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+static int cmp_long(const void *a, const void *b) {
+    long x = *(const long *)a, y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+// xorshift (스레드별 시드, rand()의 전역 락을 피함)
+static unsigned int next_rand(unsigned int *s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
+
+static void* worker_func(void *arg) {
+    Worker *w = (Worker *)arg;
+    unsigned int seed = 2463534242u + (unsigned int)w->id * 7919u;
+    char tmp[SESSION_ID_LENGTH];
+
+    pthread_barrier_wait(&g_start);
+    for (long i = 0; i < w->ops; i++) {
+        int idx = (int)(next_rand(&seed) % (unsigned int)g_session_count);
+        if (session_get_user(g_ids[idx]) != idx) w->misses++;
+
+        if (w->write_every > 0 && i % w->write_every == 0) {
+            if (session_create(g_session_count + w->id, tmp, sizeof(tmp)) == 0) {
+                session_remove(tmp);
+            }
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    int threads = (argc > 1) ? atoi(argv[1]) : 32;
+    g_session_count = (argc > 2) ? atoi(argv[2]) : 100000;
+    long ops = (argc > 3) ? atol(argv[3]) : 1000000;
+    int write_every = (argc > 4) ? atoi(argv[4]) : 64;
+    if (threads < 1 || g_session_count < 1 || ops < 1) {
+        fprintf(stderr, "usage: %s [threads] [sessions] [lookups/thread] [write every N]\n", argv[0]);
+        return 1;
+    }
+
+    if (session_system_init("table", 0, 0, NULL) != 0) return 1;
+
+    g_ids = calloc((size_t)g_session_count, sizeof(*g_ids));
+    Worker *workers = calloc((size_t)threads, sizeof(Worker));
+    pthread_t *tids = calloc((size_t)threads, sizeof(pthread_t));
+    if (!g_ids || !workers || !tids) return 1;
+
+    // ID 배열 페이지를 미리 채워 RSS 차이에 세션 테이블만 남김
+    memset(g_ids, 0, (size_t)g_session_count * sizeof(*g_ids));
+    long rss_before = rss_bytes();
+    for (int i = 0; i < g_session_count; i++) {
+        if (session_create(i, g_ids[i], sizeof(g_ids[i])) != 0) return 1;
+    }
+    long rss_after = rss_bytes();
+    printf("sessions=%d rss +%.1f MB -> %.1f bytes/session\n", g_session_count,
+           (rss_after - rss_before) / 1048576.0, (double)(rss_after - rss_before) / g_session_count);
+
+    // 단일 스레드 조회 지연 분포
+    int samples = 200000;
+    long *lat = malloc(sizeof(long) * (size_t)samples);
+    if (!lat) return 1;
+    unsigned int seed = 88172645u;
+    for (int i = 0; i < samples; i++) {
+        int idx = (int)(next_rand(&seed) % (unsigned int)g_session_count);
+        struct timespec a, b;
+        clock_gettime(CLOCK_MONOTONIC, &a);
+        int uid = session_get_user(g_ids[idx]);
+        clock_gettime(CLOCK_MONOTONIC, &b);
+        if (uid != idx) return 1;
+        lat[i] = (b.tv_sec - a.tv_sec) * 1000000000L + (b.tv_nsec - a.tv_nsec);
+    }
+    qsort(lat, (size_t)samples, sizeof(long), cmp_long);
+    printf("lookup latency: p50 %ld ns, p99 %ld ns, p99.9 %ld ns\n",
+           lat[samples / 2], lat[samples * 99 / 100], lat[samples * 999 / 1000]);
+    free(lat);
+
+    pthread_barrier_init(&g_start, NULL, (unsigned int)threads + 1);
+    for (int i = 0; i < threads; i++) {
+        workers[i].id = i;
+        workers[i].ops = ops;
+        workers[i].write_every = write_every;
+        pthread_create(&tids[i], NULL, worker_func, &workers[i]);
+    }
+
+    double start = now_sec();
+    pthread_barrier_wait(&g_start);
+    long misses = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+        misses += workers[i].misses;
+    }
+    double elapsed = now_sec() - start;
+
+    double total = (double)threads * (double)ops;
+    printf("threads=%d sessions=%d write=1/%d lookups=%.0f elapsed=%.3fs -> %.2f M lookups/s (misses %ld)\n",
+           threads, g_session_count, write_every, total, elapsed, total / elapsed / 1e6, misses);
+
+    session_system_cleanup();
+    pthread_barrier_destroy(&g_start);
+    free(tids);
+    free(workers);
+    free(g_ids);
+    return misses ? 1 : 0;
+}
@@ -0,0 +1,182 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/random.h>
+
+#include "app/session_token.h"
+#include "app/hmac_keyring.h"
+
+#define TOKEN_VERSION       1
+#define TOKEN_PAYLOAD_LEN   14  // version(1) + kid(1) + user_id(4) + expiry(4) + nonce(4)
+#define TOKEN_RAW_LEN       (TOKEN_PAYLOAD_LEN + HMAC_KEYRING_MAC_LEN)
+#define REVOKE_PROBE        8   // 폐기 목록 탐색 범위
+
+// 폐기 목록 슬롯. 읽기는 락 없이 tag만 비교, 쓰기(로그아웃)는 g_revoke_mutex로 직렬화
+typedef struct {
+    uint64_t tag;       // MAC 앞 8바이트 (0이면 빈 슬롯)
+    uint32_t expiry;    // 이 시각이 지나면 토큰 자체가 만료되므로 슬롯 재사용 가능
+    uint32_t reserved;
+} RevokeSlot;
+
+// 내부 전역 변수
+static RevokeSlot *g_revoked = NULL;
+static size_t g_revoke_mask = 0;
+static pthread_mutex_t g_revoke_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// 내부 헬퍼 함수
+static int decode_token(const char *token, uint8_t *raw);
+static int is_revoked(uint64_t tag);
+
+static inline uint64_t mac_tag(const uint8_t *mac) {
+    uint64_t tag;
+    memcpy(&tag, mac, sizeof(tag));
+    return tag | 1; // 0은 빈 슬롯 표시
+}
+
+static inline size_t revoke_home(uint64_t tag) {
+    return (size_t)(tag >> 8) & g_revoke_mask;
+}
+
+static inline uint32_t read_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void write_be32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+int session_token_init(int revoke_capacity) {
+    if (hmac_keyring_active_kid() < 0) {
+        fprintf(stderr, "[Token] Signing keys are not loaded.\n");
+        return -1;
+    }
+
+    // 폐기 목록 크기는 2의 거듭제곱으로 올림
+    size_t cap = 64;
+    while (cap < (size_t)(revoke_capacity > 0 ? revoke_capacity : 0)) cap <<= 1;
+    g_revoked = (RevokeSlot *)calloc(cap, sizeof(RevokeSlot));
+    if (!g_revoked) return -1;
+    g_revoke_mask = cap - 1;
+
+    printf("[Token] Stateless sessions enabled (signing kid=%d, revocation slots=%zu).\n",
+           hmac_keyring_active_kid(), cap);
+    return 0;
+}
+
+int session_token_issue(int user_id, int ttl_sec, char *out, size_t out_len) {
+    int kid = hmac_keyring_active_kid();
+    if (kid < 0 || out_len < SESSION_TOKEN_LENGTH + 1) return -1;
+
+    uint8_t raw[TOKEN_RAW_LEN];
+    raw[0] = TOKEN_VERSION;
+    raw[1] = (uint8_t)kid;
+    write_be32(raw + 2, (uint32_t)user_id);
+    write_be32(raw + 6, (uint32_t)time(NULL) + (uint32_t)ttl_sec);
+
+    // 같은 초에 같은 사용자가 다시 로그인해도 토큰이 달라야 함 (폐기 목록 구분)
+    if (getrandom(raw + 10, 4, 0) != 4) return -1;
+    if (hmac_keyring_sign(kid, raw, TOKEN_PAYLOAD_LEN, raw + TOKEN_PAYLOAD_LEN) != 0) return -1;
+
+    b64url_encode(raw, TOKEN_RAW_LEN, out);
+    return 0;
+}
+
+int session_token_verify(const char *token) {
+    if (!token) return -1;
+
+    uint8_t raw[TOKEN_RAW_LEN];
+    if (decode_token(token, raw) != 0 || raw[0] != TOKEN_VERSION) return -1;
+
+    // MAC 비교를 먼저 끝낸 뒤 필드 해석 (위조 토큰의 내용으로 분기하지 않음)
+    if (hmac_keyring_verify(raw[1], raw, TOKEN_PAYLOAD_LEN, raw + TOKEN_PAYLOAD_LEN) != 0) return -1;
+
+    uint32_t uid = read_be32(raw + 2);
+    uint32_t expiry = read_be32(raw + 6);
+    if ((int32_t)(expiry - (uint32_t)time(NULL)) < 0) return -1;
+    if (is_revoked(mac_tag(raw + TOKEN_PAYLOAD_LEN))) return -1;
+
+    return (int)uid;
+}
+
+void session_token_revoke(const char *token) {
+    uint8_t raw[TOKEN_RAW_LEN];
+    if (!g_revoked || decode_token(token, raw) != 0) return;
+    if (session_token_verify(token) < 0) return; // 위조/만료 토큰으로 목록을 채우지 못하게
+
+    uint32_t expiry = read_be32(raw + 6);
+    uint64_t tag = mac_tag(raw + TOKEN_PAYLOAD_LEN);
+    uint32_t now = (uint32_t)time(NULL);
+
+    pthread_mutex_lock(&g_revoke_mutex);
+
+    // 탐색 범위 안의 빈 슬롯 또는 만료된 슬롯, 없으면 가장 먼저 만료될 슬롯을 재사용
+    size_t idx = revoke_home(tag);
+    size_t victim = idx;
+    for (int n = 0; n < REVOKE_PROBE; n++) {
+        size_t i = (idx + n) & g_revoke_mask;
+        RevokeSlot *slot = &g_revoked[i];
+        uint64_t cur = __atomic_load_n(&slot->tag, __ATOMIC_RELAXED);
+        if (cur == 0 || (int32_t)(slot->expiry - now) < 0) {
+            victim = i;
+            break;
+        }
+        if ((int32_t)(slot->expiry - g_revoked[victim].expiry) < 0) victim = i;
+        if (n == REVOKE_PROBE - 1) {
+            fprintf(stderr, "[Token] Revocation list full, reusing a slot. Increase SESSION_REVOKE_CAPACITY.\n");
+        }
+    }
+
+    RevokeSlot *slot = &g_revoked[victim];
+    __atomic_store_n(&slot->tag, 0, __ATOMIC_RELAXED);
+    slot->expiry = expiry;
+    __atomic_store_n(&slot->tag, tag, __ATOMIC_RELEASE);
+
+    pthread_mutex_unlock(&g_revoke_mutex);
+}
+
+unsigned long long session_token_revoked_count(void) {
+    if (!g_revoked) return 0;
+
+    uint32_t now = (uint32_t)time(NULL);
+    unsigned long long count = 0;
+    pthread_mutex_lock(&g_revoke_mutex);
+    for (size_t i = 0; i <= g_revoke_mask; i++) {
+        if (g_revoked[i].tag && (int32_t)(g_revoked[i].expiry - now) >= 0) count++;
+    }
+    pthread_mutex_unlock(&g_revoke_mutex);
+    return count;
+}
+
+void session_token_cleanup(void) {
+    free(g_revoked);
+    g_revoked = NULL;
+    g_revoke_mask = 0;
+}
+
+// =========================================================
+// 내부 헬퍼
+// =========================================================
+
+static int decode_token(const char *token, uint8_t *raw) {
+    size_t len = strnlen(token, SESSION_TOKEN_LENGTH + 1);
+    if (len != SESSION_TOKEN_LENGTH) return -1;
+    return b64url_decode(token, len, raw, TOKEN_RAW_LEN);
+}
+
+static int is_revoked(uint64_t tag) {
+    if (!g_revoked) return 0;
+
+    size_t idx = revoke_home(tag);
+    for (int n = 0; n < REVOKE_PROBE; n++) {
+        const RevokeSlot *slot = &g_revoked[(idx + n) & g_revoke_mask];
+        if (__atomic_load_n(&slot->tag, __ATOMIC_ACQUIRE) == tag) return 1;
+    }
+    return 0;
+}
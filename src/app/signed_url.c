@@ -0,0 +1,107 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "app/signed_url.h"
+#include "app/hmac_keyring.h"
+#include "app/http_utils.h"
+
+#define SIG_CHARS           22  // 16바이트 MAC의 base64url 길이
+#define MIN_EXPIRY_BUCKET   60  // 만료 시각 올림 단위 하한 (초)
+#define SIGN_INPUT_LEN      640
+
+// 내부 전역 변수
+static int g_ttl_sec = 0;
+static int g_bucket_sec = 0;
+
+// 내부 헬퍼 함수
+static int build_sign_input(char *buf, size_t cap, int user_id, long long expiry, const char *path);
+
+int signed_url_init(int ttl_sec) {
+    if (ttl_sec <= 0 || hmac_keyring_active_kid() < 0) {
+        g_ttl_sec = 0;
+        printf("[SignedURL] Disabled (every video request checks the session).\n");
+        return -1;
+    }
+
+    g_ttl_sec = ttl_sec;
+    g_bucket_sec = ttl_sec / 4;
+    if (g_bucket_sec < MIN_EXPIRY_BUCKET) g_bucket_sec = MIN_EXPIRY_BUCKET;
+
+    printf("[SignedURL] Enabled (ttl=%ds, expiry bucket=%ds).\n", g_ttl_sec, g_bucket_sec);
+    return 0;
+}
+
+int signed_url_enabled(void) {
+    return g_ttl_sec > 0;
+}
+
+long long signed_url_expiry(void) {
+    if (!signed_url_enabled()) return 0;
+
+    // 최소 ttl은 보장하면서 구간 경계로 올림 -> 같은 구간에서 같은 URL
+    long long expiry = (long long)time(NULL) + g_ttl_sec;
+    return (expiry / g_bucket_sec + 1) * g_bucket_sec;
+}
+
+int signed_url_make(const char *url, int user_id, long long expiry, char *out, size_t out_len) {
+    if (!signed_url_enabled() || !url || expiry <= 0) return -1;
+
+    char input[SIGN_INPUT_LEN];
+    if (build_sign_input(input, sizeof(input), user_id, expiry, url) < 0) return -1;
+
+    int kid = hmac_keyring_active_kid();
+    uint8_t mac[HMAC_KEYRING_MAC_LEN];
+    if (hmac_keyring_sign(kid, input, strlen(input), mac) != 0) return -1;
+
+    char sig[SIG_CHARS + 1];
+    b64url_encode(mac, sizeof(mac), sig);
+
+    int len = snprintf(out, out_len, "%s?u=%d&e=%lld&k=%d&s=%s", url, user_id, expiry, kid, sig);
+    return (len < 0 || (size_t)len >= out_len) ? -1 : 0;
+}
+
+int signed_url_verify(const char *path, const char *query, int *out_max_age) {
+    if (!signed_url_enabled() || !path || !query || !query[0]) return -1;
+
+    char u[16], e[24], k[8], s[SIG_CHARS + 2];
+    if (http_get_form_param(query, "u", u, sizeof(u)) < 0 ||
+        http_get_form_param(query, "e", e, sizeof(e)) < 0 ||
+        http_get_form_param(query, "k", k, sizeof(k)) < 0 ||
+        http_get_form_param(query, "s", s, sizeof(s)) < 0) {
+        return -1;
+    }
+
+    char *end;
+    long user_id = strtol(u, &end, 10);
+    if (*end || user_id <= 0) return -1;
+    long long expiry = strtoll(e, &end, 10);
+    if (*end) return -1;
+    long kid = strtol(k, &end, 10);
+    if (*end) return -1;
+
+    uint8_t mac[HMAC_KEYRING_MAC_LEN];
+    if (strlen(s) != SIG_CHARS || b64url_decode(s, SIG_CHARS, mac, sizeof(mac)) != 0) return -1;
+
+    char input[SIGN_INPUT_LEN];
+    if (build_sign_input(input, sizeof(input), (int)user_id, expiry, path) < 0) return -1;
+    if (hmac_keyring_verify((int)kid, input, strlen(input), mac) != 0) return -1;
+
+    long long remaining = expiry - (long long)time(NULL);
+    if (remaining <= 0) return -1;
+
+    if (out_max_age) *out_max_age = (int)remaining;
+    return (int)user_id;
+}
+
+// 서명 대상: 사용자, 만료 시각, 디코딩한 경로 (다른 사용자/파일/기간으로 재사용 불가)
+// 브라우저가 어떤 문자를 다시 인코딩하든 같은 입력이 되도록 퍼센트 인코딩을 푼 경로로 서명
+static int build_sign_input(char *buf, size_t cap, int user_id, long long expiry, const char *path) {
+    int len = snprintf(buf, cap, "v1\n%d\n%lld\n", user_id, expiry);
+    if (len < 0 || (size_t)len >= cap) return -1;
+    int path_len = http_url_decode_path(path, buf + len, cap - (size_t)len);
+    return (path_len < 0) ? -1 : len + path_len;
+}
@@ -0,0 +1,93 @@
+// 서명 URL 테스트 (make bench -> build/bin/test/app/signed_url_test)
+// 공백/한글/?#&가 들어간 경로를 인코딩해 서명한 뒤, 브라우저가 보낼 법한 형태로 검증합니다.
+#include <stdio.h>
+#include <string.h>
+
+#include "app/signed_url.h"
+#include "app/hmac_keyring.h"
+#include "app/http_utils.h"
+
+static int g_failed = 0;
+
+#define CHECK(cond, ...)                                \
+    do {                                                \
+        if (!(cond)) {                                  \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__);                        \
+            printf("\n");                               \
+            g_failed++;                                 \
+        }                                               \
+    } while (0)
+
+// 서명 URL을 경로와 쿼리로 나눠 검증 (http_handler가 요청 줄을 나누는 것과 같이)
+static int verify_url(const char *url, int *max_age) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s", url);
+    char *q = strchr(path, '?');
+    if (!q) return -1;
+    *q++ = '\0';
+    return signed_url_verify(path, q, max_age);
+}
+
+static void check_roundtrip(const char *raw_path) {
+    char encoded[1024];
+    CHECK(http_url_encode_path(raw_path, encoded, sizeof(encoded)) > 0, "encode %s", raw_path);
+    CHECK(strpbrk(encoded, " ?#&") == NULL, "unencoded reserved char in %s", encoded);
+
+    char decoded[1024];
+    CHECK(http_url_decode_path(encoded, decoded, sizeof(decoded)) >= 0 && strcmp(decoded, raw_path) == 0,
+          "decode(encode(%s)) = %s", raw_path, decoded);
+
+    char url[2048];
+    long long expiry = signed_url_expiry();
+    CHECK(signed_url_make(encoded, 7, expiry, url, sizeof(url)) == 0, "make %s", raw_path);
+
+    // 그대로 돌아온 URL
+    int max_age = 0;
+    CHECK(verify_url(url, &max_age) == 7 && max_age > 0, "verify %s", url);
+
+    // 다른 사용자 / 다른 파일로는 통과하지 않음
+    char other[2048];
+    snprintf(other, sizeof(other), "%s", url);
+    char *u = strstr(other, "u=7");
+    if (u) u[2] = '8';
+    CHECK(verify_url(other, &max_age) < 0, "other user accepted: %s", other);
+
+    snprintf(other, sizeof(other), "/videos/x%s", url + strlen("/videos/"));
+    CHECK(verify_url(other, &max_age) < 0, "other path accepted: %s", other);
+}
+
+int main(void) {
+    if (hmac_keyring_init(NULL) != 0 || signed_url_init(3600) != 0) {
+        printf("FAIL init\n");
+        return 1;
+    }
+
+    check_roundtrip("/videos/a.mp4");
+    check_roundtrip("/videos/한글 제목.mp4");
+    check_roundtrip("/videos1/drama/ep 1 ?#&=+%.mp4");
+
+    // 브라우저가 보내는 형태: 공백만 %20, 한글은 소문자 hex로 인코딩 -> 같은 서명으로 통과
+    char url[2048], sent[2048];
+    char encoded[1024];
+    http_url_encode_path("/videos/한글 제목.mp4", encoded, sizeof(encoded));
+    CHECK(signed_url_make(encoded, 3, signed_url_expiry(), url, sizeof(url)) == 0, "make");
+    snprintf(sent, sizeof(sent), "/videos/%%ed%%95%%9c%%ea%%b8%%80%%20%%ec%%a0%%9c%%eb%%aa%%a9.mp4%s",
+             strchr(url, '?'));
+    int max_age = 0;
+    CHECK(verify_url(sent, &max_age) == 3, "browser-encoded path rejected: %s", sent);
+
+    // 경로의 '+'는 공백이 아님
+    char plus[64];
+    http_url_decode_path("/videos/a+b.mp4", plus, sizeof(plus));
+    CHECK(strcmp(plus, "/videos/a+b.mp4") == 0, "plus decoded to %s", plus);
+
+    // 버퍼 부족
+    char tiny[8];
+    CHECK(http_url_encode_path("/videos/한글", tiny, sizeof(tiny)) < 0, "encode overflow");
+    CHECK(http_url_decode_path("/videos/abc", tiny, sizeof(tiny)) < 0, "decode overflow");
+
+    hmac_keyring_cleanup();
+    printf("%s (%d failed)\n", g_failed ? "FAILED" : "OK", g_failed);
+    return g_failed ? 1 : 0;
+}
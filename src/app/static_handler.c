@@ -12,9 +12,13 @@
 #include "app/static_handler.h"
 #include "app/http_utils.h"
 #include "app/client_context.h"
+#include "app/stream_handler.h"
 #include "core/reactor.h"
+#include "core/logger.h"
+#include "core/metrics.h"
 
 static const char* get_mime_type(const char* path);
+static const char* get_cache_control(const char* path);
 static HttpResult start_static_transfer(ClientContext *ctx);
 static void send_static_header(ClientContext *ctx);
 static void send_static_body(ClientContext *ctx);
@@ -45,20 +49,20 @@ void handle_static_request(ClientContext* ctx) {
 }
 
 static HttpResult start_static_transfer(ClientContext *ctx) {
-    printf("[Static] Opening file: %s (Request: %s)\n", ctx->request_path, ctx->client_ip);
+    LOG_DEBUG("Static", "Opening file: %s (client %s)", ctx->request_path, ctx->client_ip);
     // 파일 오픈
     int fd = open(ctx->request_path, O_RDONLY | O_CLOEXEC);
     if (fd < 0) {
         if (errno == ENOENT) return ERR_NOT_FOUND;
         if (errno == EACCES) return ERR_FORBIDDEN;
-        perror("[Static] File open failed");
+        LOG_WARN("Static", "open %s failed: %m", ctx->request_path);
         return ERR_INTERNAL_SERVER;
     }
 
     // 파일 정보 확인
     struct stat st;
     if (fstat(fd, &st) < 0) {
-        perror("static: fstat failed");
+        LOG_WARN("Static", "fstat %s failed: %m", ctx->request_path);
         close(fd);
         return ERR_INTERNAL_SERVER;
     }
@@ -74,15 +78,19 @@ static HttpResult start_static_transfer(ClientContext *ctx) {
 
     // MIME Type 결정
     const char* mime_type = get_mime_type(ctx->request_path);
+    const char* cache_control = get_cache_control(ctx->request_path);
 
-    // 헤더 버퍼 작성
+    // 헤더 버퍼 작성 (Cache-Control은 trickplay 파일에만)
     ctx->buffer_len = snprintf(ctx->buffer, sizeof(ctx->buffer),
         "HTTP/1.1 200 OK\r\n"
         "Content-Type: %s\r\n"
         "Content-Length: %ld\r\n"
+        "%s%s%s"
         "Connection: keep-alive\r\n"
         "\r\n",
-        mime_type, st.st_size
+        mime_type, st.st_size,
+        cache_control ? "Cache-Control: " : "", cache_control ? cache_control : "",
+        cache_control ? "\r\n" : ""
     );
     ctx->buffer_sent = 0;
     
@@ -115,7 +123,7 @@ static void send_static_header(ClientContext *ctx) {
                                 EPOLLOUT | EPOLLONESHOT, ctx);
             return;
         }
-        perror("static: header send failed");
+        LOG_DEBUG("Static", "header send failed: %m");
         send_error_response(ctx, 500);
     }
 }
@@ -125,8 +133,10 @@ static void send_static_body(ClientContext *ctx) {
 
     if (sent > 0) {
         ctx->bytes_remaining -= sent;
+        metrics_add(M_SENDFILE_BYTES, (unsigned long long)sent);
 
         if (ctx->bytes_remaining <= 0) {
+            stream_release_io(ctx); // 장치 큐 슬롯 반납 (EPOLLIN 재등록 전에)
             close(ctx->file_fd);
             ctx->file_fd = -1;
 
@@ -134,24 +144,25 @@ static void send_static_body(ClientContext *ctx) {
 
             ctx->buffer_len = 0;
             ctx->buffer_sent = 0;
+
+            // 재등록 전에 남김 (재등록 후 ctx는 다른 워커 소관)
+            LOG_DEBUG("Static", "Complete response for: %s", ctx->request_path);
+            metrics_observe_since(H_ROUTE_STATIC, ctx->req_start_ns);
             if (reactor_update_event(ctx->epoll_fd, ctx->client_fd, 
                                      EPOLLIN | EPOLLONESHOT, ctx) < 0) {
-                perror("stream: rearm epollin failed");
-                close(ctx->client_fd);
-                free(ctx);
+                LOG_WARN("Static", "rearm epollin failed: %m");
+                http_close_client(ctx);
             }
-            
-            printf("Complete response for: %s\n", ctx->request_path);
             return;
         }
         else {
             // 아직 덜 보냄 
             if (reactor_update_event(ctx->epoll_fd, ctx->client_fd, 
                                      EPOLLOUT | EPOLLONESHOT, ctx) < 0) {
-                perror("stream: rearm epollout failed");
+                LOG_WARN("Static", "rearm epollout failed: %m");
+                stream_release_io(ctx);
                 close(ctx->file_fd);
-                close(ctx->client_fd);
-                free(ctx);
+                http_close_client(ctx);
             }
         }
     } else if (sent < 0) {
@@ -159,13 +170,14 @@ static void send_static_body(ClientContext *ctx) {
             // 소켓 버퍼 꽉 참 -> 쓰기 가능해지면 알려줘
             if (reactor_update_event(ctx->epoll_fd, ctx->client_fd, 
                                      EPOLLOUT | EPOLLONESHOT, ctx) < 0) {
-                perror("stream: rearm epollout failed (EAGAIN)");
+                LOG_WARN("Static", "rearm epollout failed (EAGAIN): %m");
+                stream_release_io(ctx);
                 close(ctx->file_fd);
-                close(ctx->client_fd);
-                free(ctx);
+                http_close_client(ctx);
             }
+            return; // 재등록 후 ctx는 다른 워커 소관
         }
-        perror("static: sendfile failed");
+        LOG_WARN("Static", "sendfile failed: %m");
         send_error_response(ctx, 500);
     }
     else { // sent == 0
@@ -185,10 +197,25 @@ static const char* get_mime_type(const char* path) {
     if (strcmp(ext, ".png") == 0) return "image/png";
     if (strcmp(ext, ".jpg") == 0 || strcmp(ext, ".jpeg") == 0) return "image/jpeg";
     if (strcmp(ext, ".gif") == 0) return "image/gif";
+    if (strcmp(ext, ".webp") == 0) return "image/webp";
     if (strcmp(ext, ".ico") == 0) return "image/x-icon";
     if (strcmp(ext, ".svg") == 0) return "image/svg+xml";
     if (strcmp(ext, ".txt") == 0) return "text/plain";
     if (strcmp(ext, ".mp4") == 0) return "video/mp4";
+    if (strcmp(ext, ".vtt") == 0) return "text/vtt; charset=utf-8";
 
     return "application/octet-stream"; // 기본값 (다운로드 유도)
+}
+
+// static/trickplay/ 아래만 캐시 헤더를 붙임 (나머지 정적 파일은 NULL -> 기존처럼 헤더 없음)
+static const char* get_cache_control(const char* path) {
+    while (path[0] == '.' && path[1] == '/') path += 2;
+    if (strncmp(path, "static/trickplay/", 17) != 0) return NULL;
+
+    // Trickplay 스프라이트는 파일명에 원본 mtime이 들어가므로 내용이 절대 바뀌지 않음
+    // -> 브라우저/프록시가 재검증 없이 재사용 (탐색할 때마다 origin에 오지 않도록)
+    const char* ext = strrchr(path, '.');
+    if (ext && strcmp(ext, ".jpg") == 0) return "public, max-age=31536000, immutable";
+    // index.vtt는 재생성 시 같은 경로로 덮어쓰므로 짧게
+    return "public, max-age=300";
 }
\ No newline at end of file
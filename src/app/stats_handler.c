@@ -0,0 +1,177 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+#include "app/stats_handler.h"
+#include "app/http_utils.h"
+#include "app/segment_cache.h"
+#include "app/device_io.h"
+#include "app/tiering.h"
+#include "app/session_manager.h"
+#include "app/history_buffer.h"
+#include "app/continue_watching.h"
+#include "core/uring_reader.h"
+#include "core/reactor.h"
+#include "core/logger.h"
+
+#define STATS_JSON_CAP 16384
+
+static int append_segment_cache_json(char *buf, size_t cap);
+static int append_uring_json(char *buf, size_t cap);
+static int append_tiering_json(char *buf, size_t cap);
+static int append_session_json(char *buf, size_t cap);
+static int append_history_json(char *buf, size_t cap);
+static int append_continue_json(char *buf, size_t cap);
+static int append_logger_json(char *buf, size_t cap);
+
+void handle_api_stats(ClientContext *ctx) {
+    char body[STATS_JSON_CAP];
+    size_t len = 0;
+
+    len += snprintf(body + len, sizeof(body) - len, "{");
+    len += append_segment_cache_json(body + len, sizeof(body) - len);
+    if (len < sizeof(body)) len += snprintf(body + len, sizeof(body) - len, ", ");
+    if (len < sizeof(body)) len += append_uring_json(body + len, sizeof(body) - len);
+    if (len < sizeof(body)) len += snprintf(body + len, sizeof(body) - len, ", \"devices\":");
+    if (len < sizeof(body)) len += device_io_stats_json(body + len, sizeof(body) - len);
+    if (len < sizeof(body)) len += snprintf(body + len, sizeof(body) - len, ", ");
+    if (len < sizeof(body)) len += append_tiering_json(body + len, sizeof(body) - len);
+    if (len < sizeof(body)) len += snprintf(body + len, sizeof(body) - len, ", ");
+    if (len < sizeof(body)) len += append_session_json(body + len, sizeof(body) - len);
+    if (len < sizeof(body)) len += snprintf(body + len, sizeof(body) - len, ", ");
+    if (len < sizeof(body)) len += append_history_json(body + len, sizeof(body) - len);
+    if (len < sizeof(body)) len += snprintf(body + len, sizeof(body) - len, ", ");
+    if (len < sizeof(body)) len += append_continue_json(body + len, sizeof(body) - len);
+    if (len < sizeof(body)) len += snprintf(body + len, sizeof(body) - len, ", ");
+    if (len < sizeof(body)) len += append_logger_json(body + len, sizeof(body) - len);
+    if (len < sizeof(body) - 1) {
+        len += snprintf(body + len, sizeof(body) - len, "}");
+    }
+    if (len >= sizeof(body)) {
+        send_error_response(ctx, 500);
+        return;
+    }
+
+    int header_len = snprintf(ctx->buffer, sizeof(ctx->buffer),
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json; charset=utf-8\r\n"
+        "Content-Length: %zu\r\n"
+        "Cache-Control: no-store\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n", len
+    );
+
+    if (send_all_blocking(ctx->client_fd, ctx->buffer, header_len) < 0 ||
+        send_all_blocking(ctx->client_fd, body, len) < 0) {
+        LOG_DEBUG("API", "Failed to send stats: %m");
+        http_close_client(ctx);
+        return;
+    }
+
+    ctx->state = STATE_REQ_RECEIVING;
+    ctx->buffer_len = 0;
+
+    if (reactor_update_event(ctx->epoll_fd, ctx->client_fd, EPOLLIN | EPOLLONESHOT, ctx) < 0) {
+        http_close_client(ctx);
+    }
+}
+
+static int append_segment_cache_json(char *buf, size_t cap) {
+    SegmentCacheStats st;
+    memset(&st, 0, sizeof(st));
+    if (segment_cache_enabled()) segment_cache_get_stats(&st);
+
+    unsigned long long lookups = st.hits + st.misses;
+    double hit_ratio = lookups ? (double)st.hits / (double)lookups : 0.0;
+
+    return snprintf(buf, cap,
+        "\"segment_cache\":{\"enabled\":%s, \"hugepages\":%s, "
+        "\"slots_total\":%d, \"slots_used\":%d, "
+        "\"hits\":%llu, \"misses\":%llu, \"hit_ratio\":%.4f, "
+        "\"bytes_from_ram\":%llu, \"admissions\":%llu, \"rejections\":%llu, "
+        "\"evictions\":%llu}",
+        segment_cache_enabled() ? "true" : "false", st.hugepages ? "true" : "false",
+        st.slots_total, st.slots_used,
+        st.hits, st.misses, hit_ratio,
+        st.bytes_from_ram, st.admissions, st.rejections,
+        st.evictions);
+}
+
+static int append_uring_json(char *buf, size_t cap) {
+    UringReaderStats st;
+    memset(&st, 0, sizeof(st));
+    if (uring_reader_enabled()) uring_reader_get_stats(&st);
+
+    return snprintf(buf, cap,
+        "\"direct_io\":{\"enabled\":%s, \"fixed_buffers\":%s, "
+        "\"buffers_total\":%d, \"buffers_in_use\":%d, "
+        "\"reads_submitted\":%llu, \"reads_failed\":%llu, \"bytes_read\":%llu, "
+        "\"pool_exhausted\":%llu}",
+        uring_reader_enabled() ? "true" : "false", st.fixed_buffers ? "true" : "false",
+        st.buffers_total, st.buffers_in_use,
+        st.reads_submitted, st.reads_failed, st.bytes_read,
+        st.pool_exhausted);
+}
+
+static int append_tiering_json(char *buf, size_t cap) {
+    TieringStats st;
+    memset(&st, 0, sizeof(st));
+    if (tiering_enabled()) tiering_get_stats(&st);
+
+    unsigned long long total = st.fast_hits + st.slow_hits;
+    double fast_ratio = total ? (double)st.fast_hits / (double)total : 0.0;
+
+    return snprintf(buf, cap,
+        "\"tiering\":{\"enabled\":%s, \"tracked\":%d, \"fast_copies\":%d, "
+        "\"used_mb\":%llu, \"max_mb\":%llu, "
+        "\"promotions\":%llu, \"demotions\":%llu, \"bytes_copied\":%llu, "
+        "\"fast_hits\":%llu, \"slow_hits\":%llu, \"fast_hit_ratio\":%.4f}",
+        tiering_enabled() ? "true" : "false", st.tracked, st.fast_copies,
+        st.used_bytes / (1024 * 1024), st.max_bytes / (1024 * 1024),
+        st.promotions, st.demotions, st.bytes_copied,
+        st.fast_hits, st.slow_hits, fast_ratio);
+}
+
+static int append_session_json(char *buf, size_t cap) {
+    SessionStats st;
+    session_get_stats(&st);
+
+    return snprintf(buf, cap,
+        "\"sessions\":{\"mode\":\"%s\", \"live\":%llu, \"max\":%llu, \"created\":%llu, "
+        "\"expired\":%llu, \"evicted\":%llu, \"table_bytes\":%llu, \"revoked\":%llu, \"restored\":%llu}",
+        st.token_mode ? "token" : (st.shm_mode ? "shm" : "table"),
+        st.live, st.max_sessions, st.created, st.expired, st.evicted, st.table_bytes, st.revoked, st.restored);
+}
+
+static int append_history_json(char *buf, size_t cap) {
+    HistoryBufferStats st;
+    history_buffer_get_stats(&st);
+
+    return snprintf(buf, cap,
+        "\"history\":{\"buffered\":%llu, \"dirty\":%llu, \"puts\":%llu, \"coalesced\":%llu, "
+        "\"flushes\":%llu, \"rows_flushed\":%llu, \"write_through\":%llu, \"last_flush_ms\":%.2f}",
+        st.buffered, st.dirty, st.puts, st.coalesced,
+        st.flushes, st.rows_flushed, st.write_through, st.last_flush_ms);
+}
+
+static int append_continue_json(char *buf, size_t cap) {
+    ContinueStats st;
+    continue_watching_get_stats(&st);
+
+    return snprintf(buf, cap,
+        "\"continue\":{\"cached_users\":%llu, \"capacity\":%llu, \"hits\":%llu, \"misses\":%llu, "
+        "\"updates\":%llu, \"evictions\":%llu}",
+        st.cached_users, st.capacity, st.hits, st.misses, st.updates, st.evictions);
+}
+
+static int append_logger_json(char *buf, size_t cap) {
+    LoggerStats st;
+    logger_get_stats(&st);
+
+    return snprintf(buf, cap,
+        "\"log\":{\"written\":%llu, \"dropped\":%llu, \"rings\":%llu}",
+        st.written, st.dropped, st.rings);
+}
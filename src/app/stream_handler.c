@@ -1,9 +1,11 @@
 #define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/sendfile.h>
+#include <sys/socket.h>
 #include <sys/epoll.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -12,11 +14,23 @@
 #include "app/stream_handler.h"
 #include "app/http_utils.h"
 #include "app/client_context.h"
+#include "app/segment_cache.h"
+#include "app/device_io.h"
+#include "app/tiering.h"
+#include "core/uring_reader.h"
+#include "core/logger.h"
+#include "core/metrics.h"
 
 static HttpResult start_streaming(ClientContext *ctx);
 static void continue_sending_header(ClientContext *ctx);
 static void continue_sending_file(ClientContext *ctx);
+static ssize_t send_body_chunk(ClientContext *ctx);
+static ssize_t send_io_buffer(ClientContext *ctx);
+static ssize_t send_file_range(ClientContext *ctx);
+static void on_direct_read_done(void *arg, int buf_idx, const char *data, int result);
+static void release_direct(ClientContext *ctx);
 #define MAX_SEND_CHUNK_SIZE (8 * 1024 * 1024)
+#define SEND_PARKED (-2)    // direct 읽기를 제출함: 완료 스레드가 EPOLLOUT을 걸어줄 때까지 대기
 
 void handle_streaming_request(ClientContext *ctx){
     if (ctx->state == STATE_REQ_RECEIVING || ctx->state == STATE_PROCESSING) {
@@ -56,18 +70,25 @@ static HttpResult start_streaming(ClientContext *ctx) {
         // 권한 처리 및 에러 구분
         if (errno == ENOENT) return ERR_NOT_FOUND;  // 404
         if (errno == EACCES) return ERR_FORBIDDEN;  // 403
-        perror("open failed");
+        LOG_WARN("Stream", "open %s failed: %m", ctx->request_path);
         return ERR_INTERNAL_SERVER; // 500
     }
 
     // 파일 정보 획득
     struct stat st;
     if (fstat(fd, &st) < 0) {
-        perror("fstat failed");
+        LOG_WARN("Stream", "fstat %s failed: %m", ctx->request_path);
         close(fd);
         return ERR_INTERNAL_SERVER; // 500
     }
     
+    if (!S_ISREG(st.st_mode)) {
+        close(fd);
+        return ERR_NOT_FOUND;
+    }
+    // 실제로 있는 비디오만 인기도 추적 대상에 넣음
+    tiering_record_open(ctx->request_path);
+
     // 유효성 검사
     off_t total_size = st.st_size;
     if (ctx->range_start >= total_size) {
@@ -88,6 +109,17 @@ static HttpResult start_streaming(ClientContext *ctx) {
 
     // Context에 저장
     ctx->file_fd = fd;
+    ctx->file_dev = st.st_dev;
+    ctx->file_ino = st.st_ino;
+    ctx->file_mtime = st.st_mtime;
+    ctx->file_size = total_size;
+
+    // direct 엔진: 같은 파일을 O_DIRECT로 한 번 더 엶 (tmpfs 등 미지원 FS면 sendfile 유지)
+    ctx->direct_fd = -1;
+    ctx->io_buf = -1;
+    if (uring_reader_enabled()) {
+        ctx->direct_fd = open(ctx->request_path, O_RDONLY | O_DIRECT | O_CLOEXEC);
+    }
     ctx->file_offset = ctx->range_start;
     ctx->bytes_remaining = content_length;
 
@@ -95,19 +127,28 @@ static HttpResult start_streaming(ClientContext *ctx) {
     ctx->buffer_len = 0;
     ctx->buffer_sent = 0;
 
+    // 서명 URL 응답은 사용자/만료가 URL에 묶여 있으므로 공유 캐시에 둬도 안전
+    char cache_control[64];
+    if (ctx->url_max_age > 0) {
+        snprintf(cache_control, sizeof(cache_control), "public, max-age=%d", ctx->url_max_age);
+    } else {
+        snprintf(cache_control, sizeof(cache_control), "private");
+    }
+
     int len = snprintf(ctx->buffer, sizeof(ctx->buffer),
         "HTTP/1.1 206 Partial Content\r\n"
         "Content-Type: video/mp4\r\n"
         "Content-Range: bytes %ld-%ld/%ld\r\n"
         "Content-Length: %lu\r\n"
+        "Cache-Control: %s\r\n"
         "Connection: keep-alive\r\n"
         "\r\n", // 헤더 끝
         ctx->range_start, file_end, total_size,
-        content_length
+        content_length, cache_control
     );
 
     if (len < 0 || (size_t)len >= sizeof(ctx->buffer)) {
-        fprintf(stderr, "Header too long\n");
+        LOG_WARN("Stream", "Response header too long for %s", ctx->request_path);
         return ERR_INTERNAL_SERVER; // 500
     }
     ctx->buffer_len = len;
@@ -115,8 +156,8 @@ static HttpResult start_streaming(ClientContext *ctx) {
     // 상태 변경
     ctx->state = STATE_RES_SENDING_HEADER;
 
-    printf("[Stream] File: %s, Range: %ld-%ld, Size: %lu\n", 
-           ctx->request_path, ctx->range_start, file_end, content_length);
+    LOG_DEBUG("Stream", "File: %s, Range: %ld-%ld, Size: %lu",
+              ctx->request_path, ctx->range_start, file_end, content_length);
 
     return RESULT_OK;
 }
@@ -140,6 +181,8 @@ static void continue_sending_header(ClientContext *ctx) {
         // 헤더 전송 완료 체크
         if (ctx->buffer_sent >= ctx->buffer_len) {
             ctx->state = STATE_RES_SENDING_BODY;
+            // 스트리밍 경로 지연은 첫 바이트(헤더)까지 (본문 길이는 클라이언트 속도에 좌우됨)
+            metrics_observe_since(H_ROUTE_STREAM, ctx->req_start_ns);
             // 여기서 return하지 않고, 가능하다면 바로 파일 전송 시도 (최적화)
         }
     } else if (sent < 0) {
@@ -164,17 +207,17 @@ static void continue_sending_file(ClientContext *ctx) {
         if (total_sent_this_turn >= MAX_SEND_CHUNK_SIZE) {
             if (reactor_update_event(ctx->epoll_fd, ctx->client_fd, 
                                      EPOLLOUT | EPOLLONESHOT, ctx) < 0) {
-                perror("stream: yield rearm failed");
+                LOG_WARN("Stream", "yield rearm failed: %m");
+                stream_release_io(ctx);
                 close(ctx->file_fd);
-                close(ctx->client_fd);
-                free(ctx);
+                http_close_client(ctx);
             }
             return;
         }
 
-        // 데이터 전송
-        ssize_t sent = sendfile(ctx->client_fd, ctx->file_fd, 
-                                &ctx->file_offset, ctx->bytes_remaining);
+        // 데이터 전송 (캐시 히트면 RAM에서, 아니면 sendfile)
+        ssize_t sent = send_body_chunk(ctx);
+        if (sent == SEND_PARKED) return; // 이후 ctx는 완료 스레드 소관
 
         if (sent > 0) {
             ctx->bytes_remaining -= sent;
@@ -183,6 +226,7 @@ static void continue_sending_file(ClientContext *ctx) {
             // 전송 완료
             if (ctx->bytes_remaining == 0) {
                 // 자원 정리
+                stream_release_io(ctx);
                 close(ctx->file_fd);
                 ctx->file_fd = -1;
 
@@ -192,13 +236,12 @@ static void continue_sending_file(ClientContext *ctx) {
                 ctx->buffer_sent = 0;
 
                 // 로그
-                printf("[Stream] Completed: %s (Client: %s)\n", ctx->request_path, ctx->client_ip);
+                LOG_DEBUG("Stream", "Completed: %s (client %s)", ctx->request_path, ctx->client_ip);
 
                 // 듣기 모드(EPOLLIN) 전환
                 if (reactor_update_event(ctx->epoll_fd, ctx->client_fd, 
                                          EPOLLIN | EPOLLONESHOT, ctx) < 0) {
-                    close(ctx->client_fd);
-                    free(ctx);
+                    http_close_client(ctx);
                 }
                 return;
             }
@@ -210,21 +253,21 @@ static void continue_sending_file(ClientContext *ctx) {
                 // [진짜 대기] 소켓 버퍼 꽉 참 -> Epoll 대기
                 if (reactor_update_event(ctx->epoll_fd, ctx->client_fd, 
                                          EPOLLOUT | EPOLLONESHOT, ctx) < 0) {
+                    stream_release_io(ctx);
                     close(ctx->file_fd);
-                    close(ctx->client_fd);
-                    free(ctx);
+                    http_close_client(ctx);
                 }
                 return;
             } else if (errno == EPIPE || errno == ECONNRESET) {
-            printf("[Stream] Client closed connection (Normal for probing)\n");
+            LOG_DEBUG("Stream", "Client closed connection (normal for probing)");
             
+            stream_release_io(ctx);
             close(ctx->file_fd);
-            close(ctx->client_fd);
-            free(ctx);
+            http_close_client(ctx);
             return; // 조용히 종료
             }
             // [에러]
-            perror("stream: sendfile error");
+            LOG_WARN("Stream", "sendfile error: %m");
             send_error_response(ctx, 500);
             return;
         } 
@@ -233,4 +276,108 @@ static void continue_sending_file(ClientContext *ctx) {
              return;
         }
     }
-}
\ No newline at end of file
+}
+
+// 전송 우선순위: 읽어둔 direct 버퍼 -> 세그먼트 캐시 -> direct 비동기 읽기 -> sendfile
+// (모두 file_offset을 전진시킴)
+static ssize_t send_body_chunk(ClientContext *ctx) {
+    if (ctx->io_buf >= 0) {
+        return send_io_buffer(ctx);
+    }
+
+    if (segment_cache_enabled()) {
+        SegmentRef ref;
+        if (segment_cache_get(ctx->file_dev, ctx->file_ino, ctx->file_mtime, ctx->file_size,
+                              ctx->file_fd, ctx->file_offset, &ref) == 0) {
+            size_t to_send = (ref.len < ctx->bytes_remaining) ? ref.len : ctx->bytes_remaining;
+            ssize_t sent = send(ctx->client_fd, ref.data, to_send, 0);
+            int saved_errno = errno;
+
+            segment_cache_release(&ref, (sent > 0) ? (size_t)sent : 0);
+            if (sent > 0) ctx->file_offset += sent;
+
+            errno = saved_errno;
+            return sent;
+        }
+    }
+
+    if (ctx->direct_fd >= 0) {
+        // 정렬된 위치부터 버퍼 하나만큼 읽기 제출. 워커는 디스크를 기다리지 않고 반환
+        off_t aligned = ctx->file_offset & ~((off_t)URING_READER_ALIGN - 1);
+        ctx->io_skip = ctx->file_offset - aligned;
+        if (uring_reader_read(ctx->direct_fd, aligned, on_direct_read_done, ctx) == 0) {
+            return SEND_PARKED;
+        }
+        // 버퍼 풀 고갈 -> 이번 조각은 sendfile
+    }
+
+    return send_file_range(ctx);
+}
+
+static ssize_t send_io_buffer(ClientContext *ctx) {
+    if (ctx->io_result < 0 || ctx->io_len == 0) {
+        // 읽기 실패(또는 파일이 잘림) -> 이 연결은 sendfile로 전환 (장치 큐는 그대로 유지)
+        if (ctx->io_result < 0) {
+            LOG_WARN("Stream", "Direct read failed (%s), falling back to sendfile",
+                     strerror(-ctx->io_result));
+        }
+        release_direct(ctx);
+        return send_file_range(ctx);
+    }
+
+    size_t to_send = (ctx->io_len < ctx->bytes_remaining) ? ctx->io_len : ctx->bytes_remaining;
+    ssize_t sent = send(ctx->client_fd, ctx->io_data, to_send, 0);
+    if (sent > 0) {
+        ctx->io_data += sent;
+        ctx->io_len -= sent;
+        ctx->file_offset += sent;
+        if (ctx->io_len == 0 || (size_t)sent == ctx->bytes_remaining) {
+            uring_reader_release(ctx->io_buf); // 다 보냄 -> 다음 루프에서 다음 읽기 제출
+            ctx->io_buf = -1;
+        }
+    }
+    return sent;
+}
+
+static ssize_t send_file_range(ClientContext *ctx) {
+    ssize_t sent = sendfile(ctx->client_fd, ctx->file_fd, &ctx->file_offset, ctx->bytes_remaining);
+    if (sent > 0) metrics_add(M_SENDFILE_BYTES, (unsigned long long)sent);
+    return sent;
+}
+
+// 완료 스레드에서 호출: 결과를 ctx에 기록하고 소켓 쓰기를 재개시킴
+static void on_direct_read_done(void *arg, int buf_idx, const char *data, int result) {
+    ClientContext *ctx = (ClientContext *)arg;
+    ctx->io_buf = buf_idx;
+    ctx->io_result = result;
+    ctx->io_data = NULL;
+    ctx->io_len = 0;
+
+    if (result > ctx->io_skip) {
+        ctx->io_data = data + ctx->io_skip;
+        ctx->io_len = (size_t)(result - ctx->io_skip);
+    }
+
+    if (reactor_update_event(ctx->epoll_fd, ctx->client_fd, EPOLLOUT | EPOLLONESHOT, ctx) < 0) {
+        stream_release_io(ctx);
+        close(ctx->file_fd);
+        http_close_client(ctx);
+    }
+}
+
+void stream_release_io(ClientContext *ctx) {
+    device_io_release(ctx);
+    release_direct(ctx);
+}
+
+// direct 읽기 버퍼와 O_DIRECT fd만 놓음
+static void release_direct(ClientContext *ctx) {
+    if (ctx->io_buf >= 0) {
+        uring_reader_release(ctx->io_buf);
+        ctx->io_buf = -1;
+    }
+    if (ctx->direct_fd >= 0) {
+        close(ctx->direct_fd);
+        ctx->direct_fd = -1;
+    }
+}
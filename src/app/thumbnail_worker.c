@@ -0,0 +1,717 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+
+#include "app/thumbnail_worker.h"
+#include "app/db_handler.h"
+#include "app/library_scanner.h"
+#include "core/thread_pool.h"
+
+#define THUMB_PATH_LEN      512
+#define THUMB_WIDTH         320     // 썸네일 가로 크기 (세로는 원본 비율 유지)
+#define THUMB_AT_SEC        5.0     // 썸네일로 사용할 프레임 위치 (초)
+#define MAX_DECODE_FRAMES   256     // 목표 시점까지 디코딩할 최대 프레임 수 (무한 디코딩 방지)
+
+// Trickplay (탐색 미리보기) 스프라이트 시트
+#define TRICKPLAY_DIR       "./static/trickplay"
+#define TRICKPLAY_TILE_W    160     // 타일 1칸 가로 크기
+#define TRICKPLAY_COLS      10      // 시트 1장당 10 x 10 타일
+#define TRICKPLAY_ROWS      10
+
+typedef enum {
+    JOB_THUMBNAIL,
+    JOB_TRICKPLAY
+} ThumbJobKind;
+
+typedef struct {
+    ThumbJobKind kind;
+    int video_id;                       // trickplay 출력 디렉토리 이름
+    char video_path[THUMB_PATH_LEN];
+    char thumb_path[THUMB_PATH_LEN];    // JOB_THUMBNAIL 전용
+} ThumbJob;
+
+// 디코딩 중인 입력 파일 (포맷 + 비디오 디코더)
+typedef struct {
+    AVFormatContext *fmt;
+    AVCodecContext *dec;
+    AVPacket *pkt;
+    AVFrame *frame;
+    int stream_idx;
+} MediaInput;
+
+// 내부 전역 변수
+static ThreadPool g_thumb_pool;
+static bool g_pool_started = false;
+static volatile bool g_stop = false;   // 종료 시 대기 중인 작업을 건너뛰기 위한 플래그
+static int g_trickplay_interval = 0;   // 스프라이트 타일 간격 (초), 0이면 비활성
+
+static pthread_t g_feeder;
+static bool g_feeder_started = false;
+
+// 내부 헬퍼 함수
+static int enqueue_job(ThumbJob *job);
+static void thumbnail_job_func(void *arg);
+static void trickplay_job_func(ThumbJob *job);
+static int mkdir_p(const char *path);
+static void remove_stale_sprites(const char *dir, const char *keep_prefix);
+static void* catalog_feeder_func(void *arg);
+static int is_up_to_date(const char *video_path, const char *thumb_path);
+static int media_open(MediaInput *in, const char *path);
+static void media_close(MediaInput *in);
+static double media_duration_sec(const MediaInput *in);
+static int media_decode_at(MediaInput *in, double at_sec);
+static AVFrame* scale_frame(const AVFrame *src, int dst_w, int dst_h, enum AVPixelFormat fmt);
+static int is_webp_path(const char *path);
+static int encode_image_atomic(const AVFrame *img, const char *out_path);
+static int write_file_atomic(const char *path, const uint8_t *data, size_t len);
+
+int thumbnail_worker_init(int num_threads, int queue_capacity, int trickplay_interval_sec) {
+    if (num_threads <= 0) num_threads = 1;
+    if (queue_capacity <= 0) queue_capacity = 64;
+    g_trickplay_interval = (trickplay_interval_sec > 0) ? trickplay_interval_sec : 0;
+
+    // libav 내부 로그가 서버 로그를 덮지 않도록 에러만 출력
+    av_log_set_level(AV_LOG_ERROR);
+
+    g_stop = false;
+    if (thread_pool_init(&g_thumb_pool, num_threads, queue_capacity) != 0) {
+        fprintf(stderr, "[Thumb] Failed to init thumbnail pool.\n");
+        return -1;
+    }
+    g_pool_started = true;
+
+    printf("[Thumb] Worker pool started (%d threads).\n", num_threads);
+    return 0;
+}
+
+int thumbnail_worker_submit(const char *video_path, const char *thumb_path) {
+    if (!g_pool_started || g_stop || !video_path || !thumb_path) return -1;
+
+    ThumbJob *job = (ThumbJob *)calloc(1, sizeof(ThumbJob));
+    if (!job) return -1;
+
+    job->kind = JOB_THUMBNAIL;
+    snprintf(job->video_path, sizeof(job->video_path), "%s", video_path);
+    snprintf(job->thumb_path, sizeof(job->thumb_path), "%s", thumb_path);
+    return enqueue_job(job);
+}
+
+int thumbnail_worker_submit_trickplay(int video_id, const char *video_path) {
+    if (!g_pool_started || g_stop || !video_path) return -1;
+    if (g_trickplay_interval <= 0) return 0; // 비활성
+
+    ThumbJob *job = (ThumbJob *)calloc(1, sizeof(ThumbJob));
+    if (!job) return -1;
+
+    job->kind = JOB_TRICKPLAY;
+    job->video_id = video_id;
+    snprintf(job->video_path, sizeof(job->video_path), "%s", video_path);
+    return enqueue_job(job);
+}
+
+static int enqueue_job(ThumbJob *job) {
+    // 카탈로그 전체를 밀어넣는 경우가 있으므로 Drop 대신 Blocking enqueue 사용
+    // (호출자는 요청 처리 스레드가 아닌 feeder/scanner 스레드)
+    Task task = {.function = thumbnail_job_func, .arg = job};
+    if (task_queue_enqueue(&g_thumb_pool.queue, task) != 0) {
+        free(job); // 종료 중이라 큐가 받지 않음
+        return -1;
+    }
+    return 0;
+}
+
+int thumbnail_worker_schedule_catalog(void) {
+    if (!g_pool_started || g_feeder_started) return -1;
+
+    if (pthread_create(&g_feeder, NULL, catalog_feeder_func, NULL) != 0) {
+        perror("[Thumb] Failed to create feeder thread");
+        return -1;
+    }
+    g_feeder_started = true;
+    return 0;
+}
+
+void thumbnail_worker_shutdown(void) {
+    if (!g_pool_started) return;
+
+    // 1. 새 작업 차단 + 대기 중인 작업은 즉시 리턴하도록 표시
+    g_stop = true;
+    thread_pool_shutdown(&g_thumb_pool);
+
+    // 2. feeder가 enqueue에서 막혀 있어도 워커가 큐를 비우면서 풀려남
+    if (g_feeder_started) {
+        pthread_join(g_feeder, NULL);
+        g_feeder_started = false;
+    }
+
+    thread_pool_wait(&g_thumb_pool);
+    thread_pool_cleanup(&g_thumb_pool);
+    g_pool_started = false;
+
+    printf("[Thumb] Worker pool stopped.\n");
+}
+
+// =========================================================
+// 카탈로그 feeder
+// =========================================================
+
+typedef struct {
+    ThumbJob *items;
+    int count;
+    int cap;
+} ThumbJobList;
+
+static void collect_video_cb(int id, const char *filepath, const char *thumbnail, void *arg) {
+    ThumbJobList *list = (ThumbJobList *)arg;
+    if (!filepath) return;
+
+    if (list->count == list->cap) {
+        int new_cap = list->cap ? list->cap * 2 : 64;
+        ThumbJob *grown = (ThumbJob *)realloc(list->items, new_cap * sizeof(ThumbJob));
+        if (!grown) return;
+        list->items = grown;
+        list->cap = new_cap;
+    }
+
+    ThumbJob *job = &list->items[list->count++];
+    memset(job, 0, sizeof(*job));
+    job->video_id = id;
+
+    // URL 경로 -> 물리 경로 (route_request의 매핑 규칙과 동일)
+    // 비디오: 미디어 루트 매핑 (/videos/a.mp4 -> <루트0>/a.mp4)
+    // 썸네일: /thumb1.jpg -> static/thumb1.jpg, /static/x.jpg -> ./static/x.jpg
+    if (library_resolve_url(filepath, job->video_path, sizeof(job->video_path)) < 0) {
+        snprintf(job->video_path, sizeof(job->video_path), ".%s", filepath);
+    }
+    if (!thumbnail || thumbnail[0] == '\0') {
+        job->thumb_path[0] = '\0'; // 썸네일 없음: trickplay만 생성
+    } else if (strncmp(thumbnail, "/static/", 8) == 0) {
+        snprintf(job->thumb_path, sizeof(job->thumb_path), ".%s", thumbnail);
+    } else {
+        snprintf(job->thumb_path, sizeof(job->thumb_path), "static%s", thumbnail);
+    }
+}
+
+static void* catalog_feeder_func(void *arg) {
+    (void)arg;
+    ThumbJobList list = {0};
+
+    // DB 조회는 먼저 끝내고 (statement를 오래 잡지 않도록) 큐 투입은 그 다음에
+    if (db_for_each_video(collect_video_cb, &list) != 0) {
+        fprintf(stderr, "[Thumb] Failed to read catalog.\n");
+    }
+
+    // 목록 썸네일을 먼저 모두 채우고, 무거운 trickplay는 그 다음에
+    for (int i = 0; i < list.count && !g_stop; i++) {
+        if (list.items[i].thumb_path[0] != '\0') {
+            thumbnail_worker_submit(list.items[i].video_path, list.items[i].thumb_path);
+        }
+    }
+    for (int i = 0; i < list.count && !g_stop; i++) {
+        thumbnail_worker_submit_trickplay(list.items[i].video_id, list.items[i].video_path);
+    }
+
+    printf("[Thumb] Scheduled %d catalog thumbnails.\n", list.count);
+    free(list.items);
+    return NULL;
+}
+
+// =========================================================
+// 썸네일 작업 (워커 스레드에서 실행)
+// =========================================================
+
+static void thumbnail_job_func(void *arg) {
+    ThumbJob *job = (ThumbJob *)arg;
+    if (g_stop) {
+        free(job);
+        return;
+    }
+
+    if (job->kind == JOB_TRICKPLAY) {
+        trickplay_job_func(job);
+        free(job);
+        return;
+    }
+
+    if (is_up_to_date(job->video_path, job->thumb_path)) {
+        free(job);
+        return;
+    }
+
+    MediaInput in;
+    if (media_open(&in, job->video_path) != 0) {
+        fprintf(stderr, "[Thumb] Cannot open video: %s\n", job->video_path);
+        free(job);
+        return;
+    }
+
+    // 영상이 THUMB_AT_SEC보다 짧으면 1/3 지점 사용
+    double at = THUMB_AT_SEC;
+    double duration = media_duration_sec(&in);
+    if (duration > 0 && at >= duration) at = duration / 3.0;
+
+    if (media_decode_at(&in, at) != 0) {
+        fprintf(stderr, "[Thumb] Failed to decode frame: %s\n", job->video_path);
+        media_close(&in);
+        free(job);
+        return;
+    }
+
+    // 원본 비율 유지 (YUV 4:2:0 이므로 짝수로 맞춤)
+    int dst_w = THUMB_WIDTH;
+    int dst_h = (int)((int64_t)in.frame->height * dst_w / in.frame->width) & ~1;
+    if (dst_h <= 0) dst_h = 2;
+
+    enum AVPixelFormat pix_fmt = is_webp_path(job->thumb_path) ? AV_PIX_FMT_YUV420P
+                                                               : AV_PIX_FMT_YUVJ420P;
+    AVFrame *img = scale_frame(in.frame, dst_w, dst_h, pix_fmt);
+    media_close(&in);
+
+    if (!img) {
+        free(job);
+        return;
+    }
+
+    // 썸네일 하위 디렉토리 (예: static/thumbs/) 가 없으면 생성
+    char dir[THUMB_PATH_LEN];
+    snprintf(dir, sizeof(dir), "%s", job->thumb_path);
+    char *slash = strrchr(dir, '/');
+    if (slash && slash != dir) {
+        *slash = '\0';
+        mkdir_p(dir);
+    }
+
+    if (encode_image_atomic(img, job->thumb_path) == 0) {
+        printf("[Thumb] Generated: %s\n", job->thumb_path);
+    }
+
+    av_frame_free(&img);
+    free(job);
+}
+
+// =========================================================
+// Trickplay 스프라이트 시트 + WebVTT 인덱스
+// =========================================================
+// 출력: ./static/trickplay/<video_id>/index.vtt
+//       ./static/trickplay/<video_id>/sprite_<mtime>_<n>.jpg
+// 스프라이트 파일명에 원본 mtime을 넣어 내용이 바뀌면 URL도 바뀌게 함
+// (정적 핸들러가 스프라이트에 immutable 캐시 헤더를 붙일 수 있도록)
+
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} TextBuf;
+
+static int textbuf_appendf(TextBuf *tb, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void format_vtt_time(double sec, char *out, size_t out_len) {
+    long ms = (long)(sec * 1000.0);
+    snprintf(out, out_len, "%02ld:%02ld:%02ld.%03ld",
+             ms / 3600000, (ms / 60000) % 60, (ms / 1000) % 60, ms % 1000);
+}
+
+// 캔버스를 검은색(JPEG full range)으로 초기화
+static void fill_black(AVFrame *canvas) {
+    memset(canvas->data[0], 0, (size_t)canvas->linesize[0] * canvas->height);
+    memset(canvas->data[1], 128, (size_t)canvas->linesize[1] * (canvas->height / 2));
+    memset(canvas->data[2], 128, (size_t)canvas->linesize[2] * (canvas->height / 2));
+}
+
+static void trickplay_job_func(ThumbJob *job) {
+    char dir[THUMB_PATH_LEN];
+    char vtt_path[THUMB_PATH_LEN + 16];
+    snprintf(dir, sizeof(dir), TRICKPLAY_DIR "/%d", job->video_id);
+    snprintf(vtt_path, sizeof(vtt_path), "%s/index.vtt", dir);
+
+    // index.vtt는 스프라이트를 모두 쓴 뒤 마지막에 저장하므로 완료 표시로 사용
+    if (is_up_to_date(job->video_path, vtt_path)) return;
+
+    struct stat vst;
+    if (stat(job->video_path, &vst) != 0) return;
+
+    if (mkdir_p(dir) != 0) {
+        fprintf(stderr, "[Trickplay] Cannot create dir: %s\n", dir);
+        return;
+    }
+
+    MediaInput in;
+    if (media_open(&in, job->video_path) != 0) {
+        fprintf(stderr, "[Trickplay] Cannot open video: %s\n", job->video_path);
+        return;
+    }
+
+    double duration = media_duration_sec(&in);
+    int interval = g_trickplay_interval;
+    int tile_count = (duration > 0) ? (int)(duration / interval) : 0;
+    if (tile_count <= 0) {
+        media_close(&in);
+        return;
+    }
+
+    AVStream *st = in.fmt->streams[in.stream_idx];
+    int src_w = st->codecpar->width;
+    int src_h = st->codecpar->height;
+    if (src_w <= 0 || src_h <= 0) {
+        media_close(&in);
+        return;
+    }
+
+    const int tile_w = TRICKPLAY_TILE_W;
+    int tile_h = (int)((int64_t)src_h * tile_w / src_w) & ~1;
+    if (tile_h <= 0) tile_h = 2;
+
+    const int per_sheet = TRICKPLAY_COLS * TRICKPLAY_ROWS;
+    char sprite_prefix[64];
+    snprintf(sprite_prefix, sizeof(sprite_prefix), "sprite_%ld_", (long)vst.st_mtime);
+
+    TextBuf vtt = {0};
+    textbuf_appendf(&vtt, "WEBVTT\n\n");
+
+    struct SwsContext *sws = NULL;
+    AVFrame *canvas = NULL;
+    int ok = 1;
+    int sheets = 0;
+
+    for (int i = 0; i < tile_count && ok && !g_stop; i++) {
+        int slot = i % per_sheet;
+        int sheet_idx = i / per_sheet;
+
+        // 새 시트 시작: 남은 타일 수에 맞춰 행 수 결정
+        if (slot == 0) {
+            int remaining = tile_count - i;
+            int cells = remaining < per_sheet ? remaining : per_sheet;
+            int cols = cells < TRICKPLAY_COLS ? cells : TRICKPLAY_COLS;
+            int rows = (cells + TRICKPLAY_COLS - 1) / TRICKPLAY_COLS;
+
+            canvas = av_frame_alloc();
+            if (!canvas) { ok = 0; break; }
+            canvas->format = AV_PIX_FMT_YUVJ420P;
+            canvas->width = cols * tile_w;
+            canvas->height = rows * tile_h;
+            if (av_frame_get_buffer(canvas, 0) < 0) { ok = 0; break; }
+            fill_black(canvas);
+        }
+
+        int x = (slot % TRICKPLAY_COLS) * tile_w;
+        int y = (slot / TRICKPLAY_COLS) * tile_h;
+
+        // 디코딩 실패한 타일은 검은 칸으로 남겨둠 (cue는 그대로 유지)
+        if (media_decode_at(&in, (double)i * interval) == 0) {
+            AVFrame *f = in.frame;
+            sws = sws_getCachedContext(sws, f->width, f->height, (enum AVPixelFormat)f->format,
+                                       tile_w, tile_h, AV_PIX_FMT_YUVJ420P,
+                                       SWS_BILINEAR, NULL, NULL, NULL);
+            if (sws) {
+                uint8_t *dst[4] = {
+                    canvas->data[0] + (size_t)y * canvas->linesize[0] + x,
+                    canvas->data[1] + (size_t)(y / 2) * canvas->linesize[1] + x / 2,
+                    canvas->data[2] + (size_t)(y / 2) * canvas->linesize[2] + x / 2,
+                    NULL
+                };
+                sws_scale(sws, (const uint8_t * const *)f->data, f->linesize, 0, f->height,
+                          dst, canvas->linesize);
+            }
+        }
+
+        char t_start[16], t_end[16];
+        double end_sec = (i == tile_count - 1) ? duration : (double)(i + 1) * interval;
+        format_vtt_time((double)i * interval, t_start, sizeof(t_start));
+        format_vtt_time(end_sec, t_end, sizeof(t_end));
+        textbuf_appendf(&vtt, "%s --> %s\n%s%d.jpg#xywh=%d,%d,%d,%d\n\n",
+                        t_start, t_end, sprite_prefix, sheet_idx, x, y, tile_w, tile_h);
+
+        // 시트가 꽉 찼거나 마지막 타일이면 인코딩
+        if (slot == per_sheet - 1 || i == tile_count - 1) {
+            char sprite_path[THUMB_PATH_LEN + 96];
+            snprintf(sprite_path, sizeof(sprite_path), "%s/%s%d.jpg", dir, sprite_prefix, sheet_idx);
+            if (encode_image_atomic(canvas, sprite_path) != 0) ok = 0;
+            av_frame_free(&canvas);
+            sheets++;
+        }
+    }
+
+    if (canvas) av_frame_free(&canvas);
+    if (sws) sws_freeContext(sws);
+    media_close(&in);
+
+    if (ok && !g_stop && vtt.data &&
+        write_file_atomic(vtt_path, (const uint8_t *)vtt.data, vtt.len) == 0) {
+        remove_stale_sprites(dir, sprite_prefix);
+        printf("[Trickplay] Generated %d tiles / %d sheets: %s\n", tile_count, sheets, dir);
+    }
+    free(vtt.data);
+}
+
+static int textbuf_appendf(TextBuf *tb, const char *fmt, ...) {
+    va_list ap;
+    while (1) {
+        size_t avail = tb->cap - tb->len;
+        va_start(ap, fmt);
+        int n = vsnprintf(tb->data ? tb->data + tb->len : NULL, avail, fmt, ap);
+        va_end(ap);
+        if (n < 0) return -1;
+        if ((size_t)n < avail) {
+            tb->len += (size_t)n;
+            return 0;
+        }
+
+        size_t new_cap = tb->cap ? tb->cap * 2 : 4096;
+        while (new_cap - tb->len <= (size_t)n) new_cap *= 2;
+        char *grown = (char *)realloc(tb->data, new_cap);
+        if (!grown) return -1;
+        tb->data = grown;
+        tb->cap = new_cap;
+    }
+}
+
+static int mkdir_p(const char *path) {
+    char buf[THUMB_PATH_LEN];
+    snprintf(buf, sizeof(buf), "%s", path);
+
+    for (char *p = buf + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        if (mkdir(buf, 0755) != 0 && errno != EEXIST) return -1;
+        *p = '/';
+    }
+    if (mkdir(buf, 0755) != 0 && errno != EEXIST) return -1;
+    return 0;
+}
+
+// 이전 버전(mtime이 다른) 스프라이트 정리
+static void remove_stale_sprites(const char *dir, const char *keep_prefix) {
+    DIR *d = opendir(dir);
+    if (!d) return;
+
+    struct dirent *ent;
+    char path[THUMB_PATH_LEN + 256 + 2];
+    while ((ent = readdir(d)) != NULL) {
+        if (strncmp(ent->d_name, "sprite_", 7) != 0) continue;
+        if (strncmp(ent->d_name, keep_prefix, strlen(keep_prefix)) == 0) continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+        unlink(path);
+    }
+    closedir(d);
+}
+
+// 썸네일이 존재하고 원본보다 최신이면 1
+static int is_up_to_date(const char *video_path, const char *thumb_path) {
+    struct stat vst, tst;
+    if (stat(video_path, &vst) != 0) return 0;
+    if (stat(thumb_path, &tst) != 0) return 0;
+    return tst.st_mtime >= vst.st_mtime;
+}
+
+// =========================================================
+// libav 헬퍼
+// =========================================================
+
+static int media_open(MediaInput *in, const char *path) {
+    memset(in, 0, sizeof(*in));
+    in->stream_idx = -1;
+
+    if (avformat_open_input(&in->fmt, path, NULL, NULL) < 0) return -1;
+    if (avformat_find_stream_info(in->fmt, NULL) < 0) goto fail;
+
+    in->stream_idx = av_find_best_stream(in->fmt, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+    if (in->stream_idx < 0) goto fail;
+
+    AVStream *st = in->fmt->streams[in->stream_idx];
+    const AVCodec *codec = avcodec_find_decoder(st->codecpar->codec_id);
+    if (!codec) goto fail;
+
+    in->dec = avcodec_alloc_context3(codec);
+    if (!in->dec) goto fail;
+    if (avcodec_parameters_to_context(in->dec, st->codecpar) < 0) goto fail;
+
+    // 풀 스레드 하나가 코어 하나만 쓰도록 (요청 처리 워커와 CPU 경쟁 최소화)
+    in->dec->thread_count = 1;
+    if (avcodec_open2(in->dec, codec, NULL) < 0) goto fail;
+
+    in->pkt = av_packet_alloc();
+    in->frame = av_frame_alloc();
+    if (!in->pkt || !in->frame) goto fail;
+    return 0;
+
+fail:
+    media_close(in);
+    return -1;
+}
+
+static void media_close(MediaInput *in) {
+    if (in->frame) av_frame_free(&in->frame);
+    if (in->pkt) av_packet_free(&in->pkt);
+    if (in->dec) avcodec_free_context(&in->dec);
+    if (in->fmt) avformat_close_input(&in->fmt);
+}
+
+static double media_duration_sec(const MediaInput *in) {
+    if (!in->fmt || in->fmt->duration == AV_NOPTS_VALUE) return 0;
+    return (double)in->fmt->duration / AV_TIME_BASE;
+}
+
+// at_sec 시점(직후)의 프레임을 in->frame에 디코딩. 성공 0, 실패 -1
+static int media_decode_at(MediaInput *in, double at_sec) {
+    AVStream *st = in->fmt->streams[in->stream_idx];
+    int64_t target = (int64_t)(at_sec / av_q2d(st->time_base));
+    if (st->start_time != AV_NOPTS_VALUE) target += st->start_time;
+
+    av_frame_unref(in->frame);
+
+    // 키프레임 기준으로 뒤로 seek 후 목표 시점까지 디코딩
+    if (av_seek_frame(in->fmt, in->stream_idx, target, AVSEEK_FLAG_BACKWARD) < 0) {
+        target = AV_NOPTS_VALUE; // seek 불가 포맷: 처음부터 첫 프레임 사용
+    }
+    avcodec_flush_buffers(in->dec);
+
+    int decoded = 0;
+    int ret;
+    while (av_read_frame(in->fmt, in->pkt) >= 0) {
+        if (in->pkt->stream_index != in->stream_idx) {
+            av_packet_unref(in->pkt);
+            continue;
+        }
+
+        ret = avcodec_send_packet(in->dec, in->pkt);
+        av_packet_unref(in->pkt);
+        if (ret < 0 && ret != AVERROR(EAGAIN)) return -1;
+
+        while ((ret = avcodec_receive_frame(in->dec, in->frame)) >= 0) {
+            int64_t pts = in->frame->best_effort_timestamp;
+            if (target == AV_NOPTS_VALUE || pts == AV_NOPTS_VALUE || pts >= target ||
+                ++decoded >= MAX_DECODE_FRAMES) {
+                return 0;
+            }
+            av_frame_unref(in->frame);
+        }
+        if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) return -1;
+    }
+
+    // 파일 끝: 디코더에 남은 프레임이라도 사용
+    avcodec_send_packet(in->dec, NULL);
+    if (avcodec_receive_frame(in->dec, in->frame) >= 0) return 0;
+    return -1;
+}
+
+static AVFrame* scale_frame(const AVFrame *src, int dst_w, int dst_h, enum AVPixelFormat fmt) {
+    AVFrame *dst = av_frame_alloc();
+    if (!dst) return NULL;
+
+    dst->format = fmt;
+    dst->width = dst_w;
+    dst->height = dst_h;
+    if (av_frame_get_buffer(dst, 0) < 0) {
+        av_frame_free(&dst);
+        return NULL;
+    }
+
+    struct SwsContext *sws = sws_getContext(src->width, src->height, (enum AVPixelFormat)src->format,
+                                            dst_w, dst_h, fmt, SWS_BILINEAR, NULL, NULL, NULL);
+    if (!sws) {
+        av_frame_free(&dst);
+        return NULL;
+    }
+
+    sws_scale(sws, (const uint8_t * const *)src->data, src->linesize, 0, src->height,
+              dst->data, dst->linesize);
+    sws_freeContext(sws);
+    return dst;
+}
+
+static int is_webp_path(const char *path) {
+    const char *ext = strrchr(path, '.');
+    return ext && strcmp(ext, ".webp") == 0;
+}
+
+// 프레임 1장을 JPEG/WebP로 인코딩하여 원자적으로 저장
+static int encode_image_atomic(const AVFrame *img, const char *out_path) {
+    enum AVCodecID codec_id = is_webp_path(out_path) ? AV_CODEC_ID_WEBP : AV_CODEC_ID_MJPEG;
+    const AVCodec *enc = avcodec_find_encoder(codec_id);
+    if (!enc) {
+        fprintf(stderr, "[Thumb] Encoder not available for %s\n", out_path);
+        return -1;
+    }
+
+    AVCodecContext *c = avcodec_alloc_context3(enc);
+    if (!c) return -1;
+
+    c->width = img->width;
+    c->height = img->height;
+    c->pix_fmt = (enum AVPixelFormat)img->format;
+    c->time_base = (AVRational){1, 25};
+    if (codec_id == AV_CODEC_ID_MJPEG) {
+        c->color_range = AVCOL_RANGE_JPEG;
+        c->flags |= AV_CODEC_FLAG_QSCALE;
+        c->global_quality = FF_QP2LAMBDA * 4; // q=4 (2~31, 낮을수록 고화질)
+    }
+
+    int result = -1;
+    AVPacket *pkt = NULL;
+
+    if (avcodec_open2(c, enc, NULL) < 0) goto out;
+
+    pkt = av_packet_alloc();
+    if (!pkt) goto out;
+
+    if (avcodec_send_frame(c, img) < 0) goto out;
+    avcodec_send_frame(c, NULL); // flush
+
+    if (avcodec_receive_packet(c, pkt) == 0) {
+        result = write_file_atomic(out_path, pkt->data, pkt->size);
+        av_packet_unref(pkt);
+    }
+
+out:
+    if (pkt) av_packet_free(&pkt);
+    avcodec_free_context(&c);
+    if (result != 0) fprintf(stderr, "[Thumb] Failed to encode: %s\n", out_path);
+    return result;
+}
+
+// 임시 파일에 쓴 뒤 rename: 정적 핸들러가 반쯤 써진 이미지를 보내는 일이 없음
+static int write_file_atomic(const char *path, const uint8_t *data, size_t len) {
+    char tmp_path[THUMB_PATH_LEN + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path);
+
+    int fd = mkstemp(tmp_path);
+    if (fd < 0) {
+        perror("[Thumb] mkstemp failed");
+        return -1;
+    }
+    fchmod(fd, 0644);
+
+    size_t written = 0;
+    while (written < len) {
+        ssize_t n = write(fd, data + written, len - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("[Thumb] write failed");
+            close(fd);
+            unlink(tmp_path);
+            return -1;
+        }
+        written += (size_t)n;
+    }
+    close(fd);
+
+    if (rename(tmp_path, path) != 0) {
+        perror("[Thumb] rename failed");
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,594 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <time.h>
+#include <dirent.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "app/tiering.h"
+
+#define TIER_PATH_LEN       1024
+#define TIER_BUCKETS        4096
+#define HALF_LIFE_SEC       3600.0  // 인기도 반감기
+#define COPY_CHUNK          (1024 * 1024)
+#define COPIER_INTERVAL_SEC 5       // 승격 후보가 없을 때 점검 주기
+#define VERIFY_INTERVAL_SEC 60      // 원본 변경 여부 재확인 주기
+#define MAX_TRACKED         65536   // 추적 항목 상한 (넘으면 새 비디오는 추적하지 않음)
+#define PRUNE_SCORE         0.05    // 사본 없는 항목이 이 아래로 식으면 추적 해제 (1회 요청 기준 약 4시간)
+#define RETRY_BASE_SEC      30      // 승격 실패(원본 없음, 복사 오류) 후 첫 재시도까지, 실패마다 2배
+#define RETRY_MAX_SEC       3600
+
+typedef enum {
+    FAST_NONE,          // 원본만 있음
+    FAST_COPYING,       // 복사 중
+    FAST_READY,         // 사본 사용 가능
+    FAST_UNVERIFIED     // 재시작 전에 만든 사본 (원본과 비교 전)
+} FastState;
+
+typedef struct TierEntry {
+    uint64_t key;               // 원본 경로 해시 (사본 파일명)
+    char *src_path;             // 원본 물리 경로 (재시작 후 아직 요청이 없으면 NULL)
+    double score;               // 감쇠 적용된 요청 수
+    time_t score_time;          // score를 마지막으로 감쇠한 시각
+    FastState state;
+    long long fast_size;
+    bool too_large;             // 빠른 계층 전체보다 커서 승격 불가
+    int failures;               // 연속 승격 실패 수 (성공하면 0)
+    time_t retry_at;            // 이 시각 전에는 다시 고르지 않음
+    struct TierEntry *next;
+} TierEntry;
+
+// 내부 전역 변수
+static bool g_enabled = false;
+static char g_fast_dir[TIER_PATH_LEN];
+static long long g_max_bytes = 0;
+static double g_threshold = 20.0;
+static long long g_copy_rate = 0; // bytes/sec
+
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_wake = PTHREAD_COND_INITIALIZER;
+static TierEntry *g_buckets[TIER_BUCKETS];
+static TieringStats g_stats;
+static volatile bool g_stop = false;
+static bool g_verify_requested = false; // 재시작 전 사본의 원본 경로를 알게 됨
+static pthread_t g_copier;
+static bool g_copier_started = false;
+
+// 내부 헬퍼 함수
+static uint64_t hash_path(const char *path);
+static void fast_path_for(uint64_t key, const char *suffix, char *out, size_t out_len);
+static TierEntry* entry_get(uint64_t key, bool create);
+static double decayed_score(TierEntry *e, time_t now);
+static void adopt_existing_copies(void);
+static void* copier_thread_func(void *arg);
+static void verify_copies(void);
+static TierEntry* pick_candidate(time_t now);
+static bool make_room(long long need, double candidate_score, time_t now);
+static void demote_locked(TierEntry *e);
+static void prune_cold_locked(time_t now);
+static void schedule_retry_locked(TierEntry *e, time_t now);
+static int copy_throttled(const char *src, const char *dst, long long size);
+
+int tiering_init(const char *fast_dir, size_t max_mb, int promote_threshold, int copy_rate_mbps) {
+    if (!fast_dir || fast_dir[0] == '\0' || max_mb == 0) {
+        printf("[Tier] Disabled (no FAST_TIER_DIR).\n");
+        return -1;
+    }
+
+    snprintf(g_fast_dir, sizeof(g_fast_dir), "%s", fast_dir);
+    size_t len = strlen(g_fast_dir);
+    while (len > 1 && g_fast_dir[len - 1] == '/') g_fast_dir[--len] = '\0';
+
+    if (mkdir(g_fast_dir, 0755) != 0 && errno != EEXIST) {
+        perror("[Tier] Cannot create fast tier directory");
+        return -1;
+    }
+
+    g_max_bytes = (long long)max_mb * 1024 * 1024;
+    g_threshold = (promote_threshold > 0) ? promote_threshold : 1;
+    g_copy_rate = (long long)copy_rate_mbps * 1024 * 1024;
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_stats.max_bytes = (unsigned long long)g_max_bytes;
+
+    adopt_existing_copies();
+
+    g_stop = false;
+    g_enabled = true;
+    if (pthread_create(&g_copier, NULL, copier_thread_func, NULL) != 0) {
+        perror("[Tier] Failed to create copier thread");
+        g_enabled = false;
+        return -1;
+    }
+    g_copier_started = true;
+
+    printf("[Tier] Fast tier: %s (max %zu MB, promote at %d req, %d MB/s)\n",
+           g_fast_dir, max_mb, (int)g_threshold, copy_rate_mbps);
+    return 0;
+}
+
+int tiering_enabled(void) {
+    return g_enabled;
+}
+
+const char* tiering_fast_dir(void) {
+    return g_enabled ? g_fast_dir : NULL;
+}
+
+void tiering_resolve(char *path, size_t path_len) {
+    if (!g_enabled || !path) return;
+
+    uint64_t key = hash_path(path);
+    time_t now = time(NULL);
+    bool use_fast = false;
+    bool wake = false;
+
+    pthread_mutex_lock(&g_mutex);
+    // 처음 보는 경로는 여기서 만들지 않음 (파일을 연 뒤 tiering_record_open에서)
+    TierEntry *e = entry_get(key, false);
+    if (e) {
+        if (!e->src_path) {
+            e->src_path = strdup(path);
+            if (e->state == FAST_UNVERIFIED) {
+                g_verify_requested = true;
+                wake = true;
+            }
+        }
+
+        double before = decayed_score(e, now);
+        e->score = before + 1.0;
+        if (before < g_threshold && e->score >= g_threshold && e->state == FAST_NONE) wake = true;
+
+        use_fast = (e->state == FAST_READY);
+    }
+    if (use_fast) g_stats.fast_hits++;
+    else g_stats.slow_hits++;
+    pthread_mutex_unlock(&g_mutex);
+
+    if (wake) pthread_cond_signal(&g_wake);
+    if (use_fast) fast_path_for(key, ".mp4", path, path_len);
+}
+
+void tiering_record_open(const char *path) {
+    if (!g_enabled || !path) return;
+
+    // 빠른 계층 사본으로 연 경우는 이미 추적 중
+    size_t dir_len = strlen(g_fast_dir);
+    if (strncmp(path, g_fast_dir, dir_len) == 0 && path[dir_len] == '/') return;
+
+    uint64_t key = hash_path(path);
+
+    pthread_mutex_lock(&g_mutex);
+    TierEntry *e = entry_get(key, false);
+    if (!e && g_stats.tracked < MAX_TRACKED) {
+        e = entry_get(key, true);
+        if (e) {
+            e->src_path = strdup(path);
+            e->score = 1.0; // 이번 요청 (tiering_resolve에서는 항목이 없어 세지 못함)
+        }
+    }
+    pthread_mutex_unlock(&g_mutex);
+}
+
+void tiering_get_stats(TieringStats *out) {
+    pthread_mutex_lock(&g_mutex);
+    *out = g_stats;
+    pthread_mutex_unlock(&g_mutex);
+}
+
+void tiering_shutdown(void) {
+    if (g_copier_started) {
+        pthread_mutex_lock(&g_mutex);
+        g_stop = true;
+        pthread_cond_signal(&g_wake);
+        pthread_mutex_unlock(&g_mutex);
+        pthread_join(g_copier, NULL);
+        g_copier_started = false;
+    }
+
+    pthread_mutex_lock(&g_mutex);
+    for (int i = 0; i < TIER_BUCKETS; i++) {
+        TierEntry *e = g_buckets[i];
+        while (e) {
+            TierEntry *next = e->next;
+            free(e->src_path);
+            free(e);
+            e = next;
+        }
+        g_buckets[i] = NULL;
+    }
+    g_enabled = false;
+    pthread_mutex_unlock(&g_mutex);
+}
+
+// =========================================================
+// 복사(승격) / 강등 스레드
+// =========================================================
+
+static void* copier_thread_func(void *arg) {
+    (void)arg;
+    time_t last_verify = 0;
+
+    while (1) {
+        pthread_mutex_lock(&g_mutex);
+        if (g_stop) {
+            pthread_mutex_unlock(&g_mutex);
+            break;
+        }
+
+        time_t now = time(NULL);
+        TierEntry *cand = pick_candidate(now);
+        if (!cand) {
+            prune_cold_locked(now);
+            struct timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_sec += COPIER_INTERVAL_SEC;
+            if (!g_verify_requested) pthread_cond_timedwait(&g_wake, &g_mutex, &until);
+            bool verify = g_verify_requested;
+            g_verify_requested = false;
+            pthread_mutex_unlock(&g_mutex);
+
+            if (verify || time(NULL) - last_verify >= VERIFY_INTERVAL_SEC) {
+                verify_copies();
+                last_verify = time(NULL);
+            }
+            continue;
+        }
+
+        uint64_t key = cand->key;
+        char src[TIER_PATH_LEN];
+        snprintf(src, sizeof(src), "%s", cand->src_path);
+        double cand_score = decayed_score(cand, now);
+        cand->state = FAST_COPYING; // 다른 후보 선정에서 제외
+        pthread_mutex_unlock(&g_mutex);
+
+        // 크기 확인은 락 밖에서 (느린 디스크일 수 있음)
+        struct stat st;
+        bool ok = (stat(src, &st) == 0 && S_ISREG(st.st_mode));
+
+        pthread_mutex_lock(&g_mutex);
+        TierEntry *e = entry_get(key, false);
+        if (!e) { // shutdown 중 해제됨
+            pthread_mutex_unlock(&g_mutex);
+            break;
+        }
+        if (!ok) {
+            // 원본이 잠시 없을 수 있음 (마운트 재연결, 교체 중) -> 간격을 늘려 가며 재시도
+            e->state = FAST_NONE;
+            schedule_retry_locked(e, now);
+            pthread_mutex_unlock(&g_mutex);
+            continue;
+        }
+        if (st.st_size > g_max_bytes) {
+            e->state = FAST_NONE;
+            e->too_large = true; // 다시 고르지 않음
+            pthread_mutex_unlock(&g_mutex);
+            continue;
+        }
+        if (!make_room(st.st_size, cand_score, now)) {
+            // 더 인기 있는 사본들로 가득 참 -> 다음 기회에
+            e->state = FAST_NONE;
+            e->score = g_threshold * 0.5; // 바로 다시 고르지 않도록
+            e->score_time = now;
+            pthread_mutex_unlock(&g_mutex);
+            continue;
+        }
+        g_stats.used_bytes += (unsigned long long)st.st_size; // 복사 중에도 공간 예약
+        pthread_mutex_unlock(&g_mutex);
+
+        char tmp_path[TIER_PATH_LEN], final_path[TIER_PATH_LEN];
+        fast_path_for(key, ".tmp", tmp_path, sizeof(tmp_path));
+        fast_path_for(key, ".mp4", final_path, sizeof(final_path));
+
+        int ret = copy_throttled(src, tmp_path, st.st_size);
+        if (ret == 0 && rename(tmp_path, final_path) != 0) ret = -1;
+
+        pthread_mutex_lock(&g_mutex);
+        e = entry_get(key, false);
+        if (ret == 0 && e) {
+            e->state = FAST_READY;
+            e->fast_size = st.st_size;
+            e->failures = 0;
+            g_stats.promotions++;
+            g_stats.fast_copies++;
+            printf("[Tier] Promoted %s (%lld MB)\n", src, (long long)st.st_size / (1024 * 1024));
+        } else {
+            unlink(tmp_path);
+            g_stats.used_bytes -= (unsigned long long)st.st_size;
+            if (e) {
+                e->state = FAST_NONE;
+                schedule_retry_locked(e, time(NULL));
+            }
+        }
+        pthread_mutex_unlock(&g_mutex);
+    }
+    return NULL;
+}
+
+// 인기도 임계값을 넘은 (원본 경로를 아는) 항목 중 가장 인기 있는 것
+static TierEntry* pick_candidate(time_t now) {
+    TierEntry *best = NULL;
+    double best_score = g_threshold;
+
+    for (int i = 0; i < TIER_BUCKETS; i++) {
+        for (TierEntry *e = g_buckets[i]; e; e = e->next) {
+            if (e->state != FAST_NONE || e->too_large || !e->src_path || now < e->retry_at) continue;
+            double s = decayed_score(e, now);
+            if (s >= best_score) {
+                best = e;
+                best_score = s;
+            }
+        }
+    }
+    return best;
+}
+
+// 후보보다 인기 없는 사본을 차가운 순서로 강등하여 need 바이트 확보
+static bool make_room(long long need, double candidate_score, time_t now) {
+    while ((long long)g_stats.used_bytes + need > g_max_bytes) {
+        TierEntry *coldest = NULL;
+        double coldest_score = candidate_score;
+
+        for (int i = 0; i < TIER_BUCKETS; i++) {
+            for (TierEntry *e = g_buckets[i]; e; e = e->next) {
+                if (e->state != FAST_READY && e->state != FAST_UNVERIFIED) continue;
+                double s = decayed_score(e, now);
+                if (s < coldest_score) {
+                    coldest = e;
+                    coldest_score = s;
+                }
+            }
+        }
+        if (!coldest) return false;
+        demote_locked(coldest);
+    }
+    return true;
+}
+
+// 사본 삭제. 이미 사본을 열어 둔 스트림은 fd가 살아 있으므로 끝까지 재생됨
+static void demote_locked(TierEntry *e) {
+    char path[TIER_PATH_LEN];
+    fast_path_for(e->key, ".mp4", path, sizeof(path));
+    unlink(path);
+
+    g_stats.used_bytes -= (unsigned long long)e->fast_size;
+    g_stats.demotions++;
+    g_stats.fast_copies--;
+    e->state = FAST_NONE;
+    e->fast_size = 0;
+    printf("[Tier] Demoted %s\n", e->src_path ? e->src_path : path);
+}
+
+// 사본이 없고 식어버린 항목 해제 (한두 번 요청된 비디오가 쌓여 테이블이 계속 커지지 않도록)
+static void prune_cold_locked(time_t now) {
+    for (int i = 0; i < TIER_BUCKETS; i++) {
+        TierEntry **link = &g_buckets[i];
+        while (*link) {
+            TierEntry *e = *link;
+            if (e->state == FAST_NONE && decayed_score(e, now) < PRUNE_SCORE) {
+                *link = e->next;
+                free(e->src_path);
+                free(e);
+                g_stats.tracked--;
+            } else {
+                link = &e->next;
+            }
+        }
+    }
+}
+
+// 승격 실패 후 재시도 시각을 정함 (30초, 60초, ... 최대 1시간)
+static void schedule_retry_locked(TierEntry *e, time_t now) {
+    long delay = RETRY_BASE_SEC;
+    for (int i = 0; i < e->failures && delay < RETRY_MAX_SEC; i++) delay *= 2;
+    if (delay > RETRY_MAX_SEC) delay = RETRY_MAX_SEC;
+    if (e->failures < 16) e->failures++;
+    e->retry_at = now + delay;
+}
+
+// 원본이 바뀐 사본은 강등, 재시작 전 사본은 원본과 맞으면 재사용
+static void verify_copies(void) {
+    typedef struct { uint64_t key; char src[TIER_PATH_LEN]; } Check;
+
+    Check *checks = NULL;
+    int n = 0, cap = 0;
+
+    pthread_mutex_lock(&g_mutex);
+    for (int i = 0; i < TIER_BUCKETS; i++) {
+        for (TierEntry *e = g_buckets[i]; e; e = e->next) {
+            if ((e->state != FAST_READY && e->state != FAST_UNVERIFIED) || !e->src_path) continue;
+            if (n == cap) {
+                int new_cap = cap ? cap * 2 : 32;
+                Check *grown = (Check *)realloc(checks, sizeof(Check) * new_cap);
+                if (!grown) break;
+                checks = grown;
+                cap = new_cap;
+            }
+            checks[n].key = e->key;
+            snprintf(checks[n].src, sizeof(checks[n].src), "%s", e->src_path);
+            n++;
+        }
+    }
+    pthread_mutex_unlock(&g_mutex);
+
+    for (int i = 0; i < n && !g_stop; i++) {
+        char fast[TIER_PATH_LEN];
+        fast_path_for(checks[i].key, ".mp4", fast, sizeof(fast));
+
+        struct stat src_st, fast_st;
+        bool valid = (stat(checks[i].src, &src_st) == 0 && stat(fast, &fast_st) == 0 &&
+                      src_st.st_size == fast_st.st_size && src_st.st_mtime <= fast_st.st_mtime);
+
+        pthread_mutex_lock(&g_mutex);
+        TierEntry *e = entry_get(checks[i].key, false);
+        if (e && (e->state == FAST_READY || e->state == FAST_UNVERIFIED)) {
+            if (valid) e->state = FAST_READY;
+            else demote_locked(e);
+        }
+        pthread_mutex_unlock(&g_mutex);
+    }
+    free(checks);
+}
+
+// 원본을 tmp로 복사 (속도 제한 + 원본/사본 모두 페이지 캐시에 남기지 않음)
+static int copy_throttled(const char *src, const char *dst, long long size) {
+    int in = open(src, O_RDONLY | O_CLOEXEC);
+    if (in < 0) return -1;
+    int out = open(dst, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        close(in);
+        return -1;
+    }
+    posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    char *buf = (char *)malloc(COPY_CHUNK);
+    if (!buf) {
+        close(in);
+        close(out);
+        return -1;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    long long copied = 0;
+    int ret = 0;
+
+    while (copied < size && !g_stop) {
+        ssize_t n = read(in, buf, COPY_CHUNK);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            ret = -1;
+            break;
+        }
+        for (ssize_t w = 0; w < n; ) {
+            ssize_t m = write(out, buf + w, n - w);
+            if (m < 0 && errno == EINTR) continue;
+            if (m <= 0) {
+                ret = -1;
+                break;
+            }
+            w += m;
+        }
+        if (ret != 0) break;
+
+        posix_fadvise(in, copied, n, POSIX_FADV_DONTNEED);
+        copied += n;
+
+        pthread_mutex_lock(&g_mutex);
+        g_stats.bytes_copied += (unsigned long long)n;
+        pthread_mutex_unlock(&g_mutex);
+
+        // 속도 제한: 지금까지 복사한 양에 필요한 시간보다 빠르면 잠깐 쉼
+        if (g_copy_rate > 0) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            double elapsed = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+            double expected = (double)copied / (double)g_copy_rate;
+            if (expected > elapsed) {
+                double d = expected - elapsed;
+                struct timespec ts = {(time_t)d, (long)((d - (time_t)d) * 1e9)};
+                nanosleep(&ts, NULL);
+            }
+        }
+    }
+
+    if (g_stop && copied < size) ret = -1;
+    if (ret == 0 && fsync(out) != 0) ret = -1;
+    posix_fadvise(out, 0, 0, POSIX_FADV_DONTNEED);
+
+    free(buf);
+    close(in);
+    close(out);
+    return ret;
+}
+
+// =========================================================
+// 내부 헬퍼
+// =========================================================
+
+// 재시작 전 사본: 원본 경로를 모르므로 요청이 들어와 원본과 비교될 때까지 UNVERIFIED
+static void adopt_existing_copies(void) {
+    DIR *d = opendir(g_fast_dir);
+    if (!d) return;
+
+    struct dirent *ent;
+    while ((ent = readdir(d)) != NULL) {
+        char hex[17];
+        char ext[8];
+        if (strlen(ent->d_name) != 20 ||
+            sscanf(ent->d_name, "%16[0-9a-f].%3s", hex, ext) != 2) continue;
+
+        char path[TIER_PATH_LEN + NAME_MAX + 2];
+        snprintf(path, sizeof(path), "%s/%s", g_fast_dir, ent->d_name);
+
+        if (strcmp(ext, "tmp") == 0) { // 복사 도중 종료된 잔여물
+            unlink(path);
+            continue;
+        }
+        if (strcmp(ext, "mp4") != 0) continue;
+
+        struct stat st;
+        if (stat(path, &st) != 0) continue;
+
+        TierEntry *e = entry_get(strtoull(hex, NULL, 16), true);
+        if (!e) continue;
+        e->state = FAST_UNVERIFIED;
+        e->fast_size = st.st_size;
+        g_stats.used_bytes += (unsigned long long)st.st_size;
+        g_stats.fast_copies++;
+    }
+    closedir(d);
+
+    if (g_stats.fast_copies > 0) {
+        printf("[Tier] Found %d existing fast copies (%llu MB)\n",
+               g_stats.fast_copies, g_stats.used_bytes / (1024 * 1024));
+    }
+}
+
+static double decayed_score(TierEntry *e, time_t now) {
+    if (now > e->score_time) {
+        e->score *= pow(0.5, (double)(now - e->score_time) / HALF_LIFE_SEC);
+        e->score_time = now;
+    }
+    return e->score;
+}
+
+static TierEntry* entry_get(uint64_t key, bool create) {
+    TierEntry **head = &g_buckets[key % TIER_BUCKETS];
+    for (TierEntry *e = *head; e; e = e->next) {
+        if (e->key == key) return e;
+    }
+    if (!create) return NULL;
+
+    TierEntry *e = (TierEntry *)calloc(1, sizeof(TierEntry));
+    if (!e) return NULL;
+    e->key = key;
+    e->score_time = time(NULL);
+    e->state = FAST_NONE;
+    e->next = *head;
+    *head = e;
+    g_stats.tracked++;
+    return e;
+}
+
+static void fast_path_for(uint64_t key, const char *suffix, char *out, size_t out_len) {
+    snprintf(out, out_len, "%s/%016llx%s", g_fast_dir, (unsigned long long)key, suffix);
+}
+
+// FNV-1a 64bit
+static uint64_t hash_path(const char *path) {
+    uint64_t h = 1469598103934665603ULL;
+    while (*path) {
+        h ^= (unsigned char)*path++;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
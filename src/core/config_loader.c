@@ -25,8 +25,49 @@ static ConfigMapping config_map[] = {
     {"MAX_CLIENTS",         TYPE_INT,   offsetof(ServerConfig, max_clients),   0},
     {"TIMEOUT",             TYPE_INT,   offsetof(ServerConfig, timeout_sec),   0},
     {"LOG_LEVEL",           TYPE_INT,   offsetof(ServerConfig, log_level),     0},
+    {"LOG_FILE",            TYPE_STRING,offsetof(ServerConfig, log_file), MAX_PATH_LIST_LEN},
+    {"LOG_RING_SLOTS",      TYPE_INT,   offsetof(ServerConfig, log_ring_slots), 0},
+    {"METRICS_PORT",        TYPE_INT,   offsetof(ServerConfig, metrics_port), 0},
+    {"METRICS_BIND",        TYPE_STRING,offsetof(ServerConfig, metrics_bind), MAX_HOST_LEN},
     {"QUEUE_CAPACITY",      TYPE_INT,   offsetof(ServerConfig, queue_capacity), 0},
     {"WORKER_THREAD_COUNT", TYPE_INT,   offsetof(ServerConfig, thread_num), 0},
+    {"DB_READ_POOL_SIZE",   TYPE_INT,   offsetof(ServerConfig, db_read_pool_size), 0},
+    {"HISTORY_FLUSH_INTERVAL_SEC", TYPE_INT, offsetof(ServerConfig, history_flush_interval_sec), 0},
+    {"HISTORY_BUFFER_MAX",  TYPE_INT,   offsetof(ServerConfig, history_buffer_max), 0},
+    {"AUTH_THREAD_COUNT",   TYPE_INT,   offsetof(ServerConfig, auth_thread_num), 0},
+    {"AUTH_QUEUE_CAPACITY", TYPE_INT,   offsetof(ServerConfig, auth_queue_capacity), 0},
+    {"PASSWORD_SCRYPT_LOG2_N", TYPE_INT, offsetof(ServerConfig, scrypt_log2_n), 0},
+    {"PASSWORD_SCRYPT_R",   TYPE_INT,   offsetof(ServerConfig, scrypt_r), 0},
+    {"PASSWORD_SCRYPT_P",   TYPE_INT,   offsetof(ServerConfig, scrypt_p), 0},
+    {"CONTINUE_CACHE_USERS", TYPE_INT,  offsetof(ServerConfig, continue_cache_users), 0},
+    {"VIDEO_LIST_PAGE_MAX", TYPE_INT,   offsetof(ServerConfig, video_list_page_max), 0},
+    {"THUMBNAIL_THREAD_COUNT", TYPE_INT, offsetof(ServerConfig, thumb_thread_num), 0},
+    {"TRICKPLAY_INTERVAL_SEC", TYPE_INT, offsetof(ServerConfig, trickplay_interval), 0},
+    {"SCAN_THREAD_COUNT",   TYPE_INT,   offsetof(ServerConfig, scan_thread_num), 0},
+    {"THUMBNAIL_FORMAT",    TYPE_STRING,offsetof(ServerConfig, thumb_format), 8},
+    {"SEGMENT_CACHE_MB",    TYPE_INT,   offsetof(ServerConfig, segment_cache_mb), 0},
+    {"STREAM_READ_ENGINE",  TYPE_STRING,offsetof(ServerConfig, read_engine), 16},
+    {"DIRECT_IO_BUFFERS",   TYPE_INT,   offsetof(ServerConfig, direct_io_buffers), 0},
+    {"DIRECT_IO_BUFFER_KB", TYPE_INT,   offsetof(ServerConfig, direct_io_buffer_kb), 0},
+    {"DEVICE_IO_THREADS",   TYPE_INT,   offsetof(ServerConfig, device_io_threads), 0},
+    {"DEVICE_IO_MAX_ACTIVE", TYPE_INT,  offsetof(ServerConfig, device_io_max_active), 0},
+    {"FAST_TIER_DIR",       TYPE_STRING,offsetof(ServerConfig, fast_tier_dir), MAX_PATH_LIST_LEN},
+    {"FAST_TIER_MAX_MB",    TYPE_INT,   offsetof(ServerConfig, fast_tier_max_mb), 0},
+    {"TIER_PROMOTE_THRESHOLD", TYPE_INT, offsetof(ServerConfig, tier_promote_threshold), 0},
+    {"TIER_COPY_RATE_MBPS", TYPE_INT,   offsetof(ServerConfig, tier_copy_rate_mbps), 0},
+    {"PREWARM_TOP_N",       TYPE_INT,   offsetof(ServerConfig, prewarm_top_n), 0},
+    {"PREWARM_BUDGET_MB",   TYPE_INT,   offsetof(ServerConfig, prewarm_budget_mb), 0},
+    {"PREWARM_INTERVAL_SEC", TYPE_INT,  offsetof(ServerConfig, prewarm_interval_sec), 0},
+    {"SESSION_MAX_COUNT",   TYPE_INT,   offsetof(ServerConfig, session_max_count), 0},
+    {"SESSION_MODE",        TYPE_STRING,offsetof(ServerConfig, session_mode), 16},
+    {"SESSION_SHM_NAME",    TYPE_STRING,offsetof(ServerConfig, session_shm_name), 64},
+    {"REUSE_PORT",          TYPE_INT,   offsetof(ServerConfig, reuse_port), 0},
+    {"SESSION_KEY_FILE",    TYPE_STRING,offsetof(ServerConfig, session_key_file), MAX_PATH_LIST_LEN},
+    {"SESSION_REVOKE_CAPACITY", TYPE_INT, offsetof(ServerConfig, session_revoke_capacity), 0},
+    {"SIGNED_URL_TTL_SEC",  TYPE_INT,   offsetof(ServerConfig, signed_url_ttl_sec), 0},
+    {"SESSION_SNAPSHOT_FILE", TYPE_STRING, offsetof(ServerConfig, session_snapshot_file), MAX_PATH_LIST_LEN},
+    {"SESSION_SNAPSHOT_INTERVAL_SEC", TYPE_INT, offsetof(ServerConfig, session_snapshot_interval), 0},
+    {"MEDIA_ROOTS",         TYPE_STRING,offsetof(ServerConfig, media_roots), MAX_PATH_LIST_LEN},
     {"HOST",                TYPE_STRING,offsetof(ServerConfig, server_host),   MAX_HOST_LEN},
     {NULL, 0, 0, 0} // 배열의 끝
 };
@@ -61,8 +102,49 @@ int load_config(const char *filename, ServerConfig *config) {
     config->max_clients = 1000;
     config->timeout_sec = 30;
     config->log_level = 1;
+    strncpy(config->log_file, "server.log", sizeof(config->log_file) - 1);
+    config->log_ring_slots = 1024;
+    config->metrics_port = 9100;
+    strncpy(config->metrics_bind, "127.0.0.1", sizeof(config->metrics_bind) - 1);
     config->queue_capacity = 1000;
     config->thread_num = 10;
+    config->db_read_pool_size = 0;
+    config->history_flush_interval_sec = 5;
+    config->history_buffer_max = 200000;
+    config->auth_thread_num = 2;
+    config->auth_queue_capacity = 64;
+    config->scrypt_log2_n = 14;
+    config->scrypt_r = 8;
+    config->scrypt_p = 1;
+    config->continue_cache_users = 4096;
+    config->video_list_page_max = 200;
+    config->thumb_thread_num = 2;
+    config->trickplay_interval = 10;
+    config->scan_thread_num = 4;
+    config->segment_cache_mb = 0;
+    strncpy(config->read_engine, "sendfile", sizeof(config->read_engine) - 1);
+    config->direct_io_buffers = 64;
+    config->direct_io_buffer_kb = 1024;
+    config->device_io_threads = 2;
+    config->device_io_max_active = 64;
+    config->fast_tier_dir[0] = '\0';
+    config->fast_tier_max_mb = 0;
+    config->tier_promote_threshold = 20;
+    config->tier_copy_rate_mbps = 50;
+    config->prewarm_top_n = 20;
+    config->prewarm_budget_mb = 512;
+    config->prewarm_interval_sec = 3600;
+    config->session_max_count = 100000;
+    strncpy(config->session_mode, "table", sizeof(config->session_mode) - 1);
+    strncpy(config->session_shm_name, "/ott_sessions", sizeof(config->session_shm_name) - 1);
+    config->reuse_port = 0;
+    config->session_key_file[0] = '\0';
+    config->session_revoke_capacity = 4096;
+    config->signed_url_ttl_sec = 21600;
+    strncpy(config->session_snapshot_file, "sessions.snap", sizeof(config->session_snapshot_file) - 1);
+    config->session_snapshot_interval = 60;
+    strncpy(config->thumb_format, "jpg", sizeof(config->thumb_format) - 1);
+    strncpy(config->media_roots, "./videos", MAX_PATH_LIST_LEN - 1);
     strncpy(config->server_host, "localhost", MAX_HOST_LEN - 1);
 
     char line[1024];
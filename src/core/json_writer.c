@@ -0,0 +1,205 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "core/json_writer.h"
+
+#define POOL_MAX_CHUNKS 64  // 풀에 보관하는 여분 청크 상한 (넘으면 free)
+
+// 청크 풀 (요청마다 16KB malloc/free 반복 방지)
+static JsonChunk *g_pool = NULL;
+static int g_pool_count = 0;
+static pthread_mutex_t g_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+// 내부 헬퍼 함수
+static JsonChunk* chunk_get(void);
+static void chunk_put(JsonChunk *c);
+static size_t next_special(const char *s, size_t i, size_t len);
+
+static inline int needs_escape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+void json_writer_init(JsonWriter *w, JsonSink sink, void *sink_arg) {
+    memset(w, 0, sizeof(*w));
+    w->sink = sink;
+    w->sink_arg = sink_arg;
+}
+
+void json_write_raw(JsonWriter *w, const char *data, size_t len) {
+    while (len > 0 && !w->error) {
+        if (!w->tail || w->tail->len == JSON_CHUNK_SIZE) {
+            if (w->tail && w->sink) {
+                // 스트리밍: 가득 찬 청크를 내보내고 재사용
+                if (w->sink(w->sink_arg, w->tail->data, w->tail->len) != 0) {
+                    w->error = 1;
+                    return;
+                }
+                w->tail->len = 0;
+            } else {
+                JsonChunk *c = chunk_get();
+                if (!c) {
+                    w->error = 1;
+                    return;
+                }
+                if (w->tail) w->tail->next = c;
+                else w->head = c;
+                w->tail = c;
+            }
+        }
+
+        size_t n = JSON_CHUNK_SIZE - w->tail->len;
+        if (n > len) n = len;
+        memcpy(w->tail->data + w->tail->len, data, n);
+        w->tail->len += n;
+        w->total += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void json_write_escaped(JsonWriter *w, const char *s, size_t len) {
+    size_t start = 0;
+    while (start < len) {
+        size_t i = next_special(s, start, len);
+        if (i > start) json_write_raw(w, s + start, i - start); // 이스케이프가 필요 없는 구간은 통째로
+        if (i >= len) break;
+
+        unsigned char c = (unsigned char)s[i];
+        char esc[6] = {'\\', 0, 0, 0, 0, 0};
+        size_t esc_len = 2;
+        switch (c) {
+            case '"':  esc[1] = '"';  break;
+            case '\\': esc[1] = '\\'; break;
+            case '\n': esc[1] = 'n';  break;
+            case '\r': esc[1] = 'r';  break;
+            case '\t': esc[1] = 't';  break;
+            case '\b': esc[1] = 'b';  break;
+            case '\f': esc[1] = 'f';  break;
+            default:
+                esc[1] = 'u';
+                esc[2] = '0';
+                esc[3] = '0';
+                esc[4] = HEX_DIGITS[c >> 4];
+                esc[5] = HEX_DIGITS[c & 0x0F];
+                esc_len = 6;
+                break;
+        }
+        json_write_raw(w, esc, esc_len);
+        start = i + 1;
+    }
+}
+
+void json_write_string(JsonWriter *w, const char *s) {
+    json_write_raw(w, "\"", 1);
+    if (s) json_write_escaped(w, s, strlen(s));
+    json_write_raw(w, "\"", 1);
+}
+
+void json_write_int(JsonWriter *w, long long v) {
+    char buf[24];
+    int n = snprintf(buf, sizeof(buf), "%lld", v);
+    json_write_raw(w, buf, (size_t)n);
+}
+
+int json_writer_flush(JsonWriter *w) {
+    if (w->error) return -1;
+    if (!w->sink || !w->tail || w->tail->len == 0) return 0;
+
+    if (w->sink(w->sink_arg, w->tail->data, w->tail->len) != 0) {
+        w->error = 1;
+        return -1;
+    }
+    w->tail->len = 0;
+    return 0;
+}
+
+char* json_writer_dup(const JsonWriter *w, size_t *out_len) {
+    if (w->error || w->sink) return NULL;
+
+    char *out = (char *)malloc(w->total + 1);
+    if (!out) return NULL;
+
+    size_t off = 0;
+    for (const JsonChunk *c = w->head; c; c = c->next) {
+        memcpy(out + off, c->data, c->len);
+        off += c->len;
+    }
+    out[off] = '\0';
+    if (out_len) *out_len = off;
+    return out;
+}
+
+int json_writer_error(const JsonWriter *w) {
+    return w->error;
+}
+
+void json_writer_release(JsonWriter *w) {
+    JsonChunk *c = w->head;
+    while (c) {
+        JsonChunk *next = c->next;
+        chunk_put(c);
+        c = next;
+    }
+    w->head = w->tail = NULL;
+}
+
+// =========================================================
+// 내부 헬퍼
+// =========================================================
+
+static JsonChunk* chunk_get(void) {
+    pthread_mutex_lock(&g_pool_mutex);
+    JsonChunk *c = g_pool;
+    if (c) {
+        g_pool = c->next;
+        g_pool_count--;
+    }
+    pthread_mutex_unlock(&g_pool_mutex);
+
+    if (!c) c = (JsonChunk *)malloc(sizeof(JsonChunk));
+    if (c) {
+        c->next = NULL;
+        c->len = 0;
+    }
+    return c;
+}
+
+static void chunk_put(JsonChunk *c) {
+    pthread_mutex_lock(&g_pool_mutex);
+    if (g_pool_count < POOL_MAX_CHUNKS) {
+        c->next = g_pool;
+        g_pool = c;
+        g_pool_count++;
+        c = NULL;
+    }
+    pthread_mutex_unlock(&g_pool_mutex);
+    free(c);
+}
+
+// s[i..len)에서 이스케이프가 필요한 첫 위치 (없으면 len)
+static size_t next_special(const char *s, size_t i, size_t len) {
+#ifdef __SSE2__
+    const __m128i limit = _mm_set1_epi8(0x1F);
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    while (i + 16 <= len) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+        // 부호 없는 비교: max(v, 0x1F) == 0x1F 이면 v <= 0x1F (UTF-8 바이트 >= 0x80은 통과)
+        __m128i ctrl = _mm_cmpeq_epi8(_mm_max_epu8(v, limit), limit);
+        __m128i hit = _mm_or_si128(ctrl, _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, bslash)));
+        int mask = _mm_movemask_epi8(hit);
+        if (mask) return i + (size_t)__builtin_ctz((unsigned)mask);
+        i += 16;
+    }
+#endif
+    while (i < len && !needs_escape((unsigned char)s[i])) i++;
+    return i;
+}
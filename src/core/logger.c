@@ -0,0 +1,354 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "core/logger.h"
+#include "core/json_writer.h"
+
+#define MAX_RINGS           128     // 동시에 로그를 남기는 스레드 수 상한 (넘으면 그 스레드 로그는 버림)
+#define DEFAULT_RING_SLOTS  1024
+#define TAG_LEN             16
+#define IDLE_WAIT_MS        20      // 링이 비었을 때 쓰기 스레드가 쉬는 시간
+#define DROP_REPORT_SEC     5       // 버린 레코드 수를 로그에 남기는 최소 간격
+
+enum { RING_FREE = 0, RING_ACTIVE, RING_ORPHANED };
+
+// 링 슬롯 하나 (생산자가 바로 포맷하므로 고정 크기)
+typedef struct {
+    struct timespec ts;
+    int level;
+    char tag[TAG_LEN];
+    int len;
+    char msg[LOG_MSG_MAX];
+} LogRecord;
+
+// 스레드 하나 전용 링. head는 생산자만, tail은 쓰기 스레드만 바꿈 (캐시 라인 분리)
+typedef struct {
+    unsigned long long head __attribute__((aligned(64)));
+    unsigned long long dropped;
+    unsigned long long tail __attribute__((aligned(64)));
+    int state __attribute__((aligned(64)));
+    unsigned int mask;
+    LogRecord *slots;
+} LogRing;
+
+typedef struct {
+    int fd;
+} LogFile;
+
+int g_log_level = LOG_LEVEL_INFO;
+
+// 내부 전역 변수
+static LogRing g_rings[MAX_RINGS];
+static int g_ring_count = 0;                // 한 번이라도 쓴 링 수 (쓰기 스레드가 여기까지만 봄)
+static unsigned int g_ring_slots = DEFAULT_RING_SLOTS;
+static pthread_mutex_t g_register_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t g_ring_key;
+static __thread LogRing *t_ring = NULL;
+static unsigned long long g_unregistered_dropped = 0;   // 링을 못 받은 스레드의 레코드
+
+static LogFile g_file = { -1 };
+static pthread_t g_thread;
+static bool g_started = false;
+static bool g_stop = false;
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cond = PTHREAD_COND_INITIALIZER;
+static unsigned long long g_written = 0;
+
+static const char *LEVEL_NAMES[] = { "error", "warn", "info", "debug" };
+
+// 내부 헬퍼 함수
+static LogRing* acquire_ring(void);
+static void release_ring(void *arg);
+static void* writer_thread_func(void *arg);
+static unsigned long long drain_rings(JsonWriter *w);
+static void write_record(JsonWriter *w, const struct timespec *ts, int level, const char *tag,
+                         const char *msg, int len);
+static unsigned long long total_dropped(void);
+static int file_sink(void *arg, const char *data, size_t len);
+
+int logger_init(int level, const char *path, int ring_slots) {
+    if (level < LOG_LEVEL_ERROR) level = LOG_LEVEL_ERROR;
+    if (level > LOG_LEVEL_DEBUG) level = LOG_LEVEL_DEBUG;
+    g_log_level = level;
+
+    unsigned int slots = 1;
+    while (slots < (unsigned int)(ring_slots > 0 ? ring_slots : DEFAULT_RING_SLOTS)) slots <<= 1;
+    g_ring_slots = slots;
+
+    if (path && path[0]) {
+        g_file.fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0640);
+        if (g_file.fd < 0) {
+            fprintf(stderr, "[Log] Failed to open %s (%s), logging to stderr.\n", path, strerror(errno));
+            return -1;
+        }
+    } else {
+        g_file.fd = STDOUT_FILENO;
+    }
+
+    // 스레드가 끝나면 링을 돌려받아 (다 비운 뒤) 다른 스레드가 재사용
+    if (pthread_key_create(&g_ring_key, release_ring) != 0 ||
+        pthread_create(&g_thread, NULL, writer_thread_func, NULL) != 0) {
+        fprintf(stderr, "[Log] Failed to start log writer, logging to stderr.\n");
+        if (g_file.fd != STDOUT_FILENO) close(g_file.fd);
+        g_file.fd = -1;
+        return -1;
+    }
+
+    __atomic_store_n(&g_started, true, __ATOMIC_RELEASE);
+    printf("[Log] Level %s, %u slots per thread, writing to %s.\n",
+           LEVEL_NAMES[level], slots, (path && path[0]) ? path : "stdout");
+    return 0;
+}
+
+void logger_write(int level, const char *tag, const char *fmt, ...) {
+    int saved_errno = errno; // 호출부 포맷의 %m이 원래 오류를 가리키도록
+    va_list ap;
+
+    if (!__atomic_load_n(&g_started, __ATOMIC_ACQUIRE)) {
+        // 시작 전 (또는 시작 실패): 동기로 stderr
+        char msg[LOG_MSG_MAX];
+        va_start(ap, fmt);
+        errno = saved_errno;
+        vsnprintf(msg, sizeof(msg), fmt, ap);
+        va_end(ap);
+        fprintf(stderr, "[%s] %s\n", tag, msg);
+        errno = saved_errno;
+        return;
+    }
+
+    LogRing *ring = t_ring ? t_ring : acquire_ring();
+    if (!ring) {
+        __atomic_fetch_add(&g_unregistered_dropped, 1, __ATOMIC_RELAXED);
+        errno = saved_errno;
+        return;
+    }
+
+    // 가득 차면 기다리지 않고 버림 (요청 스레드가 디스크 속도에 묶이지 않도록)
+    unsigned long long head = ring->head;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) > ring->mask) {
+        __atomic_store_n(&ring->dropped, ring->dropped + 1, __ATOMIC_RELAXED);
+        errno = saved_errno;
+        return;
+    }
+
+    LogRecord *rec = &ring->slots[head & ring->mask];
+    clock_gettime(CLOCK_REALTIME, &rec->ts);
+    rec->level = level;
+    strncpy(rec->tag, tag, TAG_LEN - 1);
+    rec->tag[TAG_LEN - 1] = '\0';
+
+    va_start(ap, fmt);
+    errno = saved_errno;
+    int n = vsnprintf(rec->msg, sizeof(rec->msg), fmt, ap);
+    va_end(ap);
+    rec->len = (n < 0) ? 0 : (n >= (int)sizeof(rec->msg) ? (int)sizeof(rec->msg) - 1 : n);
+
+    // 슬롯을 다 채운 뒤 공개
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    errno = saved_errno;
+}
+
+void logger_get_stats(LoggerStats *out) {
+    memset(out, 0, sizeof(*out));
+    out->written = __atomic_load_n(&g_written, __ATOMIC_RELAXED);
+    out->dropped = total_dropped();
+    out->rings = (unsigned long long)__atomic_load_n(&g_ring_count, __ATOMIC_ACQUIRE);
+}
+
+void logger_shutdown(void) {
+    if (!__atomic_load_n(&g_started, __ATOMIC_ACQUIRE)) return;
+
+    pthread_mutex_lock(&g_mutex);
+    g_stop = true;
+    pthread_cond_signal(&g_cond);
+    pthread_mutex_unlock(&g_mutex);
+    pthread_join(g_thread, NULL);
+
+    // 이후 로그는 stderr로
+    __atomic_store_n(&g_started, false, __ATOMIC_RELEASE);
+    if (g_file.fd >= 0 && g_file.fd != STDOUT_FILENO) close(g_file.fd);
+    g_file.fd = -1;
+
+    LoggerStats stats;
+    logger_get_stats(&stats);
+    printf("[Log] Writer stopped: %llu records written, %llu dropped.\n", stats.written, stats.dropped);
+    // 링 메모리는 그대로 둠 (아직 살아 있는 스레드가 t_ring을 가리킬 수 있음)
+}
+
+// =========================================================
+// 내부 헬퍼
+// =========================================================
+
+// 스레드당 한 번: 빈 링을 찾거나 새로 할당
+static LogRing* acquire_ring(void) {
+    LogRing *ring = NULL;
+
+    pthread_mutex_lock(&g_register_mutex);
+    int count = __atomic_load_n(&g_ring_count, __ATOMIC_RELAXED);
+    for (int i = 0; i < count && !ring; i++) {
+        if (__atomic_load_n(&g_rings[i].state, __ATOMIC_ACQUIRE) == RING_FREE) ring = &g_rings[i];
+    }
+    if (!ring && count < MAX_RINGS) {
+        LogRing *fresh = &g_rings[count];
+        fresh->slots = (LogRecord *)malloc((size_t)g_ring_slots * sizeof(LogRecord));
+        if (fresh->slots) {
+            fresh->mask = g_ring_slots - 1;
+            fresh->head = 0;
+            fresh->tail = 0;
+            ring = fresh;
+            __atomic_store_n(&g_ring_count, count + 1, __ATOMIC_RELEASE);
+        }
+    }
+    if (ring) __atomic_store_n(&ring->state, RING_ACTIVE, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&g_register_mutex);
+
+    if (ring) {
+        t_ring = ring;
+        pthread_setspecific(g_ring_key, ring);
+    }
+    return ring;
+}
+
+// 스레드 종료 시: 쓰기 스레드가 남은 레코드를 비운 뒤 FREE로 돌림
+static void release_ring(void *arg) {
+    LogRing *ring = (LogRing *)arg;
+    __atomic_store_n(&ring->state, RING_ORPHANED, __ATOMIC_RELEASE);
+}
+
+static void* writer_thread_func(void *arg) {
+    (void)arg;
+    JsonWriter w;
+    json_writer_init(&w, file_sink, &g_file);
+
+    unsigned long long reported_dropped = 0;
+    time_t last_report = 0;
+
+    while (1) {
+        pthread_mutex_lock(&g_mutex);
+        bool stop = g_stop;
+        pthread_mutex_unlock(&g_mutex);
+
+        unsigned long long drained = drain_rings(&w);
+
+        // 버린 수는 링을 채운 스레드가 아니라 여기서 한 번에 알림
+        time_t now = time(NULL);
+        unsigned long long dropped = total_dropped();
+        if (dropped != reported_dropped && (now - last_report >= DROP_REPORT_SEC || stop)) {
+            char msg[64];
+            int len = snprintf(msg, sizeof(msg), "dropped %llu records (ring full)", dropped - reported_dropped);
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            write_record(&w, &ts, LOG_LEVEL_WARN, "Log", msg, len);
+            reported_dropped = dropped;
+            last_report = now;
+        }
+
+        // 한 바퀴에 모은 만큼 한 번에 씀 (중간에 16KB가 차면 그때도 씀)
+        json_writer_flush(&w);
+
+        if (drained > 0) continue;
+        if (stop) break;
+
+        pthread_mutex_lock(&g_mutex);
+        if (!g_stop) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += IDLE_WAIT_MS * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&g_cond, &g_mutex, &deadline);
+        }
+        pthread_mutex_unlock(&g_mutex);
+    }
+
+    json_writer_release(&w);
+    return NULL;
+}
+
+static unsigned long long drain_rings(JsonWriter *w) {
+    unsigned long long drained = 0;
+    int count = __atomic_load_n(&g_ring_count, __ATOMIC_ACQUIRE);
+
+    for (int i = 0; i < count; i++) {
+        LogRing *ring = &g_rings[i];
+        int state = __atomic_load_n(&ring->state, __ATOMIC_ACQUIRE);
+        if (state == RING_FREE) continue;
+
+        unsigned long long start = ring->tail;
+        unsigned long long tail = start;
+        unsigned long long head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        for (; tail != head; tail++) {
+            const LogRecord *rec = &ring->slots[tail & ring->mask];
+            write_record(w, &rec->ts, rec->level, rec->tag, rec->msg, rec->len);
+        }
+        // 슬롯을 다 읽은 뒤 반환
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+        drained += head - start;
+
+        // 끝난 스레드의 링: 종료 표시 이후 더 쓰지 않으므로 비웠으면 재사용 가능
+        if (state == RING_ORPHANED && head == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+            __atomic_store_n(&ring->state, RING_FREE, __ATOMIC_RELEASE);
+        }
+    }
+    return drained;
+}
+
+// {"ts":"2026-01-01T00:00:00.000Z","level":"info","tag":"Stream","msg":"..."}
+static void write_record(JsonWriter *w, const struct timespec *ts, int level, const char *tag,
+                         const char *msg, int len) {
+    static time_t cached_sec = -1;      // 쓰기 스레드 전용
+    static char cached_prefix[24];
+
+    if (ts->tv_sec != cached_sec) {
+        struct tm tm;
+        gmtime_r(&ts->tv_sec, &tm);
+        strftime(cached_prefix, sizeof(cached_prefix), "%Y-%m-%dT%H:%M:%S", &tm);
+        cached_sec = ts->tv_sec;
+    }
+    char stamp[48];
+    int stamp_len = snprintf(stamp, sizeof(stamp), "{\"ts\":\"%s.%03ldZ\",\"level\":\"",
+                             cached_prefix, ts->tv_nsec / 1000000L);
+
+    json_write_raw(w, stamp, (size_t)stamp_len);
+    const char *name = LEVEL_NAMES[(level >= 0 && level <= LOG_LEVEL_DEBUG) ? level : LOG_LEVEL_DEBUG];
+    json_write_raw(w, name, strlen(name));
+    json_write_raw(w, "\",\"tag\":", 8);
+    json_write_string(w, tag);
+    json_write_raw(w, ",\"msg\":\"", 8);
+    json_write_escaped(w, msg, (size_t)len);
+    json_write_raw(w, "\"}\n", 3);
+    __atomic_fetch_add(&g_written, 1, __ATOMIC_RELAXED);
+}
+
+static unsigned long long total_dropped(void) {
+    unsigned long long dropped = __atomic_load_n(&g_unregistered_dropped, __ATOMIC_RELAXED);
+    int count = __atomic_load_n(&g_ring_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < count; i++) dropped += __atomic_load_n(&g_rings[i].dropped, __ATOMIC_RELAXED);
+    return dropped;
+}
+
+// JsonWriter sink: 파일에 그대로 씀 (실패해도 쓰기 스레드는 계속 돔)
+static int file_sink(void *arg, const char *data, size_t len) {
+    LogFile *file = (LogFile *)arg;
+    while (len > 0) {
+        ssize_t n = write(file->fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
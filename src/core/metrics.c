@@ -0,0 +1,477 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include "core/metrics.h"
+#include "core/logger.h"
+
+#define MAX_SHARDS      256     // 전용 샤드를 받는 스레드 수 상한 (넘으면 공용 샤드)
+#define HIST_BUCKETS    55      // 유한 버킷 54개 (1us ~ 2^27us) + 초과 버킷
+#define MAX_GAUGES      32
+#define NAME_LEN        64
+#define LABELS_LEN      64
+#define REQUEST_MAX     2048    // 수집 요청 헤더 최대 크기
+#define IO_TIMEOUT_SEC  2       // 느린 수집기가 리스너를 붙잡지 못하도록
+
+enum { SHARD_FREE = 0, SHARD_ACTIVE };
+
+// 개수는 버킷 합 (기록마다 쓰는 값을 하나 줄임)
+typedef struct {
+    unsigned long long sum_ns;
+    unsigned long long buckets[HIST_BUCKETS];
+} Histogram;
+
+// 스레드 하나 전용 (그 스레드만 씀). 다른 스레드의 샤드와 캐시 라인을 나누지 않도록 정렬
+typedef struct {
+    unsigned long long counters[M_COUNTER_COUNT];
+    Histogram hist[H_COUNT];
+    int state;
+} __attribute__((aligned(64))) MetricShard;
+
+typedef struct {
+    const char *name;
+    const char *labels;
+    const char *help;
+} MetricDef;
+
+typedef struct {
+    char name[NAME_LEN];
+    char labels[LABELS_LEN];
+    const char *help;
+    double (*fn)(void *arg);
+    void *arg;
+} Gauge;
+
+// 같은 이름은 연달아 둠 (HELP/TYPE을 이름마다 한 번만 출력)
+static const MetricDef COUNTER_DEFS[M_COUNTER_COUNT] = {
+    [M_CONN_ACCEPTED] = {"ott_connections_accepted_total", "", "Accepted client connections"},
+    [M_CONN_CLOSED] = {"ott_connections_closed_total", "", "Closed client connections"},
+    [M_SENDFILE_BYTES] = {"ott_sendfile_bytes_total", "", "Response body bytes sent with sendfile"},
+    [M_QUEUE_REJECTED_REQUEST] = {"ott_task_queue_rejected_total", "pool=\"request\"",
+                                  "Tasks rejected because the pool queue was full"},
+    [M_QUEUE_REJECTED_AUTH] = {"ott_task_queue_rejected_total", "pool=\"auth\"", NULL},
+};
+
+static const MetricDef HIST_DEFS[H_COUNT] = {
+    [H_QUEUE_WAIT_REQUEST] = {"ott_task_queue_wait_seconds", "pool=\"request\"",
+                              "Time tasks spent queued before a worker picked them up"},
+    [H_QUEUE_WAIT_AUTH] = {"ott_task_queue_wait_seconds", "pool=\"auth\"", NULL},
+    [H_QUEUE_WAIT_DEVICE] = {"ott_task_queue_wait_seconds", "pool=\"device\"", NULL},
+    [H_ROUTE_LOGIN] = {"ott_request_duration_seconds", "route=\"/login\"",
+                       "Request latency by route (streams: until the response header is sent)"},
+    [H_ROUTE_REGISTER] = {"ott_request_duration_seconds", "route=\"/register\"", NULL},
+    [H_ROUTE_LOGOUT] = {"ott_request_duration_seconds", "route=\"/logout\"", NULL},
+    [H_ROUTE_HISTORY] = {"ott_request_duration_seconds", "route=\"/api/history\"", NULL},
+    [H_ROUTE_VIDEOS] = {"ott_request_duration_seconds", "route=\"/api/videos\"", NULL},
+    [H_ROUTE_CONTINUE] = {"ott_request_duration_seconds", "route=\"/api/continue\"", NULL},
+    [H_ROUTE_SEARCH] = {"ott_request_duration_seconds", "route=\"/api/search\"", NULL},
+    [H_ROUTE_STATS] = {"ott_request_duration_seconds", "route=\"/api/stats\"", NULL},
+    [H_ROUTE_STREAM] = {"ott_request_duration_seconds", "route=\"stream\"", NULL},
+    [H_ROUTE_STATIC] = {"ott_request_duration_seconds", "route=\"static\"", NULL},
+    [H_DB_USER_PASSWORD] = {"ott_db_query_duration_seconds", "query=\"user_password\"",
+                            "SQLite query latency (bind to reset, excluding connection wait)"},
+    [H_DB_UPDATE_HISTORY] = {"ott_db_query_duration_seconds", "query=\"update_history\"", NULL},
+    [H_DB_USER_POSITIONS] = {"ott_db_query_duration_seconds", "query=\"user_positions\"", NULL},
+    [H_DB_CREATE_USER] = {"ott_db_query_duration_seconds", "query=\"create_user\"", NULL},
+    [H_DB_UPDATE_PASSWORD] = {"ott_db_query_duration_seconds", "query=\"update_password\"", NULL},
+    [H_DB_RECENT_HISTORY] = {"ott_db_query_duration_seconds", "query=\"recent_history\"", NULL},
+    [H_DB_HISTORY_BATCH] = {"ott_db_query_duration_seconds", "query=\"history_batch\"", NULL},
+    [H_DB_LIBRARY_BATCH] = {"ott_db_query_duration_seconds", "query=\"library_batch\"", NULL},
+};
+
+// 수집 응답 버퍼 (필요한 만큼 늘림)
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+    bool failed;
+} TextBuf;
+
+// 내부 전역 변수
+static MetricShard *g_shards[MAX_SHARDS];
+static int g_shard_count = 0;               // 한 번이라도 받은 샤드 수 (수집은 여기까지만 봄)
+static MetricShard g_shared_shard;          // 전용 샤드를 못 받은 스레드용 (원자적 덧셈)
+static pthread_mutex_t g_register_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t g_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t g_shard_key;
+static __thread MetricShard *t_shard = NULL;
+
+static Gauge g_gauges[MAX_GAUGES];
+static int g_gauge_count = 0;
+static pthread_mutex_t g_gauge_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int g_listen_fd = -1;
+static pthread_t g_thread;
+static bool g_started = false;
+static bool g_stop = false;
+
+// 내부 헬퍼 함수
+static void create_shard_key(void);
+static MetricShard* acquire_shard(void);
+static void release_shard(void *arg);
+static inline void shard_add(MetricShard *shard, unsigned long long *slot, unsigned long long value);
+static int bucket_index(unsigned long long us);
+static unsigned long long bucket_bound_us(int idx);
+static void aggregate(MetricShard *out);
+static void render(TextBuf *b);
+static void buf_printf(TextBuf *b, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void* listener_thread_func(void *arg);
+static void serve_client(int fd);
+static int send_all(int fd, const char *data, size_t len);
+
+void metrics_add(MetricCounter counter, unsigned long long value) {
+    MetricShard *shard = t_shard ? t_shard : acquire_shard();
+    shard_add(shard, &shard->counters[counter], value);
+}
+
+void metrics_observe(MetricHistogram hist, long long ns) {
+    MetricShard *shard = t_shard ? t_shard : acquire_shard();
+    Histogram *h = &shard->hist[hist];
+    if (ns < 0) ns = 0;
+
+    shard_add(shard, &h->buckets[bucket_index((unsigned long long)ns / 1000)], 1);
+    shard_add(shard, &h->sum_ns, (unsigned long long)ns);
+}
+
+int metrics_register_gauge(const char *name, const char *labels, const char *help,
+                           double (*fn)(void *arg), void *arg) {
+    if (!name || !fn) return -1;
+
+    pthread_mutex_lock(&g_gauge_mutex);
+    if (g_gauge_count == MAX_GAUGES) {
+        pthread_mutex_unlock(&g_gauge_mutex);
+        fprintf(stderr, "[Metrics] Too many gauges (max %d), ignoring %s\n", MAX_GAUGES, name);
+        return -1;
+    }
+    Gauge *g = &g_gauges[g_gauge_count++];
+    snprintf(g->name, sizeof(g->name), "%s", name);
+    snprintf(g->labels, sizeof(g->labels), "%s", labels ? labels : "");
+    g->help = help;
+    g->fn = fn;
+    g->arg = arg;
+    pthread_mutex_unlock(&g_gauge_mutex);
+    return 0;
+}
+
+int metrics_start(const char *bind_addr, int port) {
+    if (port <= 0) {
+        printf("[Metrics] Scrape listener disabled (METRICS_PORT = 0).\n");
+        return -1;
+    }
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, (bind_addr && bind_addr[0]) ? bind_addr : "127.0.0.1", &addr.sin_addr) != 1) {
+        fprintf(stderr, "[Metrics] Invalid bind address: %s\n", bind_addr);
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("[Metrics] socket() failed");
+        return -1;
+    }
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+        fprintf(stderr, "[Metrics] Cannot listen on %s:%d (%s)\n", bind_addr, port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    g_listen_fd = fd;
+    g_stop = false;
+    if (pthread_create(&g_thread, NULL, listener_thread_func, NULL) != 0) {
+        fprintf(stderr, "[Metrics] Failed to start listener thread\n");
+        close(fd);
+        g_listen_fd = -1;
+        return -1;
+    }
+    g_started = true;
+    printf("[Metrics] Serving /metrics on %s:%d\n", bind_addr, port);
+    return 0;
+}
+
+void metrics_shutdown(void) {
+    if (!g_started) return;
+
+    // 블로킹 accept를 깨움
+    __atomic_store_n(&g_stop, true, __ATOMIC_RELEASE);
+    shutdown(g_listen_fd, SHUT_RDWR);
+    pthread_join(g_thread, NULL);
+    close(g_listen_fd);
+    g_listen_fd = -1;
+    g_started = false;
+    // 샤드는 그대로 둠 (아직 살아 있는 스레드가 t_shard를 가리킬 수 있음)
+}
+
+// =========================================================
+// 내부 헬퍼
+// =========================================================
+
+static void create_shard_key(void) {
+    pthread_key_create(&g_shard_key, release_shard);
+}
+
+// 스레드당 한 번: 빈 샤드를 찾거나 새로 할당 (실패하면 공용 샤드)
+static MetricShard* acquire_shard(void) {
+    pthread_once(&g_key_once, create_shard_key);
+
+    MetricShard *shard = NULL;
+    pthread_mutex_lock(&g_register_mutex);
+    int count = __atomic_load_n(&g_shard_count, __ATOMIC_RELAXED);
+    for (int i = 0; i < count && !shard; i++) {
+        if (__atomic_load_n(&g_shards[i]->state, __ATOMIC_ACQUIRE) == SHARD_FREE) shard = g_shards[i];
+    }
+    if (!shard && count < MAX_SHARDS) {
+        MetricShard *fresh = (MetricShard *)aligned_alloc(64, sizeof(MetricShard));
+        if (fresh) {
+            memset(fresh, 0, sizeof(*fresh));
+            g_shards[count] = fresh;
+            shard = fresh;
+            __atomic_store_n(&g_shard_count, count + 1, __ATOMIC_RELEASE);
+        }
+    }
+    if (shard) __atomic_store_n(&shard->state, SHARD_ACTIVE, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&g_register_mutex);
+
+    if (!shard) {
+        // 공용 샤드는 t_shard에 두지 않음 (다음 호출에서 빈 샤드가 생겼는지 다시 봄)
+        return &g_shared_shard;
+    }
+    t_shard = shard;
+    pthread_setspecific(g_shard_key, shard);
+    return shard;
+}
+
+// 스레드 종료 시: 값은 그대로 둔 채 다음 스레드가 이어서 씀 (카운터가 줄지 않도록)
+static void release_shard(void *arg) {
+    MetricShard *shard = (MetricShard *)arg;
+    __atomic_store_n(&shard->state, SHARD_FREE, __ATOMIC_RELEASE);
+}
+
+// 전용 샤드는 쓰는 스레드가 하나라 load + store로 충분 (수집 스레드가 찢어진 값을 읽지 않도록 원자적으로)
+static inline void shard_add(MetricShard *shard, unsigned long long *slot, unsigned long long value) {
+    if (shard == &g_shared_shard) {
+        __atomic_fetch_add(slot, value, __ATOMIC_RELAXED);
+    } else {
+        __atomic_store_n(slot, __atomic_load_n(slot, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+    }
+}
+
+// 상한: 0 -> 1us, 1 -> 2us, 이후 옥타브 (2^k, 2^(k+1)]를 3 * 2^(k-1)에서 둘로 나눔
+static int bucket_index(unsigned long long us) {
+    if (us <= 1) return 0;
+    if (us <= 2) return 1;
+    int k = 63 - __builtin_clzll(us - 1);
+    int idx = 2 * k + (us > (3ULL << (k - 1)) ? 1 : 0);
+    return (idx < HIST_BUCKETS - 1) ? idx : HIST_BUCKETS - 1;
+}
+
+static unsigned long long bucket_bound_us(int idx) {
+    if (idx == 0) return 1;
+    if (idx == 1) return 2;
+    int k = idx / 2;
+    return (idx & 1) ? (1ULL << (k + 1)) : (3ULL << (k - 1));
+}
+
+// 모든 샤드 합산 (동시에 기록 중이면 sum과 버킷이 한 건 어긋날 수 있음. 다음 수집에서 맞춰짐)
+static void aggregate(MetricShard *out) {
+    memset(out, 0, sizeof(*out));
+    int count = __atomic_load_n(&g_shard_count, __ATOMIC_ACQUIRE);
+    for (int s = 0; s <= count; s++) {
+        const MetricShard *shard = (s < count) ? g_shards[s] : &g_shared_shard;
+        for (int i = 0; i < M_COUNTER_COUNT; i++) {
+            out->counters[i] += __atomic_load_n(&shard->counters[i], __ATOMIC_RELAXED);
+        }
+        for (int h = 0; h < H_COUNT; h++) {
+            const Histogram *src = &shard->hist[h];
+            Histogram *dst = &out->hist[h];
+            dst->sum_ns += __atomic_load_n(&src->sum_ns, __ATOMIC_RELAXED);
+            for (int b = 0; b < HIST_BUCKETS; b++) {
+                dst->buckets[b] += __atomic_load_n(&src->buckets[b], __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
+
+// Prometheus 텍스트 형식 0.0.4
+static void render(TextBuf *b) {
+    MetricShard *total = (MetricShard *)aligned_alloc(64, sizeof(MetricShard));
+    if (!total) {
+        b->failed = true;
+        return;
+    }
+    aggregate(total);
+
+    for (int i = 0; i < M_COUNTER_COUNT; i++) {
+        const MetricDef *d = &COUNTER_DEFS[i];
+        if (d->help) buf_printf(b, "# HELP %s %s\n# TYPE %s counter\n", d->name, d->help, d->name);
+        buf_printf(b, "%s%s%s%s %llu\n", d->name, d->labels[0] ? "{" : "", d->labels,
+                   d->labels[0] ? "}" : "", total->counters[i]);
+    }
+
+    // 닫힌 연결은 수락된 뒤에만 셈
+    unsigned long long accepted = total->counters[M_CONN_ACCEPTED];
+    unsigned long long closed = total->counters[M_CONN_CLOSED];
+    buf_printf(b, "# HELP ott_connections_active Open client connections\n"
+                  "# TYPE ott_connections_active gauge\n"
+                  "ott_connections_active %llu\n", accepted > closed ? accepted - closed : 0);
+
+    pthread_mutex_lock(&g_gauge_mutex);
+    for (int i = 0; i < g_gauge_count; i++) {
+        // 같은 이름은 처음 나온 곳에서 한꺼번에 출력
+        bool seen = false;
+        for (int j = 0; j < i && !seen; j++) seen = (strcmp(g_gauges[j].name, g_gauges[i].name) == 0);
+        if (seen) continue;
+
+        buf_printf(b, "# HELP %s %s\n# TYPE %s gauge\n", g_gauges[i].name,
+                   g_gauges[i].help ? g_gauges[i].help : g_gauges[i].name, g_gauges[i].name);
+        for (int j = i; j < g_gauge_count; j++) {
+            const Gauge *g = &g_gauges[j];
+            if (strcmp(g->name, g_gauges[i].name) != 0) continue;
+            buf_printf(b, "%s%s%s%s %.17g\n", g->name, g->labels[0] ? "{" : "", g->labels,
+                       g->labels[0] ? "}" : "", g->fn(g->arg));
+        }
+    }
+    pthread_mutex_unlock(&g_gauge_mutex);
+
+    for (int h = 0; h < H_COUNT; h++) {
+        const MetricDef *d = &HIST_DEFS[h];
+        const Histogram *hist = &total->hist[h];
+        if (d->help) buf_printf(b, "# HELP %s %s\n# TYPE %s histogram\n", d->name, d->help, d->name);
+
+        unsigned long long cumulative = 0;
+        for (int i = 0; i < HIST_BUCKETS - 1; i++) {
+            cumulative += hist->buckets[i];
+            buf_printf(b, "%s_bucket{%s,le=\"%.9g\"} %llu\n", d->name, d->labels,
+                       bucket_bound_us(i) / 1e6, cumulative);
+        }
+        cumulative += hist->buckets[HIST_BUCKETS - 1];
+        buf_printf(b, "%s_bucket{%s,le=\"+Inf\"} %llu\n", d->name, d->labels, cumulative);
+        buf_printf(b, "%s_sum{%s} %.9f\n", d->name, d->labels, hist->sum_ns / 1e9);
+        buf_printf(b, "%s_count{%s} %llu\n", d->name, d->labels, cumulative);
+    }
+
+    free(total);
+}
+
+static void buf_printf(TextBuf *b, const char *fmt, ...) {
+    if (b->failed) return;
+
+    va_list ap;
+    while (1) {
+        size_t room = b->cap - b->len;
+        va_start(ap, fmt);
+        int n = vsnprintf(b->data + b->len, room, fmt, ap);
+        va_end(ap);
+        if (n < 0) {
+            b->failed = true;
+            return;
+        }
+        if ((size_t)n < room) {
+            b->len += (size_t)n;
+            return;
+        }
+
+        size_t cap = b->cap * 2;
+        while (cap - b->len <= (size_t)n) cap *= 2;
+        char *grown = (char *)realloc(b->data, cap);
+        if (!grown) {
+            b->failed = true;
+            return;
+        }
+        b->data = grown;
+        b->cap = cap;
+    }
+}
+
+static void* listener_thread_func(void *arg) {
+    (void)arg;
+    while (!__atomic_load_n(&g_stop, __ATOMIC_ACQUIRE)) {
+        int fd = accept4(g_listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (!__atomic_load_n(&g_stop, __ATOMIC_ACQUIRE)) LOG_WARN("Metrics", "accept failed: %m");
+            break;
+        }
+        serve_client(fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+// 연결당 요청 하나 (Connection: close)
+static void serve_client(int fd) {
+    struct timeval tv = { .tv_sec = IO_TIMEOUT_SEC, .tv_usec = 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    char req[REQUEST_MAX];
+    size_t len = 0;
+    while (len < sizeof(req) - 1) {
+        ssize_t n = recv(fd, req + len, sizeof(req) - 1 - len, 0);
+        if (n <= 0) return;
+        len += (size_t)n;
+        req[len] = '\0';
+        if (strstr(req, "\r\n\r\n")) break;
+    }
+    req[len] = '\0';
+
+    char header[256];
+    bool found = strncmp(req, "GET /metrics ", 13) == 0 || strncmp(req, "GET /metrics?", 13) == 0;
+    if (!found) {
+        static const char body[] = "Not Found\n";
+        int header_len = snprintf(header, sizeof(header),
+            "HTTP/1.1 404 Not Found\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Length: %zu\r\n"
+            "Connection: close\r\n\r\n", sizeof(body) - 1);
+        if (send_all(fd, header, header_len) == 0) send_all(fd, body, sizeof(body) - 1);
+        return;
+    }
+
+    TextBuf b = { .data = malloc(64 * 1024), .len = 0, .cap = 64 * 1024, .failed = false };
+    if (!b.data) return;
+    render(&b);
+    if (b.failed) {
+        free(b.data);
+        static const char busy[] = "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 0\r\n"
+                                   "Connection: close\r\n\r\n";
+        send_all(fd, busy, sizeof(busy) - 1);
+        return;
+    }
+
+    int header_len = snprintf(header, sizeof(header),
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+        "Content-Length: %zu\r\n"
+        "Cache-Control: no-store\r\n"
+        "Connection: close\r\n\r\n", b.len);
+    if (send_all(fd, header, header_len) == 0) send_all(fd, b.data, b.len);
+    free(b.data);
+}
+
+static int send_all(int fd, const char *data, size_t len) {
+    size_t sent = 0;
+    while (sent < len) {
+        ssize_t n = send(fd, data + sent, len - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        sent += (size_t)n;
+    }
+    return 0;
+}
@@ -0,0 +1,249 @@
+// /metrics 스모크 테스트 (make bench -> build/bin/test/core/metrics_test)
+// 사용법: metrics_test [포트=19100] [스레드 수=8] [스레드당 기록 수=200000, 20의 배수]
+// 1. 여러 스레드가 카운터/히스토그램에 기록하는 동안 /metrics를 여러 번 긁어 값이 줄지 않는지 봅니다.
+// 2. 기록이 끝난 뒤 합계가 정확한지, 버킷이 누적/단조인지, +Inf와 _count가 같은지, 게이지와 HELP/TYPE 형식을 봅니다.
+// 3. /metrics 외의 경로는 404인지 봅니다.
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "core/metrics.h"
+
+#define COUNTER_STEP 3ULL
+#define MAX_SCRAPES  3
+
+static int g_failed = 0;
+
+#define CHECK(cond, ...)                                \
+    do {                                                \
+        if (!(cond)) {                                  \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__);                        \
+            printf("\n");                               \
+            g_failed++;                                 \
+        }                                               \
+    } while (0)
+
+typedef struct {
+    int id;
+    long ops;
+} Worker;
+
+static int g_port;
+static double g_gauge_a = 7.0;
+static double g_gauge_b = 0.25;
+
+static double read_gauge(void *arg) {
+    return *(double *)arg;
+}
+
+static void* worker_func(void *arg) {
+    Worker *w = (Worker *)arg;
+    for (long i = 0; i < w->ops; i++) {
+        metrics_add(M_SENDFILE_BYTES, COUNTER_STEP);
+        // 1us ~ 약 1s 사이를 고루 (버킷 여러 개에 걸치도록)
+        metrics_observe(H_ROUTE_VIDEOS, 1000LL << ((i + w->id) % 20));
+    }
+    return NULL;
+}
+
+// GET 하나를 보내고 응답 전체를 받음 (호출자가 free, 실패 NULL)
+static char* http_get(const char *path) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return NULL;
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons((uint16_t)g_port)};
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    char req[256];
+    int len = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: test\r\n\r\n", path);
+    if (send(fd, req, (size_t)len, MSG_NOSIGNAL) != len) {
+        close(fd);
+        return NULL;
+    }
+
+    // 서버가 Connection: close로 닫을 때까지 읽음
+    size_t cap = 64 * 1024, used = 0;
+    char *buf = malloc(cap);
+    while (buf) {
+        if (used + 1 >= cap) {
+            char *grown = realloc(buf, cap * 2);
+            if (!grown) {
+                free(buf);
+                buf = NULL;
+                break;
+            }
+            buf = grown;
+            cap *= 2;
+        }
+        ssize_t n = recv(fd, buf + used, cap - used - 1, 0);
+        if (n < 0) {
+            free(buf);
+            buf = NULL;
+            break;
+        }
+        if (n == 0) break;
+        used += (size_t)n;
+    }
+    close(fd);
+    if (buf) buf[used] = '\0';
+    return buf;
+}
+
+// "name{labels} value" 줄을 찾아 값을 돌려줌 (없으면 -1)
+static double sample_value(const char *body, const char *series) {
+    size_t n = strlen(series);
+    for (const char *p = body; p && *p; p = strchr(p, '\n'), p = p ? p + 1 : NULL) {
+        if (strncmp(p, series, n) == 0 && p[n] == ' ') return atof(p + n + 1);
+    }
+    return -1;
+}
+
+static int count_occurrences(const char *body, const char *needle) {
+    int count = 0;
+    for (const char *p = strstr(body, needle); p; p = strstr(p + 1, needle)) count++;
+    return count;
+}
+
+// 응답 헤더를 확인하고 본문 시작을 돌려줌
+static const char* check_response(const char *resp, int status) {
+    CHECK(resp != NULL, "no response");
+    if (!resp) return NULL;
+    CHECK(atoi(resp + 9) == status, "status %d, want %d", atoi(resp + 9), status);
+    const char *body = strstr(resp, "\r\n\r\n");
+    CHECK(body != NULL, "no header terminator");
+    if (!body) return NULL;
+    body += 4;
+    const char *cl = strstr(resp, "Content-Length: ");
+    CHECK(cl && cl < body && (size_t)atol(cl + 16) == strlen(body), "Content-Length mismatch");
+    return body;
+}
+
+// 형식: 주석이 아닌 줄은 "이름 값" 두 필드, 버킷은 누적(단조 증가), +Inf == _count
+static void check_format(const char *body) {
+    char prev_series[256] = "";
+    double prev = 0;
+    char *copy = strdup(body);
+    if (!copy) return;
+    char *save = NULL;
+    for (char *line = strtok_r(copy, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        if (line[0] == '#') {
+            CHECK(strncmp(line, "# HELP ", 7) == 0 || strncmp(line, "# TYPE ", 7) == 0, "bad comment: %s", line);
+            continue;
+        }
+        char *space = strrchr(line, ' ');
+        CHECK(space && space > line && strchr(line, ' ') == space, "bad sample: %s", line);
+        if (!space) continue;
+
+        char *le = strstr(line, ",le=\"");
+        if (!le) {
+            prev_series[0] = '\0';
+            continue;
+        }
+        double value = atof(space + 1);
+        size_t key_len = (size_t)(le - line);
+        if (key_len < sizeof(prev_series) && strncmp(prev_series, line, key_len) == 0 && prev_series[key_len] == '\0') {
+            CHECK(value >= prev, "bucket decreased: %s (prev %.0f)", line, prev);
+        } else if (key_len < sizeof(prev_series)) {
+            memcpy(prev_series, line, key_len);
+            prev_series[key_len] = '\0';
+        }
+        prev = value;
+    }
+    free(copy);
+
+    const char *route = "route=\"/api/videos\"";
+    char series[256];
+    snprintf(series, sizeof(series), "ott_request_duration_seconds_bucket{%s,le=\"+Inf\"}", route);
+    double inf = sample_value(body, series);
+    snprintf(series, sizeof(series), "ott_request_duration_seconds_count{%s}", route);
+    double count = sample_value(body, series);
+    CHECK(inf >= 0 && inf == count, "+Inf %.0f != _count %.0f", inf, count);
+}
+
+int main(int argc, char **argv) {
+    g_port = (argc > 1) ? atoi(argv[1]) : 19100;
+    int threads = (argc > 2) ? atoi(argv[2]) : 8;
+    long ops = (argc > 3) ? atol(argv[3]) : 200000;
+    if (g_port <= 0 || threads < 1 || ops < 20 || ops % 20 != 0) {
+        fprintf(stderr, "usage: %s [port] [threads] [records/thread, multiple of 20]\n", argv[0]);
+        return 1;
+    }
+
+    CHECK(metrics_register_gauge("ott_test_gauge", "kind=\"a\"", "Test gauge", read_gauge, &g_gauge_a) == 0,
+          "register a");
+    CHECK(metrics_register_gauge("ott_test_gauge", "kind=\"b\"", NULL, read_gauge, &g_gauge_b) == 0, "register b");
+    if (metrics_start("127.0.0.1", g_port) != 0) {
+        printf("FAIL metrics_start on port %d\n", g_port);
+        return 1;
+    }
+
+    Worker *workers = calloc((size_t)threads, sizeof(Worker));
+    pthread_t *tids = calloc((size_t)threads, sizeof(pthread_t));
+    if (!workers || !tids) return 1;
+    for (int i = 0; i < threads; i++) {
+        workers[i].id = i;
+        workers[i].ops = ops;
+        pthread_create(&tids[i], NULL, worker_func, &workers[i]);
+    }
+
+    // 기록 중에 긁은 값은 줄지 않아야 함
+    double last = 0;
+    for (int s = 0; s < MAX_SCRAPES; s++) {
+        char *resp = http_get("/metrics");
+        const char *body = check_response(resp, 200);
+        if (body) {
+            double v = sample_value(body, "ott_sendfile_bytes_total");
+            CHECK(v >= last, "counter went back: %.0f -> %.0f", last, v);
+            last = v;
+            check_format(body);
+        }
+        free(resp);
+    }
+    for (int i = 0; i < threads; i++) pthread_join(tids[i], NULL);
+
+    // 모든 스레드의 샤드가 합산되어야 함
+    char *resp = http_get("/metrics");
+    const char *body = check_response(resp, 200);
+    if (body) {
+        double total = (double)threads * (double)ops;
+        double bytes = sample_value(body, "ott_sendfile_bytes_total");
+        double count = sample_value(body, "ott_request_duration_seconds_count{route=\"/api/videos\"}");
+        CHECK(bytes == total * COUNTER_STEP, "counter %.0f, want %.0f", bytes, total * COUNTER_STEP);
+        CHECK(count == total, "histogram count %.0f, want %.0f", count, total);
+
+        // 1us 버킷에는 1us짜리만, 1s 위로는 넘치지 않음
+        double first = sample_value(body, "ott_request_duration_seconds_bucket{route=\"/api/videos\",le=\"1e-06\"}");
+        CHECK(first == total / 20, "1us bucket %.0f, want %.0f", first, total / 20);
+        double sum = sample_value(body, "ott_request_duration_seconds_sum{route=\"/api/videos\"}");
+        CHECK(sum > 0, "histogram sum %.9f", sum);
+
+        CHECK(sample_value(body, "ott_test_gauge{kind=\"a\"}") == 7.0, "gauge a");
+        CHECK(sample_value(body, "ott_test_gauge{kind=\"b\"}") == 0.25, "gauge b");
+        CHECK(count_occurrences(body, "# TYPE ott_test_gauge gauge\n") == 1, "gauge TYPE not printed once");
+        CHECK(count_occurrences(body, "# TYPE ott_request_duration_seconds histogram\n") == 1,
+              "histogram TYPE not printed once");
+        check_format(body);
+        printf("scraped %zu bytes: %.0f counter, %.0f observations\n", strlen(body), bytes, count);
+    }
+    free(resp);
+
+    resp = http_get("/foo");
+    check_response(resp, 404);
+    free(resp);
+
+    metrics_shutdown();
+    free(tids);
+    free(workers);
+    printf("%s (%d failed)\n", g_failed ? "FAILED" : "OK", g_failed);
+    return g_failed ? 1 : 0;
+}
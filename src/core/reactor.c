@@ -16,6 +16,8 @@
 #include "core/reactor.h"
 #include "core/thread_pool.h"
 #include "core/config_loader.h"
+#include "core/logger.h"
+#include "core/metrics.h"
 #include "app/client_event_manager.h"
 #include "app/client_context.h"
 
@@ -64,6 +66,15 @@ int reactor_init(Reactor *reactor, ThreadPool *pool, const ServerConfig *config)
             continue;
         }
 
+        // 같은 포트를 여러 서버 프로세스가 나눠 받음 (커널이 연결 분배, 세션은 SESSION_MODE=shm으로 공유)
+        if (config->reuse_port &&
+            setsockopt(listen_socket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+            perror("setsockopt(SO_REUSEPORT) failed");
+            close(listen_socket);
+            listen_socket = -1;
+            continue;
+        }
+
         if (bind(listen_socket, (struct sockaddr *)rp->ai_addr, rp->ai_addrlen) == 0) {
             break; // 바인딩 성공. 루프 탈출
         }
@@ -149,7 +160,7 @@ void reactor_run(Reactor* reactor){
                                         SOCK_NONBLOCK | SOCK_CLOEXEC);
                 if (client_fd < 0){
                     if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                        perror("accept4 failed"); 
+                        LOG_WARN("Reactor", "accept4 failed: %m");
                     }
                     continue;
                 }
@@ -157,7 +168,7 @@ void reactor_run(Reactor* reactor){
                 // ClientContext 해제, 생성: malloc/free (추후 Memory Pool로)
                 ClientContext* ctx = malloc(sizeof(ClientContext));
                 if (ctx == NULL){
-                    perror("ClientContext malloc failed");
+                    LOG_ERROR("Reactor", "ClientContext malloc failed");
                     close(client_fd);
                     continue;
                 }
@@ -169,19 +180,25 @@ void reactor_run(Reactor* reactor){
                 ctx->last_active = time(NULL);
                 ctx->state = STATE_REQ_RECEIVING;
                 ctx->file_fd = -1;
+                ctx->direct_fd = -1;
+                ctx->io_buf = -1;
+                ctx->io_dev = -1;
 
                 // 클라이언트 ip 저장 (로그용)
                 inet_ntop(AF_INET, &client_addr.sin_addr, ctx->client_ip, INET_ADDRSTRLEN);
-                printf("New Connection: %s (FD: %d)\n", ctx->client_ip, ctx->client_fd);
+                LOG_DEBUG("Reactor", "New connection: %s (fd %d)", ctx->client_ip, ctx->client_fd);
 
                 struct epoll_event client_event = {0};
                 client_event.data.ptr = ctx;
                 client_event.events = EPOLLIN | EPOLLONESHOT;
 
+                // 등록 전에 셈 (등록 직후 워커가 닫아도 열린 연결 수가 음수가 되지 않도록)
+                metrics_add(M_CONN_ACCEPTED, 1);
                 if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, client_fd, &client_event)){
-                    perror("client: epoll_ctl failed");
+                    LOG_WARN("Reactor", "client epoll_ctl failed: %m");
                     close(client_fd);
                     free(ctx);
+                    metrics_add(M_CONN_CLOSED, 1);
                     continue;
                 }
             } // listen fd
@@ -224,7 +241,7 @@ int reactor_update_event(int epoll_fd, int target_fd, int events, void *context)
     ev.data.ptr = context;
 
     if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, target_fd, &ev) < 0) {
-        perror("reactor_update_event() failed");
+        LOG_WARN("Reactor", "reactor_update_event() failed: %m");
         return -1;
     }
     return 0;
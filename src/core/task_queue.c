@@ -44,27 +44,28 @@ int task_queue_init(TaskQueue* q, int capacity){
 }
 
 // Producer
-void task_queue_enqueue(TaskQueue* q, Task task){
+int task_queue_enqueue(TaskQueue* q, Task task){
     pthread_mutex_lock(&q->mutex);
 
-    // 이미 종료 신호가 왔다면 더 이상 받지 않음
-    if (q->stop) {
-        pthread_mutex_unlock(&q->mutex);
-        return; 
-    }
-
-    while (q->size == q->capacity) {
+    while (q->size == q->capacity && !q->stop) {
         // 빈 공간이 생길 때(not_full)까지 여기서 잠들기.
         // 잠들 때는 mutex를 잠깐 반납, 깨어나면 다시 잡기.
         pthread_cond_wait(&q->cond_not_full, &q->mutex);
     }
 
+    // 종료 신호가 왔다면 (대기 중에 온 경우 포함) 더 이상 받지 않음
+    if (q->stop) {
+        pthread_mutex_unlock(&q->mutex);
+        return -2;
+    }
+
     q->tasks[q->tail] = task;
     q->tail = (q->tail + 1) % q->capacity;
     q->size++;
 
     pthread_cond_signal(&q->cond_not_empty);
     pthread_mutex_unlock(&q->mutex);
+    return 0;
 }
 
 int task_queue_try_enqueue(TaskQueue* q, Task task){
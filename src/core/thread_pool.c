@@ -3,8 +3,10 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include "core/thread_pool.h"
+#include "core/metrics.h"
 
 static void* worker_thread_func(void* arg); // 워커 스레드가 실행할 함수
+static double queue_depth_gauge(void* arg);
 
 typedef struct {
     ThreadPool* pool;
@@ -30,6 +32,8 @@ int thread_pool_init(ThreadPool* pool, int num_threads, int queue_capacity){
     }
 
     pool->num_threads = num_threads;
+    pool->wait_histogram = -1;
+    pool->reject_counter = -1;
 
     //  워커 스레드 생성 루프
     for (int i = 0; i < num_threads; ++i) {
@@ -87,6 +91,9 @@ static void* worker_thread_func(void* arg){
             printf("Worker-%d stopping.\n", idx);
             break;
         }
+        if (pool->wait_histogram >= 0) {
+            metrics_observe_since((MetricHistogram)pool->wait_histogram, task.enqueued_ns);
+        }
         task.function(task.arg);
     }
     return NULL;
@@ -95,7 +102,29 @@ static void* worker_thread_func(void* arg){
 int thread_pool_submit(ThreadPool* pool, void (*function)(void*), void* arg){
     if (pool == NULL || function == NULL) return -1;
     Task task = {.function = function, .arg = arg};
-    return task_queue_try_enqueue(&pool->queue, task);
+    if (pool->wait_histogram >= 0) task.enqueued_ns = metrics_now_ns();
+    if (task_queue_try_enqueue(&pool->queue, task) != 0) {
+        if (pool->reject_counter >= 0) metrics_add((MetricCounter)pool->reject_counter, 1);
+        return -1;
+    }
+    return 0;
+}
+
+void thread_pool_set_metrics(ThreadPool* pool, const char* name, int wait_histogram, int reject_counter){
+    if (pool == NULL) return;
+    pool->wait_histogram = wait_histogram;
+    pool->reject_counter = reject_counter;
+
+    char labels[64];
+    snprintf(labels, sizeof(labels), "pool=\"%s\"", name);
+    metrics_register_gauge("ott_task_queue_depth", labels, "Tasks waiting in the pool queue",
+                           queue_depth_gauge, pool);
+}
+
+// 수집 스레드에서 호출: 락 없이 현재 깊이만 읽음 (순간값이라 약간 어긋나도 무방)
+static double queue_depth_gauge(void* arg){
+    ThreadPool* pool = (ThreadPool*)arg;
+    return (double)__atomic_load_n(&pool->queue.size, __ATOMIC_RELAXED);
 }
 
 void thread_pool_shutdown(ThreadPool* pool){
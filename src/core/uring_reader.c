@@ -0,0 +1,368 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "core/uring_reader.h"
+
+#define SHUTDOWN_USER_DATA UINT64_MAX
+
+// 버퍼별 진행 중인 요청 정보 (user_data = 버퍼 인덱스)
+typedef struct {
+    UringReadCallback cb;
+    void *arg;
+} ReadSlot;
+
+// 커널과 공유하는 링 포인터들
+typedef struct {
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned sq_entries;
+    struct io_uring_sqe *sqes;
+
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    void *sq_ptr;
+    size_t sq_size;
+    void *cq_ptr;
+    size_t cq_size;
+    size_t sqes_size;
+} Ring;
+
+// 내부 전역 변수
+static int g_ring_fd = -1;
+static Ring g_ring;
+static pthread_mutex_t g_sq_mutex = PTHREAD_MUTEX_INITIALIZER; // SQ 제출 + 버퍼 풀 + 통계
+static pthread_t g_completion_thread;
+static bool g_thread_started = false;
+
+static char *g_buffers = NULL;
+static size_t g_buf_size = 0;
+static int g_buf_count = 0;
+static int *g_free_bufs = NULL;
+static int g_free_count = 0;
+static ReadSlot *g_slots = NULL;
+
+static UringReaderStats g_stats;
+
+// 내부 헬퍼 함수
+static int ring_setup(unsigned entries);
+static void ring_teardown(void);
+static int submit_sqe_locked(uint8_t opcode, int fd, void *addr, unsigned len,
+                             off_t offset, int buf_index, uint64_t user_data);
+static void* completion_thread_func(void *arg);
+
+static inline int sys_io_uring_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static inline int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static inline int sys_io_uring_register(int fd, unsigned opcode, const void *arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+int uring_reader_init(int buf_count, size_t buf_size) {
+    if (buf_count <= 0 || buf_size == 0) return -1;
+
+    g_buf_size = (buf_size + URING_READER_ALIGN - 1) & ~((size_t)URING_READER_ALIGN - 1);
+    g_buf_count = buf_count;
+
+    // 진행 중인 읽기 수는 버퍼 수를 넘지 않으므로 SQ도 그만큼 (+ 종료용 NOP)
+    if (ring_setup((unsigned)buf_count + 1) != 0) {
+        fprintf(stderr, "[Uring] io_uring not available, using sendfile.\n");
+        return -1;
+    }
+
+    // O_DIRECT는 버퍼 주소도 정렬되어야 함
+    if (posix_memalign((void **)&g_buffers, URING_READER_ALIGN, g_buf_size * (size_t)buf_count) != 0) {
+        g_buffers = NULL;
+        uring_reader_shutdown();
+        return -1;
+    }
+
+    g_free_bufs = (int *)malloc(sizeof(int) * buf_count);
+    g_slots = (ReadSlot *)calloc(buf_count, sizeof(ReadSlot));
+    struct iovec *iov = (struct iovec *)malloc(sizeof(struct iovec) * buf_count);
+    if (!g_free_bufs || !g_slots || !iov) {
+        free(iov);
+        uring_reader_shutdown();
+        return -1;
+    }
+
+    g_free_count = 0;
+    for (int i = buf_count - 1; i >= 0; i--) {
+        iov[i].iov_base = g_buffers + (size_t)i * g_buf_size;
+        iov[i].iov_len = g_buf_size;
+        g_free_bufs[g_free_count++] = i;
+    }
+
+    // 버퍼 등록: 매 읽기마다 페이지 고정(pin) 비용을 없앰. RLIMIT_MEMLOCK에 걸리면 일반 READ
+    if (sys_io_uring_register(g_ring_fd, IORING_REGISTER_BUFFERS, iov, (unsigned)buf_count) == 0) {
+        g_stats.fixed_buffers = 1;
+    } else {
+        perror("[Uring] Buffer registration failed (falling back to IORING_OP_READ)");
+        g_stats.fixed_buffers = 0;
+    }
+    free(iov);
+
+    if (pthread_create(&g_completion_thread, NULL, completion_thread_func, NULL) != 0) {
+        perror("[Uring] Failed to create completion thread");
+        uring_reader_shutdown();
+        return -1;
+    }
+    g_thread_started = true;
+
+    g_stats.buffers_total = buf_count;
+    printf("[Uring] Direct read engine ready: %d buffers x %zu KB (%s)\n",
+           buf_count, g_buf_size / 1024, g_stats.fixed_buffers ? "READ_FIXED" : "READ");
+    return 0;
+}
+
+int uring_reader_enabled(void) {
+    return g_thread_started;
+}
+
+size_t uring_reader_buf_size(void) {
+    return g_buf_size;
+}
+
+int uring_reader_read(int fd, off_t offset, UringReadCallback cb, void *arg) {
+    if (!g_thread_started || (offset & (URING_READER_ALIGN - 1)) != 0) return -1;
+
+    pthread_mutex_lock(&g_sq_mutex);
+    if (g_free_count == 0) {
+        g_stats.pool_exhausted++;
+        pthread_mutex_unlock(&g_sq_mutex);
+        return -1;
+    }
+
+    int idx = g_free_bufs[--g_free_count];
+    g_slots[idx].cb = cb;
+    g_slots[idx].arg = arg;
+
+    uint8_t opcode = g_stats.fixed_buffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    if (submit_sqe_locked(opcode, fd, g_buffers + (size_t)idx * g_buf_size, (unsigned)g_buf_size,
+                          offset, idx, (uint64_t)idx) != 0) {
+        g_free_bufs[g_free_count++] = idx;
+        g_stats.reads_failed++;
+        pthread_mutex_unlock(&g_sq_mutex);
+        return -1;
+    }
+
+    g_stats.reads_submitted++;
+    g_stats.buffers_in_use++;
+    pthread_mutex_unlock(&g_sq_mutex);
+    return 0;
+}
+
+void uring_reader_release(int buf_idx) {
+    if (buf_idx < 0 || buf_idx >= g_buf_count) return;
+
+    pthread_mutex_lock(&g_sq_mutex);
+    g_free_bufs[g_free_count++] = buf_idx;
+    g_stats.buffers_in_use--;
+    pthread_mutex_unlock(&g_sq_mutex);
+}
+
+void uring_reader_get_stats(UringReaderStats *out) {
+    pthread_mutex_lock(&g_sq_mutex);
+    *out = g_stats;
+    pthread_mutex_unlock(&g_sq_mutex);
+}
+
+void uring_reader_shutdown(void) {
+    if (g_thread_started) {
+        // 완료 스레드를 깨우기 위한 NOP
+        pthread_mutex_lock(&g_sq_mutex);
+        int ret = submit_sqe_locked(IORING_OP_NOP, -1, NULL, 0, 0, 0, SHUTDOWN_USER_DATA);
+        pthread_mutex_unlock(&g_sq_mutex);
+
+        if (ret == 0) pthread_join(g_completion_thread, NULL);
+        else pthread_cancel(g_completion_thread);
+        g_thread_started = false;
+    }
+
+    ring_teardown();
+
+    free(g_buffers);
+    free(g_free_bufs);
+    free(g_slots);
+    g_buffers = NULL;
+    g_free_bufs = NULL;
+    g_slots = NULL;
+    g_free_count = 0;
+    g_buf_count = 0;
+}
+
+// =========================================================
+// 링 설정 / 제출 / 완료 처리
+// =========================================================
+
+static int ring_setup(unsigned entries) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+
+    g_ring_fd = sys_io_uring_setup(entries, &p);
+    if (g_ring_fd < 0) {
+        perror("[Uring] io_uring_setup failed");
+        return -1;
+    }
+
+    Ring *r = &g_ring;
+    memset(r, 0, sizeof(*r));
+    r->sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+
+    bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        if (r->cq_size > r->sq_size) r->sq_size = r->cq_size;
+        r->cq_size = r->sq_size;
+    }
+
+    r->sq_ptr = mmap(NULL, r->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     g_ring_fd, IORING_OFF_SQ_RING);
+    if (r->sq_ptr == MAP_FAILED) {
+        r->sq_ptr = NULL;
+        ring_teardown();
+        return -1;
+    }
+
+    if (single_mmap) {
+        r->cq_ptr = r->sq_ptr;
+    } else {
+        r->cq_ptr = mmap(NULL, r->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         g_ring_fd, IORING_OFF_CQ_RING);
+        if (r->cq_ptr == MAP_FAILED) {
+            r->cq_ptr = NULL;
+            ring_teardown();
+            return -1;
+        }
+    }
+
+    r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = (struct io_uring_sqe *)mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE,
+                                         MAP_SHARED | MAP_POPULATE, g_ring_fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        r->sqes = NULL;
+        ring_teardown();
+        return -1;
+    }
+
+    char *sq = (char *)r->sq_ptr;
+    r->sq_head = (unsigned *)(sq + p.sq_off.head);
+    r->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned *)(sq + p.sq_off.array);
+    r->sq_entries = p.sq_entries;
+
+    char *cq = (char *)r->cq_ptr;
+    r->cq_head = (unsigned *)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    return 0;
+}
+
+static void ring_teardown(void) {
+    Ring *r = &g_ring;
+    if (r->sqes) munmap(r->sqes, r->sqes_size);
+    if (r->cq_ptr && r->cq_ptr != r->sq_ptr) munmap(r->cq_ptr, r->cq_size);
+    if (r->sq_ptr) munmap(r->sq_ptr, r->sq_size);
+    memset(r, 0, sizeof(*r));
+
+    if (g_ring_fd >= 0) close(g_ring_fd);
+    g_ring_fd = -1;
+}
+
+// g_sq_mutex를 잡은 상태에서 호출
+static int submit_sqe_locked(uint8_t opcode, int fd, void *addr, unsigned len,
+                             off_t offset, int buf_index, uint64_t user_data) {
+    Ring *r = &g_ring;
+    unsigned tail = *r->sq_tail;
+    unsigned head = __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+    if (tail - head >= r->sq_entries) return -1; // SQ 가득 참
+
+    unsigned idx = tail & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)addr;
+    sqe->len = len;
+    sqe->off = (uint64_t)offset;
+    sqe->buf_index = (uint16_t)buf_index;
+    sqe->user_data = user_data;
+
+    r->sq_array[idx] = idx;
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    int ret;
+    do {
+        ret = sys_io_uring_enter(g_ring_fd, 1, 0, 0);
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret < 0) {
+        perror("[Uring] io_uring_enter(submit) failed");
+        return -1;
+    }
+    return 0;
+}
+
+static void* completion_thread_func(void *arg) {
+    (void)arg;
+    Ring *r = &g_ring;
+
+    while (1) {
+        int ret = sys_io_uring_enter(g_ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+        if (ret < 0 && errno != EINTR) {
+            perror("[Uring] io_uring_enter(wait) failed");
+            break;
+        }
+
+        unsigned head = *r->cq_head;
+        unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+        bool stop = false;
+
+        while (head != tail) {
+            struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+            uint64_t user_data = cqe->user_data;
+            int res = cqe->res;
+            head++;
+
+            if (user_data == SHUTDOWN_USER_DATA) {
+                stop = true;
+                continue;
+            }
+
+            int idx = (int)user_data;
+            pthread_mutex_lock(&g_sq_mutex);
+            if (res >= 0) g_stats.bytes_read += (unsigned long long)res;
+            else g_stats.reads_failed++;
+            pthread_mutex_unlock(&g_sq_mutex);
+
+            // 콜백이 EPOLLOUT을 걸어 워커가 소켓 쓰기를 이어감
+            g_slots[idx].cb(g_slots[idx].arg, idx, g_buffers + (size_t)idx * g_buf_size, res);
+        }
+        __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+
+        if (stop) break;
+    }
+    return NULL;
+}
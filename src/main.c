@@ -3,12 +3,30 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <signal.h>
+#include <strings.h>
 
 #include "core/reactor.h"
 #include "core/thread_pool.h"
 #include "core/config_loader.h"
+#include "core/uring_reader.h"
 #include "app/http_handler.h"
+#include "app/auth_handler.h"
+#include "app/password_hash.h"
 #include "app/db_handler.h"
+#include "app/thumbnail_worker.h"
+#include "app/library_scanner.h"
+#include "app/segment_cache.h"
+#include "app/device_io.h"
+#include "app/tiering.h"
+#include "app/prewarm.h"
+#include "app/session_manager.h"
+#include "app/hmac_keyring.h"
+#include "app/signed_url.h"
+#include "app/history_buffer.h"
+#include "app/catalog.h"
+#include "app/continue_watching.h"
+#include "core/logger.h"
+#include "core/metrics.h"
 
  // 시그널 핸들러용
 Reactor *g_reactor_ptr = NULL;
@@ -32,19 +50,39 @@ void signal_handler(int sig) {
         return -1;
     }
 
-    if (db_init("ott.db") != 0) {
+    // 다른 스레드보다 먼저 (이후 요청 경로의 로그는 스레드별 링 -> 백그라운드 기록)
+    logger_init(config.log_level, config.log_file, config.log_ring_slots);
+
+    // 읽기 연결은 기본적으로 워커마다 하나
+    int read_pool = config.db_read_pool_size > 0 ? config.db_read_pool_size : config.thread_num;
+    if (db_init("ott.db", read_pool) != 0) {
         fprintf(stderr, "Failed to initialize Database.\n");
         return -1;
     }
 
+    // 이전 실행에서 인덱싱된 목록으로 카탈로그 스냅샷 (이후 라이브러리 변경 시 교체)
+    catalog_init(config.video_list_page_max);
+    catalog_refresh();
+    continue_watching_init(config.continue_cache_users);
+
+    // 실패해도 서버는 sendfile만으로 동작
+    segment_cache_init(config.segment_cache_mb);
+    if (strcasecmp(config.read_engine, "direct") == 0) {
+        uring_reader_init(config.direct_io_buffers, (size_t)config.direct_io_buffer_kb * 1024);
+    }
+
     ThreadPool pool = {0};;
     if (thread_pool_init(&pool, config.thread_num, config.queue_capacity)) {
         fprintf(stderr, "Failed to init thread pool.\n");
         db_cleanup();
         return -1;
     }
+    thread_pool_set_metrics(&pool, "request", H_QUEUE_WAIT_REQUEST, M_QUEUE_REJECTED_REQUEST);
 
-    if (session_system_init() != 0) {
+    // 세션 토큰과 서명 URL이 같은 키를 사용
+    if (hmac_keyring_init(config.session_key_file) != 0 ||
+        session_system_init(config.session_mode, config.session_max_count,
+                            config.session_revoke_capacity, config.session_shm_name) != 0) {
         fprintf(stderr, "Failed to init session system.\n");
         thread_pool_shutdown(&pool);
         thread_pool_wait(&pool);
@@ -53,6 +91,9 @@ void signal_handler(int sig) {
         return -1;
     }
 
+    session_persist_init(config.session_snapshot_file, config.session_snapshot_interval);
+    signed_url_init(config.signed_url_ttl_sec);
+
     Reactor reactor = {0};
     if (reactor_init(&reactor, &pool, &config) != 0) {
         fprintf(stderr, "Failed to init reactor.\n");
@@ -64,6 +105,48 @@ void signal_handler(int sig) {
         return 1;
     }
 
+    // 로그인 해시는 별도 풀에서 (로그인 폭주가 스트리밍 워커를 점유하지 않도록)
+    password_hash_init(config.scrypt_log2_n, config.scrypt_r, config.scrypt_p);
+    auth_pool_init(config.auth_thread_num, config.auth_queue_capacity);
+
+    if (library_init(config.media_roots, config.scan_thread_num, config.thumb_format) != 0) {
+        fprintf(stderr, "No media roots configured.\n");
+    }
+
+    // 미디어 루트와 정적 디렉토리를 장치별 I/O 큐에 매핑
+    device_io_init(config.device_io_threads, config.device_io_max_active);
+    for (int i = 0; i < library_root_count(); i++) {
+        device_io_register_path(library_root_path(i));
+    }
+    device_io_register_path("./static");
+
+    if (tiering_init(config.fast_tier_dir, (size_t)config.fast_tier_max_mb,
+                     config.tier_promote_threshold, config.tier_copy_rate_mbps) == 0) {
+        device_io_register_path(tiering_fast_dir());
+    }
+
+    // 리스너가 열린 뒤에 썸네일 생성 시작 (기동 시간이 라이브러리 크기에 좌우되지 않도록)
+    if (thumbnail_worker_init(config.thumb_thread_num, config.queue_capacity,
+                              config.trickplay_interval) == 0) {
+        thumbnail_worker_schedule_catalog();
+    } else {
+        fprintf(stderr, "Thumbnail worker disabled.\n");
+    }
+
+    // 라이브러리 스캔도 백그라운드에서 (변경된 파일만 썸네일 워커로 넘김)
+    if (library_start() != 0) {
+        fprintf(stderr, "Library indexer disabled.\n");
+    }
+
+    // 시청 이력 하트비트를 모아 주기적으로 한 트랜잭션에 기록
+    history_buffer_init(config.history_flush_interval_sec, config.history_buffer_max);
+
+    // 재시작 직후 이어보기 요청이 콜드 디스크를 만나지 않도록 페이지 캐시 프리웜
+    prewarm_start(config.prewarm_top_n, config.prewarm_budget_mb, config.prewarm_interval_sec);
+
+    // 수집은 전용 스레드에서 (요청 큐가 밀려도 메트릭은 응답)
+    metrics_start(config.metrics_bind, config.metrics_port);
+
     g_reactor_ptr = &reactor;
     signal(SIGINT, signal_handler);
 
@@ -71,14 +154,29 @@ void signal_handler(int sig) {
     reactor_run(&reactor);
 
     printf("Cleaning up resources...\n");
+
+    metrics_shutdown();
+    prewarm_shutdown();
+    library_shutdown();
+    tiering_shutdown();
+    thumbnail_worker_shutdown();
     
     thread_pool_shutdown(&pool);
     thread_pool_wait(&pool);
     thread_pool_cleanup(&pool);
+    auth_pool_shutdown();      // 요청 워커가 더 넘기지 않으므로 남은 인증만 처리
+    history_buffer_shutdown(); // 워커가 모두 멈춘 뒤 남은 위치를 DB에 기록
+    device_io_shutdown();
+    uring_reader_shutdown();
     
     reactor_destroy(&reactor);
+    segment_cache_cleanup();
     session_system_cleanup();
+    hmac_keyring_cleanup();
+    catalog_cleanup();
+    continue_watching_cleanup();
     db_cleanup();
+    logger_shutdown();         // 모든 스레드가 멈춘 뒤 남은 로그 기록
 
     printf("Server stopped cleanly.\n");
     return 0;